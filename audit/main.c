@@ -0,0 +1,743 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+
+/* Looks for netlists that can come up in the game, but are missing
+   from the oracle table. Engine_ConsultOracle turns all of the LEDs
+   off for a netlist it can't find, which is right for most of them
+   (the table only holds netlists that light something up), so a
+   netlist only counts as missing when Engine_EvaluateLeds says some
+   LED should be on. ledcheck/ makes sure the rules agree with every
+   entry that is in the table.
+
+   For each level, the boards the player can make from it are run
+   through the engine in each switch position: any number of pieces
+   from the hand placed in any of the blank squares, in any rotation,
+   along with any rotation of the pieces that can be rotated in place.
+   Only boards that could have a different netlist are searched:
+   identical pieces in the hand are only placed one way, only one of
+   the rotations that conduct the same way is tried (see
+   Engine_EquivalentPiece), and a piece from the hand is never placed
+   where pruning would take all of it away again (see
+   Engine_PieceSurvivesPruning), since that's the same netlist as
+   leaving it in the hand. A level that takes more nodes than the
+   budget (-b) is cut off there, and gets that many random boards
+   instead. With -r, that many boards made of random pieces are run
+   through as well.
+
+   The distinct netlists of the boards without a short circuit are
+   gathered in a hash set shared by one thread per CPU, and each one
+   that is missing from the table is printed along with the first
+   board that produced it.
+
+   Example:
+     circuit/audit$ ./main                  (all levels)
+     circuit/audit$ ./main 12 33            (just levels 12 and 33)
+     circuit/audit$ ./main -r 100000000 0   (only random boards)
+     circuit/audit$ ./main -t 4 -b 1000000  (on 4 threads, with a smaller budget per level) */
+
+#include "../data/levels.inc"
+// (under another name, since engine.c may include the same table)
+#define sorted_netlists_and_led_states audit_netlists_and_led_states
+#include "../oracle2/sorted_netlists_and_led_states.inc"
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+// The level layout, as in circuit.c
+#define GOAL_WIDTH 4
+#define GOAL_HEIGHT 3
+#define HAND_WIDTH 5
+#define HAND_HEIGHT 2
+#define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
+#define LEVELS (sizeof(levelData) / LEVEL_SIZE)
+#define BOARD_OFFSET_IN_LEVEL 0
+#define HAND_OFFSET_IN_LEVEL (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT)
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define MAX_TOKENS (HAND_WIDTH * HAND_HEIGHT)
+#define MAX_THREADS 256
+#define TASKS_PER_THREAD 64 // split each level into at least this many pieces of work per thread
+#define DEFAULT_BUDGET 20000000
+#define BUDGET_CHUNK 4096 // nodes each worker counts up before adding them to the total
+#define DEFAULT_SET_BITS 22 // 4M slots, 16 MB
+#define SET_FULL(bits) ((1UL << (bits)) / 10 * 9)
+#define RANDOM_LEVEL 0 // stands in for the level number of the random boards
+
+#define CELL_FIXED  0 // locked in place
+#define CELL_ROTATE 1 // can be rotated in place
+#define CELL_OPEN   2 // blank, so a piece from the hand may go here
+
+#define NO_TOKEN 0xFF
+
+struct LEVEL;
+typedef struct LEVEL LEVEL;
+
+struct LEVEL {
+  uint8_t number;
+  uint8_t board[CELLS];      // the pieces that start on the board, P_BLANK where the hand can go
+  uint8_t kind[CELLS];       // CELL_*
+  uint8_t rotations[CELLS][4]; // the rotations a CELL_ROTATE square can have
+  uint8_t count[CELLS];
+  uint8_t order[CELLS];      // the squares that can change, in the order they get decided
+  uint8_t orderCount;
+  uint8_t tokenRotations[MAX_TOKENS][4]; // the rotations of each piece in the hand
+  uint8_t tokenCount[MAX_TOKENS];
+  uint8_t tokenSame[MAX_TOKENS]; // an identical piece earlier in the hand, which has to be placed first, or NO_TOKEN
+  uint8_t tokens;
+};
+
+struct TASK;
+typedef struct TASK TASK;
+
+// A board with the first 'depth' squares of order[] decided
+struct TASK {
+  uint8_t board[CELLS];
+  uint32_t decided; // bit i is set once board[i] can't change anymore
+  uint16_t used;    // bit i is set once tokens[i] has been placed
+  uint8_t depth;
+};
+
+struct MISSING;
+typedef struct MISSING MISSING;
+
+struct MISSING {
+  uint32_t netlist;
+  uint8_t leds;     // what Engine_EvaluateLeds says it should light up
+  uint8_t level;    // or RANDOM_LEVEL
+  uint8_t board[CELLS];
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  ENGINE engine;
+  uint64_t seed;
+  uint64_t nodes;     // squares decided, not yet added to spentNodes
+  uint64_t boards;    // boards run through the engine, counting each switch position
+  uint64_t shorts;
+  uint64_t samples;   // random boards still to make
+};
+
+// Which part of the audit the workers are on
+static const LEVEL* level;    // or NULL for random boards
+static TASK* tasks;
+static uint32_t taskCount;
+static uint32_t taskCapacity;
+static uint32_t nextTask;
+static uint64_t nodeBudget;
+static uint64_t spentNodes;
+static bool stopped;          // the search ran out of budget
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+
+// The distinct netlists that have come up so far, as open addressing with linear probing. Slots hold the
+// netlist with the top bit set, so that 0 can mean empty.
+#define SET_OCCUPIED 0x80000000
+static uint32_t* set;
+static uint8_t setBits = DEFAULT_SET_BITS;
+static uint32_t setCount;
+
+static pthread_mutex_t missingLock = PTHREAD_MUTEX_INITIALIZER;
+static MISSING* missing;
+static uint32_t missingCount;
+static uint32_t missingCapacity;
+static uint32_t tableHits;    // distinct netlists the table has
+static uint32_t absentDark;   // distinct netlists the table doesn't have, and that shouldn't light anything
+
+static bool IsSwitch(uint8_t piece)
+{
+  return (piece >= P_SW1_BL && piece <= P_SW1_RB) || (piece >= P_SW2_BT && piece <= P_SW2_RL) || (piece >= P_SW3_BR && piece <= P_SW3_RT);
+}
+
+// The rotations a piece can be turned into, as a run of 'count' pieces starting at 'first'. The
+// *_U pieces stand for their whole group, and switches always use the SW1 position here.
+static uint8_t Rotations(uint8_t piece, uint8_t* first)
+{
+  switch (piece) {
+  case P_VCC_U:        piece = P_VCC_T; break;
+  case P_GND_U:        piece = P_GND_LTR; break;
+  case P_SW1_U:
+  case P_SW2_U:
+  case P_SW3_U:        piece = P_SW1_BL; break;
+  case P_RLED_U:       piece = P_RLED_AB_CR; break;
+  case P_YLED_U:       piece = P_YLED_AL_CR; break;
+  case P_GLED_U:       piece = P_GLED_AB_CL; break;
+  case P_STRAIGHT_U:   piece = P_STRAIGHT_LR; break;
+  case P_DBL_CORNER_U: piece = P_DBL_CORNER_TL_BR; break;
+  case P_CORNER_U:     piece = P_CORNER_BL; break;
+  case P_TPIECE_U:     piece = P_TPIECE_RBL; break;
+  case P_BRIDGE_U:     piece = P_BRIDGE1_TB_LR; break;
+  }
+  if (IsSwitch(piece))
+    piece = P_SW1_BL + ((piece - P_SW1_BL) & 3);
+
+  if (piece >= P_VCC_T && piece <= P_GLED_AR_CB) {
+    *first = ((piece - P_VCC_T) & ~3) + P_VCC_T;
+    return 4;
+  }
+  if (piece >= P_CORNER_BL && piece <= P_TPIECE_TRB) {
+    *first = ((piece - P_CORNER_BL) & ~3) + P_CORNER_BL;
+    return 4;
+  }
+  if (piece >= P_STRAIGHT_LR && piece <= P_BRIDGE2_TB_LR && piece != P_BLOCKER) {
+    *first = ((piece - P_STRAIGHT_LR) & ~1) + P_STRAIGHT_LR; // straights, double corners, and bridges come in pairs
+    return 2;
+  }
+  *first = piece;
+  return 1;
+}
+
+// The rotations of a piece that make a difference to the netlist. A switch has
+// to match in all three positions, since only the SW1 position gets placed.
+static uint8_t Orientations(uint8_t piece, uint8_t rotations[4])
+{
+  uint8_t first;
+  uint8_t count = Rotations(piece, &first);
+  uint8_t n = 0;
+  for (uint8_t r = 0; r < count; ++r) {
+    bool seen = false;
+    for (uint8_t j = 0; j < n && !seen; ++j) {
+      seen = true;
+      for (uint8_t p = 0; p < (IsSwitch(first) ? 3 : 1); ++p)
+        if (Engine_EquivalentPiece(rotations[j] + p * (P_SW2_BT - P_SW1_BL)) != Engine_EquivalentPiece(first + r + p * (P_SW2_BT - P_SW1_BL)))
+          seen = false;
+    }
+    if (!seen)
+      rotations[n++] = first + r;
+  }
+  return n;
+}
+
+static void DecodeLevel(uint8_t number, LEVEL* level)
+{
+  const uint8_t* data = &levelData[(number - 1) * LEVEL_SIZE];
+  memset(level, 0, sizeof(*level));
+  level->number = number;
+
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t piece = pgm_read_byte(&data[BOARD_OFFSET_IN_LEVEL + i]);
+    level->kind[i] = CELL_FIXED;
+    if (piece == P_BLANK) {
+      level->kind[i] = CELL_OPEN;
+    } else if (piece >= P_VCC_U) {
+      level->count[i] = Orientations(piece, level->rotations[i]);
+      piece = level->rotations[i][0];
+      if (level->count[i] > 1)
+        level->kind[i] = CELL_ROTATE;
+    }
+    level->board[i] = piece;
+    if (level->kind[i] != CELL_FIXED)
+      level->order[level->orderCount++] = i;
+  }
+
+  for (uint8_t i = 0; i < HAND_WIDTH * HAND_HEIGHT; ++i) {
+    uint8_t piece = pgm_read_byte(&data[HAND_OFFSET_IN_LEVEL + i]);
+    if (piece == P_BLANK)
+      continue;
+    uint8_t t = level->tokens++;
+    level->tokenCount[t] = Orientations(piece, level->tokenRotations[t]);
+    uint8_t same = NO_TOKEN;
+    for (uint8_t u = 0; u < t; ++u)
+      if (level->tokenRotations[u][0] == level->tokenRotations[t][0])
+        same = u;
+    level->tokenSame[t] = same;
+  }
+}
+
+static uint64_t Random(WORKER* w)
+{
+  // xorshift64*
+  w->seed ^= w->seed >> 12;
+  w->seed ^= w->seed << 25;
+  w->seed ^= w->seed >> 27;
+  return w->seed * 0x2545F4914F6CDD1DULL;
+}
+
+static bool InTable(uint32_t nl)
+{
+  int32_t low = 0;
+  int32_t high = NELEMS(sorted_netlists_and_led_states) - 1;
+  while (low <= high) {
+    int32_t mid = (low + high) / 2;
+    uint32_t netlist = sorted_netlists_and_led_states[mid] & NETLIST_NETLIST_MASK;
+    if (netlist == nl)
+      return true;
+    if (netlist < nl)
+      low = mid + 1;
+    else
+      high = mid - 1;
+  }
+  return false;
+}
+
+// Returns true if the netlist hadn't come up before
+static bool Insert(uint32_t nl)
+{
+  uint32_t mask = (1UL << setBits) - 1;
+  uint32_t key = nl | SET_OCCUPIED;
+  for (uint32_t i = (nl * 0x9E3779B1U) >> (32 - setBits);; i = (i + 1) & mask) {
+    uint32_t slot = __atomic_load_n(&set[i], __ATOMIC_RELAXED);
+    if (slot == key)
+      return false;
+    if (slot == 0) {
+      if (__atomic_compare_exchange_n(&set[i], &slot, key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+      if (slot == key) // someone else just put it there
+        return false;
+    }
+  }
+
+  if (__atomic_add_fetch(&setCount, 1, __ATOMIC_RELAXED) > SET_FULL(setBits)) {
+    fprintf(stderr, "The netlist set is full, try -s %u\n", setBits + 1);
+    exit(EXIT_FAILURE);
+  }
+  return true;
+}
+
+static void Record(uint32_t nl, const uint8_t board[CELLS])
+{
+  if (!Insert(nl))
+    return;
+  if (InTable(nl)) {
+    __atomic_add_fetch(&tableHits, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  uint8_t leds = Engine_EvaluateLeds(nl);
+  if (!leds) {
+    __atomic_add_fetch(&absentDark, 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  pthread_mutex_lock(&missingLock);
+  if (missingCount == missingCapacity) {
+    missingCapacity = missingCapacity ? missingCapacity * 2 : 64;
+    missing = realloc(missing, missingCapacity * sizeof(MISSING));
+    if (!missing) {
+      perror("realloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+  MISSING* m = &missing[missingCount++];
+  m->netlist = nl;
+  m->leds = leds;
+  m->level = level ? level->number : RANDOM_LEVEL;
+  memcpy(m->board, board, CELLS);
+  pthread_mutex_unlock(&missingLock);
+}
+
+// Runs a board through the engine the same way BoardChanged does, once for each position the switches can be in
+static void Evaluate(WORKER* w, uint8_t board[CELLS])
+{
+  const uint8_t (*rows)[BOARD_WIDTH] = (const uint8_t (*)[BOARD_WIDTH])board;
+  uint8_t original[CELLS];
+  bool hasSwitch = false;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    hasSwitch |= IsSwitch(board[i]);
+  if (hasSwitch)
+    memcpy(original, board, CELLS);
+
+  for (uint8_t p = 0; p < (hasSwitch ? 3 : 1); ++p) {
+    // Pressing the button moves every switch on the board at once
+    if (hasSwitch)
+      for (uint8_t i = 0; i < CELLS; ++i)
+        if (IsSwitch(original[i]))
+          board[i] = P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((original[i] - P_SW1_BL) & 3);
+    Engine_PruneBoard(&w->engine, rows, PRUNEBOARD_FLAG_NORMAL);
+    Engine_UpdateNetlist(&w->engine);
+    w->boards++;
+    if (Engine_IsShort(&w->engine))
+      w->shorts++;
+    else
+      Record(Engine_PackNetlist(&w->engine), board);
+  }
+
+  if (hasSwitch)
+    memcpy(board, original, CELLS);
+}
+
+// Whether the piece on square c might keep some of its ports once the board is pruned, assuming
+// every undecided neighbor will end up facing back at it. Switches get every position tried.
+static bool Survives(const TASK* task, uint8_t c)
+{
+  uint8_t x = c % BOARD_WIDTH;
+  uint8_t y = c / BOARD_WIDTH;
+  uint8_t valid = 0;
+  if (y > 0 && (!(task->decided & (1UL << (c - BOARD_WIDTH))) || (Engine_MeetsRulesPorts(task->board[c - BOARD_WIDTH]) & D_OUT_B)))
+    valid |= D_OUT_T;
+  if (x < BOARD_WIDTH - 1 && (!(task->decided & (1UL << (c + 1))) || (Engine_MeetsRulesPorts(task->board[c + 1]) & D_OUT_L)))
+    valid |= D_OUT_R;
+  if (y < BOARD_HEIGHT - 1 && (!(task->decided & (1UL << (c + BOARD_WIDTH))) || (Engine_MeetsRulesPorts(task->board[c + BOARD_WIDTH]) & D_OUT_T)))
+    valid |= D_OUT_B;
+  if (x > 0 && (!(task->decided & (1UL << (c - 1))) || (Engine_MeetsRulesPorts(task->board[c - 1]) & D_OUT_R)))
+    valid |= D_OUT_L;
+
+  uint8_t piece = task->board[c];
+  if (!IsSwitch(piece))
+    return Engine_PieceSurvivesPruning(piece, valid);
+  for (uint8_t p = 0; p < 3; ++p)
+    if (Engine_PieceSurvivesPruning(P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((piece - P_SW1_BL) & 3), valid))
+      return true;
+  return false;
+}
+
+// Deciding square c can leave it, or a piece from the hand next to it, with nothing to connect to
+static bool Useful(const TASK* task, uint8_t c)
+{
+  if (level->kind[c] == CELL_OPEN && task->board[c] != P_BLANK && !Survives(task, c))
+    return false;
+  uint8_t x = c % BOARD_WIDTH;
+  uint8_t y = c / BOARD_WIDTH;
+  uint8_t neighbors[4];
+  uint8_t count = 0;
+  if (y > 0)
+    neighbors[count++] = c - BOARD_WIDTH;
+  if (x < BOARD_WIDTH - 1)
+    neighbors[count++] = c + 1;
+  if (y < BOARD_HEIGHT - 1)
+    neighbors[count++] = c + BOARD_WIDTH;
+  if (x > 0)
+    neighbors[count++] = c - 1;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t n = neighbors[i];
+    if (level->kind[n] == CELL_OPEN && (task->decided & (1UL << n)) && task->board[n] != P_BLANK && !Survives(task, n))
+      return false;
+  }
+  return true;
+}
+
+static void Search(WORKER* w, TASK* task);
+
+static void Try(WORKER* w, TASK* task, uint8_t c, uint8_t piece)
+{
+  if (++w->nodes == BUDGET_CHUNK) {
+    if (__atomic_add_fetch(&spentNodes, w->nodes, __ATOMIC_RELAXED) > nodeBudget)
+      __atomic_store_n(&stopped, true, __ATOMIC_RELAXED);
+    w->nodes = 0;
+  }
+
+  task->board[c] = piece;
+  if (Useful(task, c))
+    Search(w, task);
+}
+
+static void Search(WORKER* w, TASK* task)
+{
+  if (task->depth == level->orderCount) {
+    Evaluate(w, task->board);
+    return;
+  }
+  if (__atomic_load_n(&stopped, __ATOMIC_RELAXED))
+    return;
+
+  uint8_t c = level->order[task->depth++];
+  task->decided |= (1UL << c);
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      Try(w, task, c, level->rotations[c][r]);
+  } else {
+    Try(w, task, c, P_BLANK);
+
+    uint16_t used = task->used;
+    for (uint8_t t = 0; t < level->tokens; ++t)
+      if (!(used & (1U << t)) && (level->tokenSame[t] == NO_TOKEN || (used & (1U << level->tokenSame[t])))) {
+        task->used = used | (1U << t);
+        for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+          Try(w, task, c, level->tokenRotations[t][r]);
+      }
+    task->used = used;
+  }
+  task->board[c] = level->board[c];
+  task->decided &= ~(1UL << c);
+  task->depth--;
+}
+
+// Splits the search into tasks that each decide the first 'depth' squares a different way
+static void AddTasks(TASK* task, uint8_t depth)
+{
+  if (task->depth == depth) {
+    if (taskCount == taskCapacity) {
+      taskCapacity = taskCapacity ? taskCapacity * 2 : 1024;
+      tasks = realloc(tasks, taskCapacity * sizeof(TASK));
+      if (!tasks) {
+        perror("realloc");
+        exit(EXIT_FAILURE);
+      }
+    }
+    tasks[taskCount++] = *task;
+    return;
+  }
+
+  TASK next = *task;
+  uint8_t c = level->order[next.depth++];
+  next.decided |= (1UL << c);
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r) {
+      next.board[c] = level->rotations[c][r];
+      if (Useful(&next, c))
+        AddTasks(&next, depth);
+    }
+    return;
+  }
+  next.board[c] = P_BLANK;
+  if (Useful(&next, c))
+    AddTasks(&next, depth);
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t)) && (level->tokenSame[t] == NO_TOKEN || (task->used & (1U << level->tokenSame[t])))) {
+      next.used = task->used | (1U << t);
+      for (uint8_t r = 0; r < level->tokenCount[t]; ++r) {
+        next.board[c] = level->tokenRotations[t][r];
+        if (Useful(&next, c))
+          AddTasks(&next, depth);
+      }
+    }
+}
+
+// A board the player could make from the level: a random number of random pieces from the hand, in random blank squares
+static void RandomLevelBoard(WORKER* w, uint8_t board[CELLS])
+{
+  uint8_t open[CELLS];
+  uint8_t openCount = 0;
+  memcpy(board, level->board, CELLS);
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if (level->kind[i] == CELL_ROTATE)
+      board[i] = level->rotations[i][Random(w) % level->count[i]];
+    else if (level->kind[i] == CELL_OPEN)
+      open[openCount++] = i;
+
+  uint8_t hand[MAX_TOKENS];
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    hand[t] = t;
+  uint8_t most = (level->tokens < openCount) ? level->tokens : openCount;
+  uint8_t placed = Random(w) % (most + 1);
+  for (uint8_t k = 0; k < placed; ++k) {
+    uint8_t j = k + Random(w) % (level->tokens - k);
+    uint8_t t = hand[j];
+    hand[j] = hand[k];
+    uint8_t s = k + Random(w) % (openCount - k);
+    uint8_t c = open[s];
+    open[s] = open[k];
+    board[c] = level->tokenRotations[t][Random(w) % level->tokenCount[t]];
+  }
+}
+
+// Any piece at all (other than a blocker) in any square, with about one in eight left blank
+static void RandomBoard(WORKER* w, uint8_t board[CELLS])
+{
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint64_t r = Random(w);
+    board[i] = (r % 8 == 0) ? P_BLANK : P_VCC_T + (r >> 3) % (P_BLOCKER - P_VCC_T);
+  }
+}
+
+static void* Work(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  uint8_t board[CELLS];
+
+  for (; w->samples; w->samples--) {
+    if (level)
+      RandomLevelBoard(w, board);
+    else
+      RandomBoard(w, board);
+    Evaluate(w, board);
+  }
+
+  for (;;) {
+    uint32_t t = __atomic_fetch_add(&nextTask, 1, __ATOMIC_RELAXED);
+    if (t >= taskCount)
+      break;
+    TASK task = tasks[t];
+    Search(w, &task);
+  }
+  return NULL;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Either searches 'tasks', or makes 'samples' random boards, on every thread
+static void Run(uint64_t samples, uint64_t* boards, uint64_t* shorts)
+{
+  nextTask = 0;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    WORKER* w = &workers[t];
+    memset(&w->engine, 0, sizeof(w->engine));
+    w->nodes = w->boards = w->shorts = 0;
+    w->samples = samples / workerCount + (t < samples % workerCount);
+    if (pthread_create(&w->thread, NULL, Work, w)) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  }
+  *boards = *shorts = 0;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    pthread_join(workers[t].thread, NULL);
+    *boards += workers[t].boards;
+    *shorts += workers[t].shorts;
+    spentNodes += workers[t].nodes;
+  }
+}
+
+static void AuditLevel(uint8_t number, uint64_t budget, uint64_t* totalBoards)
+{
+  static LEVEL decoded;
+  DecodeLevel(number, &decoded);
+  level = &decoded;
+
+  uint32_t before = setCount;
+  uint64_t boards, shorts;
+  double start = Now();
+
+  TASK root;
+  memcpy(root.board, level->board, CELLS);
+  root.decided = 0;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if (level->kind[i] == CELL_FIXED)
+      root.decided |= (1UL << i);
+  root.used = 0;
+  root.depth = 0;
+  uint8_t depth = 0;
+  do {
+    taskCount = 0;
+    AddTasks(&root, ++depth);
+  } while (depth < level->orderCount && taskCount < workerCount * TASKS_PER_THREAD);
+
+  nodeBudget = budget;
+  spentNodes = 0;
+  stopped = false;
+  Run(0, &boards, &shorts);
+  printf("Level %02u: %s %lu nodes, %lu boards, %lu shorts", number, stopped ? "stopped after" : "all of", spentNodes,
+         boards, shorts);
+
+  if (stopped) {
+    uint64_t sampled, sampledShorts;
+    taskCount = 0;
+    Run(budget, &sampled, &sampledShorts);
+    boards += sampled;
+    printf(", then %lu random boards, %lu shorts", sampled, sampledShorts);
+  }
+  *totalBoards += boards;
+  printf(", %u new netlists, %.2f s\n", setCount - before, Now() - start);
+}
+
+static void PrintBoard(const uint8_t board[CELLS])
+{
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y) {
+    printf(" ");
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+      printf(" %2u", board[y * BOARD_WIDTH + x]);
+    printf("\n");
+  }
+}
+
+static int CompareMissing(const void* a, const void* b)
+{
+  uint32_t x = ((const MISSING*)a)->netlist;
+  uint32_t y = ((const MISSING*)b)->netlist;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t budget = DEFAULT_BUDGET;
+  uint64_t randomBoards = 0;
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t"))
+      cpus = atol(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-b"))
+      budget = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-r"))
+      randomBoards = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-s"))
+      setBits = atoi(argv[2]);
+    else
+      break;
+    argc -= 2;
+    argv += 2;
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  for (uint32_t t = 0; t < workerCount; ++t)
+    workers[t].seed = (t + 1) * 0x9E3779B97F4A7C15ULL; // xorshift gets stuck at 0
+  if (setBits < 10 || setBits > 31) {
+    fprintf(stderr, "The set size goes from 10 to 31 bits\n");
+    return EXIT_FAILURE;
+  }
+  set = calloc(1UL << setBits, sizeof(uint32_t));
+  if (!set) {
+    perror("calloc");
+    return EXIT_FAILURE;
+  }
+
+  // Level 0 means no levels, for just auditing random boards
+  uint8_t levels[LEVELS];
+  uint8_t levelCount = 0;
+  bool none = false;
+  for (int i = 1; i < argc; ++i) {
+    int number = atoi(argv[i]);
+    if (number == 0) {
+      none = true;
+      continue;
+    }
+    if (number < 1 || number > (int)LEVELS) {
+      fprintf(stderr, "Levels go from 1 to %zu\n", LEVELS);
+      return EXIT_FAILURE;
+    }
+    levels[levelCount++] = number;
+  }
+  if (levelCount == 0 && !none)
+    for (uint8_t i = 1; i <= LEVELS; ++i)
+      levels[levelCount++] = i;
+
+  uint64_t totalBoards = 0;
+  double start = Now();
+  for (uint8_t i = 0; i < levelCount; ++i)
+    AuditLevel(levels[i], budget, &totalBoards);
+
+  if (randomBoards) {
+    uint32_t before = setCount;
+    uint64_t boards, shorts;
+    double randomStart = Now();
+    level = NULL;
+    taskCount = 0;
+    Run(randomBoards, &boards, &shorts);
+    totalBoards += boards;
+    printf("Random: %lu boards, %lu shorts, %u new netlists, %.2f s\n", boards, shorts, setCount - before, Now() - randomStart);
+  }
+  double elapsed = Now() - start;
+
+  qsort(missing, missingCount, sizeof(MISSING), CompareMissing);
+  for (uint32_t i = 0; i < missingCount; ++i) {
+    MISSING* m = &missing[i];
+    printf("\nMissing 0x%08x should light %c%c%c, from ", m->netlist, (m->leds & R_BIT) ? 'R' : '-', (m->leds & Y_BIT) ? 'Y' : '-',
+           (m->leds & G_BIT) ? 'G' : '-');
+    if (m->level == RANDOM_LEVEL)
+      printf("a random board\n");
+    else
+      printf("level %02u\n", m->level);
+    PrintBoard(m->board);
+  }
+
+  printf("\nRan %lu boards using %u threads in %.2f s (%.2f M boards/s)\n", totalBoards, workerCount, elapsed,
+         (elapsed > 0) ? totalBoards / elapsed / 1e6 : 0.0);
+  printf("Distinct netlists without a short: %u, in the table: %u (of %zu entries), not in the table and dark: %u, missing: %u\n",
+         setCount, tableHits, NELEMS(sorted_netlists_and_led_states), absentDark, missingCount);
+  puts(missingCount ? "\nFAILED\n" : "\nEvery netlist that lights something up is in the table\n");
+
+  return missingCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -30,6 +30,9 @@
 #include <uzebox.h>
 #include <avr/interrupt.h>
 
+#include "engine/engine.h"
+#include "profile/profile.h"
+
 #include "data/tileset.inc"
 #include "data/sprites.inc"
 #include "data/titlescreen.inc"
@@ -45,6 +48,7 @@
 //#define OPTION_DEBUG_DISPLAY_PRUNED_BOARD
 //#define OPTION_DEBUG_DISPLAY_GOAL_STATES
 //#define OPTION_DEBUG_EPIC_WIN
+//#define OPTION_PROFILE
 
 #define EEPROM_ID 0x0400
 #define EEPROM_SAVEGAME_VERSION 0x0001
@@ -133,10 +137,73 @@ void MyResumeSong()
 #define UZEMH _SFR_IO8(25)
 #define UZEMC _SFR_IO8(26)
 
+#if defined(OPTION_PROFILE)
+// Timer1 belongs to the video kernel, so Timer0 counts at F_CPU/8 and its overflow interrupt extends it to
+// 24 bits. The kernel renders each field with interrupts off, which can drop overflows, so a phase that a
+// vsync or a late overflow interrupt lands in gets flagged with PROFILE_FLAG_INTERRUPTED (see profile/profile.h)
+volatile uint16_t profile_overflows = 0;
+volatile uint8_t profile_interruptions = 0;
+volatile uint8_t profile_vsyncs = 0;
+
+ISR(TIMER0_OVF_vect, ISR_NOBLOCK) // let the video interrupt in right away
+{
+  if (TCNT0 >= 64) // over 512 cycles late, so it was held off by the render loop (and may have missed some)
+    ++profile_interruptions;
+  ++profile_overflows;
+}
+
+void Profile_Vsync(void)
+{
+  ++profile_vsyncs;
+  ++profile_interruptions;
+}
+
+void Profile_Init(void)
+{
+  TCCR0A = 0;
+  TCCR0B = (1 << CS01); // F_CPU/8
+  TIMSK0 = (1 << TOIE0);
+  SetUserPostVsyncCallback(Profile_Vsync);
+}
+
+uint32_t Profile_Ticks(void)
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint8_t low = TCNT0;
+  uint16_t high = profile_overflows;
+  if ((TIFR0 & (1 << TOV0)) && low < 0x80) // it overflowed, but the interrupt hasn't run yet
+    ++high;
+  SREG = sreg;
+  return ((uint32_t)high << 8) | low;
+}
+
+void Profile_Emit(uint8_t phase, uint32_t value)
+{
+  UZEMC = PROFILE_RECORD_START; UZEMH = phase; UZEMH = (uint8_t)(value >> 16); UZEMH = (uint8_t)(value >> 8); UZEMH = (uint8_t)value; UZEMC = '\n';
+}
+
+#define PROFILE_BEGIN(phase)                                            \
+  uint8_t profile_interruptions_##phase = profile_interruptions;        \
+  uint32_t profile_ticks_##phase = Profile_Ticks()
+#define PROFILE_END(phase)                                              \
+  Profile_Emit((phase) | ((profile_interruptions != profile_interruptions_##phase) ? PROFILE_FLAG_INTERRUPTED : 0), \
+               (Profile_Ticks() - profile_ticks_##phase) & 0x00FFFFFF)
+// Called once per pass through the main loop, right after its WaitVsync, to catch the frames that overran
+#define PROFILE_FRAME_END() do {                                        \
+    static uint8_t profile_last_vsyncs = 0;                             \
+    uint8_t vsyncs = profile_vsyncs;                                    \
+    Profile_Emit(PROFILE_FRAME, (uint8_t)(vsyncs - profile_last_vsyncs)); \
+    profile_last_vsyncs = vsyncs;                                       \
+  } while (0)
+#else
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_FRAME_END()
+#endif
+
 #define TOKEN_WIDTH 3
 #define TOKEN_HEIGHT 3
-#define BOARD_WIDTH 5
-#define BOARD_HEIGHT 5
 #define BOARD_START_X 1
 #define BOARD_START_Y 1
 #define BOARD_H_SPACING 3
@@ -165,11 +232,6 @@ void MyResumeSong()
 #define GAME_USER_RAM_TILES_COUNT 3
 #define OVERLAY_SPRITE_START 0
 
-#define PIECE_MASK   0x3F
-#define FLAGS_MASK   0xC0
-#define FLAG_ROTATE  0x40
-#define FLAG_LOCKED  0x80
-
 bool boardChanged = false;
 bool switchChanged = false;
 bool startAdvancesLevel = false;
@@ -182,7 +244,7 @@ typedef struct {
   uint16_t released;
 } __attribute__ ((packed)) BUTTON_INFO;
 
-void BoardChanged(BUTTON_INFO* buttons);
+void BoardChanged(void);
 uint8_t GetLevelColor(uint8_t level);
 void RamFont_Load2Digits(const uint8_t* ramfont, uint8_t ramfont_index, uint8_t number, uint8_t fg_color, uint8_t bg_color);
 
@@ -201,100 +263,6 @@ void RamFont_Load2Digits(const uint8_t* ramfont, uint8_t ramfont_index, uint8_t
 #define TILE_DPAD_LEFT 12
 #define TILE_DPAD_RIGHT 13
 
-// Defines for the pieces. Rotations are treated as different pieces.
-#define P_BLANK 0
-
-#define P_VCC_T 1
-#define P_VCC_R 2
-#define P_VCC_B 3
-#define P_VCC_L 4
-
-#define P_GND_LTR 5
-#define P_GND_TRB 6
-#define P_GND_RBL 7
-#define P_GND_BLT 8
-
-#define P_SW1_BL 9
-#define P_SW1_LT 10
-#define P_SW1_TR 11
-#define P_SW1_RB 12
-
-#define P_RLED_AB_CR 13
-#define P_RLED_AL_CB 14
-#define P_RLED_AT_CL 15
-#define P_RLED_AR_CT 16
-
-#define P_SW2_BT 17
-#define P_SW2_LR 18
-#define P_SW2_TB 19
-#define P_SW2_RL 20
-
-#define P_YLED_AL_CR 21
-#define P_YLED_AT_CB 22
-#define P_YLED_AR_CL 23
-#define P_YLED_AB_CT 24
-
-#define P_SW3_BR 25
-#define P_SW3_LB 26
-#define P_SW3_TL 27
-#define P_SW3_RT 28
-
-#define P_GLED_AB_CL 29
-#define P_GLED_AL_CT 30
-#define P_GLED_AT_CR 31
-#define P_GLED_AR_CB 32
-
-#define P_STRAIGHT_LR 33
-#define P_STRAIGHT_TB 34
-
-#define P_DBL_CORNER_TL_BR 35
-#define P_DBL_CORNER_TR_BL 36
-
-#define P_CORNER_BL 37
-#define P_CORNER_TL 38
-#define P_CORNER_TR 39
-#define P_CORNER_BR 40
-
-#define P_TPIECE_RBL 41
-#define P_TPIECE_BLT 42
-#define P_TPIECE_LTR 43
-#define P_TPIECE_TRB 44
-
-#define P_BRIDGE1_TB_LR 45
-#define P_BRIDGE2_TB_LR 46
-
-#define P_BLOCKER 47
-
-// Unknown rotations (these only exist in the level definitions)
-#define P_VCC_U 48
-#define P_GND_U 49
-#define P_SW1_U 50
-#define P_RLED_U 51
-#define P_SW2_U 52
-#define P_YLED_U 53
-#define P_SW3_U 54
-#define P_GLED_U 55
-#define P_STRAIGHT_U 56
-#define P_DBL_CORNER_U 57
-#define P_CORNER_U 58
-#define P_TPIECE_U 59
-#define P_BRIDGE_U 60
-
-
-// Defines for the goals. There are no rotations.
-#define P_GOAL_BLANK 0
-#define P_GOAL_RLED_OFF 1
-#define P_GOAL_YLED_OFF 2
-#define P_GOAL_GLED_OFF 3
-
-#define P_GOAL_RLED_ON 4
-#define P_GOAL_YLED_ON 5
-#define P_GOAL_GLED_ON 6
-
-#define P_GOAL_SW1 7
-#define P_GOAL_SW2 8
-#define P_GOAL_SW3 9
-
 ////////////////////////////////////////////////////////////////////////
 // For "mouse" acceleration
 
@@ -422,7 +390,7 @@ void cursor_update(CURSOR* c, uint16_t held)
 }
 ////////////////////////////////////////////////////////////////////////
 
-// We need to know the position of the X or checkbox when LoadLevel is called in order to update it in BoardChanged
+// We need to know the position of the X or checkbox when LoadLevel is called in order to update it in BoardChanged_Commit
 uint8_t meetsRulesY = 0;
 uint8_t currentLevel;
 
@@ -453,987 +421,10 @@ uint8_t hand[2][5] = {
   { 0, 0, 0, 0, 0 },
 };
 
-// Used to prune pieces with loose ends before netlist generation
-uint8_t pruned_board[5][5] = {
-  {  0,  0,  0,  0,  0 },
-  {  0,  0,  0,  0,  0 },
-  {  0,  0,  0,  0,  0 },
-  {  0,  0,  0,  0,  0 },
-  {  0,  0,  0,  0,  0 },
-};
-
-/* Each square may have an electron going in and/or out in any direction
-      IN   OUT
-   0b 0000 0000
-       \\\\ \\\\__ top
-        \\\\ \\\__ right
-         \\\\ \\__ bottom
-          \\\\ \__ left
-           \\\\
-            \\\\__ top
-             \\\__ right
-              \\__ bottom
-               \__ left
-*/
-#define D_OUT_T 1
-#define D_OUT_R 2
-#define D_OUT_B 4
-#define D_OUT_L 8
-
-#define D_IN_T 16
-#define D_IN_R 32
-#define D_IN_B 64
-#define D_IN_L 128
-
-// The bitmap of where the electron is, and which direction(s) it is travelling
-/* uint8_t directions[5][5] = { */
-/*   {  0,  0,  0,  0,  0 }, */
-/*   {  0,  0,  0,  0,  0 }, */
-/*   {  0,  0,  0,  0,  0 }, */
-/*   {  0,  0,  0,  0,  0 }, */
-/*   {  0,  0,  0,  0,  0 }, */
-/* }; */
-
-
-#define NL_VV 0
-#define NL_00 1
-#define NL_RA 2
-#define NL_RC 3
-#define NL_YA 4
-#define NL_YC 5
-#define NL_GA 6
-#define NL_GC 7
-
-// Used to store the netlist (can be made more efficient later)
-uint8_t pruned_netlist[8][8] = {
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-  { 0, 0, 0, 0, 0, 0, 0, 0 },
-};
+// Scratch state for the circuit evaluation engine (holds pruned_board and the packed netlist)
+ENGINE engine;
 
-const uint8_t levelData[] PROGMEM = {
-  // LEVEL 01
-  // Puzzle
-  P_VCC_B, 0, 0, 0, 0,
-  0, P_YLED_AL_CR, 0, 0, 0,
-  0, 0, P_STRAIGHT_TB, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, 0, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_GND_U, 0, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 02
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_VCC_B, P_CORNER_BR, P_CORNER_BL, 0,
-  0, 0, P_BRIDGE2_TB_LR, P_CORNER_TL, 0,
-  0, P_GND_RBL, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_GLED_ON, 0, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_GLED_U, 0, 0, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 03
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_CORNER_BL, 0, 0,
-  0, P_VCC_T, 0, P_CORNER_TL, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_RLED_U, P_GLED_U, P_GND_U, 0, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 04
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_CORNER_BR, 0, P_CORNER_BL, 0,
-  0, 0, P_TPIECE_RBL, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_RLED_U, P_GLED_U, P_VCC_U, P_GND_U, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 05
-  // Puzzle
-  0, 0, 0, 0, 0,
-  P_VCC_R, P_TPIECE_RBL, P_TPIECE_RBL, 0, 0,
-  0, 0, P_GLED_AT_CR, 0, 0,
-  0, 0, P_STRAIGHT_LR, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_RLED_U, P_YLED_U, P_GND_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 06
-  // Puzzle
-  0, P_GND_LTR, 0, P_VCC_B, 0,
-  0, 0, 0, 0, P_GLED_AB_CL,
-  0, P_BLOCKER, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_GLED_ON, 0, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 07
-  // Puzzle
-  0, P_RLED_AB_CR, 0, P_GLED_AB_CL, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_SW2_BT, 0, 0,
-  0, 0, P_VCC_T, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_STRAIGHT_U, P_CORNER_U, P_CORNER_U, P_YLED_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 08
-  // Puzzle
-  P_GLED_AR_CB, 0, P_VCC_L, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_GND_BLT, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_TPIECE_U, P_RLED_U, P_YLED_U, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 09
-  // Puzzle
-  0, 0, 0, P_RLED_AL_CB, 0,
-  0, 0, P_GLED_AT_CR, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_TPIECE_U, P_VCC_U, P_GND_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 10
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_VCC_R, P_CORNER_BL, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_GLED_AT_CR, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_TPIECE_U, P_STRAIGHT_U, P_YLED_AB_CT, P_GND_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 11
-  // Puzzle
-  0, 0, 0, P_STRAIGHT_LR, 0,
-  0, P_TPIECE_TRB, 0, 0, 0,
-  0, 0, P_GND_BLT, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_YLED_U, P_GLED_U, P_VCC_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 12
-  // Puzzle
-  0, 0, P_BLOCKER, 0, 0,
-  P_STRAIGHT_TB, 0, 0, 0, 0,
-  0, 0, P_CORNER_BL, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_TPIECE_U, P_YLED_U, P_GLED_U, P_VCC_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 13
-  // Puzzle
-  0, 0, P_GLED_AR_CB, 0, 0,
-  0, 0, 0, P_YLED_AR_CL, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_VCC_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 14
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_CORNER_BL, 0,
-  0, P_SW2_LR, 0, P_GND_U, 0,
-  0, P_CORNER_TR, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_STRAIGHT_U, P_RLED_U, P_YLED_U, P_GLED_U,
-  P_VCC_U, 0, 0, 0, 0,
-
-  // LEVEL 15
-  // Puzzle
-  0, 0, P_VCC_B, 0, 0,
-  0, P_GLED_U, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_GND_TRB, P_YLED_AR_CL, P_TPIECE_BLT, 0, 0,
-  P_CORNER_TR, P_STRAIGHT_LR, P_RLED_AT_CL, 0, 0,
-  // Goal
-  P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, 0,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 16
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_SW2_BT, P_BRIDGE1_TB_LR, P_RLED_AL_CB, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_YLED_U, P_GLED_U, P_VCC_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 17
-  // Puzzle
-  0, 0, 0, P_YLED_U, P_CORNER_BL,
-  0, P_BRIDGE1_TB_LR, 0, P_BLOCKER, 0,
-  P_CORNER_TR, P_GND_LTR, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_CORNER_U, P_RLED_U, P_GLED_U, P_VCC_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 18
-  // Puzzle
-  P_BLOCKER, 0, P_GND_TRB, 0, 0,
-  0, 0, 0, 0, 0,
-  0, P_SW2_LR, 0, 0, 0,
-  0, 0, P_GLED_U, 0, 0,
-  P_VCC_T, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  // Hand
-  P_TPIECE_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_RLED_U,
-  P_YLED_U, 0, 0, 0, 0,
-
-  // LEVEL 19
-  // Puzzle
-  0, 0, P_GLED_AB_CL, 0, 0,
-  0, P_GND_BLT, 0, P_RLED_U, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_VCC_T, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  P_YLED_U, 0, 0, 0, 0,
-
-  // LEVEL 20
-  // Puzzle
-  0, 0, 0, 0, 0,
-  P_TPIECE_TRB, P_CORNER_BL, 0, 0, 0,
-  0, P_DBL_CORNER_U, 0, P_CORNER_BL, 0,
-  0, P_GLED_U, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_STRAIGHT_U, P_RLED_U, P_VCC_U, P_GND_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 21
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_GLED_AR_CB, P_YLED_AR_CL, 0, 0,
-  0, P_CORNER_U, 0, P_CORNER_U, P_VCC_U,
-  0, 0, 0, 0, 0,
-  0, P_GND_BLT, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_RLED_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 22
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, P_CORNER_BL, 0, 0, 0,
-  0, 0, 0, P_GND_RBL, 0,
-  0, 0, P_STRAIGHT_LR, P_VCC_L, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_TPIECE_U, P_BRIDGE_U, P_RLED_AB_CR, P_YLED_AB_CT,
-  P_GLED_AB_CL, 0, 0, 0, 0,
-
-  // LEVEL 23
-  // Puzzle
-  0, 0, P_GND_TRB, 0, P_VCC_B,
-  0, 0, 0, P_GLED_AR_CB, 0,
-  0, 0, P_TPIECE_U, 0, 0,
-  0, 0, P_CORNER_TR, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_TPIECE_U, P_BRIDGE_U, P_RLED_U, P_YLED_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 24
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_GND_LTR, 0, 0, 0,
-  0, 0, P_DBL_CORNER_TL_BR, 0, 0,
-  P_CORNER_TR, 0, 0, P_CORNER_U, 0,
-  0, 0, P_VCC_U, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, 0, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_BRIDGE_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, 0, 0, 0,
-
-  // LEVEL 25
-  // Puzzle
-  0, 0, P_CORNER_BL, 0, 0,
-  P_VCC_B, P_YLED_U, P_RLED_U, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 26
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_GND_TRB, 0,
-  P_RLED_AB_CR, 0, 0, P_TPIECE_TRB, 0,
-  0, P_DBL_CORNER_U, P_STRAIGHT_U, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_GLED_U,
-  P_VCC_U, 0, 0, 0, 0,
-
-  // LEVEL 27
-  // Puzzle
-  0, 0, P_CORNER_BR, 0, 0,
-  0, P_CORNER_U, P_SW2_BT, P_TPIECE_U, 0,
-  P_GND_RBL, 0, 0, 0, 0,
-  0, 0, 0, P_VCC_U, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, 0, 0,
-  P_GOAL_SW2, P_GOAL_RLED_ON, 0, 0,
-  P_GOAL_SW3, P_GOAL_RLED_ON, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_TPIECE_U, P_RLED_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 28
-  // Puzzle
-  0, 0, P_GLED_AR_CB, 0, 0,
-  0, 0, 0, P_STRAIGHT_TB, 0,
-  0, 0, 0, P_DBL_CORNER_U, 0,
-  0, P_GND_RBL, 0, P_CORNER_U, P_YLED_AB_CT,
-  0, 0, P_BLOCKER, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_TPIECE_U,
-  P_TPIECE_U, P_VCC_U, 0, 0, 0,
-
-  // LEVEL 29
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_GLED_AR_CB, 0,
-  0, 0, 0, 0, 0,
-  0, P_RLED_AR_CT, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_STRAIGHT_U, P_TPIECE_U, P_YLED_U, P_VCC_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 30
-  // Puzzle
-  0, P_GND_TRB, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_GLED_AT_CR, 0, P_BLOCKER,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_RLED_U,
-  P_YLED_U, P_VCC_U, 0, 0, 0,
-
-  // LEVEL 31
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_STRAIGHT_U, 0, P_VCC_T, 0,
-  0, 0, P_BLOCKER, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_TPIECE_U, P_RLED_U, P_YLED_U, P_GLED_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 32
-  // Puzzle
-  0, 0, 0, 0, 0,
-  P_VCC_U, 0, P_CORNER_U, 0, 0,
-  0, 0, 0, 0, P_BLOCKER,
-  0, 0, P_CORNER_U, 0, P_CORNER_BL,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_DBL_CORNER_U, P_RLED_U, P_GLED_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 33
-  // Puzzle
-  0, 0, P_GND_LTR, 0, 0,
-  P_TPIECE_TRB, 0, 0, 0, 0,
-  P_STRAIGHT_TB, 0, P_BLOCKER, 0, 0,
-  P_GLED_AT_CR, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_BRIDGE_U, P_CORNER_U, P_RLED_U, P_YLED_U,
-  P_VCC_U, 0, 0, 0, 0,
-
-  // LEVEL 34
-  // Puzzle
-  0, P_BLOCKER, P_CORNER_BR, 0, P_VCC_U,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, P_CORNER_TR, P_STRAIGHT_LR, P_CORNER_TL, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_TPIECE_U, P_TPIECE_U, P_BRIDGE_U, P_RLED_U, P_YLED_U,
-  P_GLED_U, P_GND_U, 0, 0, 0,
-
-  // LEVEL 35
-  // Puzzle
-  0, 0, P_TPIECE_RBL, P_STRAIGHT_LR, 0,
-  0, 0, 0, 0, P_VCC_U,
-  P_GND_U, 0, P_BLOCKER, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, P_YLED_U, 0, 0,
-
-  // LEVEL 36
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_GLED_U, 0, 0, 0, 0,
-  0, 0, P_GND_RBL, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_TPIECE_U, P_RLED_U, P_VCC_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 37
-  // Puzzle
-  0, 0, P_BLOCKER, 0, 0,
-  0, 0, P_CORNER_U, 0, 0,
-  0, 0, P_GND_TRB, P_CORNER_U, P_YLED_AB_CT,
-  0, 0, 0, P_TPIECE_U, P_CORNER_TL,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_TPIECE_U, P_RLED_U, P_GLED_U, P_VCC_U,
-  0, 0, 0, 0, 0,
-
-  // LEVEL 38
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, P_VCC_R, 0, 0,
-  0, 0, 0, 0, P_RLED_U,
-  P_GND_U, P_YLED_U, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_GLED_U,
-  P_SW2_U, 0, 0, 0, 0,
-
-  // LEVEL 39
-  // Puzzle
-  0, 0, P_CORNER_U, 0, 0,
-  0, P_STRAIGHT_U, 0, 0, 0,
-  P_CORNER_U, 0, 0, 0, 0,
-  0, 0, P_CORNER_TR, P_VCC_L, 0,
-  P_GLED_AT_CR, P_GND_RBL, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_DBL_CORNER_U, P_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_RLED_U,
-  P_YLED_U, 0, 0, 0, 0,
-
-  // LEVEL 40
-  // Puzzle
-  0, P_CORNER_U, 0, P_VCC_U, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_BRIDGE1_TB_LR, 0, 0,
-  0, 0, P_SW2_BT, P_CORNER_U, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_RLED_U, P_YLED_U, P_GLED_U,
-  P_GND_U, 0, 0, 0, 0,
-
-  // LEVEL 41
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, P_RLED_U, 0, P_CORNER_U,
-  0, 0, P_DBL_CORNER_U, 0, 0,
-  0, 0, P_GLED_U, P_GND_U, P_STRAIGHT_TB,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_GLED_OFF, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U,
-  P_VCC_U, 0, 0, 0, 0,
-
-  // LEVEL 42
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, P_RLED_AR_CT, 0, 0,
-  0, 0, 0, 0, 0,
-  0, P_TPIECE_LTR, 0, P_GLED_U, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_YLED_U,
-  P_VCC_U, P_GND_U, 0, 0, 0,
-
-  // LEVEL 43
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, P_BLOCKER, 0, 0,
-  0, 0, 0, 0, 0,
-  0, P_YLED_U, 0, 0, 0,
-  0, 0, P_CORNER_U, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_RLED_U, P_GLED_U, P_VCC_U,
-  P_GND_U, P_SW2_U, 0, 0, 0,
-
-  // LEVEL 44
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_TPIECE_LTR, 0, 0, 0,
-  P_GND_LTR, 0, P_YLED_AB_CT, 0, 0,
-  0, 0, 0, P_TPIECE_U, 0,
-  0, 0, 0, 0, P_VCC_U,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, P_GLED_U, 0, 0,
-
-  // LEVEL 45
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_CORNER_BR, 0, P_BRIDGE1_TB_LR, P_CORNER_U, P_VCC_U,
-  0, P_GND_BLT, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_GLED_OFF, 0,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_GLED_OFF, 0,
-  // Hand
-  P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_RLED_U,
-  P_GLED_U, P_SW2_U, 0, 0, 0,
-
-  // LEVEL 46
-  // Puzzle
-  P_VCC_R, P_TPIECE_RBL, 0, 0, 0,
-  P_CORNER_BR, P_TPIECE_BLT, 0, 0, 0,
-  0, 0, P_DBL_CORNER_U, P_CORNER_TL, 0,
-  0, 0, P_CORNER_TL, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_CORNER_U, P_CORNER_U, P_BRIDGE_U, P_RLED_U, P_YLED_U,
-  P_GLED_U, P_GND_U, 0, 0, 0,
-
-  // LEVEL 47
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_CORNER_U, P_DBL_CORNER_U, P_RLED_U, 0,
-  0, 0, 0, 0, 0,
-  0, P_CORNER_U, 0, 0, P_GND_RBL,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_OFF, P_GOAL_YLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_YLED_U,
-  P_VCC_U, 0, 0, 0, 0,
-
-  // LEVEL 48
-  // Puzzle
-  P_VCC_R, P_TPIECE_RBL, 0, 0, 0,
-  P_CORNER_BR, P_TPIECE_LTR, 0, 0, 0,
-  0, 0, P_DBL_CORNER_U, P_CORNER_TL, 0,
-  0, 0, P_CORNER_TL, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_BRIDGE_U, P_CORNER_U, P_CORNER_U, P_RLED_U, P_YLED_U,
-  P_GLED_U, P_GND_U, 0, 0, 0,
-
-  // LEVEL 49
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  P_CORNER_BR, 0, P_BRIDGE1_TB_LR, 0, P_VCC_U,
-  P_CORNER_TR, P_GND_BLT, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_GLED_OFF, 0,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_GLED_OFF, 0,
-  // Hand
-  P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_RLED_U,
-  P_GLED_U, P_SW2_U, 0, 0, 0,
-
-  // LEVEL 50
-  // Puzzle
-  0, 0, P_CORNER_BR, P_GND_U, 0,
-  0, 0, 0, 0, 0,
-  P_VCC_R, 0, 0, 0, P_CORNER_U,
-  0, 0, P_CORNER_TR, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  // Hand
-  P_TPIECE_U, P_TPIECE_U, P_DBL_CORNER_U, P_BRIDGE_U, P_RLED_U,
-  P_YLED_U, P_GLED_U, P_SW2_U, 0, 0,
-
-  // LEVEL 51
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_GND_LTR, 0,
-  0, 0, 0, 0, 0,
-  0, P_SW2_U, 0, 0, 0,
-  0, P_GLED_U, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, P_YLED_U, P_VCC_U, 0,
-
-  // LEVEL 52
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_STRAIGHT_U, 0,
-  0, P_CORNER_U, P_CORNER_U, P_CORNER_U, 0,
-  0, 0, P_CORNER_U, P_STRAIGHT_U, P_RLED_U,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON,
-  // Hand
-  P_TPIECE_U, P_YLED_U, P_GLED_U, P_VCC_U, P_GND_U,
-  P_SW2_U, 0, 0, 0, 0,
-
-  // LEVEL 53
-  // Puzzle
-  0, P_GND_U, 0, 0, 0,
-  P_CORNER_U, 0, P_CORNER_U, 0, 0,
-  0, P_GLED_AR_CB, 0, 0, 0,
-  0, 0, P_CORNER_U, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_BRIDGE_U, P_TPIECE_U, P_TPIECE_U, P_RLED_U,
-  P_YLED_U, P_VCC_U, 0, 0, 0,
-
-  // LEVEL 54
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, P_BLOCKER, 0, 0, 0,
-  0, 0, 0, P_CORNER_BL, 0,
-  0, 0, 0, 0, 0,
-  P_VCC_U, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_OFF,
-  // Hand
-  P_TPIECE_U, P_STRAIGHT_U, P_STRAIGHT_U, P_RLED_U, P_YLED_U,
-  P_GLED_U, P_GND_U, P_SW2_U, 0, 0,
-
-  // LEVEL 55
-  // Puzzle
-  0, 0, P_CORNER_BR, 0, 0,
-  0, 0, 0, 0, P_CORNER_BL,
-  0, 0, 0, P_YLED_AL_CR, 0,
-  0, 0, P_SW2_BT, 0, 0,
-  0, 0, P_VCC_T, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_BRIDGE_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U,
-  P_CORNER_U, P_CORNER_U, P_RLED_U, P_GLED_U, P_GND_U,
-
-  // LEVEL 56
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_GLED_AB_CL, P_YLED_AB_CT,
-  0, 0, 0, 0, 0,
-  0, P_STRAIGHT_TB, 0, P_VCC_U, 0,
-  0, P_RLED_AR_CT, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_DBL_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U,
-  P_CORNER_U, P_CORNER_U, P_CORNER_U, P_CORNER_U, P_GND_U,
-
-  // LEVEL 57
-  // Puzzle
-  0, 0, P_STRAIGHT_LR, 0, 0,
-  0, 0, 0, 0, 0,
-  P_VCC_T, 0, P_TPIECE_BLT, P_YLED_U, 0,
-  0, 0, 0, 0, P_GND_RBL,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_OFF, P_GOAL_YLED_ON, P_GOAL_GLED_OFF,
-  P_GOAL_SW2, P_GOAL_RLED_ON, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_YLED_OFF, P_GOAL_GLED_ON,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, P_GLED_U, P_SW2_U, 0,
-
-  // LEVEL 58
-  // Puzzle
-  0, 0, 0, 0, P_BLOCKER,
-  0, 0, 0, P_VCC_U, 0,
-  0, 0, P_CORNER_U, 0, P_STRAIGHT_TB,
-  0, P_GND_TRB, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_DBL_CORNER_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U,
-  P_CORNER_U, P_CORNER_U, P_YLED_U, P_GLED_U, 0,
-
-  // LEVEL 59
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, P_CORNER_U, P_RLED_AL_CB, 0,
-  0, 0, 0, 0, 0,
-  0, P_BLOCKER, 0, 0, 0,
-  0, 0, 0, P_GND_BLT, 0,
-  // Goal
-  P_GOAL_SW1, P_GOAL_RLED_ON, P_GOAL_GLED_ON, 0,
-  P_GOAL_SW2, P_GOAL_RLED_OFF, P_GOAL_GLED_ON, 0,
-  P_GOAL_SW3, P_GOAL_RLED_OFF, P_GOAL_GLED_ON, 0,
-  // Hand
-  P_BRIDGE_U, P_TPIECE_U, P_TPIECE_U, P_CORNER_U, P_CORNER_U,
-  P_GLED_U, P_VCC_U, P_SW2_U, 0, 0,
-
-  // LEVEL 60
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, P_CORNER_BL, 0,
-  P_YLED_U, P_CORNER_U, 0, 0, P_GLED_AB_CL,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  P_GOAL_RLED_ON, P_GOAL_YLED_ON, P_GOAL_GLED_ON, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  P_STRAIGHT_U, P_TPIECE_U, P_BRIDGE_U, P_CORNER_U, P_CORNER_U,
-  P_CORNER_U, P_RLED_U, P_VCC_U, P_GND_U, 0,
-
-#if 0
-  // LEVEL ?
-  // Puzzle
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-  // Goal
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  0, 0, 0, 0,
-  // Hand
-  0, 0, 0, 0, 0,
-  0, 0, 0, 0, 0,
-#endif
-};
+#include "data/levels.inc"
 
 #define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
 #define LEVELS (sizeof(levelData) / LEVEL_SIZE)
@@ -1785,6 +776,8 @@ const uint8_t rf_digits[] PROGMEM = {
 
 static void LoadLevel(const uint8_t level)
 {
+  PROFILE_BEGIN(PROFILE_LOADLEVEL);
+
   cursor_init(&cursor, MAX_SPRITES - 1, CURSOR_SPRITE,
               HAND_START_X * TILE_WIDTH + (TILE_WIDTH >> 1),
               HAND_START_Y * TILE_HEIGHT + (TILE_HEIGHT >> 1));
@@ -1877,7 +870,7 @@ static void LoadLevel(const uint8_t level)
   // Draw Goal
   // Figure out the last occupied goal line, and then draw the "Meets Rules" below that
 
-  // This is now a global, so the BoardChanged function can use it to update the X or checkmark when the board changes
+  // This is now a global, so the BoardChanged_Commit function can use it to update the X or checkmark when the board changes
   meetsRulesY = GOAL_START_Y + GOAL_HEIGHT * GOAL_V_SPACING;
   for (uint8_t y = 0; y < GOAL_HEIGHT; ++y) {
     bool occupied = false;
@@ -1925,6 +918,8 @@ static void LoadLevel(const uint8_t level)
     }
 
   boardChanged = true;
+
+  PROFILE_END(PROFILE_LOADLEVEL);
 }
 
 const uint8_t rotateClockwise[] PROGMEM =
@@ -2132,9 +1127,11 @@ const uint8_t rf_popup_border[] PROGMEM = {
 void RamFont_Load(const uint8_t* ramfont, uint8_t user_ram_tile_start, uint8_t len, uint8_t fg_color, uint8_t bg_color)
 {
   //SetUserRamTilesCount(len); // commented out to avoid flickering of the current level, call manually before this function is called
+  PROFILE_BEGIN(PROFILE_RAMFONT_LOAD);
   if (fg_color == bg_color) { // This saves 10's of thousands of clock cycles when the condition is met
     uint8_t* ramTile = GetUserRamTile(user_ram_tile_start);
     memset(ramTile, fg_color, len * 64);
+    PROFILE_END(PROFILE_RAMFONT_LOAD);
     return;
   }
   for (uint8_t tile = 0; tile < len; ++tile) {
@@ -2152,6 +1149,7 @@ void RamFont_Load(const uint8_t* ramfont, uint8_t user_ram_tile_start, uint8_t l
       }
     }
   }
+  PROFILE_END(PROFILE_RAMFONT_LOAD);
 }
 
 // Ensure that 4 adjacent letters will pixel fade in differently
@@ -2362,2281 +1360,496 @@ int8_t FindSpriteIndexForOverlay(uint8_t level, uint8_t x, uint8_t y)
   return -1;
 }
 
-#define DIRECTION_MASK 0x03
-#define D_T 0
-#define D_R 1
-#define D_B 2
-#define D_L 3
+bool CurrentLevelHasSwitch(void)
+{
+  return (goal[0][0] == P_GOAL_SW1);
+}
 
-const uint8_t isValidNeighborFromDirection[48][4] PROGMEM =
-  {
-// P_BLANK 0
-   {0, 0, 0, 0},
-// P_VCC_T 1
-   {1, 0, 0, 0},
-// P_VCC_R 2
-   {0, 1, 0, 0},
-// P_VCC_B 3
-   {0, 0, 1, 0},
-// P_VCC_L 4
-   {0, 0, 0, 1},
-
-// P_GND_LTR 5
-   {1, 1, 0, 1},
-// P_GND_TRB 6
-   {1, 1, 1, 0},
-// P_GND_RBL 7
-   {0, 1, 1, 1},
-// P_GND_BLT 8
-   {1, 0, 1, 1},
-
-// P_SW1_BL 9
-   {0, 0, 1, 1},
-// P_SW1_LT 10
-   {1, 0, 0, 1},
-// P_SW1_TR 11
-   {1, 1, 0, 0},
-// P_SW1_RB 12
-   {0, 1, 1, 0},
-
-// P_RLED_AB_CR 13
-   {0, 1, 1, 0},
-// P_RLED_AL_CB 14
-   {0, 0, 1, 1},
-// P_RLED_AT_CL 15
-   {1, 0, 0, 1},
-// P_RLED_AR_CT 16
-   {1, 1, 0, 0},
-
-// P_SW2_BT 17
-   {1, 0, 1, 0},
-// P_SW2_LR 18
-   {0, 1, 0, 1},
-// P_SW2_TB 19
-   {1, 0, 1, 0},
-// P_SW2_RL 20
-   {0, 1, 0, 1},
-
-// P_YLED_AL_CR 21
-   {0, 1, 0, 1},
-// P_YLED_AT_CB 22
-   {1, 0, 1, 0},
-// P_YLED_AR_CL 23
-   {0, 1, 0, 1},
-// P_YLED_AB_CT 24
-   {1, 0, 1, 0},
-
-// P_SW3_BR 25
-   {0, 1, 1, 0},
-// P_SW3_LB 26
-   {0, 0, 1, 1},
-// P_SW3_TL 27
-   {1, 0, 0, 1},
-// P_SW3_RT 28
-   {1, 1, 0, 0},
-
-// P_GLED_AB_CL 29
-   {0, 0, 1, 1},
-// P_GLED_AL_CT 30
-   {1, 0, 0, 1},
-// P_GLED_AT_CR 31
-   {1, 1, 0, 0},
-// P_GLED_AR_CB 32
-   {0, 1, 1, 0},
-
-// P_STRAIGHT_LR 33
-   {0, 1, 0, 1},
-// P_STRAIGHT_TB 34
-   {1, 0, 1, 0},
-
-// P_DBL_CORNER_TL_BR 35
-   {1, 1, 1, 1},
-// P_DBL_CORNER_TR_BL 36
-   {1, 1, 1, 1},
-
-// P_CORNER_BL 37
-   {0, 0, 1, 1},
-// P_CORNER_TL 38
-   {1, 0, 0, 1},
-// P_CORNER_TR 39
-   {1, 1, 0, 0},
-// P_CORNER_BR 40
-   {0, 1, 1, 0},
-
-// P_TPIECE_RBL 41
-   {0, 1, 1, 1},
-// P_TPIECE_BLT 42
-   {1, 0, 1, 1},
-// P_TPIECE_LTR 43
-   {1, 1, 0, 1},
-// P_TPIECE_TRB 44
-   {1, 1, 1, 0},
-
-// P_BRIDGE1_TB_LR 45
-   {1, 1, 1, 1},
-// P_BRIDGE2_TB_LR 46
-   {1, 1, 1, 1},
-
-// P_BLOCKER 47
-   {0, 0, 0, 0},
+// If there is not a switch in the level, just pass -1 in for switchPosition
+// If the goal state is requested for a level with a switch, but a switch position wasn't passed in, return 0xFF
+// (which should not match the goalState from the netlist lookup)
+uint8_t GoalStatesForCurrentLevel(int8_t switchPosition)
+{
+  bool currentLevelHasSwitch = CurrentLevelHasSwitch();
+  if (currentLevelHasSwitch && !(switchPosition == 1 || switchPosition == 2 || switchPosition == 3))
+    return 0xFF; // error condition that shouldn't match anything in the netlist lookup
+
+  uint8_t goalState = 0;
+
+  if (currentLevelHasSwitch) {
+    for (uint8_t i = 1; i < 4; ++i) {
+      uint8_t goalPiece = goal[switchPosition - 1][i];
+      switch (goalPiece) {
+      case P_GOAL_RLED_ON:
+        goalState |= R_BIT;
+        break;
+      case P_GOAL_YLED_ON:
+        goalState |= Y_BIT;
+        break;
+      case P_GOAL_GLED_ON:
+        goalState |= G_BIT;
+        break;
+      }
+    }
+  } else {
+    for (uint8_t i = 0; i < 3; ++i) {
+      uint8_t goalPiece = goal[0][i];
+      switch (goalPiece) {
+      case P_GOAL_RLED_ON:
+        goalState |= R_BIT;
+        break;
+      case P_GOAL_YLED_ON:
+        goalState |= Y_BIT;
+        break;
+      case P_GOAL_GLED_ON:
+        goalState |= G_BIT;
+        break;
+      }
+    }
+  }
+
+  return goalState;
+}
+
+// RAM Font data for letters ABCDEFGHI-KLMNOPQRSTUVWXYZ,.
+const uint8_t rf_help[] PROGMEM = {
+  0x30, 0x78, 0xec, 0xe4, 0xfe, 0xc2, 0xc2, 0x00,
+  0x3e, 0x62, 0x32, 0x7e, 0xe2, 0xf2, 0x7e, 0x00,
+  0x7c, 0xc6, 0x02, 0x02, 0xc6, 0xfe, 0x7c, 0x00,
+  0x3c, 0x62, 0xc2, 0xc2, 0xe2, 0xfe, 0x7e, 0x00,
+  0x7c, 0xc6, 0x02, 0x7e, 0x02, 0xfe, 0xfc, 0x00,
+  0x7c, 0xc6, 0x02, 0x7e, 0x06, 0x06, 0x06, 0x00,
+  0x7c, 0xc6, 0x02, 0x02, 0xf2, 0xe6, 0xbc, 0x00,
+  0x42, 0xc2, 0xc2, 0xfe, 0xc2, 0xc6, 0xc6, 0x00,
+  0x10, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x00,
+  0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00,
+  0x64, 0x36, 0x16, 0x3e, 0x76, 0xe6, 0xe6, 0x00,
+  0x04, 0x06, 0x02, 0x02, 0x82, 0xfe, 0x7c, 0x00,
+  0x62, 0xf6, 0xde, 0xca, 0xc2, 0xc6, 0x46, 0x00,
+  0x46, 0xce, 0xda, 0xf2, 0xe2, 0xc6, 0x46, 0x00,
+  0x70, 0xcc, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
+  0x7c, 0xc6, 0xe2, 0x7e, 0x06, 0x06, 0x04, 0x00,
+  0x7c, 0xe2, 0xc2, 0xc2, 0x7a, 0xe6, 0xdc, 0x00,
+  0x7c, 0xc6, 0xc2, 0x7e, 0x1a, 0xf2, 0xe2, 0x00,
+  0x3c, 0x62, 0x02, 0x7c, 0xc0, 0xe6, 0x7c, 0x00,
+  0x7c, 0xfe, 0x12, 0x10, 0x18, 0x18, 0x18, 0x00,
+  0x40, 0xc2, 0xc2, 0xc2, 0xe6, 0x7e, 0x3c, 0x00,
+  0x40, 0xc2, 0xc2, 0xc4, 0x64, 0x38, 0x18, 0x00,
+  0x40, 0xc2, 0xd2, 0xda, 0xda, 0xfe, 0x6c, 0x00,
+  0x80, 0xc6, 0x6e, 0x38, 0x38, 0xec, 0xc6, 0x00,
+  0x80, 0x86, 0xcc, 0x78, 0x30, 0x1c, 0x0c, 0x00,
+  0x7c, 0xc0, 0x60, 0x10, 0x0c, 0xfe, 0x7c, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x0c,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00,
 };
 
-const uint8_t isValidNeighborFromDirectionMeetsRules[48][4] PROGMEM =
-  {
-// P_BLANK 0
-   {0, 0, 0, 0},
-// P_VCC_T 1
-   {1, 0, 0, 0},
-// P_VCC_R 2
-   {0, 1, 0, 0},
-// P_VCC_B 3
-   {0, 0, 1, 0},
-// P_VCC_L 4
-   {0, 0, 0, 1},
-
-// P_GND_LTR 5
-   {1, 1, 0, 1},
-// P_GND_TRB 6
-   {1, 1, 1, 0},
-// P_GND_RBL 7
-   {0, 1, 1, 1},
-// P_GND_BLT 8
-   {1, 0, 1, 1},
-
-// P_SW1_BL 9
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW1_LT 10
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW1_TR 11
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW1_RB 12
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-
-// P_RLED_AB_CR 13
-   {0, 1, 1, 0},
-// P_RLED_AL_CB 14
-   {0, 0, 1, 1},
-// P_RLED_AT_CL 15
-   {1, 0, 0, 1},
-// P_RLED_AR_CT 16
-   {1, 1, 0, 0},
-
-// P_SW2_BT 17
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW2_LR 18
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW2_TB 19
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW2_RL 20
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-
-// P_YLED_AL_CR 21
-   {0, 1, 0, 1},
-// P_YLED_AT_CB 22
-   {1, 0, 1, 0},
-// P_YLED_AR_CL 23
-   {0, 1, 0, 1},
-// P_YLED_AB_CT 24
-   {1, 0, 1, 0},
-
-// P_SW3_BR 25
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW3_LB 26
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW3_TL 27
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-// P_SW3_RT 28
-   {1, 1, 1, 1}, // THESE ARE ALL 1
-
-// P_GLED_AB_CL 29
-   {0, 0, 1, 1},
-// P_GLED_AL_CT 30
-   {1, 0, 0, 1},
-// P_GLED_AT_CR 31
-   {1, 1, 0, 0},
-// P_GLED_AR_CB 32
-   {0, 1, 1, 0},
-
-// P_STRAIGHT_LR 33
-   {0, 1, 0, 1},
-// P_STRAIGHT_TB 34
-   {1, 0, 1, 0},
-
-// P_DBL_CORNER_TL_BR 35
-   {1, 1, 1, 1},
-// P_DBL_CORNER_TR_BL 36
-   {1, 1, 1, 1},
-
-// P_CORNER_BL 37
-   {0, 0, 1, 1},
-// P_CORNER_TL 38
-   {1, 0, 0, 1},
-// P_CORNER_TR 39
-   {1, 1, 0, 0},
-// P_CORNER_BR 40
-   {0, 1, 1, 0},
-
-// P_TPIECE_RBL 41
-   {0, 1, 1, 1},
-// P_TPIECE_BLT 42
-   {1, 0, 1, 1},
-// P_TPIECE_LTR 43
-   {1, 1, 0, 1},
-// P_TPIECE_TRB 44
-   {1, 1, 1, 0},
-
-// P_BRIDGE1_TB_LR 45
-   {1, 1, 1, 1},
-// P_BRIDGE2_TB_LR 46
-   {1, 1, 1, 1},
-
-// P_BLOCKER 47
-   {0, 0, 0, 0},
+// RAM Font data for (c)20-
+const uint8_t rf_title_extra[] PROGMEM = {
+  0x3c, 0x42, 0x99, 0x85, 0x99, 0x42, 0x3c, 0x00,
+  0x7c, 0xe6, 0xc4, 0x60, 0x18, 0xfc, 0x7e, 0x00,
+  0x7c, 0xc2, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
+  0x00, 0x00, 0x00, 0x3e, 0x00, 0x00, 0x00, 0x00,
+};
+
+// RAM Font data for PRESTAFONXCIU
+const uint8_t rf_win[] PROGMEM = {
+  0x7c, 0xc6, 0xe2, 0x7e, 0x06, 0x06, 0x04, 0x00,
+  0x7c, 0xc6, 0xc2, 0x7e, 0x1a, 0xf2, 0xe2, 0x00,
+  0x7c, 0xc6, 0x02, 0x7e, 0x02, 0xfe, 0xfc, 0x00,
+  0x3c, 0x62, 0x02, 0x7c, 0xc0, 0xe6, 0x7c, 0x00,
+  0x7c, 0xfe, 0x12, 0x10, 0x18, 0x18, 0x18, 0x00,
+  0x30, 0x78, 0xec, 0xe4, 0xfe, 0xc2, 0xc2, 0x00,
+  0x7c, 0xc6, 0x02, 0x7e, 0x06, 0x06, 0x06, 0x00,
+  0x70, 0xcc, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
+  0x46, 0xce, 0xda, 0xf2, 0xe2, 0xc6, 0x46, 0x00,
+  0x80, 0xc6, 0x6e, 0x38, 0x38, 0xec, 0xc6, 0x00,
+  0x7c, 0xc6, 0x02, 0x02, 0xc6, 0xfe, 0x7c, 0x00,
+  0x10, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x00,
+  0x40, 0xc2, 0xc2, 0xc2, 0xe6, 0x7e, 0x3c, 0x00,
 };
 
-#define PRUNEBOARD_FLAG_NORMAL 0
-#define PRUNEBOARD_FLAG_MEETS_RULES 1
+#define W_P (GAME_USER_RAM_TILES_COUNT + 0)
+#define W_R (GAME_USER_RAM_TILES_COUNT + 1)
+#define W_E (GAME_USER_RAM_TILES_COUNT + 2)
+#define W_S (GAME_USER_RAM_TILES_COUNT + 3)
+#define W_T (GAME_USER_RAM_TILES_COUNT + 4)
+#define W_A (GAME_USER_RAM_TILES_COUNT + 5)
+#define W_F (GAME_USER_RAM_TILES_COUNT + 6)
+#define W_O (GAME_USER_RAM_TILES_COUNT + 7)
+#define W_N (GAME_USER_RAM_TILES_COUNT + 8)
+#define W_X (GAME_USER_RAM_TILES_COUNT + 9)
+#define W_C (GAME_USER_RAM_TILES_COUNT + 10)
+#define W_I (GAME_USER_RAM_TILES_COUNT + 11)
+#define W_U (GAME_USER_RAM_TILES_COUNT + 12)
+// For Epic Win, a W gets loaded into the 'X' position
+#define W_W (GAME_USER_RAM_TILES_COUNT + 9)
 
-uint8_t CountValidTopNeighbor(uint8_t flags, uint8_t x, uint8_t y)
-{
-  if (y > 0) {
-    uint8_t piece = pruned_board[y - 1][x];
-    if (flags == 0)
-      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_B]);
-    else
-      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_B]);
-  } else
-    return 0;
-}
+const uint8_t pgm_W_PRESS_START[] PROGMEM = { RAM_TILES_COUNT, W_P, W_R, W_E, W_S, W_S, RAM_TILES_COUNT, W_S, W_T, W_A, W_R, W_T, RAM_TILES_COUNT, W_F, W_O, W_R, RAM_TILES_COUNT, W_N, W_E, W_X, W_T, RAM_TILES_COUNT, W_C, W_I, W_R, W_C, W_U, W_I, W_T };
+const uint8_t pgm_W_EPIC_WIN[] PROGMEM = { W_P, W_R, W_E, W_S, W_S, RAM_TILES_COUNT, W_S, W_T, W_A, W_R, W_T, RAM_TILES_COUNT, W_F, W_O, W_R, RAM_TILES_COUNT, W_E, W_P, W_I, W_C, RAM_TILES_COUNT, W_W, W_I, W_N };
 
-uint8_t CountValidRightNeighbor(uint8_t flags, uint8_t x, uint8_t y)
-{
-  if (x < BOARD_WIDTH - 1) {
-    uint8_t piece = pruned_board[y][x + 1];
-    if (flags == 0)
-      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_L]);
-    else
-      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_L]);
-  } else
-    return 0;
-}
+const uint8_t fade[] PROGMEM = { 0x09, 0x12, 0x1B, 0x24, 0x2D, 0x36, 0x3F };
+const uint8_t win_fade[] PROGMEM = { 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0xF0 };
 
-uint8_t CountValidBottomNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+void CancelStartAdvancesLevel(void)
 {
-  if (y < BOARD_HEIGHT - 1) {
-    uint8_t piece = pruned_board[y + 1][x];
-    if (flags == 0)
-      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_T]);
-    else
-      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_T]);
-  } else
-    return 0;
+  if (startAdvancesLevel) {
+    for (uint8_t i = HAND_START_X; i < HAND_START_X + sizeof(pgm_W_PRESS_START); ++i)
+      SetTile(i, HAND_START_Y - 2, TILE_BACKGROUND);
+    DrawMap(HAND_START_X, HAND_START_Y - 2, map_addtogrid);
+    SetUserRamTilesCount(GAME_USER_RAM_TILES_COUNT);
+    startAdvancesLevel = false;
+  }
 }
 
-uint8_t CountValidLeftNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+// Evaluating the board is spread across frames so the cursor and the piece being dragged never stall.
+// BoardChanged (re)starts the evaluation, BoardChanged_Run does as many of its steps as fit before
+// the next vsync, and once every step is done, BoardChanged_Commit draws the result right after the
+// main loop's WaitVsync. Any change to the board before then starts it over, although the engine
+// keeps the part of the netlist repair it already did.
+#define EVALUATION_IDLE    0
+#define EVALUATION_SCAN    1 // find the pieces whose tiles depend on the result
+#define EVALUATION_PRUNE   2 // Engine_PruneBoard
+#define EVALUATION_NETLIST 3 // Engine_UpdateNetlistStep, until the netlist is up to date
+#define EVALUATION_LOOKUP  4 // Engine_PackNetlist and Engine_ConsultOracle
+#define EVALUATION_RULES   5 // short circuits, pieces left in the hand, and loose ends
+#define EVALUATION_READY   6 // waiting for BoardChanged_Commit
+
+struct EVALUATION;
+typedef struct EVALUATION EVALUATION;
+struct EVALUATION {
+  uint8_t step;
+  bool boardChanged; // not just the switch position, since the last commit
+  int8_t boardMeetsRules; // -1 until the lazy "meets rules" pruning runs for this board
+  // Where the pieces of interest are in case their tiles need to be changed
+  int8_t vccx;
+  int8_t vccy;
+  int8_t gndx;
+  int8_t gndy;
+  int8_t rx;
+  int8_t ry;
+  int8_t yx;
+  int8_t yy;
+  int8_t gx;
+  int8_t gy;
+  int8_t switch_position; // for goal-matching purposes
+  bool isShort;
+  uint8_t ledStates;
+  bool meetsRules;
+} __attribute__ ((packed));
+
+EVALUATION evaluation = { .step = EVALUATION_IDLE, .boardMeetsRules = -1 };
+
+// Called whenever boardChanged or switchChanged gets set
+void BoardChanged(void)
 {
-  if (x > 0) {
-    uint8_t piece = pruned_board[y][x - 1];
-    if (flags == 0)
-      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_R]);
-    else
-      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_R]);
-  } else
-    return 0;
+  if (boardChanged) {
+    evaluation.boardChanged = true;
+    // The "meets rules" pruning treats a switch the same in every position, so its answer only changes when the board does
+    evaluation.boardMeetsRules = -1;
+    if (startAdvancesLevel)
+      CancelStartAdvancesLevel();
+  }
+  boardChanged = false;
+  switchChanged = false;
+
+  evaluation.step = EVALUATION_SCAN;
 }
 
-// If this function is called with PRUNEBOARD_FLAG_NORMAL, it will prune the board for proper minimal netlist generation. If called
-// with PRUNEBOARD_FLAG_MEETS_RULES, then a switch in any position will not cause a piece properly connected to it to be pruned,
-// which is used during the "meets rules" check to make sure that there aren't any loose ends that don't belong on the board.
-bool PruneBoard(uint8_t flags)
+static void BoardChanged_Step(void)
 {
-  bool meetsRules = true;
+  switch (evaluation.step) {
+  case EVALUATION_SCAN:
+    evaluation.vccx = evaluation.vccy = evaluation.gndx = evaluation.gndy = -1;
+    evaluation.rx = evaluation.ry = evaluation.yx = evaluation.yy = evaluation.gx = evaluation.gy = -1;
 
-  // Copy the state of the board into pruned_board, because this is what we will prune, and what the netlist generator will run from
-  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
-    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
-      pruned_board[y][x] = board[y][x] & PIECE_MASK;
+    // If the switch is on the board, keep track of its switch position for goal-matching purposes
+    evaluation.switch_position = -1;
 
-  // Keep looping until we reach a steady state where no pieces were removed or degenerated
-  uint8_t piecesRemoved;
-  do {
-    piecesRemoved = 0;
-    // Loop over the pruned_board and ensure each piece has enough valid neighbors in the right places, otherwise that piece will degenerate
+    // We have to use the 'board' array, because the LEDs might not exist on 'pruned_board'
     for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
       for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
-        uint8_t piece = pruned_board[y][x];
-        uint8_t count = 0;
+        uint8_t piece = board[y][x] & PIECE_MASK;
         switch (piece) {
-          // -------------------- BLANK
-        case P_BLANK:
-          break;
 
-          // -------------------- VCC
+          // VCC
         case P_VCC_T:
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_VCC_R:
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_VCC_B:
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_VCC_L:
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.vccx = x;
+          evaluation.vccy = y;
           break;
 
-          // -------------------- GND
+          // GND
         case P_GND_LTR:
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_GND_TRB:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_GND_RBL:
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_GND_BLT:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count == 0) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.gndx = x;
+          evaluation.gndy = y;
           break;
 
-          // -------------------- SW1
+          // SW1
         case P_SW1_BL:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidRightNeighbor(flags, x, y);
-          }
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW1_LT:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidRightNeighbor(flags, x, y);
-            count += CountValidBottomNeighbor(flags, x, y);
-          }
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW1_TR:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidBottomNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW1_RB:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.switch_position = 1;
           break;
 
-          // -------------------- RLED
-        case P_RLED_AB_CR:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_RLED_AL_CB:
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
+          // RED LED
         case P_RLED_AT_CL:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_RLED_AR_CT:
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+        case P_RLED_AB_CR:
+        case P_RLED_AL_CB:
+          evaluation.rx = x;
+          evaluation.ry = y;
           break;
 
-          // -------------------- SW2
+          // SW2
         case P_SW2_BT:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidRightNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW2_LR:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidBottomNeighbor(flags, x, y);
-          }
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW2_TB:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidRightNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW2_RL:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidBottomNeighbor(flags, x, y);
-          }
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.switch_position = 2;
           break;
 
-          // -------------------- YLED
-        case P_YLED_AL_CR:
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
+          // YELLOW LED
         case P_YLED_AT_CB:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_YLED_AR_CL:
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_YLED_AB_CT:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+        case P_YLED_AL_CR:
+          evaluation.yx = x;
+          evaluation.yy = y;
           break;
 
-          // -------------------- SW3
+          // SW3
         case P_SW3_BR:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW3_LB:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidTopNeighbor(flags, x, y);
-            count += CountValidRightNeighbor(flags, x, y);
-          }
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW3_TL:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidRightNeighbor(flags, x, y);
-            count += CountValidBottomNeighbor(flags, x, y);
-          }
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_SW3_RT:
-          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
-            count += CountValidBottomNeighbor(flags, x, y);
-            count += CountValidLeftNeighbor(flags, x, y);
-          }
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.switch_position = 3;
           break;
 
-          // -------------------- GLED
+          // GREEN LED
+        case P_GLED_AT_CR:
+        case P_GLED_AR_CB:
         case P_GLED_AB_CL:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
         case P_GLED_AL_CT:
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidTopNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
+          evaluation.gx = x;
+          evaluation.gy = y;
           break;
-        case P_GLED_AT_CR:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_GLED_AR_CB:
-          count += CountValidRightNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-
-          // -------------------- STRAIGHT
-        case P_STRAIGHT_LR:
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_STRAIGHT_TB:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-
-          // -------------------- DBL CORNER
-        case P_DBL_CORNER_TL_BR: {
-          bool removeTL = false;
-          bool removeBR = false;
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            removeTL = true; // degenerate
-          }
-          count = 0; // reset the count
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            removeBR = true; // degenerate
-          }
-          if (removeTL && removeBR)
-            pruned_board[y][x] = P_BLANK;
-          else if (removeTL)
-            pruned_board[y][x] = P_CORNER_BR;
-          else if (removeBR)
-            pruned_board[y][x] = P_CORNER_TL;
-          if (removeTL || removeBR)
-            ++piecesRemoved;
-        }
-          break;
-        case P_DBL_CORNER_TR_BL: {
-          bool removeTR = false;
-          bool removeBL = false;
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            removeTR = true; // degenerate
-          }
-          count = 0; // reset the count
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            removeBL = true; // degenerate
-          }
-          if (removeTR && removeBL)
-            pruned_board[y][x] = P_BLANK;
-          else if (removeTR)
-            pruned_board[y][x] = P_CORNER_BL; // degenerate into the other corner
-          else if (removeBL)
-            pruned_board[y][x] = P_CORNER_TR; // degenerate into the other corner
-          if (removeTR || removeBL)
-            ++piecesRemoved;
-        }
-          break;
-
-          // -------------------- CORNER
-        case P_CORNER_BL:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_CORNER_TL:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidLeftNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_CORNER_TR:
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-        case P_CORNER_BR:
-          count += CountValidBottomNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          }
-          break;
-
-          // -------------------- TPIECE
-        case P_TPIECE_RBL: {
-          uint8_t countR = CountValidRightNeighbor(flags, x, y);
-          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
-          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
-          if (countR + countB + countL < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          } else if (countR == 0) {
-            pruned_board[y][x] = P_CORNER_BL; // degenerate into corner
-            ++piecesRemoved;
-          } else if (countB == 0) {
-            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into straight
-            ++piecesRemoved;
-          } else if (countL == 0) {
-            pruned_board[y][x] = P_CORNER_BR; // degenerate into corner
-            ++piecesRemoved;
-          }
-        }
-          break;
-        case P_TPIECE_BLT: {
-          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
-          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
-          uint8_t countT = CountValidTopNeighbor(flags, x, y);
-          if (countB + countL + countT < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          } else if (countB == 0) {
-            pruned_board[y][x] = P_CORNER_TL; // degenerate into corner
-            ++piecesRemoved;
-          } else if (countL == 0) {
-            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into straight
-            ++piecesRemoved;
-          } else if (countT == 0) {
-            pruned_board[y][x] = P_CORNER_BL; // degenerate into corner
-            ++piecesRemoved;
-          }
-        }
-          break;
-        case P_TPIECE_LTR: {
-          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
-          uint8_t countT = CountValidTopNeighbor(flags, x, y);
-          uint8_t countR = CountValidRightNeighbor(flags, x, y);
-          if (countL + countT + countR < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          } else if (countL == 0) {
-            pruned_board[y][x] = P_CORNER_TR; // degenerate into corner
-            ++piecesRemoved;
-          } else if (countT == 0) {
-            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into straight
-            ++piecesRemoved;
-          } else if (countR == 0) {
-            pruned_board[y][x] = P_CORNER_TL; // degenerate into corner
-            ++piecesRemoved;
-          }
-        }
-          break;
-        case P_TPIECE_TRB: {
-          uint8_t countT = CountValidTopNeighbor(flags, x, y);
-          uint8_t countR = CountValidRightNeighbor(flags, x, y);
-          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
-          if (countT + countR + countB < 2) {
-            pruned_board[y][x] = P_BLANK;
-            ++piecesRemoved;
-          } else if (countT == 0) {
-            pruned_board[y][x] = P_CORNER_BR; // degenerate into corner
-            ++piecesRemoved;
-          } else if (countR == 0) {
-            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into straight
-            ++piecesRemoved;
-          } else if (countB == 0) {
-            pruned_board[y][x] = P_CORNER_TR; // degenerate into corner
-            ++piecesRemoved;
-          }
-        }
-          break;
-
-          // -------------------- BRIDGE
-        case P_BRIDGE1_TB_LR:
-        case P_BRIDGE2_TB_LR: {
-          bool removeTB = false;
-          bool removeLR = false;
-          count += CountValidTopNeighbor(flags, x, y);
-          count += CountValidBottomNeighbor(flags, x, y);
-          if (count < 2) {
-            removeTB = true; // degenerate
-          }
-          count = 0; // reset the count
-          count += CountValidLeftNeighbor(flags, x, y);
-          count += CountValidRightNeighbor(flags, x, y);
-          if (count < 2) {
-            removeLR = true; // degenerate
-          }
-          if (removeTB && removeLR)
-            pruned_board[y][x] = P_BLANK;
-          else if (removeTB)
-            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into the other straight
-          else if (removeLR)
-            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into the other straight
-          if (removeTB || removeLR)
-            ++piecesRemoved;
-        }
-          break;
-
-        case P_BLOCKER:
-          pruned_board[y][x] = P_BLANK;
-          break;
-
-        default:
-          // This should never happen
-          break;
-        }
-      }
-    if (piecesRemoved)
-      meetsRules = false;
-  } while (piecesRemoved);
-
-  return meetsRules;
-}
-
-#define DECIDE_NOW   0
-#define DECIDE_INIT  1
-#define DECIDE_NEXT  2
-#define DECIDE_QUERY 4
-
-/*
- * The decide function avoids having to call many iterations of the
- * slow rand() function to trace out the branches in the circuit, by
- * carefully returning binary numbers in a methodical fashion.
- *
- * Example usage below:
-
-     int main(int argc, char *argv[])
-     {
-       // initialize the decider
-       decide(DECIDE_INIT);
-
-       for (uint8_t a = 0; a < 4; ++a) {
-         for (uint8_t i = 0; i < 2; ++i) {
-           uint8_t d = decide(DECIDE_NOW);
-           printf("%d\n", d);
-         }
-         puts("next\n");
-         decide(DECIDE_NEXT);
-       }
-       return 0;
-     }
- */
-uint8_t decide(uint8_t flags)
-{
-  static uint8_t generation = 0;
-  static uint8_t bitmask = 1;
-  static bool wasCalled = false;
-
-  if (!flags) {
-    // decide something
-    uint8_t decision = (generation & bitmask);
-    bitmask <<= 1;
-    wasCalled |= true;
-    return decision ? 1 : 0;
-  }
-
-  if (flags & DECIDE_INIT) {
-    generation = 0;
-    bitmask = 1;
-    wasCalled = false;
-    return 0;
-  }
-
-  if (flags & DECIDE_QUERY)
-    return wasCalled;
-
-  if (flags & DECIDE_NEXT) {
-    ++generation;
-    bitmask = 1;
-  }
-
-  return 0;
-}
-
-// nl_source will be NL_VV, NL_00, NL_RA, NL_RC, etc...
-// d will be D_T, D_R, D_B, or D_L (masked with DIRECTION_MASK to ensure it is in range)
-// returns NL_VV, NL_00, NL_RA, etc... depending on what it finds
-uint8_t SimulateElectron(uint8_t nl_src, int8_t x, int8_t y, uint8_t d)
-{
-  uint8_t nl_dest = nl_src; // in case we are in a loop
-
-  //  memset(directions, 0, sizeof(directions));
-
-  uint8_t decision = 0;
-  bool halt = false;
-  uint8_t ttl = 0;
-  while (!halt && (++ttl != 0) && x >= 0 && x <= BOARD_WIDTH - 1 && y >= 0 && y <= BOARD_HEIGHT - 1) {
-    uint8_t piece = pruned_board[y][x];
-    switch (piece) {
-    case P_BLANK:
-      halt = true;
-      break;
-
-    case P_VCC_T: // technically direction doesn't matter, because previously validated by PruneBoard
-      if (d == D_IN_T)
-        return NL_VV;
-      halt = true;
-      break;
-    case P_VCC_R:
-      if (d == D_IN_R)
-        return NL_VV;
-      halt = true;
-      break;
-    case P_VCC_B:
-      if (d == D_IN_B)
-        return NL_VV;
-      halt = true;
-      break;
-    case P_VCC_L:
-      if (d == D_IN_L)
-        return NL_VV;
-      halt = true;
-      break;
-
-    case P_GND_LTR: // technically direction doesn't matter, because previously validated by PruneBoard
-      if (d == D_IN_T || d == D_IN_R || d == D_IN_L)
-        return NL_00;
-      halt = true;
-      break;
-    case P_GND_TRB:
-      if (d == D_IN_T || d == D_IN_R || d == D_IN_B)
-        return NL_00;
-      halt = true;
-      break;
-    case P_GND_RBL:
-      if (d == D_IN_R || d == D_IN_B || d == D_IN_L)
-        return NL_00;
-      halt = true;
-      break;
-    case P_GND_BLT:
-      if (d == D_IN_T || d == D_IN_B || d == D_IN_L)
-        return NL_00;
-      halt = true;
-      break;
-
-      // we need to pay attention to direction so we know where it exits
-    case P_SW1_BL:
-      switch (d) {
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      default: // these default cases should not be needed, but I put them here for safety
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW1_LT:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW1_TR:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW1_RB:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-      // direction matters here, because we need to know whether we hit an anode or cathode
-    case P_RLED_AB_CR:
-      switch (d) {
-      case D_IN_R:
-        return NL_RC;
-        break;
-      case D_IN_B:
-        return NL_RA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_RLED_AL_CB:
-      switch (d) {
-      case D_IN_B:
-        return NL_RC;
-        break;
-      case D_IN_L:
-        return NL_RA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_RLED_AT_CL:
-      switch (d) {
-      case D_IN_T:
-        return NL_RA;
-        break;
-      case D_IN_L:
-        return NL_RC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_RLED_AR_CT:
-      switch (d) {
-      case D_IN_T:
-        return NL_RC;
-        break;
-      case D_IN_R:
-        return NL_RA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_SW2_BT:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW2_LR:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW2_TB:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW2_RL:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-      // direction matters here, because we need to know whether we hit an anode or cathode
-    case P_YLED_AL_CR:
-      switch (d) {
-      case D_IN_R:
-        return NL_YC;
-        break;
-      case D_IN_L:
-        return NL_YA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_YLED_AT_CB:
-      switch (d) {
-      case D_IN_T:
-        return NL_YA;
-        break;
-      case D_IN_B:
-        return NL_YC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_YLED_AR_CL:
-      switch (d) {
-      case D_IN_R:
-        return NL_YA;
-        break;
-      case D_IN_L:
-        return NL_YC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_YLED_AB_CT:
-      switch (d) {
-      case D_IN_T:
-        return NL_YC;
-        break;
-      case D_IN_B:
-        return NL_YA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_SW3_BR:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW3_LB:
-      switch (d) {
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW3_TL:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_SW3_RT:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-      // direction matters here, because we need to know whether we hit an anode or cathode
-    case P_GLED_AB_CL:
-      switch (d) {
-      case D_IN_B:
-        return NL_GA;
-        break;
-      case D_IN_L:
-        return NL_GC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_GLED_AL_CT:
-      switch (d) {
-      case D_IN_T:
-        return NL_GC;
-        break;
-      case D_IN_L:
-        return NL_GA;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_GLED_AT_CR:
-      switch (d) {
-      case D_IN_T:
-        return NL_GA;
-        break;
-      case D_IN_R:
-        return NL_GC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_GLED_AR_CB:
-      switch (d) {
-      case D_IN_R:
-        return NL_GA;
-        break;
-      case D_IN_B:
-        return NL_GC;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_STRAIGHT_LR:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_STRAIGHT_TB:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_DBL_CORNER_TL_BR:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_DBL_CORNER_TR_BL:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_CORNER_BL:
-      switch (d) {
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_CORNER_TL:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_CORNER_TR:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_CORNER_BR:
-      switch (d) {
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_TPIECE_RBL:
-      decision = decide(DECIDE_NOW);
-      switch (d) {
-      case D_IN_R:
-        if (decision) { // continue to L
-          //directions[y][x] |= (D_IN_R | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        } else { // turn to B
-          //directions[y][x] |= (D_IN_R | D_OUT_B);
-          d = D_IN_T;
-          y++;
-        }
-        break;
-      case D_IN_B:
-        if (decision) { // turn to R
-          //directions[y][x] |= (D_IN_B | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        } else { // turn to L
-          //directions[y][x] |= (D_IN_B | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        }
-        break;
-      case D_IN_L:
-        if (decision) { // turn to B
-          //directions[y][x] |= (D_IN_L | D_OUT_B);
-          d = D_IN_T;
-          y++;
-        } else { // continue to R
-          //directions[y][x] |= (D_IN_L | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        }
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_TPIECE_BLT:
-      decision = decide(DECIDE_NOW);
-      switch (d) {
-      case D_IN_T:
-        if (decision) { // turn to L
-          //directions[y][x] |= (D_IN_T | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        } else { // continue to B
-          //directions[y][x] |= (D_IN_T | D_OUT_B);
-          d = D_IN_T;
-          y++;
-        }
-        break;
-      case D_IN_B:
-        if (decision) { // continue to T
-          //directions[y][x] |= (D_IN_B | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        } else { // turn to L
-          //directions[y][x] |= (D_IN_B | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        }
-        break;
-      case D_IN_L:
-        if (decision) { // turn to B
-          //directions[y][x] |= (D_IN_L | D_OUT_B);
-          d = D_IN_T;
-          y++;
-        } else { // turn to T
-          //directions[y][x] |= (D_IN_L | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        }
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_TPIECE_LTR:
-      decision = decide(DECIDE_NOW);
-      switch (d) {
-      case D_IN_T:
-        if (decision) { // turn to L
-          //directions[y][x] |= (D_IN_T | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        } else { // turn to R
-          //directions[y][x] |= (D_IN_T | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        }
-        break;
-      case D_IN_R:
-        if (decision) { // turn to T
-          //directions[y][x] |= (D_IN_R | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        } else { // continue to L
-          //directions[y][x] |= (D_IN_R | D_OUT_L);
-          d = D_IN_R;
-          x--;
-        }
-        break;
-      case D_IN_L:
-        if (decision) { // continue to R
-          //directions[y][x] |= (D_IN_L | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        } else { // turn to T
-          //directions[y][x] |= (D_IN_L | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        }
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-    case P_TPIECE_TRB:
-      decision = decide(DECIDE_NOW);
-      switch (d) {
-      case D_IN_T:
-        if (decision) { // continue to B
-          //directions[y][x] |= (D_IN_T | D_OUT_B);
-          d = D_IN_T;
-          y++;
-        } else { // turn to R
-          //directions[y][x] |= (D_IN_T | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        }
-        break;
-      case D_IN_R:
-        if (decision) { // turn to T
-          //directions[y][x] |= (D_IN_R | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        } else { // turn to B
-          //directions[y][x] |= (D_IN_R | D_OUT_B);
-          d = D_IN_T;
-          y++;
         }
-        break;
-      case D_IN_B:
-        if (decision) { // turn to R
-          //directions[y][x] |= (D_IN_B | D_OUT_R);
-          d = D_IN_L;
-          x++;
-        } else { // continue to T
-          //directions[y][x] |= (D_IN_B | D_OUT_T);
-          d = D_IN_B;
-          y--;
-        }
-        break;
-      default:
-        halt = true;
-        break;
-      }
-      break;
-
-    case P_BRIDGE1_TB_LR:
-    case P_BRIDGE2_TB_LR:
-      switch (d) {
-      case D_IN_T:
-        //directions[y][x] |= (D_IN_T | D_OUT_B);
-        d = D_IN_T;
-        y++;
-        break;
-      case D_IN_R:
-        //directions[y][x] |= (D_IN_R | D_OUT_L);
-        d = D_IN_R;
-        x--;
-        break;
-      case D_IN_B:
-        //directions[y][x] |= (D_IN_B | D_OUT_T);
-        d = D_IN_B;
-        y--;
-        break;
-      case D_IN_L:
-        //directions[y][x] |= (D_IN_L | D_OUT_R);
-        d = D_IN_L;
-        x++;
-        break;
-      default:
-        halt = true;
-        break;
       }
-      break;
+    break;
 
-    case P_BLOCKER:
-    default:
-      halt = true;
-      break;
-    }
+  case EVALUATION_PRUNE: {
+    // The algorithm works with or without pruning the board first
+    // Change the 1 to a 0 to experiment with the runtimes of each
+#if 1
+    PROFILE_BEGIN(PROFILE_PRUNEBOARD);
+    Engine_PruneBoard(&engine, board, PRUNEBOARD_FLAG_NORMAL);
+    PROFILE_END(PROFILE_PRUNEBOARD);
+#else
+    for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+      for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+        engine.pruned_board[y][x] = board[y][x] & PIECE_MASK;
+    Engine_InvalidateNetlist(&engine);
+#endif
+    break;
   }
-  return nl_dest;
-}
 
-void SimulateElectrons(uint8_t nl_src, int8_t x, int8_t y, uint8_t d) {
-  decide(DECIDE_INIT);
-  for (uint8_t e = 0; e < 4; ++e) { // send electrons in every possible path
-    for (uint8_t i = 0; i < 2; ++i) { // using the fewest number of electrons
-      uint8_t result = SimulateElectron(nl_src, x, y, d);
-      pruned_netlist[result][nl_src] = pruned_netlist[nl_src][result] = 1;
-
-      // If the first electron did not hit a branch (TPIECE), it wouldn't have called the decide
-      // function, and therefore we don't need to send any more electrons from nl_src, because
-      // they will also never branch. This saves a ton of clock cycles (3000-4000 typically, but
-      // sometimes 13000+ clocks).
-      if (!decide(DECIDE_QUERY))
-        return;
+  case EVALUATION_NETLIST: {
+    // Find which of VCC, GND, and the LED terminals on 'pruned_board' are wired together (this is
+    // skipped if 'pruned_board' didn't change, such as when a switch on a loose end was toggled).
+    // Only the sources a change touched are traced again, one square of them each time through, so
+    // this step is repeated until the netlist is up to date.
+    PROFILE_BEGIN(PROFILE_UPDATENETLIST);
+    bool netlistDone = Engine_UpdateNetlistStep(&engine);
+    PROFILE_END(PROFILE_UPDATENETLIST);
+    if (!netlistDone)
+      return;
+    evaluation.isShort = Engine_IsShort(&engine);
+
+    // print netlist
+#if defined(OPTION_DEBUG_NETLIST_MATRIX)
+    UZEMC = '\n';
+    for (uint8_t y = 0; y < 8; ++y) {
+      for (uint8_t x = 0; x < 8; ++x) {
+       UZEMC = NETLIST_CONNECTED(engine.netlist, y, x) ? '1' : '0'; UZEMC = ' ';
+      }
+      UZEMC = '\n';
     }
-    decide(DECIDE_NEXT);
+#endif
+    break;
   }
-}
-
-#define R_BIT 1
-#define Y_BIT 2
-#define G_BIT 4
-
-#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
-#define NETLIST_NETLIST_MASK     0x07FFFFFF
-#define NETLIST_LED_STATES_MASK  0xE0000000
-#define NETLIST_R_ON             0x20000000
-#define NETLIST_Y_ON             0x40000000
-#define NETLIST_G_ON             0x80000000
-
-// This data is generated by running the oracle2/main program to take
-// all of the netlist data I gathered manually and permute all of the
-// LED colors to fill out the dataset
-// circuit/oracle2$ ./main > sorted_netlists_and_led_states.inc
-#include "oracle2/sorted_netlists_and_led_states.inc"
-
-uint8_t ConsultOracle(uint32_t nl)
-{
-  int16_t low = 0;
-  int16_t high = NELEMS(sorted_netlists_and_led_states) - 1;
 
-  while (low <= high) {
-    int16_t mid = (low + high) / 2;
-
-    uint32_t netlist_and_led_states = (uint32_t)pgm_read_dword(&sorted_netlists_and_led_states[mid]);
-    uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
-
-    if (netlist < nl) {
-      low = mid + 1;
-    } else if (netlist > nl) {
-      high = mid - 1;
-    } else {
-      // We found it, so extract the led state, and return it
-      uint8_t led_states = (uint8_t)((netlist_and_led_states & NETLIST_LED_STATES_MASK) >> 29);
-      return led_states;
+  case EVALUATION_LOOKUP: {
+    typedef union {
+      uint32_t dword;
+      uint8_t byte[4];
+    } dword;
+
+    // Pack the netlist into a single 27 bit number
+    dword packed_netlist;
+    PROFILE_BEGIN(PROFILE_PACKNETLIST);
+    packed_netlist.dword = Engine_PackNetlist(&engine);
+    PROFILE_END(PROFILE_PACKNETLIST);
+    // Output the netlist
+    /* uint8_t bits26_17 = (uint8_t)((packed_netlist.dword & 0xFF000000) >> 24); */
+    /* uint8_t bits23_16 = (uint8_t)((packed_netlist.dword & 0x00FF0000) >> 16); */
+    /* uint8_t bits15_8 = (uint8_t)((packed_netlist.dword & 0x0000FF00) >> 8); */
+    /* uint8_t bits7_0 = (uint8_t)(packed_netlist.dword & 0x000000FF); */
+    /* UZEMC = '0'; UZEMC = 'x'; UZEMH = bits26_17; UZEMH = bits23_16; UZEMH = bits15_8; UZEMH = bits7_0; UZEMC = '\n'; */
+
+    static uint32_t prev_netlist = 0;
+    if (packed_netlist.dword != prev_netlist) {
+      prev_netlist = packed_netlist.dword;
+#if defined(OPTION_DEBUG_NETLIST)
+      UZEMC = '0'; UZEMC = 'x'; UZEMH = packed_netlist.byte[3]; UZEMH = packed_netlist.byte[2]; UZEMH = packed_netlist.byte[1]; UZEMH = packed_netlist.byte[0]; UZEMC = '\n';
+#endif
     }
+
+    PROFILE_BEGIN(PROFILE_CONSULTORACLE);
+    evaluation.ledStates = Engine_ConsultOracle(packed_netlist.dword);
+    PROFILE_END(PROFILE_CONSULTORACLE);
+    break;
   }
-  // Not found, so default all LEDs to off
-  return 0;
-}
 
-bool CurrentLevelHasSwitch(void)
-{
-  return (goal[0][0] == P_GOAL_SW1);
-}
+  case EVALUATION_RULES:
+    // See if we meet the rules
+    evaluation.meetsRules = false;
 
-// If there is not a switch in the level, just pass -1 in for switchPosition
-// If the goal state is requested for a level with a switch, but a switch position wasn't passed in, return 0xFF
-// (which should not match the goalState from the netlist lookup)
-uint8_t GoalStatesForCurrentLevel(int8_t switchPosition)
-{
-  bool currentLevelHasSwitch = CurrentLevelHasSwitch();
-  if (currentLevelHasSwitch && !(switchPosition == 1 || switchPosition == 2 || switchPosition == 3))
-    return 0xFF; // error condition that shouldn't match anything in the netlist lookup
+    // The rules can't be met if there is a short circuit
+    if (evaluation.isShort)
+      break;
 
-  uint8_t goalState = 0;
+    // The rules can't be met if you have a piece picked up
+    if (old_piece != -1)
+      break;
 
-  if (currentLevelHasSwitch) {
-    for (uint8_t i = 1; i < 4; ++i) {
-      uint8_t goalPiece = goal[switchPosition - 1][i];
-      switch (goalPiece) {
-      case P_GOAL_RLED_ON:
-        goalState |= R_BIT;
-        break;
-      case P_GOAL_YLED_ON:
-        goalState |= Y_BIT;
-        break;
-      case P_GOAL_GLED_ON:
-        goalState |= G_BIT;
-        break;
-      }
-    }
-  } else {
-    for (uint8_t i = 0; i < 3; ++i) {
-      uint8_t goalPiece = goal[0][i];
-      switch (goalPiece) {
-      case P_GOAL_RLED_ON:
-        goalState |= R_BIT;
-        break;
-      case P_GOAL_YLED_ON:
-        goalState |= Y_BIT;
-        break;
-      case P_GOAL_GLED_ON:
-        goalState |= G_BIT;
-        break;
-      }
+    // The rules can't be met if you have pieces in your hand
+    for (uint8_t y = 0; y < HAND_HEIGHT; ++y)
+      for (uint8_t x = 0; x < HAND_WIDTH; ++x)
+        if (hand[y][x] != 0)
+          goto skip_expensive_rule_checks;
+
+    // The rules can't be met if there are invalid "loose ends"
+    if (evaluation.boardMeetsRules == -1) {
+      PROFILE_BEGIN(PROFILE_MEETSRULES);
+      evaluation.boardMeetsRules = Engine_PruneBoard(&engine, board, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY);
+      PROFILE_END(PROFILE_MEETSRULES);
     }
+    evaluation.meetsRules = evaluation.boardMeetsRules;
+
+  skip_expensive_rule_checks:
+    break;
   }
 
-  return goalState;
+  ++evaluation.step;
 }
 
-// RAM Font data for letters ABCDEFGHI-KLMNOPQRSTUVWXYZ,.
-const uint8_t rf_help[] PROGMEM = {
-  0x30, 0x78, 0xec, 0xe4, 0xfe, 0xc2, 0xc2, 0x00,
-  0x3e, 0x62, 0x32, 0x7e, 0xe2, 0xf2, 0x7e, 0x00,
-  0x7c, 0xc6, 0x02, 0x02, 0xc6, 0xfe, 0x7c, 0x00,
-  0x3c, 0x62, 0xc2, 0xc2, 0xe2, 0xfe, 0x7e, 0x00,
-  0x7c, 0xc6, 0x02, 0x7e, 0x02, 0xfe, 0xfc, 0x00,
-  0x7c, 0xc6, 0x02, 0x7e, 0x06, 0x06, 0x06, 0x00,
-  0x7c, 0xc6, 0x02, 0x02, 0xf2, 0xe6, 0xbc, 0x00,
-  0x42, 0xc2, 0xc2, 0xfe, 0xc2, 0xc6, 0xc6, 0x00,
-  0x10, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x00,
-  0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00,
-  0x64, 0x36, 0x16, 0x3e, 0x76, 0xe6, 0xe6, 0x00,
-  0x04, 0x06, 0x02, 0x02, 0x82, 0xfe, 0x7c, 0x00,
-  0x62, 0xf6, 0xde, 0xca, 0xc2, 0xc6, 0x46, 0x00,
-  0x46, 0xce, 0xda, 0xf2, 0xe2, 0xc6, 0x46, 0x00,
-  0x70, 0xcc, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
-  0x7c, 0xc6, 0xe2, 0x7e, 0x06, 0x06, 0x04, 0x00,
-  0x7c, 0xe2, 0xc2, 0xc2, 0x7a, 0xe6, 0xdc, 0x00,
-  0x7c, 0xc6, 0xc2, 0x7e, 0x1a, 0xf2, 0xe2, 0x00,
-  0x3c, 0x62, 0x02, 0x7c, 0xc0, 0xe6, 0x7c, 0x00,
-  0x7c, 0xfe, 0x12, 0x10, 0x18, 0x18, 0x18, 0x00,
-  0x40, 0xc2, 0xc2, 0xc2, 0xe6, 0x7e, 0x3c, 0x00,
-  0x40, 0xc2, 0xc2, 0xc4, 0x64, 0x38, 0x18, 0x00,
-  0x40, 0xc2, 0xd2, 0xda, 0xda, 0xfe, 0x6c, 0x00,
-  0x80, 0xc6, 0x6e, 0x38, 0x38, 0xec, 0xc6, 0x00,
-  0x80, 0x86, 0xcc, 0x78, 0x30, 0x1c, 0x0c, 0x00,
-  0x7c, 0xc0, 0x60, 0x10, 0x0c, 0xfe, 0x7c, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x0c,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00,
-};
-
-// RAM Font data for (c)20-
-const uint8_t rf_title_extra[] PROGMEM = {
-  0x3c, 0x42, 0x99, 0x85, 0x99, 0x42, 0x3c, 0x00,
-  0x7c, 0xe6, 0xc4, 0x60, 0x18, 0xfc, 0x7e, 0x00,
-  0x7c, 0xc2, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
-  0x00, 0x00, 0x00, 0x3e, 0x00, 0x00, 0x00, 0x00,
-};
-
-// RAM Font data for PRESTAFONXCIU
-const uint8_t rf_win[] PROGMEM = {
-  0x7c, 0xc6, 0xe2, 0x7e, 0x06, 0x06, 0x04, 0x00,
-  0x7c, 0xc6, 0xc2, 0x7e, 0x1a, 0xf2, 0xe2, 0x00,
-  0x7c, 0xc6, 0x02, 0x7e, 0x02, 0xfe, 0xfc, 0x00,
-  0x3c, 0x62, 0x02, 0x7c, 0xc0, 0xe6, 0x7c, 0x00,
-  0x7c, 0xfe, 0x12, 0x10, 0x18, 0x18, 0x18, 0x00,
-  0x30, 0x78, 0xec, 0xe4, 0xfe, 0xc2, 0xc2, 0x00,
-  0x7c, 0xc6, 0x02, 0x7e, 0x06, 0x06, 0x06, 0x00,
-  0x70, 0xcc, 0xc2, 0xc2, 0xe2, 0xfe, 0x7c, 0x00,
-  0x46, 0xce, 0xda, 0xf2, 0xe2, 0xc6, 0x46, 0x00,
-  0x80, 0xc6, 0x6e, 0x38, 0x38, 0xec, 0xc6, 0x00,
-  0x7c, 0xc6, 0x02, 0x02, 0xc6, 0xfe, 0x7c, 0x00,
-  0x10, 0x30, 0x30, 0x30, 0x38, 0x38, 0x38, 0x00,
-  0x40, 0xc2, 0xc2, 0xc2, 0xe6, 0x7e, 0x3c, 0x00,
-};
-
-#define W_P (GAME_USER_RAM_TILES_COUNT + 0)
-#define W_R (GAME_USER_RAM_TILES_COUNT + 1)
-#define W_E (GAME_USER_RAM_TILES_COUNT + 2)
-#define W_S (GAME_USER_RAM_TILES_COUNT + 3)
-#define W_T (GAME_USER_RAM_TILES_COUNT + 4)
-#define W_A (GAME_USER_RAM_TILES_COUNT + 5)
-#define W_F (GAME_USER_RAM_TILES_COUNT + 6)
-#define W_O (GAME_USER_RAM_TILES_COUNT + 7)
-#define W_N (GAME_USER_RAM_TILES_COUNT + 8)
-#define W_X (GAME_USER_RAM_TILES_COUNT + 9)
-#define W_C (GAME_USER_RAM_TILES_COUNT + 10)
-#define W_I (GAME_USER_RAM_TILES_COUNT + 11)
-#define W_U (GAME_USER_RAM_TILES_COUNT + 12)
-// For Epic Win, a W gets loaded into the 'X' position
-#define W_W (GAME_USER_RAM_TILES_COUNT + 9)
-
-const uint8_t pgm_W_PRESS_START[] PROGMEM = { RAM_TILES_COUNT, W_P, W_R, W_E, W_S, W_S, RAM_TILES_COUNT, W_S, W_T, W_A, W_R, W_T, RAM_TILES_COUNT, W_F, W_O, W_R, RAM_TILES_COUNT, W_N, W_E, W_X, W_T, RAM_TILES_COUNT, W_C, W_I, W_R, W_C, W_U, W_I, W_T };
-const uint8_t pgm_W_EPIC_WIN[] PROGMEM = { W_P, W_R, W_E, W_S, W_S, RAM_TILES_COUNT, W_S, W_T, W_A, W_R, W_T, RAM_TILES_COUNT, W_F, W_O, W_R, RAM_TILES_COUNT, W_E, W_P, W_I, W_C, RAM_TILES_COUNT, W_W, W_I, W_N };
-
-const uint8_t fade[] PROGMEM = { 0x09, 0x12, 0x1B, 0x24, 0x2D, 0x36, 0x3F };
-const uint8_t win_fade[] PROGMEM = { 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0x07, 0x1F, 0x3F, 0x38, 0xC8, 0x8C, 0xF0 };
-
-void CancelStartAdvancesLevel(void)
+// Called once per pass through the main loop. Runs at least one step of a pending evaluation (so it
+// can't be starved), and then keeps going until it's done or the frame is used up. It only checks
+// for the vsync between steps, so the main loop can overrun by one step. On a legal board no step
+// can take more than a fifth of a frame (worstcase/ reports the bound on each one, the largest being
+// one square of the netlist repair), which keeps the cursor moving every frame.
+void BoardChanged_Run(void)
 {
-  if (startAdvancesLevel) {
-    for (uint8_t i = HAND_START_X; i < HAND_START_X + sizeof(pgm_W_PRESS_START); ++i)
-      SetTile(i, HAND_START_Y - 2, TILE_BACKGROUND);
-    DrawMap(HAND_START_X, HAND_START_Y - 2, map_addtogrid);
-    SetUserRamTilesCount(GAME_USER_RAM_TILES_COUNT);
-    startAdvancesLevel = false;
-  }
+  if (evaluation.step == EVALUATION_IDLE || evaluation.step == EVALUATION_READY)
+    return;
+
+  do {
+    BoardChanged_Step();
+  } while (evaluation.step != EVALUATION_READY && !GetVsyncFlag());
 }
 
-void BoardChanged(BUTTON_INFO* buttons)
+// Called right after the main loop's WaitVsync (and reading the controller), so the LED and goal
+// tiles change before the sprites under the cursor are redrawn, instead of tearing
+void BoardChanged_Commit(BUTTON_INFO* buttons)
 {
-  //cli();
-  //__asm__ __volatile__ ("wdr");
-
-  // The algorithm works with or without pruning the board first
-  // Change the 1 to a 0 to experiment with the runtimes of each
-#if 1
-  PruneBoard(PRUNEBOARD_FLAG_NORMAL);
-#else
-  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
-    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
-      pruned_board[y][x] = board[y][x] & PIECE_MASK;
-#endif
-
-  memset(pruned_netlist, 0, sizeof(pruned_netlist));
-  /* for (uint8_t i = 0; i < 8; ++i) // set the diagonals, not strictly necessary */
-  /*   pruned_netlist[i][i] = 1; */
-
-  // Keep track of where the pieces of interest are in case their tiles need to be changed
-  int8_t vccx = -1;
-  int8_t vccy = -1;
-  int8_t gndx = -1;
-  int8_t gndy = -1;
-  int8_t rx = -1;
-  int8_t ry = -1;
-  int8_t yx = -1;
-  int8_t yy = -1;
-  int8_t gx = -1;
-  int8_t gy = -1;
-
-  // If the switch is on the board, keep track of its switch position for goal-matching purposes
-  int8_t switch_position = -1;
-
-  // We have to use the 'board' array, because the LEDs might not exist on 'pruned_board'
-  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
-    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
-      uint8_t piece = board[y][x] & PIECE_MASK;
-      switch (piece) {
-
-        // VCC
-      case P_VCC_T:
-      case P_VCC_R:
-      case P_VCC_B:
-      case P_VCC_L:
-        vccx = x;
-        vccy = y;
-        break;
-
-        // GND
-      case P_GND_LTR:
-      case P_GND_TRB:
-      case P_GND_RBL:
-      case P_GND_BLT:
-        gndx = x;
-        gndy = y;
-        break;
-
-        // SW1
-      case P_SW1_BL:
-      case P_SW1_LT:
-      case P_SW1_TR:
-      case P_SW1_RB:
-        switch_position = 1;
-        break;
-
-        // RED LED
-      case P_RLED_AT_CL:
-      case P_RLED_AR_CT:
-      case P_RLED_AB_CR:
-      case P_RLED_AL_CB:
-        rx = x;
-        ry = y;
-        break;
-
-        // SW2
-      case P_SW2_BT:
-      case P_SW2_LR:
-      case P_SW2_TB:
-      case P_SW2_RL:
-        switch_position = 2;
-        break;
-
-        // YELLOW LED
-      case P_YLED_AT_CB:
-      case P_YLED_AR_CL:
-      case P_YLED_AB_CT:
-      case P_YLED_AL_CR:
-        yx = x;
-        yy = y;
-        break;
-
-        // SW3
-      case P_SW3_BR:
-      case P_SW3_LB:
-      case P_SW3_TL:
-      case P_SW3_RT:
-        switch_position = 3;
-        break;
-
-        // GREEN LED
-      case P_GLED_AT_CR:
-      case P_GLED_AR_CB:
-      case P_GLED_AB_CL:
-      case P_GLED_AL_CT:
-        gx = x;
-        gy = y;
-        break;
-      }
-    }
-
-  // Find where all the pieces of interest are on 'pruned_board', and call SimulateElectrons
-  // from that x, y, and direction the electrons need to go into the adjacent piece
-  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
-    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
-      uint8_t piece = pruned_board[y][x];
-      switch (piece) {
-
-        // VCC
-      case P_VCC_T:
-        SimulateElectrons(NL_VV, x, y - 1, D_IN_B);
-        break;
-      case P_VCC_R:
-        SimulateElectrons(NL_VV, x + 1, y, D_IN_L);
-        break;
-      case P_VCC_B:
-        SimulateElectrons(NL_VV, x, y + 1, D_IN_T);
-        break;
-      case P_VCC_L:
-        SimulateElectrons(NL_VV, x - 1, y, D_IN_R);
-        break;
-
-        // RED LED
-      case P_RLED_AT_CL:
-        SimulateElectrons(NL_RA, x, y - 1, D_IN_B);
-        SimulateElectrons(NL_RC, x - 1, y, D_IN_R);
-        break;
-      case P_RLED_AR_CT:
-        SimulateElectrons(NL_RA, x + 1, y, D_IN_L);
-        SimulateElectrons(NL_RC, x, y - 1, D_IN_B);
-        break;
-      case P_RLED_AB_CR:
-        SimulateElectrons(NL_RA, x, y + 1, D_IN_T);
-        SimulateElectrons(NL_RC, x + 1, y, D_IN_L);
-        break;
-      case P_RLED_AL_CB:
-        SimulateElectrons(NL_RA, x - 1, y, D_IN_R);
-        SimulateElectrons(NL_RC, x, y + 1, D_IN_T);
-        break;
-
-        // YELLOW LED
-      case P_YLED_AT_CB:
-        SimulateElectrons(NL_YA, x, y - 1, D_IN_B);
-        SimulateElectrons(NL_YC, x, y + 1, D_IN_T);
-        break;
-      case P_YLED_AR_CL:
-        SimulateElectrons(NL_YA, x + 1, y, D_IN_L);
-        SimulateElectrons(NL_YC, x - 1, y, D_IN_R);
-        break;
-      case P_YLED_AB_CT:
-        SimulateElectrons(NL_YA, x, y + 1, D_IN_T);
-        SimulateElectrons(NL_YC, x, y - 1, D_IN_B);
-        break;
-      case P_YLED_AL_CR:
-        SimulateElectrons(NL_YA, x - 1, y, D_IN_R);
-        SimulateElectrons(NL_YC, x + 1, y, D_IN_L);
-        break;
-
-        // GREEN LED
-      case P_GLED_AT_CR:
-        SimulateElectrons(NL_GA, x, y - 1, D_IN_B);
-        SimulateElectrons(NL_GC, x + 1, y, D_IN_L);
-        break;
-      case P_GLED_AR_CB:
-        SimulateElectrons(NL_GA, x + 1, y, D_IN_L);
-        SimulateElectrons(NL_GC, x, y + 1, D_IN_T);
-        break;
-      case P_GLED_AB_CL:
-        SimulateElectrons(NL_GA, x, y + 1, D_IN_T);
-        SimulateElectrons(NL_GC, x - 1, y, D_IN_R);
-        break;
-      case P_GLED_AL_CT:
-        SimulateElectrons(NL_GA, x - 1, y, D_IN_R);
-        SimulateElectrons(NL_GC, x, y - 1, D_IN_B);
-        break;
-
-      }
-    }
+  // Don't draw a result for a board that has changed since (or for the previous level)
+  if (evaluation.step != EVALUATION_READY || boardChanged || switchChanged)
+    return;
 
-  // print netlist
-#if defined(OPTION_DEBUG_NETLIST_MATRIX)
-  UZEMC = '\n';
-  for (uint8_t y = 0; y < 8; ++y) {
-    for (uint8_t x = 0; x < 8; ++x) {
-     UZEMC = pruned_netlist[y][x] ? '1' : '0'; UZEMC = ' ';
-    }
-    UZEMC = '\n';
-  }
-#endif
+  PROFILE_BEGIN(PROFILE_BOARDCHANGED);
+  evaluation.step = EVALUATION_IDLE;
 
-  // Pack the netlist into a single 27 bit number
-  const uint8_t packedNetlistY[] =
-    {
-     NL_GA,
-     NL_YC, NL_YC,
-     NL_YA, NL_YA, NL_YA,
-     NL_RC, NL_RC, NL_RC, NL_RC,
-     NL_RA, NL_RA, NL_RA, NL_RA, NL_RA,
-     NL_00, NL_00, NL_00, NL_00, NL_00, NL_00,
-     NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
-  const uint8_t packedNetlistX[] =
-    {
-     NL_GC,
-     NL_GC, NL_GA,
-     NL_GC, NL_GA, NL_YC,
-     NL_GC, NL_GA, NL_YC, NL_YA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
-
-  bool isShort = false;
-    // If we always check for a short, the 28th bit can always be 0, and then we only need to use 27 bits
-  if (pruned_netlist[NL_00][NL_VV]) {
-    isShort = true;
+  if (evaluation.isShort) {
     TriggerNote(SFX_CHANNEL, SFX_ZAP, SFX_SPEED_ZAP, SFX_VOL_ZAP);
 
     // If there is a short, draw the + and - of the VCC and GND tokens in red
-    if (vccx >= 0 && vccy >= 0)
-      SetTile(BOARD_START_X + vccx * BOARD_H_SPACING + 1, BOARD_START_Y + vccy * BOARD_V_SPACING + 1, TILE_SHORT_VCC);
-    if (gndx >= 0 && gndy >= 0) {
-      uint8_t piece = board[gndy][gndx] & PIECE_MASK;
+    if (evaluation.vccx >= 0 && evaluation.vccy >= 0)
+      SetTile(BOARD_START_X + evaluation.vccx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.vccy * BOARD_V_SPACING + 1, TILE_SHORT_VCC);
+    if (evaluation.gndx >= 0 && evaluation.gndy >= 0) {
+      uint8_t piece = board[evaluation.gndy][evaluation.gndx] & PIECE_MASK;
       if (piece == P_GND_LTR || piece == P_GND_RBL)
-        SetTile(BOARD_START_X + gndx * BOARD_H_SPACING + 1, BOARD_START_Y + gndy * BOARD_V_SPACING + 1, TILE_SHORT_GND);
+        SetTile(BOARD_START_X + evaluation.gndx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.gndy * BOARD_V_SPACING + 1, TILE_SHORT_GND);
       else
-        SetTile(BOARD_START_X + gndx * BOARD_H_SPACING + 1, BOARD_START_Y + gndy * BOARD_V_SPACING + 1, TILE_SHORT_GND_ROT);
+        SetTile(BOARD_START_X + evaluation.gndx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.gndy * BOARD_V_SPACING + 1, TILE_SHORT_GND_ROT);
     }
 
   } else {
     // If there is not a short, ensure the + and - of the VCC and GND tokens are white
-    if (vccx >= 0 && vccy >= 0)
-      SetTile(BOARD_START_X + vccx * BOARD_H_SPACING + 1, BOARD_START_Y + vccy * BOARD_V_SPACING + 1, TILE_VCC);
-    if (gndx >= 0 && gndy >= 0) {
-      uint8_t piece = board[gndy][gndx] & PIECE_MASK;
+    if (evaluation.vccx >= 0 && evaluation.vccy >= 0)
+      SetTile(BOARD_START_X + evaluation.vccx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.vccy * BOARD_V_SPACING + 1, TILE_VCC);
+    if (evaluation.gndx >= 0 && evaluation.gndy >= 0) {
+      uint8_t piece = board[evaluation.gndy][evaluation.gndx] & PIECE_MASK;
       if (piece == P_GND_LTR || piece == P_GND_RBL)
-        SetTile(BOARD_START_X + gndx * BOARD_H_SPACING + 1, BOARD_START_Y + gndy * BOARD_V_SPACING + 1, TILE_GND);
+        SetTile(BOARD_START_X + evaluation.gndx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.gndy * BOARD_V_SPACING + 1, TILE_GND);
       else
-        SetTile(BOARD_START_X + gndx * BOARD_H_SPACING + 1, BOARD_START_Y + gndy * BOARD_V_SPACING + 1, TILE_GND_ROT);
-    }
-  }
-
-  typedef union {
-    uint32_t dword;
-    uint8_t byte[4];
-  } dword;
-
-  dword packed_netlist;
-  packed_netlist.dword = 0;
-  if (!isShort) {
-    uint32_t bitmask = 1;
-    for (uint8_t i = 0; i < 27; ++i) {
-      if (pruned_netlist[packedNetlistY[i]][packedNetlistX[i]])
-        packed_netlist.dword |= bitmask;
-      bitmask <<= 1;
+        SetTile(BOARD_START_X + evaluation.gndx * BOARD_H_SPACING + 1, BOARD_START_Y + evaluation.gndy * BOARD_V_SPACING + 1, TILE_GND_ROT);
     }
   }
-  // Output the netlist
-  /* uint8_t bits26_17 = (uint8_t)((packed_netlist.dword & 0xFF000000) >> 24); */
-  /* uint8_t bits23_16 = (uint8_t)((packed_netlist.dword & 0x00FF0000) >> 16); */
-  /* uint8_t bits15_8 = (uint8_t)((packed_netlist.dword & 0x0000FF00) >> 8); */
-  /* uint8_t bits7_0 = (uint8_t)(packed_netlist.dword & 0x000000FF); */
-  /* UZEMC = '0'; UZEMC = 'x'; UZEMH = bits26_17; UZEMH = bits23_16; UZEMH = bits15_8; UZEMH = bits7_0; UZEMC = '\n'; */
-
-  //__asm__ __volatile__ ("wdr");
-  //sei();
-
-  static uint32_t prev_netlist = 0;
-  if (packed_netlist.dword != prev_netlist) {
-    prev_netlist = packed_netlist.dword;
-#if defined(OPTION_DEBUG_NETLIST)
-    UZEMC = '0'; UZEMC = 'x'; UZEMH = packed_netlist.byte[3]; UZEMH = packed_netlist.byte[2]; UZEMH = packed_netlist.byte[1]; UZEMH = packed_netlist.byte[0]; UZEMC = '\n';
-#endif
-  }
-
-  //cli();
-  //__asm__ __volatile__ ("wdr");
-  uint8_t ledStates = ConsultOracle(packed_netlist.dword);
-  //__asm__ __volatile__ ("wdr");
-  //sei();
-  uint8_t goalStates;
 
-  WaitVsync(1); // Prevent tearing of the LED tiles under the mouse cursor if the oracle took too long and the LED state needs to be changed
+  // If only the switch position changed, none of the LEDs were moved or redrawn, so only
+  // the ones that turned on or off need to be drawn
+  static uint8_t prev_ledStates = 0;
+  uint8_t ledStates = evaluation.ledStates;
+  uint8_t redrawLeds = evaluation.boardChanged ? (R_BIT | Y_BIT | G_BIT) : (ledStates ^ prev_ledStates);
+  prev_ledStates = ledStates;
 
-  if (rx >= 0 && ry >= 0) {
+  PROFILE_BEGIN(PROFILE_REDRAWLEDS);
+  if ((redrawLeds & R_BIT) && evaluation.rx >= 0 && evaluation.ry >= 0) {
     if (ledStates & R_BIT) {
-      uint8_t piece = pruned_board[ry][rx];
-      DrawMap(BOARD_START_X + rx * BOARD_H_SPACING, BOARD_START_Y + ry * BOARD_V_SPACING, LedOnMapName(piece));
+      uint8_t piece = engine.pruned_board[evaluation.ry][evaluation.rx];
+      DrawMap(BOARD_START_X + evaluation.rx * BOARD_H_SPACING, BOARD_START_Y + evaluation.ry * BOARD_V_SPACING, LedOnMapName(piece));
     } else {
-      uint8_t piece = board[ry][rx] & PIECE_MASK;
-      DrawMap(BOARD_START_X + rx * BOARD_H_SPACING, BOARD_START_Y + ry * BOARD_V_SPACING, MapName(piece));
+      uint8_t piece = board[evaluation.ry][evaluation.rx] & PIECE_MASK;
+      DrawMap(BOARD_START_X + evaluation.rx * BOARD_H_SPACING, BOARD_START_Y + evaluation.ry * BOARD_V_SPACING, MapName(piece));
     }
   }
 
-  if (yx >=0 && yy >= 0) {
+  if ((redrawLeds & Y_BIT) && evaluation.yx >=0 && evaluation.yy >= 0) {
     if (ledStates & Y_BIT) {
-      uint8_t piece = pruned_board[yy][yx];
-      DrawMap(BOARD_START_X + yx * BOARD_H_SPACING, BOARD_START_Y + yy * BOARD_V_SPACING, LedOnMapName(piece));
+      uint8_t piece = engine.pruned_board[evaluation.yy][evaluation.yx];
+      DrawMap(BOARD_START_X + evaluation.yx * BOARD_H_SPACING, BOARD_START_Y + evaluation.yy * BOARD_V_SPACING, LedOnMapName(piece));
     } else {
-      uint8_t piece = board[yy][yx] & PIECE_MASK;
-      DrawMap(BOARD_START_X + yx * BOARD_H_SPACING, BOARD_START_Y + yy * BOARD_V_SPACING, MapName(piece));
+      uint8_t piece = board[evaluation.yy][evaluation.yx] & PIECE_MASK;
+      DrawMap(BOARD_START_X + evaluation.yx * BOARD_H_SPACING, BOARD_START_Y + evaluation.yy * BOARD_V_SPACING, MapName(piece));
     }
   }
 
-  if (gx >= 0 && gy >= 0) {
+  if ((redrawLeds & G_BIT) && evaluation.gx >= 0 && evaluation.gy >= 0) {
     if (ledStates & G_BIT) {
-      uint8_t piece = pruned_board[gy][gx];
-      DrawMap(BOARD_START_X + gx * BOARD_H_SPACING, BOARD_START_Y + gy * BOARD_V_SPACING, LedOnMapName(piece));
+      uint8_t piece = engine.pruned_board[evaluation.gy][evaluation.gx];
+      DrawMap(BOARD_START_X + evaluation.gx * BOARD_H_SPACING, BOARD_START_Y + evaluation.gy * BOARD_V_SPACING, LedOnMapName(piece));
     } else {
-      uint8_t piece = board[gy][gx] & PIECE_MASK;
-      DrawMap(BOARD_START_X + gx * BOARD_H_SPACING, BOARD_START_Y + gy * BOARD_V_SPACING, MapName(piece));
+      uint8_t piece = board[evaluation.gy][evaluation.gx] & PIECE_MASK;
+      DrawMap(BOARD_START_X + evaluation.gx * BOARD_H_SPACING, BOARD_START_Y + evaluation.gy * BOARD_V_SPACING, MapName(piece));
     }
   }
+  PROFILE_END(PROFILE_REDRAWLEDS);
 
 #if defined(OPTION_DEBUG_DISPLAY_PRUNED_BOARD)
   // Display pruned_board
   for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
     for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
-      uint8_t piece = pruned_board[y][x];
+      uint8_t piece = engine.pruned_board[y][x];
       DrawMap(BOARD_START_X + BOARD_WIDTH * BOARD_H_SPACING + x * BOARD_H_SPACING, BOARD_START_Y + y * BOARD_V_SPACING, MapName(piece));
     }
 #endif
 
-  // See if we meet the rules
-  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
-    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
-      pruned_board[y][x] = board[y][x] & PIECE_MASK;
-
-  bool meetsRules = true;
-
-  // The rules can't be met if there is a short circuit
-  if (isShort) {
-    meetsRules = false;
-    goto skip_expensive_rule_checks;
-  }
-
-  // The rules can't be met if you have a piece picked up
-  if (old_piece != -1) {
-    meetsRules = false;
-    goto skip_expensive_rule_checks;
-  }
-
-  // The rules can't be met if you have pieces in your hand
-  for (uint8_t y = 0; y < HAND_HEIGHT; ++y)
-    for (uint8_t x = 0; x < HAND_WIDTH; ++x)
-      if (hand[y][x] != 0) {
-        meetsRules = false;
-        goto skip_expensive_rule_checks;
-      }
-
-  // The rules can't be met if there are invalid "loose ends"
-  if (PruneBoard(PRUNEBOARD_FLAG_MEETS_RULES) == false)
-    meetsRules = false;
-
- skip_expensive_rule_checks:
-
-  if (boardChanged && startAdvancesLevel)
-    CancelStartAdvancesLevel();
-
   // If the goal doesn't match, we haven't met the rules yet
   // When the goal matches and we have met the rules, play the win sound,
   // disable input for a bit (except the start button) and replace the
@@ -4657,24 +1870,24 @@ void BoardChanged(BUTTON_INFO* buttons)
   // Even though a particular configuration doesn't meet the rules, we
   // still want to put a checkbox next to a goal where the LED state
   // matches, even though it's not a win condition
-  goalStates = GoalStatesForCurrentLevel(switch_position);
+  uint8_t goalStates = GoalStatesForCurrentLevel(evaluation.switch_position);
 
 #if defined(OPTION_DEBUG_DISPLAY_GOAL_STATES)
   UZEMC = 'G'; UZEMC = 'S'; UZEMC = ':'; UZEMH = goalStates; UZEMC = '\n';
 #endif
 
   if (CurrentLevelHasSwitch()) {
-    if (boardChanged)
+    if (evaluation.boardChanged)
       for (uint8_t i = 0; i < 3; ++i) // change tiles here to avoid flicker
         SetTile(GOAL_START_X - 2, GOAL_START_Y + GOAL_V_SPACING * i + 1, TILE_FOREGROUND);
 
-    if (switch_position != -1) {
+    if (evaluation.switch_position != -1) {
       if (ledStates == goalStates) {
-        met_goal[switch_position - 1] = true;
-        SetTile(GOAL_START_X - 2, GOAL_START_Y + GOAL_V_SPACING * (switch_position - 1) + 1, TILE_GOAL_MET);
+        met_goal[evaluation.switch_position - 1] = true;
+        SetTile(GOAL_START_X - 2, GOAL_START_Y + GOAL_V_SPACING * (evaluation.switch_position - 1) + 1, TILE_GOAL_MET);
       } else {
-        met_goal[switch_position - 1] = false;
-        SetTile(GOAL_START_X - 2, GOAL_START_Y + GOAL_V_SPACING * (switch_position - 1) + 1, TILE_GOAL_UNMET);
+        met_goal[evaluation.switch_position - 1] = false;
+        SetTile(GOAL_START_X - 2, GOAL_START_Y + GOAL_V_SPACING * (evaluation.switch_position - 1) + 1, TILE_GOAL_UNMET);
       }
     }
   } else {
@@ -4688,14 +1901,14 @@ void BoardChanged(BUTTON_INFO* buttons)
   bool levelComplete = false;
   if (CurrentLevelHasSwitch()) {
     // Ensure all goals have been met along with the rules
-    if (met_goal[0] && met_goal[1] && met_goal[2] && meetsRules) {
+    if (met_goal[0] && met_goal[1] && met_goal[2] && evaluation.meetsRules) {
       SetTile(GOAL_START_X - 2, meetsRulesY, TILE_GOAL_MET);
       levelComplete = true;
     } else {
       SetTile(GOAL_START_X - 2, meetsRulesY, TILE_GOAL_UNMET);
     }
   } else {
-    if ((ledStates == goalStates) && meetsRules) {
+    if ((ledStates == goalStates) && evaluation.meetsRules) {
       SetTile(GOAL_START_X - 2, meetsRulesY, TILE_GOAL_MET);
       levelComplete = true;
     } else {
@@ -4703,10 +1916,7 @@ void BoardChanged(BUTTON_INFO* buttons)
     }
   }
 
-  if (boardChanged)
-    boardChanged = false;
-  if (switchChanged)
-    switchChanged = false;
+  evaluation.boardChanged = false;
 
   if (levelComplete) {
     if (!startAdvancesLevel) {
@@ -4808,6 +2018,7 @@ void BoardChanged(BUTTON_INFO* buttons)
     startAdvancesLevel = true;
   }
 
+  PROFILE_END(PROFILE_BOARDCHANGED);
 }
 
 #define T_(x) ((x) - 'A')
@@ -4929,6 +2140,10 @@ int main()
   ClearVram();
   SetTileTable(titlescreen);
 
+#if defined(OPTION_PROFILE)
+  Profile_Init();
+#endif
+
   BUTTON_INFO buttons;
   memset(&buttons, 0, sizeof(BUTTON_INFO));
   InitMusicPlayer(patches);
@@ -5115,6 +2330,7 @@ int main()
 
   for (;;) {
     WaitVsync(1);
+    PROFILE_FRAME_END();
 
     // Read the current state of the player's controller
     buttons.prev = buttons.held;
@@ -5122,6 +2338,9 @@ int main()
     buttons.pressed = buttons.held & (buttons.held ^ buttons.prev);
     buttons.released = buttons.prev & (buttons.held ^ buttons.prev);
 
+    // Draw the result of the evaluation that BoardChanged started, if it's done
+    BoardChanged_Commit(&buttons);
+
     // Allow song to be paused/unpaused without going to the popup menu
     if (buttons.pressed & BTN_SELECT) {
       if (IsSongPlaying())
@@ -5463,14 +2682,15 @@ int main()
     // ----------------------------------------
 
     // If the current level includes a switch, and the board change wasn't due to just the switch position changing
-    // we should clear all of "met goals" for the switch, and let BoardChanged fill it back in for
+    // we should clear all of "met goals" for the switch, and let BoardChanged_Commit fill it back in for
     // the current switch position, because the board change may have invalidated previously met goals
     if (boardChanged && CurrentLevelHasSwitch())
       for (uint8_t i = 0; i < 3; ++i)
         met_goal[i] = false;
 
     if (boardChanged || switchChanged)
-      BoardChanged(&buttons);
+      BoardChanged();
+    BoardChanged_Run();
 
     // -------------------- PROCESS POPUP MENU --------------------
     // If we pressed the START button with no other buttons held down
@@ -0,0 +1,904 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+
+/* Measures how hard each level in levelData is, since GetLevelColor
+   only goes by the level number. For each level:
+
+     - The solutions, and the nodes the search in solver/ takes to
+       find all of them (with every reduction and forward checking).
+     - The raw search tree: every placement of the hand and rotation
+       of the pieces that rotate in place, only cut off where a square
+       can no longer meet the rules, which is closer to what a player
+       has to go through. Its branching factor is how many ways on
+       average each square it decides can go.
+     - A Monte Carlo run of random finished boards: every piece in the
+       hand on a random blank square, and everything in a random
+       rotation. Each board either solves the level, meets the goal
+       but not the rules (a loose end or a short), meets the rules but
+       not the goal, or neither. The two in the middle are the near
+       misses, which are what make a level feel close but not there.
+
+   The score is how many tries each solution takes, searching through
+   the raw tree and guessing at random, multiplied together (and shown
+   as a log10). The report ranks the levels by score, and suggests an
+   order for them along with the color each one would get. The
+   searches run one level per thread, and the random boards are split
+   across every thread and run through Engine_EvaluateBatch.
+
+   Example:
+     circuit/difficulty$ ./main              (all levels)
+     circuit/difficulty$ ./main 12 33        (just levels 12 and 33)
+     circuit/difficulty$ ./main -m 10000000  (10 million random boards per level)
+     circuit/difficulty$ ./main -t 4 -s 7    (on 4 threads, starting from seed 7) */
+
+#include "../data/levels.inc"
+
+// The level layout, as in circuit.c
+#define GOAL_WIDTH 4
+#define GOAL_HEIGHT 3
+#define HAND_WIDTH 5
+#define HAND_HEIGHT 2
+#define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
+#define LEVELS (sizeof(levelData) / LEVEL_SIZE)
+#define BOARD_OFFSET_IN_LEVEL 0
+#define GOAL_OFFSET_IN_LEVEL (BOARD_WIDTH * BOARD_HEIGHT)
+#define HAND_OFFSET_IN_LEVEL (GOAL_OFFSET_IN_LEVEL + (GOAL_WIDTH * GOAL_HEIGHT))
+#define LEVELS_PER_COLOR 15 // see GetLevelColor in circuit.c
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define MAX_TOKENS (HAND_WIDTH * HAND_HEIGHT)
+#define MAX_THREADS 256
+#define DEFAULT_SAMPLES 1000000
+#define SAMPLE_BATCH 256 // random boards per Engine_EvaluateBatch call, times 3 with a switch
+
+#define CELL_FIXED  0 // locked in place
+#define CELL_ROTATE 1 // can be rotated in place
+#define CELL_OPEN   2 // blank, so a piece from the hand may go here
+
+#define NO_TOKEN 0xFF
+
+#define SEARCH_REDUCE    1 // skip placements that are equivalent to ones already tried
+#define SEARCH_PROPAGATE 2 // give up on partial boards the rest of the hand can't complete
+
+#define ROLE_VCC 8 // along with R_BIT, Y_BIT, and G_BIT for the LEDs
+
+// A level, decoded for the search
+struct LEVEL;
+typedef struct LEVEL LEVEL;
+
+struct LEVEL {
+  uint8_t flags;             // SEARCH_*
+  uint8_t board[CELLS];      // the pieces that start on the board, P_BLANK where the hand can go
+  uint8_t kind[CELLS];       // CELL_*
+  uint8_t rotations[CELLS][4]; // the rotations a CELL_ROTATE square can have
+  uint8_t rotationWeight[CELLS][4]; // how many rotations each one stands for
+  uint8_t count[CELLS];
+  uint8_t rotatePorts[CELLS]; // every side any of those rotations has a port on
+  uint8_t order[CELLS];      // the squares the search decides, in the order it decides them
+  uint8_t orderCount;
+  uint8_t openAfter[CELLS + 1]; // how many CELL_OPEN squares there are in order[i..]
+  uint8_t tokenRotations[MAX_TOKENS][4]; // the rotations of each piece in the hand
+  uint8_t tokenWeight[MAX_TOKENS][4];
+  uint8_t tokenCount[MAX_TOKENS];
+  uint8_t tokenPorts[MAX_TOKENS];
+  uint8_t tokenRoles[MAX_TOKENS]; // ROLE_VCC, or the color of an LED
+  uint8_t tokenSame[MAX_TOKENS]; // an identical piece earlier in the hand, which has to be placed first, or NO_TOKEN
+  uint8_t tokens;
+  uint32_t weight;           // how many boards each one the search finds stands for, on top of TASK.weight
+  bool hasSwitch;
+  uint8_t goalStates[3];     // for each switch position, or just [0] without a switch
+  uint8_t goalLeds;          // the LEDs that are lit in any of them
+};
+
+struct TASK;
+typedef struct TASK TASK;
+
+// A partly filled in board
+struct TASK {
+  uint8_t board[CELLS];
+  uint32_t decided; // bit i is set once board[i] can't change anymore
+  uint16_t used;    // bit i is set once tokens[i] has been placed
+  uint8_t depth;    // index into order[] of the next square to decide
+  uint32_t weight;  // how many boards this one stands for, from the rotations skipped so far
+};
+
+struct SPARE;
+typedef struct SPARE SPARE;
+
+struct SPARE {
+  uint8_t ports; // the sides any rotation of any piece left in the hand has a port on
+  uint8_t roles; // ROLE_* of the pieces left in the hand
+  uint8_t remaining; // how many pieces are left in the hand
+  bool blankAllowed; // there are more undecided blank squares than pieces left in the hand
+};
+
+
+struct SEARCH;
+typedef struct SEARCH SEARCH;
+
+struct SEARCH {
+  const LEVEL* level;
+  ENGINE* engine;
+  uint64_t nodes;     // pieces (or blanks) tried on a square
+  uint64_t expanded;  // partial boards that had their next square tried
+  uint64_t solutions; // boards found
+  uint64_t weighted;  // boards found, counting the boards each one stands for
+};
+
+struct METRICS;
+typedef struct METRICS METRICS;
+
+struct METRICS {
+  uint8_t number;
+  uint8_t decisions;    // squares the search decides
+  uint64_t solutions;   // up to symmetry
+  uint64_t weighted;    // counting every board
+  uint64_t nodes;       // with every reduction and forward checking
+  uint64_t rawNodes;    // with just the per-square checks
+  uint64_t rawExpanded;
+  uint64_t samples;     // random boards
+  uint64_t successes;
+  uint64_t goalOnly;    // met the goal, but not the rules
+  uint64_t rulesOnly;   // met the rules, but not the goal
+  double score;
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  uint64_t seed;
+  ENGINE engine;
+  uint64_t samples; // random boards left to try for the current level
+  uint64_t successes;
+  uint64_t goalOnly;
+  uint64_t rulesOnly;
+};
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+
+static METRICS metrics[LEVELS];
+static uint8_t levelCount;
+static uint8_t nextLevel; // the next one a thread takes to search
+static const uint8_t* sampleLevel; // the level the random boards are for
+
+static bool IsSwitch(uint8_t piece)
+{
+  return (piece >= P_SW1_BL && piece <= P_SW1_RB) || (piece >= P_SW2_BT && piece <= P_SW2_RL) || (piece >= P_SW3_BR && piece <= P_SW3_RT);
+}
+
+static uint8_t Role(uint8_t piece)
+{
+  if (piece >= P_VCC_T && piece <= P_VCC_L)
+    return ROLE_VCC;
+  if (piece >= P_RLED_AB_CR && piece <= P_RLED_AR_CT)
+    return R_BIT;
+  if (piece >= P_YLED_AL_CR && piece <= P_YLED_AB_CT)
+    return Y_BIT;
+  if (piece >= P_GLED_AB_CL && piece <= P_GLED_AR_CB)
+    return G_BIT;
+  return 0;
+}
+
+// The rotations a piece can be turned into, as a run of 'count' pieces starting at 'first'. The
+// *_U pieces stand for their whole group, and switches always use the SW1 position here.
+static uint8_t Rotations(uint8_t piece, uint8_t* first)
+{
+  switch (piece) {
+  case P_VCC_U:        piece = P_VCC_T; break;
+  case P_GND_U:        piece = P_GND_LTR; break;
+  case P_SW1_U:
+  case P_SW2_U:
+  case P_SW3_U:        piece = P_SW1_BL; break;
+  case P_RLED_U:       piece = P_RLED_AB_CR; break;
+  case P_YLED_U:       piece = P_YLED_AL_CR; break;
+  case P_GLED_U:       piece = P_GLED_AB_CL; break;
+  case P_STRAIGHT_U:   piece = P_STRAIGHT_LR; break;
+  case P_DBL_CORNER_U: piece = P_DBL_CORNER_TL_BR; break;
+  case P_CORNER_U:     piece = P_CORNER_BL; break;
+  case P_TPIECE_U:     piece = P_TPIECE_RBL; break;
+  case P_BRIDGE_U:     piece = P_BRIDGE1_TB_LR; break;
+  }
+  if (IsSwitch(piece))
+    piece = P_SW1_BL + ((piece - P_SW1_BL) & 3);
+
+  if (piece >= P_VCC_T && piece <= P_GLED_AR_CB) {
+    *first = ((piece - P_VCC_T) & ~3) + P_VCC_T;
+    return 4;
+  }
+  if (piece >= P_CORNER_BL && piece <= P_TPIECE_TRB) {
+    *first = ((piece - P_CORNER_BL) & ~3) + P_CORNER_BL;
+    return 4;
+  }
+  if (piece >= P_STRAIGHT_LR && piece <= P_BRIDGE2_TB_LR && piece != P_BLOCKER) {
+    *first = ((piece - P_STRAIGHT_LR) & ~1) + P_STRAIGHT_LR; // straights, double corners, and bridges come in pairs
+    return 2;
+  }
+  *first = piece;
+  return 1;
+}
+
+// Whether two rotations of the same piece make no difference to the game. A switch
+// has to match in all three positions, since the search only places it in SW1.
+static bool Equivalent(uint8_t a, uint8_t b)
+{
+  for (uint8_t p = 0; p < (IsSwitch(a) ? 3 : 1); ++p)
+    if (Engine_EquivalentPiece(a + p * (P_SW2_BT - P_SW1_BL)) != Engine_EquivalentPiece(b + p * (P_SW2_BT - P_SW1_BL)))
+      return false;
+  return true;
+}
+
+// The rotations of a piece the search tries, and how many rotations each one stands for
+static uint8_t Orientations(uint8_t piece, bool reduce, uint8_t rotations[4], uint8_t weights[4])
+{
+  uint8_t first;
+  uint8_t count = Rotations(piece, &first);
+  uint8_t n = 0;
+  for (uint8_t r = 0; r < count; ++r) {
+    uint8_t j = 0;
+    while (reduce && j < n && !Equivalent(rotations[j], first + r))
+      ++j;
+    if (reduce && j < n) {
+      weights[j]++;
+    } else {
+      rotations[n] = first + r;
+      weights[n++] = 1;
+    }
+  }
+  return n;
+}
+
+static bool DecodeLevel(const uint8_t* data, uint8_t flags, LEVEL* level)
+{
+  bool reduce = (flags & SEARCH_REDUCE);
+  memset(level, 0, sizeof(*level));
+  level->flags = flags;
+  level->weight = 1;
+
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t piece = data[BOARD_OFFSET_IN_LEVEL + i];
+    if (piece == P_BLANK) {
+      level->kind[i] = CELL_OPEN;
+    } else if (piece >= P_VCC_U) {
+      level->kind[i] = CELL_ROTATE;
+      level->count[i] = Orientations(piece, reduce, level->rotations[i], level->rotationWeight[i]);
+      piece = level->rotations[i][0];
+      for (uint8_t r = 0; r < level->count[i]; ++r)
+        level->rotatePorts[i] |= Engine_MeetsRulesPorts(level->rotations[i][r]);
+      if (level->count[i] == 1) {
+        level->kind[i] = CELL_FIXED;
+        level->weight *= level->rotationWeight[i][0];
+      }
+    } else {
+      level->kind[i] = CELL_FIXED;
+    }
+    level->board[i] = piece;
+    if (level->kind[i] != CELL_FIXED)
+      level->order[level->orderCount++] = i;
+  }
+  for (int8_t i = level->orderCount - 1; i >= 0; --i)
+    level->openAfter[i] = level->openAfter[i + 1] + (level->kind[level->order[i]] == CELL_OPEN);
+
+  for (uint8_t i = 0; i < HAND_WIDTH * HAND_HEIGHT; ++i) {
+    uint8_t piece = data[HAND_OFFSET_IN_LEVEL + i];
+    if (piece == P_BLANK)
+      continue;
+    uint8_t t = level->tokens++;
+    level->tokenCount[t] = Orientations(piece, reduce, level->tokenRotations[t], level->tokenWeight[t]);
+    for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+      level->tokenPorts[t] |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+    level->tokenRoles[t] = Role(level->tokenRotations[t][0]);
+
+    // Placing n identical pieces in a fixed order skips the other n! - 1 orders
+    uint8_t same = NO_TOKEN;
+    uint8_t identical = 1;
+    for (uint8_t u = 0; reduce && u < t; ++u)
+      if (level->tokenRotations[u][0] == level->tokenRotations[t][0]) {
+        same = u;
+        identical++;
+      }
+    level->tokenSame[t] = same;
+    level->weight *= identical;
+  }
+
+  // The same goal states GoalStatesForCurrentLevel in circuit.c comes up with
+  level->hasSwitch = (data[GOAL_OFFSET_IN_LEVEL] == P_GOAL_SW1);
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p)
+    for (uint8_t i = 0; i < 3; ++i)
+      switch (data[GOAL_OFFSET_IN_LEVEL + p * GOAL_WIDTH + (level->hasSwitch ? 1 : 0) + i]) {
+      case P_GOAL_RLED_ON:
+        level->goalStates[p] |= R_BIT;
+        break;
+      case P_GOAL_YLED_ON:
+        level->goalStates[p] |= Y_BIT;
+        break;
+      case P_GOAL_GLED_ON:
+        level->goalStates[p] |= G_BIT;
+        break;
+      }
+  level->goalLeds = level->goalStates[0] | level->goalStates[1] | level->goalStates[2];
+
+  return level->tokens <= level->openAfter[0];
+}
+
+// What the pieces left in the hand could still do, for the squares that haven't been decided yet
+static void Spare(const LEVEL* level, const TASK* task, SPARE* spare)
+{
+  uint8_t remaining = 0;
+  spare->ports = 0;
+  spare->roles = 0;
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t))) {
+      spare->ports |= level->tokenPorts[t];
+      spare->roles |= level->tokenRoles[t];
+      remaining++;
+    }
+  spare->remaining = remaining;
+  spare->blankAllowed = (remaining < level->openAfter[task->depth]);
+}
+
+// The square on the given side of square c, or false if that's off the board
+static bool Neighbor(uint8_t c, uint8_t side, uint8_t* n)
+{
+  uint8_t x = c % BOARD_WIDTH;
+  uint8_t y = c / BOARD_WIDTH;
+  switch (side) {
+  case D_OUT_T: *n = c - BOARD_WIDTH; return y > 0;
+  case D_OUT_R: *n = c + 1;           return x < BOARD_WIDTH - 1;
+  case D_OUT_B: *n = c + BOARD_WIDTH; return y < BOARD_HEIGHT - 1;
+  default:      *n = c - 1;           return x > 0;
+  }
+}
+
+static uint8_t Opposite(uint8_t side)
+{
+  return ((side << 2) | (side >> 2)) & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+}
+
+// The sides square c might end up with a port on. Without propagation, a square that hasn't been decided
+// yet is assumed to end up facing every way, otherwise it's whatever could still be put there.
+static uint8_t Ports(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (task->decided & (1UL << c))
+    return Engine_MeetsRulesPorts(task->board[c]);
+  if (!(level->flags & SEARCH_PROPAGATE))
+    return D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L;
+  return (level->kind[c] == CELL_ROTATE) ? level->rotatePorts[c] : spare->ports;
+}
+
+// The sides of square c that have a neighbor that might face back at it
+static uint8_t ValidSides(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (Ports(level, task, n, spare) & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// Whether the piece on square c can still meet the rules (see Engine_PieceMeetsRules)
+static bool Fits(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t piece = task->board[c];
+  if (!Engine_MeetsRulesPorts(piece))
+    return true;
+  return Engine_PieceMeetsRules(piece, ValidSides(level, task, c, spare));
+}
+
+// Deciding square c can only take possibilities away from it and its decided neighbors
+static bool Consistent(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (!Fits(level, task, c, spare))
+    return false;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && !Fits(level, task, n, spare))
+      return false;
+  }
+  return true;
+}
+
+// The sides of square c whose neighbor might face back at it, given what each square might face its neighbors with
+static uint8_t Facing(const uint8_t ports[CELLS], uint8_t c)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (ports[n] & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// The sides that the pieces that could still go on undecided square c, and meet the rules there, have ports on.
+// Returns false if there aren't any, and the square can't be left blank either.
+static bool Narrow(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare, uint8_t ports[CELLS])
+{
+  uint8_t valid = Facing(ports, c);
+  uint8_t narrowed = 0;
+  bool any = false;
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      if (Engine_PieceMeetsRules(level->rotations[c][r], valid)) {
+        narrowed |= Engine_MeetsRulesPorts(level->rotations[c][r]);
+        any = true;
+      }
+  } else {
+    any = spare->blankAllowed;
+    for (uint8_t t = 0; t < level->tokens; ++t)
+      if (!(task->used & (1U << t)))
+        for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+          if (Engine_PieceMeetsRules(level->tokenRotations[t][r], valid)) {
+            narrowed |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+            any = true;
+          }
+  }
+  ports[c] = narrowed;
+  return any;
+}
+
+// Every LED the goal wants lit has to be able to connect to a VCC. Squares are joined wherever they might
+// face each other, so this only gives up once no way of filling in the rest of the board could connect them.
+static bool CanLight(const LEVEL* level, const TASK* task, const SPARE* spare, const uint8_t ports[CELLS])
+{
+  if (!level->goalLeds)
+    return true;
+
+  uint8_t roles[CELLS];
+  uint8_t stack[CELLS];
+  uint8_t top = 0;
+  uint32_t reached = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (task->decided & (1UL << c))
+      roles[c] = Role(task->board[c]);
+    else
+      roles[c] = (level->kind[c] == CELL_ROTATE) ? Role(level->rotations[c][0]) : spare->roles;
+    if (roles[c] & ROLE_VCC) {
+      reached |= (1UL << c);
+      stack[top++] = c;
+    }
+  }
+
+  uint8_t lit = 0;
+  while (top) {
+    uint8_t c = stack[--top];
+    lit |= roles[c];
+    for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+      uint8_t n;
+      if ((ports[c] & side) && Neighbor(c, side, &n) && !(reached & (1UL << n)) && (ports[n] & Opposite(side))) {
+        reached |= (1UL << n);
+        stack[top++] = n;
+      }
+    }
+  }
+  return (lit & level->goalLeds) == level->goalLeds;
+}
+
+// Forward checking: narrows down what every undecided square could still face its neighbors with, until
+// nothing changes, then makes sure every decided square can still meet the rules, that there are enough
+// pieces left in the hand for the blank squares that have to be filled in, and that the goal can still be lit
+static bool Propagate(const LEVEL* level, const TASK* task, const SPARE* spare)
+{
+  uint8_t ports[CELLS];
+  for (uint8_t c = 0; c < CELLS; ++c)
+    ports[c] = Ports(level, task, c, spare);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint8_t c = 0; c < CELLS; ++c)
+      if (!(task->decided & (1UL << c))) {
+        uint8_t before = ports[c];
+        if (!Narrow(level, task, c, spare, ports))
+          return false;
+        changed |= (ports[c] != before);
+      }
+  }
+
+  uint8_t mustFill = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (!(task->decided & (1UL << c))) {
+      if (level->kind[c] != CELL_OPEN)
+        continue;
+      // Left blank, this square would take away a port one of its decided neighbors needs
+      for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+        uint8_t n;
+        if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && (ports[n] & Opposite(side)) &&
+            !Engine_PieceMeetsRules(task->board[n], Facing(ports, n) & ~Opposite(side))) {
+          mustFill++;
+          break;
+        }
+      }
+    } else if (ports[c] && !Engine_PieceMeetsRules(task->board[c], Facing(ports, c))) {
+      return false;
+    }
+  }
+  if (mustFill > spare->remaining)
+    return false;
+
+  return CanLight(level, task, spare, ports);
+}
+
+
+// The LED states a complete board lights up in each switch position (just [0] without a switch), the same way
+// BoardChanged works them out. Returns false if it doesn't meet the rules, or has a short in every position.
+static bool Light(ENGINE* engine, uint8_t board[CELLS], bool hasSwitch, uint8_t states[3])
+{
+  const uint8_t (*rows)[BOARD_WIDTH] = (const uint8_t (*)[BOARD_WIDTH])board;
+  if (!Engine_PruneBoard(engine, rows, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY))
+    return false;
+
+  int8_t sw = -1;
+  if (hasSwitch) {
+    for (uint8_t i = 0; i < CELLS && sw == -1; ++i)
+      if (IsSwitch(board[i]))
+        sw = i;
+    if (sw == -1)
+      return false;
+  }
+
+  uint8_t original = (sw == -1) ? 0 : board[sw];
+  bool anyWithoutShort = false;
+  for (uint8_t p = 0; p < (hasSwitch ? 3 : 1); ++p) {
+    if (sw != -1)
+      board[sw] = P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((original - P_SW1_BL) & 3);
+    Engine_PruneBoard(engine, rows, PRUNEBOARD_FLAG_NORMAL);
+    Engine_UpdateNetlist(engine);
+    anyWithoutShort |= !Engine_IsShort(engine);
+    states[p] = Engine_ConsultOracle(Engine_PackNetlist(engine));
+  }
+  if (sw != -1)
+    board[sw] = original;
+  return anyWithoutShort;
+}
+
+
+static void Evaluate(SEARCH* s, TASK* task)
+{
+  const LEVEL* level = s->level;
+  uint8_t states[3];
+  if (!Light(s->engine, task->board, level->hasSwitch, states))
+    return;
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p)
+    if (states[p] != level->goalStates[p])
+      return;
+  s->solutions++;
+  s->weighted += task->weight;
+}
+
+static void Search(SEARCH* s, TASK* task);
+
+static void Try(SEARCH* s, TASK* task, uint8_t c, uint8_t piece, uint16_t used, uint8_t weight)
+{
+  const LEVEL* level = s->level;
+  s->nodes++;
+
+  uint16_t previouslyUsed = task->used;
+  uint32_t previousWeight = task->weight;
+  task->board[c] = piece;
+  task->decided |= (1UL << c);
+  task->used = used;
+  task->depth++;
+  task->weight *= weight;
+
+  SPARE spare;
+  Spare(level, task, &spare);
+  if (Consistent(level, task, c, &spare) && (!(level->flags & SEARCH_PROPAGATE) || Propagate(level, task, &spare))) {
+    if (task->depth == level->orderCount)
+      Evaluate(s, task);
+    else
+      Search(s, task);
+  }
+
+  task->weight = previousWeight;
+  task->depth--;
+  task->used = previouslyUsed;
+  task->decided &= ~(1UL << c);
+  task->board[c] = P_BLANK;
+}
+
+static void Search(SEARCH* s, TASK* task)
+{
+  const LEVEL* level = s->level;
+  uint8_t c = level->order[task->depth];
+  s->expanded++;
+
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      Try(s, task, c, level->rotations[c][r], task->used, level->rotationWeight[c][r]);
+    return;
+  }
+
+  // Every piece in the hand has to end up on the board, so only leave this square blank if there is room for them after it
+  uint8_t remaining = level->tokens - __builtin_popcount(task->used);
+  if (remaining < level->openAfter[task->depth])
+    Try(s, task, c, P_BLANK, task->used, 1);
+  if (remaining == 0)
+    return;
+
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t)) && (level->tokenSame[t] == NO_TOKEN || (task->used & (1U << level->tokenSame[t]))))
+      for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+        Try(s, task, c, level->tokenRotations[t][r], task->used | (1U << t), level->tokenWeight[t][r]);
+}
+
+static void RunSearch(ENGINE* engine, uint8_t number, uint8_t flags, SEARCH* s, uint8_t* decisions)
+{
+  LEVEL level;
+  bool feasible = DecodeLevel(&levelData[(number - 1) * LEVEL_SIZE], flags, &level);
+  *decisions = level.orderCount;
+
+  TASK root;
+  memcpy(root.board, level.board, CELLS);
+  root.decided = 0;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if (level.kind[i] == CELL_FIXED)
+      root.decided |= (1UL << i);
+  root.used = 0;
+  root.depth = 0;
+  root.weight = 1;
+
+  // A locked piece surrounded by other locked pieces never gets checked by the search
+  SPARE spare;
+  Spare(&level, &root, &spare);
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if ((root.decided & (1UL << i)) && !Fits(&level, &root, i, &spare))
+      feasible = false;
+  if ((flags & SEARCH_PROPAGATE) && !Propagate(&level, &root, &spare))
+    feasible = false;
+
+  memset(s, 0, sizeof(*s));
+  s->level = &level;
+  s->engine = engine;
+  if (feasible) {
+    if (level.orderCount == 0)
+      Evaluate(s, &root);
+    else
+      Search(s, &root);
+  }
+  s->weighted *= level.weight;
+  s->level = NULL;
+}
+
+// Each thread takes the next level that hasn't been searched yet
+static void* SearchLevels(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  for (;;) {
+    uint8_t i = __atomic_fetch_add(&nextLevel, 1, __ATOMIC_RELAXED);
+    if (i >= levelCount)
+      break;
+    METRICS* m = &metrics[i];
+    SEARCH s;
+    RunSearch(&w->engine, m->number, SEARCH_REDUCE | SEARCH_PROPAGATE, &s, &m->decisions);
+    m->solutions = s.solutions;
+    m->nodes = s.nodes;
+    RunSearch(&w->engine, m->number, 0, &s, &m->decisions);
+    m->weighted = s.weighted;
+    m->rawNodes = s.nodes;
+    m->rawExpanded = s.expanded;
+  }
+  return NULL;
+}
+
+// xorshift64, which gets stuck at 0, so every worker starts from somewhere else
+static uint64_t Random(WORKER* w)
+{
+  w->seed ^= w->seed << 13;
+  w->seed ^= w->seed >> 7;
+  w->seed ^= w->seed << 17;
+  return w->seed;
+}
+
+static uint32_t RandomBelow(WORKER* w, uint32_t n)
+{
+  return (uint32_t)((Random(w) >> 32) * n >> 32);
+}
+
+// A random rotation of a piece, switches in the SW1 position
+static uint8_t RandomRotation(WORKER* w, uint8_t piece)
+{
+  uint8_t first;
+  uint8_t count = Rotations(piece, &first);
+  return first + RandomBelow(w, count);
+}
+
+// Every piece in the hand on a random blank square, and every piece that can rotate in a random rotation
+static void RandomBoard(WORKER* w, const uint8_t* data, uint8_t board[CELLS])
+{
+  uint8_t open[CELLS];
+  uint8_t openCount = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    uint8_t piece = pgm_read_byte(&data[BOARD_OFFSET_IN_LEVEL + c]);
+    if (piece == P_BLANK)
+      open[openCount++] = c;
+    board[c] = (piece >= P_VCC_U) ? RandomRotation(w, piece) : piece;
+  }
+  for (uint8_t i = 0; i < MAX_TOKENS && openCount; ++i) {
+    uint8_t piece = pgm_read_byte(&data[HAND_OFFSET_IN_LEVEL + i]);
+    if (piece == P_BLANK)
+      continue;
+    uint8_t k = RandomBelow(w, openCount);
+    board[open[k]] = RandomRotation(w, piece);
+    open[k] = open[--openCount];
+  }
+}
+
+static void* Sample(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  const uint8_t* data = sampleLevel;
+  LEVEL level;
+  DecodeLevel(data, 0, &level);
+  uint8_t positions = level.hasSwitch ? 3 : 1;
+
+  uint8_t boards[SAMPLE_BATCH * 3][BOARD_HEIGHT][BOARD_WIDTH];
+  ENGINE_RESULT results[SAMPLE_BATCH * 3];
+  w->successes = w->goalOnly = w->rulesOnly = 0;
+  while (w->samples) {
+    uint32_t batch = (w->samples < SAMPLE_BATCH) ? w->samples : SAMPLE_BATCH;
+    for (uint32_t b = 0; b < batch; ++b) {
+      uint8_t* board = &boards[b * positions][0][0];
+      RandomBoard(w, data, board);
+      int8_t sw = -1;
+      for (uint8_t i = 0; i < CELLS && level.hasSwitch && sw == -1; ++i)
+        if (IsSwitch(board[i]))
+          sw = i;
+      for (uint8_t p = 1; p < positions; ++p) {
+        memcpy(boards[b * positions + p], board, CELLS);
+        if (sw != -1)
+          boards[b * positions + p][0][sw] = board[sw] + p * (P_SW2_BT - P_SW1_BL);
+      }
+    }
+    Engine_EvaluateBatch((const uint8_t (*)[BOARD_HEIGHT][BOARD_WIDTH])boards, results, batch * positions);
+
+    // The same as Light: the rules are met in a position without a short, and the goal in every position
+    for (uint32_t b = 0; b < batch; ++b) {
+      bool rules = false;
+      bool goal = true;
+      for (uint8_t p = 0; p < positions; ++p) {
+        rules |= results[b * positions + p].meetsRules;
+        goal &= (results[b * positions + p].ledStates == level.goalStates[p]);
+      }
+      if (rules && goal)
+        w->successes++;
+      else if (goal)
+        w->goalOnly++;
+      else if (rules)
+        w->rulesOnly++;
+    }
+    w->samples -= batch;
+  }
+  return NULL;
+}
+
+static void RunThreads(void* (*work)(void*))
+{
+  for (uint32_t t = 0; t < workerCount; ++t)
+    if (pthread_create(&workers[t].thread, NULL, work, &workers[t])) {
+      perror("pthread_create");
+      exit(EXIT_FAILURE);
+    }
+  for (uint32_t t = 0; t < workerCount; ++t)
+    pthread_join(workers[t].thread, NULL);
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* ColorName(uint8_t position)
+{
+  const char* names[] = { "green", "yellow", "blue", "red" };
+  uint8_t bucket = (position - 1) / LEVELS_PER_COLOR;
+  return (bucket < 4) ? names[bucket] : "none";
+}
+
+static int CompareScore(const void* a, const void* b)
+{
+  double x = ((const METRICS*)a)->score;
+  double y = ((const METRICS*)b)->score;
+  if (x != y)
+    return (x > y) - (x < y);
+  return ((const METRICS*)a)->number - ((const METRICS*)b)->number;
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t samples = DEFAULT_SAMPLES;
+  uint64_t seed = 1;
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t"))
+      cpus = atol(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-m"))
+      samples = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-s"))
+      seed = strtoull(argv[2], NULL, 0);
+    else
+      break;
+    argc -= 2;
+    argv += 2;
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  for (uint32_t t = 0; t < workerCount; ++t)
+    workers[t].seed = (seed + t) * 0x9E3779B97F4A7C15ULL; // xorshift gets stuck at 0
+
+  for (int i = 1; i < argc; ++i) {
+    int number = atoi(argv[i]);
+    if (number < 1 || number > (int)LEVELS) {
+      fprintf(stderr, "Levels go from 1 to %zu\n", LEVELS);
+      return EXIT_FAILURE;
+    }
+    metrics[levelCount++].number = number;
+  }
+  if (levelCount == 0)
+    for (uint8_t i = 1; i <= LEVELS; ++i)
+      metrics[levelCount++].number = i;
+
+  double start = Now();
+  RunThreads(SearchLevels);
+  double searched = Now();
+
+  for (uint8_t i = 0; i < levelCount; ++i) {
+    METRICS* m = &metrics[i];
+    sampleLevel = &levelData[(m->number - 1) * LEVEL_SIZE];
+    for (uint32_t t = 0; t < workerCount; ++t)
+      workers[t].samples = samples / workerCount + (t < samples % workerCount);
+    RunThreads(Sample);
+    m->samples = samples;
+    for (uint32_t t = 0; t < workerCount; ++t) {
+      m->successes += workers[t].successes;
+      m->goalOnly += workers[t].goalOnly;
+      m->rulesOnly += workers[t].rulesOnly;
+    }
+
+    // Tries per solution: through the raw search tree, and at random (with a little smoothing, for the levels
+    // where no random board ever worked)
+    double searchTries = (double)(m->rawNodes + 1) / (m->weighted + 1);
+    double randomTries = (double)(m->samples + 2) / (m->successes + 1);
+    m->score = log10(searchTries) + log10(randomTries);
+  }
+  double elapsed = Now() - start;
+
+  qsort(metrics, levelCount, sizeof(METRICS), CompareScore);
+  printf("Rank Level Color   Solutions      Nodes   Raw nodes Branching   Success Goal only Rules only  Score  Suggested\n");
+  uint8_t moved = 0;
+  for (uint8_t i = 0; i < levelCount; ++i) {
+    const METRICS* m = &metrics[i];
+    const char* now = ColorName(m->number);
+    const char* suggested = ColorName(i + 1);
+    moved += (now != suggested);
+    printf("%4u   %02u  %-6s %10lu %10lu %11lu %9.2f %9.2e %9.2e %9.2e %6.2f  %s\n", i + 1, m->number, now, m->weighted,
+           m->nodes, m->rawNodes, m->rawExpanded ? (double)m->rawNodes / m->rawExpanded : 0.0,
+           (double)m->successes / m->samples, (double)m->goalOnly / m->samples, (double)m->rulesOnly / m->samples,
+           m->score, suggested);
+  }
+
+  printf("\nSuggested order:");
+  for (uint8_t i = 0; i < levelCount; ++i)
+    printf(" %u", metrics[i].number);
+  printf("\n%u of %u levels would change color\n", moved, levelCount);
+
+  uint64_t total = samples * levelCount;
+  fprintf(stderr, "\nSearched in %.2f s, then %lu random boards in %.2f s (%.2f M boards/s) on %u threads\n",
+          searched - start, total, elapsed - (searched - start), total / (elapsed - (searched - start)) / 1e6, workerCount);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,1018 @@
+/*
+
+  engine.c
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pgmspace.h"
+#include "engine.h"
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+// The kind of pruning each piece gets, stored in the high nibble of pruneInfo[]
+#define PRUNE_KIND_MASK   0xF0
+#define PRUNE_PORTS_MASK  0x0F // D_OUT_* bits for the sides that have a port
+#define PRUNE_VALID_PORTS 0x00 // needs at least 2 valid ports, degenerates down to the valid ones (LED, straight, corner, T-piece)
+#define PRUNE_ANY_PORT    0x10 // needs at least 1 valid port, and then keeps all of them (VCC, GND)
+#define PRUNE_SWITCH      0x20 // like PRUNE_VALID_PORTS, but for the "meets rules" check it has ports on all 4 sides and needs 2
+#define PRUNE_PAIR_TL_BR  0x30 // each pair of ports needs both to be valid, the other pair is independent (double corner)
+#define PRUNE_PAIR_TR_BL  0x40 // (double corner)
+#define PRUNE_PAIR_TB_LR  0x50 // (bridge)
+
+// What is on the other side of each port, stored in pieceTransitions[piece][D_T..D_L]
+#define TRANSITION_HALT   0x00 // no port on this side
+#define TRANSITION_NODE   0x80 // a terminal, with its NL_* in the low bits
+#define TRANSITION_EXIT   0x40 // a wire, with the D_OUT_* bits of the other ports it leads to
+#define TRANSITION_NL_MASK 0x07
+
+// pruneInfo[], degeneratePiece[], and pieceTransitions[] are generated from the piece definitions
+#include "../piecegen/piece_tables.inc"
+
+// Bitboards have one bit per square of the board, bit (y * BOARD_WIDTH + x)
+#define BB_COL0 0x00108421UL // x == 0
+#define BB_COL4 0x01084210UL // x == BOARD_WIDTH - 1
+
+#if defined(ENGINE_COUNTERS)
+__thread ENGINE_COUNTS engineCounts;
+#endif
+
+static uint8_t PrunePorts(uint8_t info, uint8_t flags)
+{
+  if ((flags & PRUNEBOARD_FLAG_MEETS_RULES) && (info & PRUNE_KIND_MASK) == PRUNE_SWITCH)
+    return D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L;
+  return info & PRUNE_PORTS_MASK;
+}
+
+// If this function is called with PRUNEBOARD_FLAG_NORMAL, it will prune the board for proper minimal netlist generation. If called
+// with PRUNEBOARD_FLAG_MEETS_RULES, then a switch in any position will not cause a piece properly connected to it to be pruned,
+// which is used during the "meets rules" check to make sure that there aren't any loose ends that don't belong on the board.
+// With PRUNEBOARD_FLAG_CHECK_ONLY it stops as soon as it knows the answer, and leaves pruned_board alone.
+//
+// Rather than sweeping over the board one square at a time, this keeps one bitboard per side (pT, pR, pB, pL) of the ports
+// that are still connected, and updates every square at once. A piece only ever loses ports, and losing a port can only cause
+// its neighbors to lose ports, so this reaches the same steady state as the square-by-square version.
+bool Engine_PruneBoard(ENGINE* engine, const uint8_t board[BOARD_HEIGHT][BOARD_WIDTH], uint8_t flags)
+{
+  uint32_t pT = 0, pR = 0, pB = 0, pL = 0;
+  uint32_t anyPort = 0;  // pieces that stay whole while at least 1 port is valid
+  uint32_t twoPorts = 0; // pieces that stay whole while at least 2 ports are valid
+  uint32_t pairTL = 0, pairTR = 0, pairTB = 0;
+  ENGINE_COUNT(pruneCalls, 1);
+
+  // Walk the board backwards so each square can be shifted in at bit 0
+  for (int8_t y = BOARD_HEIGHT - 1; y >= 0; --y)
+    for (int8_t x = BOARD_WIDTH - 1; x >= 0; --x) {
+      ENGINE_COUNT(pruneSquares, 1);
+      ENGINE_COUNT(tableReads, 1);
+      uint8_t info = pgm_read_byte(&pruneInfo[board[y][x] & PIECE_MASK]);
+      uint8_t kind = info & PRUNE_KIND_MASK;
+      uint8_t ports = PrunePorts(info, flags);
+      pT = (pT << 1) | ((ports & D_OUT_T) != 0);
+      pR = (pR << 1) | ((ports & D_OUT_R) != 0);
+      pB = (pB << 1) | ((ports & D_OUT_B) != 0);
+      pL = (pL << 1) | ((ports & D_OUT_L) != 0);
+      anyPort = (anyPort << 1) | (kind == PRUNE_ANY_PORT);
+      twoPorts = (twoPorts << 1) | (kind == PRUNE_SWITCH && (flags & PRUNEBOARD_FLAG_MEETS_RULES));
+      pairTL = (pairTL << 1) | (kind == PRUNE_PAIR_TL_BR);
+      pairTR = (pairTR << 1) | (kind == PRUNE_PAIR_TR_BL);
+      pairTB = (pairTB << 1) | (kind == PRUNE_PAIR_TB_LR);
+    }
+  uint32_t validPorts = ~(anyPort | twoPorts | pairTL | pairTR | pairTB);
+  uint32_t oT = pT, oR = pR, oB = pB, oL = pL;
+
+  // Keep looping until we reach a steady state where no pieces were removed or degenerated
+  bool meetsRules = true;
+  for (;;) {
+    ENGINE_COUNT(pruneIterations, 1);
+    // A port is valid if the neighbor on that side has a port facing back at it
+    uint32_t vT = pT & (pB << BOARD_WIDTH);
+    uint32_t vR = pR & (pL >> 1) & ~BB_COL4;
+    uint32_t vB = pB & (pT >> BOARD_WIDTH);
+    uint32_t vL = pL & (pR << 1) & ~BB_COL0;
+
+    uint32_t atLeast1 = vT | vR | vB | vL;
+    uint32_t atLeast2 = (vT & (vR | vB | vL)) | (vR & (vB | vL)) | (vB & vL);
+
+    uint32_t keepAll = (anyPort & atLeast1) | (twoPorts & atLeast2);
+    uint32_t keepValid = validPorts & atLeast2;
+
+    uint32_t nT = (pT & keepAll) | (vT & (keepValid | (pairTL & vL) | (pairTR & vR) | (pairTB & vB)));
+    uint32_t nR = (pR & keepAll) | (vR & (keepValid | (pairTL & vB) | (pairTR & vT) | (pairTB & vL)));
+    uint32_t nB = (pB & keepAll) | (vB & (keepValid | (pairTL & vR) | (pairTR & vL) | (pairTB & vT)));
+    uint32_t nL = (pL & keepAll) | (vL & (keepValid | (pairTL & vT) | (pairTR & vB) | (pairTB & vR)));
+
+    if (nT == pT && nR == pR && nB == pB && nL == pL)
+      break;
+
+    meetsRules = false;
+    if (flags & PRUNEBOARD_FLAG_CHECK_ONLY)
+      return meetsRules;
+    pT = nT;
+    pR = nR;
+    pB = nB;
+    pL = nL;
+  }
+
+  if (flags & PRUNEBOARD_FLAG_CHECK_ONLY)
+    return meetsRules;
+
+  // Copy the surviving pieces into pruned_board, which is what the netlist generator will run from
+  uint32_t changed = (pT ^ oT) | (pR ^ oR) | (pB ^ oB) | (pL ^ oL);
+  uint32_t square = 1;
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      ENGINE_COUNT(pruneCopies, 1);
+      uint8_t piece = board[y][x] & PIECE_MASK;
+      if (changed & 1) {
+        ENGINE_COUNT(pruneDegenerated, 1);
+        ENGINE_COUNT(tableReads, 1);
+        // Pieces that lost some of their ports degenerate, and pieces with no ports left become blank
+        uint8_t ports = 0;
+        if (pT & 1)
+          ports |= D_OUT_T;
+        if (pR & 1)
+          ports |= D_OUT_R;
+        if (pB & 1)
+          ports |= D_OUT_B;
+        if (pL & 1)
+          ports |= D_OUT_L;
+        piece = pgm_read_byte(&degeneratePiece[ports]);
+      } else if (piece == P_BLOCKER) {
+        piece = P_BLANK;
+      }
+      if (engine->pruned_board[y][x] != piece) {
+        engine->pruned_board[y][x] = piece;
+        engine->pruned_changed |= square; // for Engine_UpdateNetlist
+      }
+      square <<= 1;
+      changed >>= 1;
+      pT >>= 1;
+      pR >>= 1;
+      pB >>= 1;
+      pL >>= 1;
+    }
+
+  return meetsRules;
+}
+
+// The sides a piece has ports on, as the "meets rules" check sees them (a switch has ports on all 4)
+uint8_t Engine_MeetsRulesPorts(uint8_t piece)
+{
+  return PrunePorts(pgm_read_byte(&pruneInfo[piece & PIECE_MASK]), PRUNEBOARD_FLAG_MEETS_RULES);
+}
+
+// The lowest numbered piece that prunes and conducts exactly like 'piece' does, for tools that want to skip
+// boards that only differ in how they look (the two bridges only differ in which wire is drawn on top)
+uint8_t Engine_EquivalentPiece(uint8_t piece)
+{
+  piece &= PIECE_MASK;
+  for (uint8_t p = 0; p < piece; ++p) {
+    if (pgm_read_byte(&pruneInfo[p]) != pgm_read_byte(&pruneInfo[piece]))
+      continue;
+    uint8_t d = 0;
+    while (d < 4 && pgm_read_byte(&pieceTransitions[p][d]) == pgm_read_byte(&pieceTransitions[piece][d]))
+      ++d;
+    if (d == 4)
+      return p;
+  }
+  return piece;
+}
+
+// Whether a single piece would survive the "meets rules" pruning untouched, when only the sides in
+// 'valid' have a neighbor with a port facing back at it. This is the per-square rule that
+// Engine_PruneBoard applies to the whole board at once, for tools that build boards up one square at a time.
+bool Engine_PieceMeetsRules(uint8_t piece, uint8_t valid)
+{
+  uint8_t info = pgm_read_byte(&pruneInfo[piece & PIECE_MASK]);
+  uint8_t ports = PrunePorts(info, PRUNEBOARD_FLAG_MEETS_RULES);
+  valid &= ports;
+  switch (info & PRUNE_KIND_MASK) {
+  case PRUNE_ANY_PORT:
+    return valid != 0;
+  case PRUNE_SWITCH:
+    return (valid & (valid - 1)) != 0; // at least 2
+  default:
+    return valid == ports;
+  }
+}
+
+// Whether a single piece would keep any of its ports through Engine_PruneBoard with PRUNEBOARD_FLAG_NORMAL,
+// when only the sides in 'valid' might have a neighbor with a port facing back at it. If it wouldn't, the
+// piece ends up blank no matter what, so the netlist is the same as if it had never been placed.
+bool Engine_PieceSurvivesPruning(uint8_t piece, uint8_t valid)
+{
+  uint8_t info = pgm_read_byte(&pruneInfo[piece & PIECE_MASK]);
+  valid &= PrunePorts(info, PRUNEBOARD_FLAG_NORMAL);
+  switch (info & PRUNE_KIND_MASK) {
+  case PRUNE_ANY_PORT:
+    return valid != 0;
+  case PRUNE_PAIR_TL_BR:
+    return (valid & (D_OUT_T | D_OUT_L)) == (D_OUT_T | D_OUT_L) || (valid & (D_OUT_B | D_OUT_R)) == (D_OUT_B | D_OUT_R);
+  case PRUNE_PAIR_TR_BL:
+    return (valid & (D_OUT_T | D_OUT_R)) == (D_OUT_T | D_OUT_R) || (valid & (D_OUT_B | D_OUT_L)) == (D_OUT_B | D_OUT_L);
+  case PRUNE_PAIR_TB_LR:
+    return (valid & (D_OUT_T | D_OUT_B)) == (D_OUT_T | D_OUT_B) || (valid & (D_OUT_L | D_OUT_R)) == (D_OUT_L | D_OUT_R);
+  default:
+    return (valid & (valid - 1)) != 0; // at least 2
+  }
+}
+
+// The netlist is built from the edges between the squares of the board. Every edge (including the ones
+// along the outside of the board) is a node, and each side of a node faces a square (or the outside of the
+// board), which makes it the end of a wire unless the square carries the wire straight on to another node.
+// One union-find pass over the pieces joins the nodes each wire goes through, and then every wire has
+// exactly 2 ends: a VCC, GND, or LED terminal (NL_VV, NL_00, NL_RA, etc...), a T-piece, or nothing at all.
+//
+// The game has always lit its LEDs by where the electrons of the original circuit.c (see reference.c) ended
+// up, and decide() only sent them both ways out of the first two T-pieces they met. After that, an electron
+// always takes the first way out clockwise, so where it ends up from each T-piece it comes into is worked out
+// once and kept, and an electron goes straight there. It never walks a wire square by square, and one that
+// would have gone around in circles until its 255 steps ran out is found without taking any of them.
+#define NODE_L(x, y) ((y) * (BOARD_WIDTH + 1) + (x))
+#define NODE_R(x, y) (NODE_L(x, y) + 1)
+#define NODE_T(x, y) ((BOARD_WIDTH + 1) * BOARD_HEIGHT + (y) * BOARD_WIDTH + (x))
+#define NODE_B(x, y) (NODE_T(x, y) + BOARD_WIDTH)
+#define NODE_COUNT ((BOARD_WIDTH + 1) * BOARD_HEIGHT + (BOARD_HEIGHT + 1) * BOARD_WIDTH)
+
+// The end of a wire at node n that faces the square on side k of it (0 for the square to the left of or above
+// the node, and 1 for the one to the right of or below it)
+#define END(n, k) ((uint8_t)((n) * 2 + (k)))
+#define END_COUNT (NODE_COUNT * 2)
+#define END_NONE 0xFF
+
+// What an electron finds at the end of a wire, other than an NL_* node
+#define REACH_NOTHING 0x08 // no port, or the edge of the board, so it stops where it started
+#define REACH_BRANCH  0x10 // a T-piece
+#define REACH_UNKNOWN 0xFE
+#define REACH_PENDING 0xFF
+
+// The bits of a packed netlist that each NL_* node is part of
+const uint32_t netlistNodeMasks[NL_COUNT] PROGMEM =
+  {
+   NETLIST_NODE_MASK(NL_VV),
+   NETLIST_NODE_MASK(NL_00),
+   NETLIST_NODE_MASK(NL_RA),
+   NETLIST_NODE_MASK(NL_RC),
+   NETLIST_NODE_MASK(NL_YA),
+   NETLIST_NODE_MASK(NL_YC),
+   NETLIST_NODE_MASK(NL_GA),
+   NETLIST_NODE_MASK(NL_GC),
+  };
+
+struct NODES;
+typedef struct NODES NODES;
+
+struct NODES {
+  uint8_t parent[NODE_COUNT];   // or NODE_ROOT plus the rank of the group, for the root of a group
+  uint8_t ends[NODE_COUNT][2];  // the END() of both ends of each wire (only valid for the root of a group)
+  uint8_t reached[END_COUNT];   // REACH_*, or the NL_* node an electron that always takes the first way out gets to
+} __attribute__ ((packed));
+
+// Joining the group of the lower rank under the other one keeps every path from a node to its root shorter than
+// the rank of the root, and a group of rank r has at least 2^r nodes, so no FindNode takes more than 5 steps
+#define NODE_ROOT 0x80
+#define NODE_MAX_RANK 5
+
+static uint8_t FindNode(NODES* nodes, uint8_t n)
+{
+  uint8_t p;
+  while (!((p = nodes->parent[n]) & NODE_ROOT)) {
+    ENGINE_COUNT(netlistFindSteps, 1);
+    uint8_t g = nodes->parent[p];
+    if (g & NODE_ROOT)
+      return p;
+    nodes->parent[n] = g; // path halving keeps the groups shallow
+    n = g;
+  }
+  return n;
+}
+
+static void JoinNodes(NODES* nodes, uint8_t a, uint8_t b)
+{
+  ENGINE_COUNT(netlistJoins, 1);
+  a = FindNode(nodes, a);
+  b = FindNode(nodes, b);
+  if (a == b)
+    return;
+  if (nodes->parent[a] < nodes->parent[b]) {
+    uint8_t t = a;
+    a = b;
+    b = t;
+  }
+  if (nodes->parent[a] == nodes->parent[b])
+    ++nodes->parent[a];
+  nodes->parent[b] = a;
+}
+
+// The node on side d of the square at x, y
+static uint8_t SquareNode(uint8_t x, uint8_t y, uint8_t d)
+{
+  switch (d) {
+  case D_T:
+    return NODE_T(x, y);
+  case D_R:
+    return NODE_R(x, y);
+  case D_B:
+    return NODE_B(x, y);
+  default:
+    return NODE_L(x, y);
+  }
+}
+
+// The square on side k of node n (which can be off the board), and returns the side of it that faces the node
+static uint8_t NodeSquare(uint8_t n, uint8_t k, int8_t* x, int8_t* y)
+{
+  if (n < NODE_T(0, 0)) {
+    *y = n / (BOARD_WIDTH + 1);
+    *x = n % (BOARD_WIDTH + 1) - 1 + k;
+    return k ? D_L : D_R;
+  }
+  *x = (n - NODE_T(0, 0)) % BOARD_WIDTH;
+  *y = (n - NODE_T(0, 0)) / BOARD_WIDTH - 1 + k;
+  return k ? D_T : D_B;
+}
+
+// What is through side k of node n, or TRANSITION_HALT off the edge of the board
+static uint8_t NodeTransition(const ENGINE* engine, uint8_t n, uint8_t k, int8_t* x, int8_t* y, uint8_t* d)
+{
+  *d = NodeSquare(n, k, x, y);
+  if (*x < 0 || *x > BOARD_WIDTH - 1 || *y < 0 || *y > BOARD_HEIGHT - 1)
+    return TRANSITION_HALT;
+  ENGINE_COUNT(tableReads, 1);
+  return pgm_read_byte(&pieceTransitions[engine->pruned_board[*y][*x]][*d]);
+}
+
+// A port that carries a wire straight on to one other port
+static bool IsWire(uint8_t transition)
+{
+  uint8_t exits = transition & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+  return (transition & TRANSITION_EXIT) && !(exits & (exits - 1));
+}
+
+// The next way out of a piece going clockwise from side d
+static uint8_t NextExit(uint8_t d, uint8_t exits)
+{
+  do
+    d = (d + 1) & DIRECTION_MASK;
+  while (!(exits & (1 << d)));
+  return d;
+}
+
+// The packed netlist bit for a pair of different NL_* nodes
+static uint32_t NetlistBit(uint8_t a, uint8_t b)
+{
+  ENGINE_COUNT(tableReads, 2);
+  return pgm_read_dword(&netlistNodeMasks[a]) & pgm_read_dword(&netlistNodeMasks[b]);
+}
+
+// Joins the nodes at either end of every wire square, and finds the 2 ends of each wire
+static void FindWires(const ENGINE* engine, NODES* nodes)
+{
+  ENGINE_COUNT(netlistWires, 1);
+  memset(nodes->parent, NODE_ROOT, sizeof(nodes->parent));
+  memset(nodes->ends, END_NONE, sizeof(nodes->ends));
+  memset(nodes->reached, REACH_UNKNOWN, sizeof(nodes->reached));
+
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = engine->pruned_board[y][x];
+      if (piece == P_BLANK)
+        continue;
+      ENGINE_COUNT(netlistPieces, 1);
+      ENGINE_COUNT(tableReads, 4);
+      // Each wire only needs to be joined once, from the first of its ports
+      for (uint8_t d = D_T; d <= D_L; ++d) {
+        uint8_t transition = pgm_read_byte(&pieceTransitions[piece][d]);
+        uint8_t exits = transition & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+        if (IsWire(transition) && exits > (1 << d))
+          JoinNodes(nodes, SquareNode(x, y, d), SquareNode(x, y, NextExit(d, exits)));
+      }
+    }
+
+  // A wire is a line of nodes, so the 2 sides of them that don't carry it on are its ends (a loop of wire squares
+  // has none, but nothing can get into one either)
+  for (uint8_t n = 0; n < NODE_COUNT; ++n)
+    for (uint8_t k = 0; k < 2; ++k) {
+      int8_t x;
+      int8_t y;
+      uint8_t d;
+      ENGINE_COUNT(netlistEnds, 1);
+      if (IsWire(NodeTransition(engine, n, k, &x, &y, &d)))
+        continue;
+      uint8_t* ends = nodes->ends[FindNode(nodes, n)];
+      ends[ends[0] != END_NONE] = END(n, k);
+    }
+}
+
+// The end an electron gets to going out of the square at x, y through side d, and along the wire on that side
+static uint8_t LeaveSquare(NODES* nodes, uint8_t x, uint8_t y, uint8_t d)
+{
+  uint8_t n = SquareNode(x, y, d);
+  uint8_t* ends = nodes->ends[FindNode(nodes, n)];
+  return ends[ends[0] == END(n, d == D_T || d == D_L)];
+}
+
+// What an electron finds at end e: an NL_* node, REACH_NOTHING, or REACH_BRANCH with the T-piece it comes into
+static uint8_t Reach(const ENGINE* engine, uint8_t e, int8_t* x, int8_t* y, uint8_t* d, uint8_t* exits)
+{
+  ENGINE_COUNT(netlistSteps, 1);
+  uint8_t transition = NodeTransition(engine, e >> 1, e & 1, x, y, d);
+  *exits = transition & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+  if (transition & TRANSITION_NODE)
+    return transition & TRANSITION_NL_MASK;
+  return (transition & TRANSITION_EXIT) ? REACH_BRANCH : REACH_NOTHING;
+}
+
+// Where an electron coming in at end e ends up if it takes the first way out of every T-piece from then on. Each
+// end is only followed once, and everything along the way is kept, so this is bounded by the number of ends no
+// matter how many electrons ask. Going around in circles is the same as stopping, as it was when the ttl ran out.
+static uint8_t FollowFirstExits(const ENGINE* engine, NODES* nodes, uint8_t e)
+{
+  int8_t x;
+  int8_t y;
+  uint8_t d;
+  uint8_t exits;
+  uint8_t f = e;
+  uint8_t reach;
+  while ((reach = Reach(engine, f, &x, &y, &d, &exits)) == REACH_BRANCH) {
+    if (nodes->reached[f] != REACH_UNKNOWN) {
+      reach = (nodes->reached[f] == REACH_PENDING) ? REACH_NOTHING : nodes->reached[f];
+      break;
+    }
+    nodes->reached[f] = REACH_PENDING;
+    f = LeaveSquare(nodes, x, y, NextExit(d, exits));
+  }
+
+  // Everything on the way there ends up there too
+  for (f = e; nodes->reached[f] == REACH_PENDING; ) {
+    nodes->reached[f] = reach;
+    Reach(engine, f, &x, &y, &d, &exits);
+    f = LeaveSquare(nodes, x, y, NextExit(d, exits));
+  }
+  return reach;
+}
+
+#define DECIDE_NOW   0
+#define DECIDE_INIT  1
+#define DECIDE_NEXT  2
+#define DECIDE_QUERY 4
+
+struct DECIDER;
+typedef struct DECIDER DECIDER;
+
+// The statics of decide() in the original circuit.c
+struct DECIDER {
+  uint8_t generation;
+  uint8_t bitmask;
+  bool wasCalled;
+};
+
+// Returns bits of 'generation' in order, so the electrons of each generation take a different set of
+// turns at the T-pieces they meet (see reference.c for how the original was used)
+static uint8_t decide(DECIDER* decider, uint8_t flags)
+{
+  if (!flags) {
+    // decide something
+    uint8_t decision = (decider->generation & decider->bitmask);
+    decider->bitmask <<= 1;
+    decider->wasCalled = true;
+    return decision ? 1 : 0;
+  }
+
+  if (flags & DECIDE_INIT) {
+    decider->generation = 0;
+    decider->bitmask = 1;
+    decider->wasCalled = false;
+    return 0;
+  }
+
+  if (flags & DECIDE_QUERY)
+    return decider->wasCalled;
+
+  if (flags & DECIDE_NEXT) {
+    ++decider->generation;
+    decider->bitmask = 1;
+  }
+
+  return 0;
+}
+
+// Sends one electron in at end e, and returns the NL_* node it ends up at, or nl_src if it stops. At a T-piece,
+// decide() picks between the other two ports going clockwise from the one it came in through: 0 takes the first
+// one, and 1 takes the second one, the same turns SimulateElectron's switch took for each T-piece. Once every
+// decision left in this generation is 0, it goes straight to where FollowFirstExits says, so it only ever takes
+// as many turns itself as 'generation' has bits.
+static uint8_t SimulateElectron(const ENGINE* engine, NODES* nodes, DECIDER* decider, uint8_t nl_src, uint8_t e)
+{
+  for (;;) {
+    int8_t x;
+    int8_t y;
+    uint8_t d;
+    uint8_t exits;
+    uint8_t reach = Reach(engine, e, &x, &y, &d, &exits);
+    if (reach == REACH_BRANCH && !(decider->generation & ~(decider->bitmask - 1))) {
+      decider->wasCalled = true;
+      decider->bitmask = 0; // every decision it would have made from here on
+      reach = FollowFirstExits(engine, nodes, e);
+    }
+    if (reach != REACH_BRANCH)
+      return (reach == REACH_NOTHING) ? nl_src : reach;
+
+    uint8_t out = NextExit(d, exits);
+    if (decide(decider, DECIDE_NOW))
+      out = NextExit(out, exits);
+    e = LeaveSquare(nodes, x, y, out);
+  }
+}
+
+// Sends electrons from the port on side d of the square at x, y, which is nl_src, the same ones SimulateElectrons
+// did, and returns the NL_* nodes they reached (bit n for NL n)
+static uint8_t SimulateElectrons(const ENGINE* engine, NODES* nodes, uint8_t nl_src, uint8_t x, uint8_t y, uint8_t d)
+{
+  DECIDER decider;
+  uint8_t reached = 0;
+  uint8_t e = LeaveSquare(nodes, x, y, d);
+  decide(&decider, DECIDE_INIT);
+  for (uint8_t g = 0; g < 4; ++g) { // send electrons in every possible path
+    for (uint8_t i = 0; i < 2; ++i) { // using the fewest number of electrons
+      ENGINE_COUNT(netlistElectrons, 1);
+      reached |= (uint8_t)(1 << SimulateElectron(engine, nodes, &decider, nl_src, e));
+
+      // If the first electron did not hit a branch (TPIECE), it wouldn't have called the decide
+      // function, and therefore we don't need to send any more electrons from nl_src, because
+      // they will also never branch.
+      if (!decide(&decider, DECIDE_QUERY))
+        return reached;
+    }
+    decide(&decider, DECIDE_NEXT);
+  }
+  return reached;
+}
+
+// The group of nodes the port on side d of the square at x, y is in, found by going through the pieces on either
+// side of each node (T-pieces included), without looking at the rest of the board. Returns the NL_* labels in the
+// group (bit n for NL n), and sets 'squares' to the squares with a port in it, and 'branched' if one of them is a
+// T-piece.
+static uint8_t TraceGroup(const ENGINE* engine, uint8_t x, uint8_t y, uint8_t d, uint32_t* squares, bool* branched)
+{
+  uint8_t stack[NODE_COUNT]; // each node only goes on once
+  uint8_t top = 0;
+  uint64_t seen = (uint64_t)1 << SquareNode(x, y, d);
+  uint8_t labels = 0;
+  *squares = 0;
+  *branched = false;
+
+  stack[top++] = SquareNode(x, y, d);
+  while (top) {
+    uint8_t n = stack[--top];
+    ENGINE_COUNT(netlistTraced, 1);
+    for (uint8_t k = 0; k < 2; ++k) {
+      int8_t sx;
+      int8_t sy;
+      uint8_t sd;
+      uint8_t transition = NodeTransition(engine, n, k, &sx, &sy, &sd);
+      if (transition == TRANSITION_HALT)
+        continue;
+      *squares |= (uint32_t)1 << (sy * BOARD_WIDTH + sx);
+      if (transition & TRANSITION_NODE) {
+        labels |= (uint8_t)(1 << (transition & TRANSITION_NL_MASK));
+        continue;
+      }
+      uint8_t exits = transition & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+      if (exits & (exits - 1))
+        *branched = true;
+      for (uint8_t e = D_T; e <= D_L; ++e) {
+        uint8_t other = SquareNode(sx, sy, e);
+        if ((exits & (1 << e)) && !(seen & ((uint64_t)1 << other))) {
+          seen |= (uint64_t)1 << other;
+          stack[top++] = other;
+        }
+      }
+    }
+  }
+  return labels;
+}
+
+// Adds the pairs of NL_* nodes a source is connected to
+static uint32_t SourceNetlist(const ENGINE_SOURCE* source)
+{
+  uint32_t netlist = 0;
+  ENGINE_COUNT(netlistSources, 1);
+  for (uint8_t nl = 0; nl < NL_COUNT; ++nl)
+    if (nl != source->nl_src && (source->nl_dests & (1 << nl)))
+      netlist |= NetlistBit(source->nl_src, nl);
+  return netlist;
+}
+
+// Rebuilds every source from scratch, with one pass of the union-find over the whole board
+static void RebuildNetlist(ENGINE* engine)
+{
+  ENGINE_COUNT(netlistBuilds, 1);
+
+  NODES nodes;
+  FindWires(engine, &nodes);
+
+  // VCC and the LEDs are the sources (GND never sent any electrons)
+  uint32_t netlist = 0;
+  uint8_t count = 0;
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = engine->pruned_board[y][x];
+      if (piece == P_BLANK)
+        continue;
+      ENGINE_COUNT(tableReads, 4);
+      for (uint8_t d = D_T; d <= D_L; ++d) {
+        uint8_t transition = pgm_read_byte(&pieceTransitions[piece][d]);
+        uint8_t nl_src = transition & TRANSITION_NL_MASK;
+        if (!(transition & TRANSITION_NODE) || nl_src == NL_00)
+          continue;
+        ENGINE_SOURCE source;
+        source.port = (uint8_t)((y * BOARD_WIDTH + x) * 4 + d);
+        source.nl_src = nl_src;
+        source.nl_dests = SimulateElectrons(engine, &nodes, nl_src, x, y, d);
+        source.squares = 0;
+        netlist |= SourceNetlist(&source);
+        if (count < ENGINE_MAX_SOURCES)
+          engine->sources[count] = source;
+        ++count;
+      }
+    }
+  engine->netlist = netlist;
+  engine->retrace = 0;
+
+  if (count > ENGINE_MAX_SOURCES) {
+    // More sources than any level has, so every change rebuilds it from scratch
+    engine->source_count = ENGINE_SOURCES_OVERFLOW;
+    return;
+  }
+  engine->source_count = count;
+  if (!count)
+    return;
+
+  // Every square with a port in the group of a source, going through the T-pieces too, can change what the
+  // source is connected to
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = engine->pruned_board[y][x];
+      if (piece == P_BLANK)
+        continue;
+      ENGINE_COUNT(tableReads, 4);
+      for (uint8_t d = D_T; d <= D_L; ++d) {
+        uint8_t exits = pgm_read_byte(&pieceTransitions[piece][d]) & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+        if (exits & (exits - 1))
+          for (uint8_t e = d + 1; e <= D_L; ++e)
+            if (exits & (1 << e))
+              JoinNodes(&nodes, SquareNode(x, y, d), SquareNode(x, y, e));
+      }
+    }
+  uint8_t roots[ENGINE_MAX_SOURCES];
+  for (uint8_t i = 0; i < count; ++i)
+    roots[i] = FindNode(&nodes, SquareNode(engine->sources[i].port / 4 % BOARD_WIDTH, engine->sources[i].port / 4 / BOARD_WIDTH,
+                                           engine->sources[i].port & DIRECTION_MASK));
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = engine->pruned_board[y][x];
+      if (piece == P_BLANK)
+        continue;
+      ENGINE_COUNT(tableReads, 4);
+      for (uint8_t d = D_T; d <= D_L; ++d) {
+        if (pgm_read_byte(&pieceTransitions[piece][d]) == TRANSITION_HALT)
+          continue;
+        uint8_t root = FindNode(&nodes, SquareNode(x, y, d));
+        for (uint8_t i = 0; i < count; ++i)
+          if (roots[i] == root)
+            engine->sources[i].squares |= (uint32_t)1 << (y * BOARD_WIDTH + x);
+      }
+    }
+}
+
+// A source can only be connected to something else if a square with a port in its group changed, so only
+// those sources, and the ones on squares that changed, are traced again. Everything else is kept as it was.
+// With 'oneSquare' set, it stops after the first square it traced a source on, and the rest of the squares
+// stay in 'retrace' for the next call.
+static void RepairNetlist(ENGINE* engine, bool oneSquare)
+{
+  uint8_t count = engine->source_count;
+  if (engine->pruned_changed) {
+    ENGINE_COUNT(netlistRepairs, 1);
+
+    // Both ports of an LED go together, so a square is either kept or traced again as a whole
+    uint32_t retrace = engine->retrace | engine->pruned_changed;
+    for (uint8_t i = 0; i < count; ++i)
+      if (engine->sources[i].squares & engine->pruned_changed)
+        retrace |= (uint32_t)1 << (engine->sources[i].port / 4);
+
+    count = 0;
+    for (uint8_t i = 0; i < engine->source_count; ++i)
+      if (!(retrace & ((uint32_t)1 << (engine->sources[i].port / 4))))
+        engine->sources[count++] = engine->sources[i];
+    engine->retrace = retrace;
+    engine->pruned_changed = 0;
+  }
+
+  // A group without a T-piece is a single wire, and its labels are where the electrons end up. The wires are
+  // only found the first time a group with a T-piece needs electrons.
+  NODES nodes;
+  bool foundWires = false;
+  for (uint8_t i = 0; engine->retrace && i < BOARD_HEIGHT * BOARD_WIDTH; ++i) {
+    if (!(engine->retrace & ((uint32_t)1 << i)))
+      continue;
+    engine->retrace &= ~((uint32_t)1 << i);
+    uint8_t x = i % BOARD_WIDTH;
+    uint8_t y = i / BOARD_WIDTH;
+    uint8_t piece = engine->pruned_board[y][x];
+    uint8_t traced = 0;
+    ENGINE_COUNT(tableReads, 4);
+    for (uint8_t d = D_T; d <= D_L; ++d) {
+      uint8_t transition = pgm_read_byte(&pieceTransitions[piece][d]);
+      uint8_t nl_src = transition & TRANSITION_NL_MASK;
+      if (!(transition & TRANSITION_NODE) || nl_src == NL_00)
+        continue;
+      if (count == ENGINE_MAX_SOURCES) {
+        RebuildNetlist(engine); // more sources than any level has
+        return;
+      }
+      ENGINE_SOURCE* source = &engine->sources[count++];
+      uint32_t squares;
+      bool branched;
+      source->port = (uint8_t)(i * 4 + d);
+      source->nl_src = nl_src;
+      source->nl_dests = TraceGroup(engine, x, y, d, &squares, &branched);
+      source->squares = squares;
+      if (branched) {
+        if (!foundWires)
+          FindWires(engine, &nodes);
+        foundWires = true;
+        source->nl_dests = SimulateElectrons(engine, &nodes, nl_src, x, y, d);
+      }
+      ++traced;
+    }
+    if (oneSquare && traced)
+      break;
+  }
+  engine->source_count = count;
+  if (engine->retrace)
+    return;
+
+  uint32_t netlist = 0;
+  for (uint8_t i = 0; i < count; ++i)
+    netlist |= SourceNetlist(&engine->sources[i]);
+  engine->netlist = netlist;
+}
+
+void Engine_InvalidateNetlist(ENGINE* engine)
+{
+  engine->source_count = ENGINE_SOURCES_INVALID;
+}
+
+void Engine_BuildNetlist(ENGINE* engine)
+{
+  Engine_InvalidateNetlist(engine);
+  Engine_UpdateNetlist(engine);
+}
+
+static void UpdateNetlist(ENGINE* engine, bool oneSquare)
+{
+  if (engine->source_count == ENGINE_SOURCES_INVALID ||
+      (engine->source_count == ENGINE_SOURCES_OVERFLOW && engine->pruned_changed)) {
+    RebuildNetlist(engine);
+    engine->pruned_changed = 0;
+  } else if (engine->pruned_changed || engine->retrace)
+    RepairNetlist(engine, oneSquare);
+}
+
+// Brings the netlist up to date with 'pruned_board', repairing only what the changes since the last time touched
+void Engine_UpdateNetlist(ENGINE* engine)
+{
+  UpdateNetlist(engine, false);
+}
+
+// Does the same as Engine_UpdateNetlist a square of sources at a time, so the game can spread a repair across
+// frames, and returns true once the netlist is up to date. Only a rebuild, which the game never needs on a
+// legal board, is done all at once. A change to pruned_board in between is picked up by the next call.
+bool Engine_UpdateNetlistStep(ENGINE* engine)
+{
+  UpdateNetlist(engine, true);
+  return !engine->retrace;
+}
+
+bool Engine_IsShort(const ENGINE* engine)
+{
+  return engine->netlist & NETLIST_SHORT;
+}
+
+// If we always check for a short, the 28th bit can always be 0, and then we only need to use 27 bits
+uint32_t Engine_PackNetlist(const ENGINE* engine)
+{
+  return Engine_IsShort(engine) ? 0 : engine->netlist;
+}
+
+// The simple paths an electron can take from VCC to GND through the LEDs, as a length in the top 2 bits,
+// followed by 2 bits for each LED along the way (0 = red, 1 = yellow, 2 = green, matching R_BIT, Y_BIT, G_BIT)
+#define LED_PATH(length, first, second, third) (((length) << 6) | ((third) << 4) | ((second) << 2) | (first))
+const uint8_t ledPaths[15] PROGMEM =
+  {
+   LED_PATH(1, 0, 0, 0), LED_PATH(1, 1, 0, 0), LED_PATH(1, 2, 0, 0),
+   LED_PATH(2, 0, 1, 0), LED_PATH(2, 0, 2, 0), LED_PATH(2, 1, 0, 0),
+   LED_PATH(2, 1, 2, 0), LED_PATH(2, 2, 0, 0), LED_PATH(2, 2, 1, 0),
+   LED_PATH(3, 0, 1, 2), LED_PATH(3, 0, 2, 1), LED_PATH(3, 1, 0, 2),
+   LED_PATH(3, 1, 2, 0), LED_PATH(3, 2, 0, 1), LED_PATH(3, 2, 1, 0),
+  };
+
+// Works out the LED states from the rules instead of looking them up: an LED is on if it is forward
+// biased along some simple path from VCC to GND, which leaves LEDs that are bypassed (anode and cathode
+// on the same net), backwards, or hanging off to the side off. A short circuit turns everything off.
+// It always runs the same loops (28 bits, 64 closure steps, 15 paths), so its cycle count is bounded.
+uint8_t Engine_EvaluateLeds(uint32_t nl)
+{
+  // Which nodes each node is wired to, walking the pairs in bit order (see packed_netlist.h)
+  uint8_t net[NL_COUNT];
+  for (uint8_t i = 0; i < NL_COUNT; ++i)
+    net[i] = (uint8_t)(1 << i);
+  for (int8_t lo = NL_GA; lo >= NL_VV; --lo)
+    for (int8_t hi = NL_GC; hi > lo; --hi) {
+      if (nl & 1) {
+        net[lo] |= (uint8_t)(1 << hi);
+        net[hi] |= (uint8_t)(1 << lo);
+      }
+      nl >>= 1;
+    }
+
+  // GND has 3 ports, so a net can span more than one group of pairs
+  for (uint8_t k = 0; k < NL_COUNT; ++k)
+    for (uint8_t i = 0; i < NL_COUNT; ++i)
+      if (net[i] & (1 << k))
+        net[i] |= net[k];
+
+  if (net[NL_VV] & (1 << NL_00))
+    return 0;
+
+  // From here on a net is identified by its mask, so nets are either equal or don't overlap
+  uint8_t anode[3] = { net[NL_RA], net[NL_YA], net[NL_GA] };
+  uint8_t cathode[3] = { net[NL_RC], net[NL_YC], net[NL_GC] };
+
+  uint8_t ledStates = 0;
+  for (uint8_t p = 0; p < NELEMS(ledPaths); ++p) {
+    uint8_t path = pgm_read_byte(&ledPaths[p]);
+    uint8_t at = net[NL_VV];
+    uint8_t visited = at;
+    uint8_t leds = 0;
+    for (uint8_t length = path >> 6; length; --length) {
+      uint8_t led = path & 3;
+      if (anode[led] != at || (cathode[led] & visited)) { // not forward biased, or not a simple path
+        leds = 0;
+        break;
+      }
+      at = cathode[led];
+      visited |= at;
+      leds |= (uint8_t)(1 << led);
+      path >>= 2;
+    }
+    if (at == net[NL_00])
+      ledStates |= leds;
+  }
+  return ledStates;
+}
+
+// The layout of the oracle table, which can be overridden with -DORACLE_LAYOUT=... (the game has always
+// shipped the sorted table, and the others are there to be measured against it)
+#define ORACLE_LAYOUT_BINARY_SEARCH 0 // sorted, ~9 probes
+#define ORACLE_LAYOUT_EYTZINGER     1 // sorted in breadth first order, same probes but cheaper index math
+#define ORACLE_LAYOUT_PERFECT_HASH  2 // 1 probe, plus ORACLE_HASH_BUCKETS bytes of PROGMEM
+#define ORACLE_LAYOUT_ANALYTIC      3 // no table at all, Engine_EvaluateLeds
+#if !defined(ORACLE_LAYOUT)
+#define ORACLE_LAYOUT ORACLE_LAYOUT_BINARY_SEARCH
+#endif
+
+// This data is generated by running the oracle2/main program to take
+// all of the netlist data I gathered manually and permute all of the
+// LED colors to fill out the dataset
+#if ORACLE_LAYOUT == ORACLE_LAYOUT_EYTZINGER
+// circuit/oracle2$ ./main eytzinger > eytzinger_netlists_and_led_states.inc
+#include "../oracle2/eytzinger_netlists_and_led_states.inc"
+
+uint8_t Engine_ConsultOracle(uint32_t nl)
+{
+  // The children of entry k are at 2k+1 (smaller) and 2k+2 (larger)
+  uint16_t k = 0;
+  ENGINE_COUNT(oracleLookups, 1);
+  while (k < NELEMS(eytzinger_netlists_and_led_states)) {
+    ENGINE_COUNT(oracleProbes, 1);
+    ENGINE_COUNT(tableReads, 1);
+    uint32_t netlist_and_led_states = (uint32_t)pgm_read_dword(&eytzinger_netlists_and_led_states[k]);
+    uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
+
+    if (netlist == nl)
+      return (uint8_t)((netlist_and_led_states & NETLIST_LED_STATES_MASK) >> 29);
+    k = 2 * k + 1 + (netlist < nl);
+  }
+  // Not found, so default all LEDs to off
+  return 0;
+}
+
+#elif ORACLE_LAYOUT == ORACLE_LAYOUT_ANALYTIC
+// The LED states for netlists that were never gathered by hand are worked out too (ledcheck/ checks
+// that this agrees with every netlist in the table)
+uint8_t Engine_ConsultOracle(uint32_t nl)
+{
+  ENGINE_COUNT(oracleLookups, 1);
+  ENGINE_COUNT(tableReads, NELEMS(ledPaths));
+  return Engine_EvaluateLeds(nl);
+}
+
+#elif ORACLE_LAYOUT == ORACLE_LAYOUT_PERFECT_HASH
+// circuit/oracle2$ ./main hash > hashed_netlists_and_led_states.inc
+#include "../oracle2/oracle_hash.h"
+#include "../oracle2/hashed_netlists_and_led_states.inc"
+
+uint8_t Engine_ConsultOracle(uint32_t nl)
+{
+  ENGINE_COUNT(oracleLookups, 1);
+  ENGINE_COUNT(oracleProbes, 1);
+  ENGINE_COUNT(tableReads, 2);
+  uint32_t hash = OracleHash(nl, ORACLE_HASH_MUL1);
+  uint8_t displacement = pgm_read_byte(&oracle_hash_displacements[OracleHash_Bucket(hash)]);
+  uint16_t slot = OracleHash_Slot(hash, displacement, ORACLE_HASH_MUL2, NELEMS(hashed_netlists_and_led_states));
+
+  // Every netlist lands in some slot, so it's only a match if the netlist stored there is the same one
+  uint32_t netlist_and_led_states = (uint32_t)pgm_read_dword(&hashed_netlists_and_led_states[slot]);
+  if ((netlist_and_led_states & NETLIST_NETLIST_MASK) == nl)
+    return (uint8_t)((netlist_and_led_states & NETLIST_LED_STATES_MASK) >> 29);
+  // Not found, so default all LEDs to off
+  return 0;
+}
+
+#else
+// circuit/oracle2$ ./main > sorted_netlists_and_led_states.inc
+#include "../oracle2/sorted_netlists_and_led_states.inc"
+
+uint8_t Engine_ConsultOracle(uint32_t nl)
+{
+  int16_t low = 0;
+  int16_t high = NELEMS(sorted_netlists_and_led_states) - 1;
+  ENGINE_COUNT(oracleLookups, 1);
+
+  while (low <= high) {
+    int16_t mid = (low + high) / 2;
+    ENGINE_COUNT(oracleProbes, 1);
+    ENGINE_COUNT(tableReads, 1);
+
+    uint32_t netlist_and_led_states = (uint32_t)pgm_read_dword(&sorted_netlists_and_led_states[mid]);
+    uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
+
+    if (netlist < nl) {
+      low = mid + 1;
+    } else if (netlist > nl) {
+      high = mid - 1;
+    } else {
+      // We found it, so extract the led state, and return it
+      uint8_t led_states = (uint8_t)((netlist_and_led_states & NETLIST_LED_STATES_MASK) >> 29);
+      return led_states;
+    }
+  }
+  // Not found, so default all LEDs to off
+  return 0;
+}
+#endif
+
+void Engine_Evaluate(ENGINE* engine, const uint8_t board[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* result)
+{
+  // The netlist is only repaired where this board differs from the last one this engine saw, which is what
+  // makes a batch of similar boards cheaper than evaluating each one from scratch
+  Engine_PruneBoard(engine, board, PRUNEBOARD_FLAG_NORMAL);
+  Engine_UpdateNetlist(engine);
+  result->isShort = Engine_IsShort(engine);
+  result->netlist = Engine_PackNetlist(engine);
+  result->ledStates = Engine_ConsultOracle(result->netlist);
+
+  // The rules can't be met if there is a short circuit, or if there are invalid "loose ends"
+  result->meetsRules = !result->isShort && Engine_PruneBoard(engine, board, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY);
+}
+
+void Engine_EvaluateBatch(const uint8_t (*boards)[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* results, uint32_t count)
+{
+  ENGINE engine = { 0 };
+  for (uint32_t i = 0; i < count; ++i)
+    Engine_Evaluate(&engine, boards[i], &results[i]);
+}
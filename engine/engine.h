@@ -0,0 +1,140 @@
+/*
+
+  engine.h
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+/* The circuit evaluation engine: prunes loose ends, traces the
+   netlist, and looks up the LED states for a 5x5 board. It has no
+   side effects (no drawing, no sound), so the same code runs on the
+   Uzebox and inside the host tools. */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pieces.h"
+#include "packed_netlist.h"
+
+#define R_BIT 1
+#define Y_BIT 2
+#define G_BIT 4
+
+#define PRUNEBOARD_FLAG_NORMAL 0
+#define PRUNEBOARD_FLAG_MEETS_RULES 1
+#define PRUNEBOARD_FLAG_CHECK_ONLY 2
+
+// One VCC and three LEDs with two ports each
+#define ENGINE_MAX_SOURCES 7
+#define ENGINE_SOURCES_OVERFLOW 0xFE // the netlist is up to date, but there were too many sources to keep
+#define ENGINE_SOURCES_INVALID 0xFF  // the netlist has to be rebuilt from scratch
+
+struct ENGINE_SOURCE;
+typedef struct ENGINE_SOURCE ENGINE_SOURCE;
+
+// What one port of a VCC or LED is connected to, and every square that could change that
+struct ENGINE_SOURCE {
+  uint8_t port;     // (y * BOARD_WIDTH + x) * 4 + D_* of the port on pruned_board
+  uint8_t nl_src;
+  uint8_t nl_dests; // bit n set if it is connected to NL n
+  uint32_t squares; // the squares with a port in its group of nodes, bit (y * BOARD_WIDTH + x)
+} __attribute__ ((packed));
+
+struct ENGINE;
+typedef struct ENGINE ENGINE;
+
+// Scratch state for a single evaluation. The game keeps one of these
+// as a global, host tools keep one per thread. All zeros is a valid
+// starting state (an empty board).
+struct ENGINE {
+  // Used to prune pieces with loose ends before netlist generation
+  uint8_t pruned_board[BOARD_HEIGHT][BOARD_WIDTH];
+  // Which NL_* nodes are connected, including the NETLIST_SHORT bit (see packed_netlist.h)
+  uint32_t netlist;
+  // Squares of pruned_board that changed since the netlist was last updated, bit (y * BOARD_WIDTH + x)
+  uint32_t pruned_changed;
+  // The sources the netlist was put together from, so Engine_UpdateNetlist only redoes the ones a change touched
+  uint8_t source_count; // or ENGINE_SOURCES_*
+  ENGINE_SOURCE sources[ENGINE_MAX_SOURCES];
+  // Squares whose sources a repair still has to trace again, when Engine_UpdateNetlistStep hasn't finished it
+  uint32_t retrace;
+} __attribute__ ((packed));
+
+struct ENGINE_RESULT;
+typedef struct ENGINE_RESULT ENGINE_RESULT;
+
+struct ENGINE_RESULT {
+  uint32_t netlist;   // packed 27 bit netlist, 0 if there is a short circuit
+  uint8_t ledStates;  // R_BIT | Y_BIT | G_BIT
+  bool isShort;       // VCC is connected directly to GND
+  bool meetsRules;    // no short circuit, and no loose ends (the hand and held piece are not considered)
+} __attribute__ ((packed));
+
+// Host tools can build the engine with -DENGINE_COUNTERS to count the work each call does (see worstcase/).
+// The counts are per thread, and the game never turns them on.
+#if defined(ENGINE_COUNTERS)
+struct ENGINE_COUNTS;
+typedef struct ENGINE_COUNTS ENGINE_COUNTS;
+
+struct ENGINE_COUNTS {
+  uint32_t pruneCalls;
+  uint32_t pruneSquares;      // squares read from the board to set up the bitboards
+  uint32_t pruneIterations;   // passes over the bitboards, including the last one that changes nothing
+  uint32_t pruneCopies;       // squares copied into pruned_board
+  uint32_t pruneDegenerated;  // squares that lost ports, and went through degeneratePiece[]
+  uint32_t netlistBuilds;     // times Engine_UpdateNetlist rebuilt the netlist from scratch
+  uint32_t netlistWires;      // times the wires of the whole board were found, for a rebuild or for electrons
+  uint32_t netlistRepairs;    // times it only redid the sources a change touched
+  uint32_t netlistTraced;     // nodes those repairs went through
+  uint32_t netlistPieces;     // squares of pruned_board that weren't blank
+  uint32_t netlistJoins;
+  uint32_t netlistEnds;       // sides of nodes checked for the ends of the wires, 2 for every node
+  uint32_t netlistFindSteps;  // parent links followed by FindNode
+  uint32_t netlistSources;    // VCC and LED ports, which each read 2 netlistNodeMasks[] for every NL_* they reach
+  uint32_t netlistElectrons;  // electrons sent from the sources
+  uint32_t netlistSteps;      // ends of wires those electrons, and the first ways out of the T-pieces, got to
+  uint32_t oracleLookups;
+  uint32_t oracleProbes;      // netlists read from the oracle table
+  uint32_t tableReads;        // every pgm_read_*, which is an LPM on the AVR
+};
+
+extern __thread ENGINE_COUNTS engineCounts;
+#define ENGINE_COUNT(counter, n) (engineCounts.counter += (n))
+#else
+#define ENGINE_COUNT(counter, n)
+#endif
+
+bool Engine_PruneBoard(ENGINE* engine, const uint8_t board[BOARD_HEIGHT][BOARD_WIDTH], uint8_t flags);
+uint8_t Engine_MeetsRulesPorts(uint8_t piece);
+bool Engine_PieceMeetsRules(uint8_t piece, uint8_t valid);
+uint8_t Engine_EquivalentPiece(uint8_t piece);
+bool Engine_PieceSurvivesPruning(uint8_t piece, uint8_t valid);
+void Engine_InvalidateNetlist(ENGINE* engine);
+void Engine_BuildNetlist(ENGINE* engine);
+void Engine_UpdateNetlist(ENGINE* engine);
+bool Engine_UpdateNetlistStep(ENGINE* engine);
+bool Engine_IsShort(const ENGINE* engine);
+uint32_t Engine_PackNetlist(const ENGINE* engine);
+uint8_t Engine_ConsultOracle(uint32_t nl);
+uint8_t Engine_EvaluateLeds(uint32_t nl);
+
+void Engine_Evaluate(ENGINE* engine, const uint8_t board[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* result);
+void Engine_EvaluateBatch(const uint8_t (*boards)[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* results, uint32_t count);
@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "engine.h"
+
+/* Reads boards from stdin as raw 25 byte records (row-major, the same
+   layout as the board[][] array in circuit.c, flag bits allowed), runs
+   them through Engine_EvaluateBatch, and prints one line per board:
+
+     <packed netlist> <led states> <is short> <meets rules>
+
+   Example:
+     circuit/engine$ ./main < boards.bin */
+
+#define BATCH_SIZE 4096
+
+static uint8_t boards[BATCH_SIZE][BOARD_HEIGHT][BOARD_WIDTH];
+static ENGINE_RESULT results[BATCH_SIZE];
+
+int main(void)
+{
+  size_t count;
+  while ((count = fread(boards, sizeof(boards[0]), BATCH_SIZE, stdin)) > 0) {
+    Engine_EvaluateBatch(boards, results, count);
+    for (size_t i = 0; i < count; ++i)
+      printf("0x%08x %u %u %u\n", results[i].netlist, results[i].ledStates, results[i].isShort, results[i].meetsRules);
+  }
+
+  if (ferror(stdin)) {
+    perror("fread");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
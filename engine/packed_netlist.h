@@ -0,0 +1,79 @@
+/*
+
+  engine/packed_netlist.h
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#pragma once
+
+/* The packed netlist is the single representation of which of VCC,
+   GND, and the LED terminals are connected to each other, shared by
+   the engine, circuit.c, and the oracle2 generator. Each of the 28
+   pairs of NL_* nodes has its own bit, so a connection sets its bit
+   directly and the 8x8 matrix is never needed.
+
+   Bit layout, counting down from the highest node pair:
+
+     bit  0      GA-GC
+     bits 1..2   YC-GC YC-GA
+     bits 3..5   YA-GC YA-GA YA-YC
+     bits 6..9   RC-GC ... RC-YA
+     bits 10..14 RA-GC ... RA-RC
+     bits 15..20 00-GC ... 00-RA
+     bits 21..26 VV-GC ... VV-RA
+     bit  27     VV-00 (a short circuit, which the oracle never stores)
+
+   The top 3 bits hold the LED states in the oracle. */
+
+#define NL_VV 0
+#define NL_00 1
+#define NL_RA 2
+#define NL_RC 3
+#define NL_YA 4
+#define NL_YC 5
+#define NL_GA 6
+#define NL_GC 7
+
+#define NL_COUNT 8
+
+#define NETLIST_NETLIST_MASK     0x07FFFFFF
+#define NETLIST_SHORT            0x08000000
+#define NETLIST_PAIRS_MASK       (NETLIST_NETLIST_MASK | NETLIST_SHORT)
+#define NETLIST_LED_STATES_MASK  0xE0000000
+#define NETLIST_R_ON             0x20000000
+#define NETLIST_Y_ON             0x40000000
+#define NETLIST_G_ON             0x80000000
+
+// The (node, node) -> bit index map, which folds to a constant when a and b are constants (a != b)
+#define NETLIST_LO_(a, b) ((a) < (b) ? (a) : (b))
+#define NETLIST_HI_(a, b) ((a) < (b) ? (b) : (a))
+#define NETLIST_BIT_INDEX(a, b) ((6 - NETLIST_LO_(a, b)) * (7 - NETLIST_LO_(a, b)) / 2 + 7 - NETLIST_HI_(a, b))
+#define NETLIST_BIT(a, b) ((uint32_t)1 << NETLIST_BIT_INDEX(a, b))
+#define NETLIST_CONNECTED(nl, a, b) ((a) != (b) && ((nl) & NETLIST_BIT(a, b)))
+
+// Every bit that has node n as one of its pair
+#define NETLIST_NODE_MASK(n)                                            \
+  (((n) == NL_VV ? 0 : NETLIST_BIT(n, NL_VV)) |                         \
+   ((n) == NL_00 ? 0 : NETLIST_BIT(n, NL_00)) |                         \
+   ((n) == NL_RA ? 0 : NETLIST_BIT(n, NL_RA)) |                         \
+   ((n) == NL_RC ? 0 : NETLIST_BIT(n, NL_RC)) |                         \
+   ((n) == NL_YA ? 0 : NETLIST_BIT(n, NL_YA)) |                         \
+   ((n) == NL_YC ? 0 : NETLIST_BIT(n, NL_YC)) |                         \
+   ((n) == NL_GA ? 0 : NETLIST_BIT(n, NL_GA)) |                         \
+   ((n) == NL_GC ? 0 : NETLIST_BIT(n, NL_GC)))
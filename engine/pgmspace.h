@@ -0,0 +1,36 @@
+/*
+
+  pgmspace.h
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+/* The engine keeps its lookup tables in flash on the AVR, and in
+   ordinary read-only memory when it is compiled for a host tool. */
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#endif
@@ -0,0 +1,154 @@
+/*
+
+  pieces.h
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#pragma once
+
+#define BOARD_WIDTH 5
+#define BOARD_HEIGHT 5
+
+#define PIECE_MASK   0x3F
+#define FLAGS_MASK   0xC0
+#define FLAG_ROTATE  0x40
+#define FLAG_LOCKED  0x80
+
+// Defines for the pieces. Rotations are treated as different pieces.
+#define P_BLANK 0
+
+#define P_VCC_T 1
+#define P_VCC_R 2
+#define P_VCC_B 3
+#define P_VCC_L 4
+
+#define P_GND_LTR 5
+#define P_GND_TRB 6
+#define P_GND_RBL 7
+#define P_GND_BLT 8
+
+#define P_SW1_BL 9
+#define P_SW1_LT 10
+#define P_SW1_TR 11
+#define P_SW1_RB 12
+
+#define P_RLED_AB_CR 13
+#define P_RLED_AL_CB 14
+#define P_RLED_AT_CL 15
+#define P_RLED_AR_CT 16
+
+#define P_SW2_BT 17
+#define P_SW2_LR 18
+#define P_SW2_TB 19
+#define P_SW2_RL 20
+
+#define P_YLED_AL_CR 21
+#define P_YLED_AT_CB 22
+#define P_YLED_AR_CL 23
+#define P_YLED_AB_CT 24
+
+#define P_SW3_BR 25
+#define P_SW3_LB 26
+#define P_SW3_TL 27
+#define P_SW3_RT 28
+
+#define P_GLED_AB_CL 29
+#define P_GLED_AL_CT 30
+#define P_GLED_AT_CR 31
+#define P_GLED_AR_CB 32
+
+#define P_STRAIGHT_LR 33
+#define P_STRAIGHT_TB 34
+
+#define P_DBL_CORNER_TL_BR 35
+#define P_DBL_CORNER_TR_BL 36
+
+#define P_CORNER_BL 37
+#define P_CORNER_TL 38
+#define P_CORNER_TR 39
+#define P_CORNER_BR 40
+
+#define P_TPIECE_RBL 41
+#define P_TPIECE_BLT 42
+#define P_TPIECE_LTR 43
+#define P_TPIECE_TRB 44
+
+#define P_BRIDGE1_TB_LR 45
+#define P_BRIDGE2_TB_LR 46
+
+#define P_BLOCKER 47
+
+// Unknown rotations (these only exist in the level definitions)
+#define P_VCC_U 48
+#define P_GND_U 49
+#define P_SW1_U 50
+#define P_RLED_U 51
+#define P_SW2_U 52
+#define P_YLED_U 53
+#define P_SW3_U 54
+#define P_GLED_U 55
+#define P_STRAIGHT_U 56
+#define P_DBL_CORNER_U 57
+#define P_CORNER_U 58
+#define P_TPIECE_U 59
+#define P_BRIDGE_U 60
+
+// Defines for the goals. There are no rotations.
+#define P_GOAL_BLANK 0
+#define P_GOAL_RLED_OFF 1
+#define P_GOAL_YLED_OFF 2
+#define P_GOAL_GLED_OFF 3
+
+#define P_GOAL_RLED_ON 4
+#define P_GOAL_YLED_ON 5
+#define P_GOAL_GLED_ON 6
+
+#define P_GOAL_SW1 7
+#define P_GOAL_SW2 8
+#define P_GOAL_SW3 9
+
+#define DIRECTION_MASK 0x03
+#define D_T 0
+#define D_R 1
+#define D_B 2
+#define D_L 3
+
+/* Each square may have an electron going in and/or out in any direction
+      IN   OUT
+   0b 0000 0000
+       \\\\ \\\\__ top
+        \\\\ \\\__ right
+         \\\\ \\__ bottom
+          \\\\ \__ left
+           \\\\
+            \\\\__ top
+             \\\__ right
+              \\__ bottom
+               \__ left
+*/
+#define D_OUT_T 1
+#define D_OUT_R 2
+#define D_OUT_B 4
+#define D_OUT_L 8
+
+#define D_IN_T 16
+#define D_IN_R 32
+#define D_IN_B 64
+#define D_IN_L 128
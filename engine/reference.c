@@ -0,0 +1,1950 @@
+/*
+
+  reference.c
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/* The circuit evaluation code exactly as it was in circuit.c before
+   it was split out into the engine: the isValidNeighborFromDirection
+   tables, PruneBoard, decide, SimulateElectron(s), and the binary
+   search ConsultOracle, along with the part of BoardChanged that
+   turns their output into a netlist, short flag, LED states, and
+   meets-rules result. Don't clean it up, don't optimize it: it is the
+   reference the fuzzer holds the engine to, quirks and all.
+
+   The only changes are mechanical, so several threads can each run
+   their own copy: the globals and decide's statics are thread local,
+   and everything but Reference_Evaluate is static. Reference_Connections
+   is new, and only reads what Reference_Evaluate already worked out. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "pgmspace.h"
+#include "reference.h"
+
+static __thread uint8_t board[BOARD_HEIGHT][BOARD_WIDTH];
+static __thread uint8_t pruned_board[BOARD_HEIGHT][BOARD_WIDTH];
+
+// Used to store the netlist (can be made more efficient later)
+static __thread uint8_t pruned_netlist[8][8];
+
+// Every connection the last Reference_Evaluate found, for Reference_Connections
+static __thread uint32_t connections;
+
+static const uint8_t isValidNeighborFromDirection[48][4] PROGMEM =
+  {
+// P_BLANK 0
+   {0, 0, 0, 0},
+// P_VCC_T 1
+   {1, 0, 0, 0},
+// P_VCC_R 2
+   {0, 1, 0, 0},
+// P_VCC_B 3
+   {0, 0, 1, 0},
+// P_VCC_L 4
+   {0, 0, 0, 1},
+
+// P_GND_LTR 5
+   {1, 1, 0, 1},
+// P_GND_TRB 6
+   {1, 1, 1, 0},
+// P_GND_RBL 7
+   {0, 1, 1, 1},
+// P_GND_BLT 8
+   {1, 0, 1, 1},
+
+// P_SW1_BL 9
+   {0, 0, 1, 1},
+// P_SW1_LT 10
+   {1, 0, 0, 1},
+// P_SW1_TR 11
+   {1, 1, 0, 0},
+// P_SW1_RB 12
+   {0, 1, 1, 0},
+
+// P_RLED_AB_CR 13
+   {0, 1, 1, 0},
+// P_RLED_AL_CB 14
+   {0, 0, 1, 1},
+// P_RLED_AT_CL 15
+   {1, 0, 0, 1},
+// P_RLED_AR_CT 16
+   {1, 1, 0, 0},
+
+// P_SW2_BT 17
+   {1, 0, 1, 0},
+// P_SW2_LR 18
+   {0, 1, 0, 1},
+// P_SW2_TB 19
+   {1, 0, 1, 0},
+// P_SW2_RL 20
+   {0, 1, 0, 1},
+
+// P_YLED_AL_CR 21
+   {0, 1, 0, 1},
+// P_YLED_AT_CB 22
+   {1, 0, 1, 0},
+// P_YLED_AR_CL 23
+   {0, 1, 0, 1},
+// P_YLED_AB_CT 24
+   {1, 0, 1, 0},
+
+// P_SW3_BR 25
+   {0, 1, 1, 0},
+// P_SW3_LB 26
+   {0, 0, 1, 1},
+// P_SW3_TL 27
+   {1, 0, 0, 1},
+// P_SW3_RT 28
+   {1, 1, 0, 0},
+
+// P_GLED_AB_CL 29
+   {0, 0, 1, 1},
+// P_GLED_AL_CT 30
+   {1, 0, 0, 1},
+// P_GLED_AT_CR 31
+   {1, 1, 0, 0},
+// P_GLED_AR_CB 32
+   {0, 1, 1, 0},
+
+// P_STRAIGHT_LR 33
+   {0, 1, 0, 1},
+// P_STRAIGHT_TB 34
+   {1, 0, 1, 0},
+
+// P_DBL_CORNER_TL_BR 35
+   {1, 1, 1, 1},
+// P_DBL_CORNER_TR_BL 36
+   {1, 1, 1, 1},
+
+// P_CORNER_BL 37
+   {0, 0, 1, 1},
+// P_CORNER_TL 38
+   {1, 0, 0, 1},
+// P_CORNER_TR 39
+   {1, 1, 0, 0},
+// P_CORNER_BR 40
+   {0, 1, 1, 0},
+
+// P_TPIECE_RBL 41
+   {0, 1, 1, 1},
+// P_TPIECE_BLT 42
+   {1, 0, 1, 1},
+// P_TPIECE_LTR 43
+   {1, 1, 0, 1},
+// P_TPIECE_TRB 44
+   {1, 1, 1, 0},
+
+// P_BRIDGE1_TB_LR 45
+   {1, 1, 1, 1},
+// P_BRIDGE2_TB_LR 46
+   {1, 1, 1, 1},
+
+// P_BLOCKER 47
+   {0, 0, 0, 0},
+};
+
+static const uint8_t isValidNeighborFromDirectionMeetsRules[48][4] PROGMEM =
+  {
+// P_BLANK 0
+   {0, 0, 0, 0},
+// P_VCC_T 1
+   {1, 0, 0, 0},
+// P_VCC_R 2
+   {0, 1, 0, 0},
+// P_VCC_B 3
+   {0, 0, 1, 0},
+// P_VCC_L 4
+   {0, 0, 0, 1},
+
+// P_GND_LTR 5
+   {1, 1, 0, 1},
+// P_GND_TRB 6
+   {1, 1, 1, 0},
+// P_GND_RBL 7
+   {0, 1, 1, 1},
+// P_GND_BLT 8
+   {1, 0, 1, 1},
+
+// P_SW1_BL 9
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW1_LT 10
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW1_TR 11
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW1_RB 12
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+
+// P_RLED_AB_CR 13
+   {0, 1, 1, 0},
+// P_RLED_AL_CB 14
+   {0, 0, 1, 1},
+// P_RLED_AT_CL 15
+   {1, 0, 0, 1},
+// P_RLED_AR_CT 16
+   {1, 1, 0, 0},
+
+// P_SW2_BT 17
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW2_LR 18
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW2_TB 19
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW2_RL 20
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+
+// P_YLED_AL_CR 21
+   {0, 1, 0, 1},
+// P_YLED_AT_CB 22
+   {1, 0, 1, 0},
+// P_YLED_AR_CL 23
+   {0, 1, 0, 1},
+// P_YLED_AB_CT 24
+   {1, 0, 1, 0},
+
+// P_SW3_BR 25
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW3_LB 26
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW3_TL 27
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+// P_SW3_RT 28
+   {1, 1, 1, 1}, // THESE ARE ALL 1
+
+// P_GLED_AB_CL 29
+   {0, 0, 1, 1},
+// P_GLED_AL_CT 30
+   {1, 0, 0, 1},
+// P_GLED_AT_CR 31
+   {1, 1, 0, 0},
+// P_GLED_AR_CB 32
+   {0, 1, 1, 0},
+
+// P_STRAIGHT_LR 33
+   {0, 1, 0, 1},
+// P_STRAIGHT_TB 34
+   {1, 0, 1, 0},
+
+// P_DBL_CORNER_TL_BR 35
+   {1, 1, 1, 1},
+// P_DBL_CORNER_TR_BL 36
+   {1, 1, 1, 1},
+
+// P_CORNER_BL 37
+   {0, 0, 1, 1},
+// P_CORNER_TL 38
+   {1, 0, 0, 1},
+// P_CORNER_TR 39
+   {1, 1, 0, 0},
+// P_CORNER_BR 40
+   {0, 1, 1, 0},
+
+// P_TPIECE_RBL 41
+   {0, 1, 1, 1},
+// P_TPIECE_BLT 42
+   {1, 0, 1, 1},
+// P_TPIECE_LTR 43
+   {1, 1, 0, 1},
+// P_TPIECE_TRB 44
+   {1, 1, 1, 0},
+
+// P_BRIDGE1_TB_LR 45
+   {1, 1, 1, 1},
+// P_BRIDGE2_TB_LR 46
+   {1, 1, 1, 1},
+
+// P_BLOCKER 47
+   {0, 0, 0, 0},
+};
+
+static uint8_t CountValidTopNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+{
+  if (y > 0) {
+    uint8_t piece = pruned_board[y - 1][x];
+    if (flags == 0)
+      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_B]);
+    else
+      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_B]);
+  } else
+    return 0;
+}
+
+static uint8_t CountValidRightNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+{
+  if (x < BOARD_WIDTH - 1) {
+    uint8_t piece = pruned_board[y][x + 1];
+    if (flags == 0)
+      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_L]);
+    else
+      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_L]);
+  } else
+    return 0;
+}
+
+static uint8_t CountValidBottomNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+{
+  if (y < BOARD_HEIGHT - 1) {
+    uint8_t piece = pruned_board[y + 1][x];
+    if (flags == 0)
+      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_T]);
+    else
+      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_T]);
+  } else
+    return 0;
+}
+
+static uint8_t CountValidLeftNeighbor(uint8_t flags, uint8_t x, uint8_t y)
+{
+  if (x > 0) {
+    uint8_t piece = pruned_board[y][x - 1];
+    if (flags == 0)
+      return pgm_read_byte(&isValidNeighborFromDirection[piece][D_R]);
+    else
+      return pgm_read_byte(&isValidNeighborFromDirectionMeetsRules[piece][D_R]);
+  } else
+    return 0;
+}
+
+// If this function is called with PRUNEBOARD_FLAG_NORMAL, it will prune the board for proper minimal netlist generation. If called
+// with PRUNEBOARD_FLAG_MEETS_RULES, then a switch in any position will not cause a piece properly connected to it to be pruned,
+// which is used during the "meets rules" check to make sure that there aren't any loose ends that don't belong on the board.
+static bool PruneBoard(uint8_t flags)
+{
+  bool meetsRules = true;
+
+  // Copy the state of the board into pruned_board, because this is what we will prune, and what the netlist generator will run from
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+      pruned_board[y][x] = board[y][x] & PIECE_MASK;
+
+  // Keep looping until we reach a steady state where no pieces were removed or degenerated
+  uint8_t piecesRemoved;
+  do {
+    piecesRemoved = 0;
+    // Loop over the pruned_board and ensure each piece has enough valid neighbors in the right places, otherwise that piece will degenerate
+    for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+      for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+        uint8_t piece = pruned_board[y][x];
+        uint8_t count = 0;
+        switch (piece) {
+          // -------------------- BLANK
+        case P_BLANK:
+          break;
+
+          // -------------------- VCC
+        case P_VCC_T:
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_VCC_R:
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_VCC_B:
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_VCC_L:
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- GND
+        case P_GND_LTR:
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GND_TRB:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GND_RBL:
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GND_BLT:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count == 0) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- SW1
+        case P_SW1_BL:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidRightNeighbor(flags, x, y);
+          }
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW1_LT:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidRightNeighbor(flags, x, y);
+            count += CountValidBottomNeighbor(flags, x, y);
+          }
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW1_TR:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidBottomNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW1_RB:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- RLED
+        case P_RLED_AB_CR:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_RLED_AL_CB:
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_RLED_AT_CL:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_RLED_AR_CT:
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- SW2
+        case P_SW2_BT:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidRightNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW2_LR:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidBottomNeighbor(flags, x, y);
+          }
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW2_TB:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidRightNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW2_RL:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidBottomNeighbor(flags, x, y);
+          }
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- YLED
+        case P_YLED_AL_CR:
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_YLED_AT_CB:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_YLED_AR_CL:
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_YLED_AB_CT:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- SW3
+        case P_SW3_BR:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW3_LB:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidTopNeighbor(flags, x, y);
+            count += CountValidRightNeighbor(flags, x, y);
+          }
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW3_TL:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidRightNeighbor(flags, x, y);
+            count += CountValidBottomNeighbor(flags, x, y);
+          }
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_SW3_RT:
+          if (flags & PRUNEBOARD_FLAG_MEETS_RULES) {
+            count += CountValidBottomNeighbor(flags, x, y);
+            count += CountValidLeftNeighbor(flags, x, y);
+          }
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- GLED
+        case P_GLED_AB_CL:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GLED_AL_CT:
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidTopNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GLED_AT_CR:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_GLED_AR_CB:
+          count += CountValidRightNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- STRAIGHT
+        case P_STRAIGHT_LR:
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_STRAIGHT_TB:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- DBL CORNER
+        case P_DBL_CORNER_TL_BR: {
+          bool removeTL = false;
+          bool removeBR = false;
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            removeTL = true; // degenerate
+          }
+          count = 0; // reset the count
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            removeBR = true; // degenerate
+          }
+          if (removeTL && removeBR)
+            pruned_board[y][x] = P_BLANK;
+          else if (removeTL)
+            pruned_board[y][x] = P_CORNER_BR;
+          else if (removeBR)
+            pruned_board[y][x] = P_CORNER_TL;
+          if (removeTL || removeBR)
+            ++piecesRemoved;
+        }
+          break;
+        case P_DBL_CORNER_TR_BL: {
+          bool removeTR = false;
+          bool removeBL = false;
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            removeTR = true; // degenerate
+          }
+          count = 0; // reset the count
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            removeBL = true; // degenerate
+          }
+          if (removeTR && removeBL)
+            pruned_board[y][x] = P_BLANK;
+          else if (removeTR)
+            pruned_board[y][x] = P_CORNER_BL; // degenerate into the other corner
+          else if (removeBL)
+            pruned_board[y][x] = P_CORNER_TR; // degenerate into the other corner
+          if (removeTR || removeBL)
+            ++piecesRemoved;
+        }
+          break;
+
+          // -------------------- CORNER
+        case P_CORNER_BL:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_CORNER_TL:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidLeftNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_CORNER_TR:
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+        case P_CORNER_BR:
+          count += CountValidBottomNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          }
+          break;
+
+          // -------------------- TPIECE
+        case P_TPIECE_RBL: {
+          uint8_t countR = CountValidRightNeighbor(flags, x, y);
+          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
+          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
+          if (countR + countB + countL < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          } else if (countR == 0) {
+            pruned_board[y][x] = P_CORNER_BL; // degenerate into corner
+            ++piecesRemoved;
+          } else if (countB == 0) {
+            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into straight
+            ++piecesRemoved;
+          } else if (countL == 0) {
+            pruned_board[y][x] = P_CORNER_BR; // degenerate into corner
+            ++piecesRemoved;
+          }
+        }
+          break;
+        case P_TPIECE_BLT: {
+          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
+          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
+          uint8_t countT = CountValidTopNeighbor(flags, x, y);
+          if (countB + countL + countT < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          } else if (countB == 0) {
+            pruned_board[y][x] = P_CORNER_TL; // degenerate into corner
+            ++piecesRemoved;
+          } else if (countL == 0) {
+            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into straight
+            ++piecesRemoved;
+          } else if (countT == 0) {
+            pruned_board[y][x] = P_CORNER_BL; // degenerate into corner
+            ++piecesRemoved;
+          }
+        }
+          break;
+        case P_TPIECE_LTR: {
+          uint8_t countL = CountValidLeftNeighbor(flags, x, y);
+          uint8_t countT = CountValidTopNeighbor(flags, x, y);
+          uint8_t countR = CountValidRightNeighbor(flags, x, y);
+          if (countL + countT + countR < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          } else if (countL == 0) {
+            pruned_board[y][x] = P_CORNER_TR; // degenerate into corner
+            ++piecesRemoved;
+          } else if (countT == 0) {
+            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into straight
+            ++piecesRemoved;
+          } else if (countR == 0) {
+            pruned_board[y][x] = P_CORNER_TL; // degenerate into corner
+            ++piecesRemoved;
+          }
+        }
+          break;
+        case P_TPIECE_TRB: {
+          uint8_t countT = CountValidTopNeighbor(flags, x, y);
+          uint8_t countR = CountValidRightNeighbor(flags, x, y);
+          uint8_t countB = CountValidBottomNeighbor(flags, x, y);
+          if (countT + countR + countB < 2) {
+            pruned_board[y][x] = P_BLANK;
+            ++piecesRemoved;
+          } else if (countT == 0) {
+            pruned_board[y][x] = P_CORNER_BR; // degenerate into corner
+            ++piecesRemoved;
+          } else if (countR == 0) {
+            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into straight
+            ++piecesRemoved;
+          } else if (countB == 0) {
+            pruned_board[y][x] = P_CORNER_TR; // degenerate into corner
+            ++piecesRemoved;
+          }
+        }
+          break;
+
+          // -------------------- BRIDGE
+        case P_BRIDGE1_TB_LR:
+        case P_BRIDGE2_TB_LR: {
+          bool removeTB = false;
+          bool removeLR = false;
+          count += CountValidTopNeighbor(flags, x, y);
+          count += CountValidBottomNeighbor(flags, x, y);
+          if (count < 2) {
+            removeTB = true; // degenerate
+          }
+          count = 0; // reset the count
+          count += CountValidLeftNeighbor(flags, x, y);
+          count += CountValidRightNeighbor(flags, x, y);
+          if (count < 2) {
+            removeLR = true; // degenerate
+          }
+          if (removeTB && removeLR)
+            pruned_board[y][x] = P_BLANK;
+          else if (removeTB)
+            pruned_board[y][x] = P_STRAIGHT_LR; // degenerate into the other straight
+          else if (removeLR)
+            pruned_board[y][x] = P_STRAIGHT_TB; // degenerate into the other straight
+          if (removeTB || removeLR)
+            ++piecesRemoved;
+        }
+          break;
+
+        case P_BLOCKER:
+          pruned_board[y][x] = P_BLANK;
+          break;
+
+        default:
+          // This should never happen
+          break;
+        }
+      }
+    if (piecesRemoved)
+      meetsRules = false;
+  } while (piecesRemoved);
+
+  return meetsRules;
+}
+
+#define DECIDE_NOW   0
+#define DECIDE_INIT  1
+#define DECIDE_NEXT  2
+#define DECIDE_QUERY 4
+
+/*
+ * The decide function avoids having to call many iterations of the
+ * slow rand() function to trace out the branches in the circuit, by
+ * carefully returning binary numbers in a methodical fashion.
+ *
+ * Example usage below:
+
+     int main(int argc, char *argv[])
+     {
+       // initialize the decider
+       decide(DECIDE_INIT);
+
+       for (uint8_t a = 0; a < 4; ++a) {
+         for (uint8_t i = 0; i < 2; ++i) {
+           uint8_t d = decide(DECIDE_NOW);
+           printf("%d\n", d);
+         }
+         puts("next\n");
+         decide(DECIDE_NEXT);
+       }
+       return 0;
+     }
+ */
+static uint8_t decide(uint8_t flags)
+{
+  static __thread uint8_t generation = 0;
+  static __thread uint8_t bitmask = 1;
+  static __thread bool wasCalled = false;
+
+  if (!flags) {
+    // decide something
+    uint8_t decision = (generation & bitmask);
+    bitmask <<= 1;
+    wasCalled |= true;
+    return decision ? 1 : 0;
+  }
+
+  if (flags & DECIDE_INIT) {
+    generation = 0;
+    bitmask = 1;
+    wasCalled = false;
+    return 0;
+  }
+
+  if (flags & DECIDE_QUERY)
+    return wasCalled;
+
+  if (flags & DECIDE_NEXT) {
+    ++generation;
+    bitmask = 1;
+  }
+
+  return 0;
+}
+
+// nl_source will be NL_VV, NL_00, NL_RA, NL_RC, etc...
+// d will be D_T, D_R, D_B, or D_L (masked with DIRECTION_MASK to ensure it is in range)
+// returns NL_VV, NL_00, NL_RA, etc... depending on what it finds
+static uint8_t SimulateElectron(uint8_t nl_src, int8_t x, int8_t y, uint8_t d)
+{
+  uint8_t nl_dest = nl_src; // in case we are in a loop
+
+  //  memset(directions, 0, sizeof(directions));
+
+  uint8_t decision = 0;
+  bool halt = false;
+  uint8_t ttl = 0;
+  while (!halt && (++ttl != 0) && x >= 0 && x <= BOARD_WIDTH - 1 && y >= 0 && y <= BOARD_HEIGHT - 1) {
+    uint8_t piece = pruned_board[y][x];
+    switch (piece) {
+    case P_BLANK:
+      halt = true;
+      break;
+
+    case P_VCC_T: // technically direction doesn't matter, because previously validated by PruneBoard
+      if (d == D_IN_T)
+        return NL_VV;
+      halt = true;
+      break;
+    case P_VCC_R:
+      if (d == D_IN_R)
+        return NL_VV;
+      halt = true;
+      break;
+    case P_VCC_B:
+      if (d == D_IN_B)
+        return NL_VV;
+      halt = true;
+      break;
+    case P_VCC_L:
+      if (d == D_IN_L)
+        return NL_VV;
+      halt = true;
+      break;
+
+    case P_GND_LTR: // technically direction doesn't matter, because previously validated by PruneBoard
+      if (d == D_IN_T || d == D_IN_R || d == D_IN_L)
+        return NL_00;
+      halt = true;
+      break;
+    case P_GND_TRB:
+      if (d == D_IN_T || d == D_IN_R || d == D_IN_B)
+        return NL_00;
+      halt = true;
+      break;
+    case P_GND_RBL:
+      if (d == D_IN_R || d == D_IN_B || d == D_IN_L)
+        return NL_00;
+      halt = true;
+      break;
+    case P_GND_BLT:
+      if (d == D_IN_T || d == D_IN_B || d == D_IN_L)
+        return NL_00;
+      halt = true;
+      break;
+
+      // we need to pay attention to direction so we know where it exits
+    case P_SW1_BL:
+      switch (d) {
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      default: // these default cases should not be needed, but I put them here for safety
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW1_LT:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW1_TR:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW1_RB:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+      // direction matters here, because we need to know whether we hit an anode or cathode
+    case P_RLED_AB_CR:
+      switch (d) {
+      case D_IN_R:
+        return NL_RC;
+        break;
+      case D_IN_B:
+        return NL_RA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_RLED_AL_CB:
+      switch (d) {
+      case D_IN_B:
+        return NL_RC;
+        break;
+      case D_IN_L:
+        return NL_RA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_RLED_AT_CL:
+      switch (d) {
+      case D_IN_T:
+        return NL_RA;
+        break;
+      case D_IN_L:
+        return NL_RC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_RLED_AR_CT:
+      switch (d) {
+      case D_IN_T:
+        return NL_RC;
+        break;
+      case D_IN_R:
+        return NL_RA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_SW2_BT:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW2_LR:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW2_TB:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW2_RL:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+      // direction matters here, because we need to know whether we hit an anode or cathode
+    case P_YLED_AL_CR:
+      switch (d) {
+      case D_IN_R:
+        return NL_YC;
+        break;
+      case D_IN_L:
+        return NL_YA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_YLED_AT_CB:
+      switch (d) {
+      case D_IN_T:
+        return NL_YA;
+        break;
+      case D_IN_B:
+        return NL_YC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_YLED_AR_CL:
+      switch (d) {
+      case D_IN_R:
+        return NL_YA;
+        break;
+      case D_IN_L:
+        return NL_YC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_YLED_AB_CT:
+      switch (d) {
+      case D_IN_T:
+        return NL_YC;
+        break;
+      case D_IN_B:
+        return NL_YA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_SW3_BR:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW3_LB:
+      switch (d) {
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW3_TL:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_SW3_RT:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+      // direction matters here, because we need to know whether we hit an anode or cathode
+    case P_GLED_AB_CL:
+      switch (d) {
+      case D_IN_B:
+        return NL_GA;
+        break;
+      case D_IN_L:
+        return NL_GC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_GLED_AL_CT:
+      switch (d) {
+      case D_IN_T:
+        return NL_GC;
+        break;
+      case D_IN_L:
+        return NL_GA;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_GLED_AT_CR:
+      switch (d) {
+      case D_IN_T:
+        return NL_GA;
+        break;
+      case D_IN_R:
+        return NL_GC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_GLED_AR_CB:
+      switch (d) {
+      case D_IN_R:
+        return NL_GA;
+        break;
+      case D_IN_B:
+        return NL_GC;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_STRAIGHT_LR:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_STRAIGHT_TB:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_DBL_CORNER_TL_BR:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_DBL_CORNER_TR_BL:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_CORNER_BL:
+      switch (d) {
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_CORNER_TL:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_CORNER_TR:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_CORNER_BR:
+      switch (d) {
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_TPIECE_RBL:
+      decision = decide(DECIDE_NOW);
+      switch (d) {
+      case D_IN_R:
+        if (decision) { // continue to L
+          //directions[y][x] |= (D_IN_R | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        } else { // turn to B
+          //directions[y][x] |= (D_IN_R | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        }
+        break;
+      case D_IN_B:
+        if (decision) { // turn to R
+          //directions[y][x] |= (D_IN_B | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        } else { // turn to L
+          //directions[y][x] |= (D_IN_B | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        }
+        break;
+      case D_IN_L:
+        if (decision) { // turn to B
+          //directions[y][x] |= (D_IN_L | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        } else { // continue to R
+          //directions[y][x] |= (D_IN_L | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        }
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_TPIECE_BLT:
+      decision = decide(DECIDE_NOW);
+      switch (d) {
+      case D_IN_T:
+        if (decision) { // turn to L
+          //directions[y][x] |= (D_IN_T | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        } else { // continue to B
+          //directions[y][x] |= (D_IN_T | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        }
+        break;
+      case D_IN_B:
+        if (decision) { // continue to T
+          //directions[y][x] |= (D_IN_B | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        } else { // turn to L
+          //directions[y][x] |= (D_IN_B | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        }
+        break;
+      case D_IN_L:
+        if (decision) { // turn to B
+          //directions[y][x] |= (D_IN_L | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        } else { // turn to T
+          //directions[y][x] |= (D_IN_L | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        }
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_TPIECE_LTR:
+      decision = decide(DECIDE_NOW);
+      switch (d) {
+      case D_IN_T:
+        if (decision) { // turn to L
+          //directions[y][x] |= (D_IN_T | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        } else { // turn to R
+          //directions[y][x] |= (D_IN_T | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        }
+        break;
+      case D_IN_R:
+        if (decision) { // turn to T
+          //directions[y][x] |= (D_IN_R | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        } else { // continue to L
+          //directions[y][x] |= (D_IN_R | D_OUT_L);
+          d = D_IN_R;
+          x--;
+        }
+        break;
+      case D_IN_L:
+        if (decision) { // continue to R
+          //directions[y][x] |= (D_IN_L | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        } else { // turn to T
+          //directions[y][x] |= (D_IN_L | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        }
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+    case P_TPIECE_TRB:
+      decision = decide(DECIDE_NOW);
+      switch (d) {
+      case D_IN_T:
+        if (decision) { // continue to B
+          //directions[y][x] |= (D_IN_T | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        } else { // turn to R
+          //directions[y][x] |= (D_IN_T | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        }
+        break;
+      case D_IN_R:
+        if (decision) { // turn to T
+          //directions[y][x] |= (D_IN_R | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        } else { // turn to B
+          //directions[y][x] |= (D_IN_R | D_OUT_B);
+          d = D_IN_T;
+          y++;
+        }
+        break;
+      case D_IN_B:
+        if (decision) { // turn to R
+          //directions[y][x] |= (D_IN_B | D_OUT_R);
+          d = D_IN_L;
+          x++;
+        } else { // continue to T
+          //directions[y][x] |= (D_IN_B | D_OUT_T);
+          d = D_IN_B;
+          y--;
+        }
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_BRIDGE1_TB_LR:
+    case P_BRIDGE2_TB_LR:
+      switch (d) {
+      case D_IN_T:
+        //directions[y][x] |= (D_IN_T | D_OUT_B);
+        d = D_IN_T;
+        y++;
+        break;
+      case D_IN_R:
+        //directions[y][x] |= (D_IN_R | D_OUT_L);
+        d = D_IN_R;
+        x--;
+        break;
+      case D_IN_B:
+        //directions[y][x] |= (D_IN_B | D_OUT_T);
+        d = D_IN_B;
+        y--;
+        break;
+      case D_IN_L:
+        //directions[y][x] |= (D_IN_L | D_OUT_R);
+        d = D_IN_L;
+        x++;
+        break;
+      default:
+        halt = true;
+        break;
+      }
+      break;
+
+    case P_BLOCKER:
+    default:
+      halt = true;
+      break;
+    }
+  }
+  return nl_dest;
+}
+
+static void SimulateElectrons(uint8_t nl_src, int8_t x, int8_t y, uint8_t d) {
+  decide(DECIDE_INIT);
+  for (uint8_t e = 0; e < 4; ++e) { // send electrons in every possible path
+    for (uint8_t i = 0; i < 2; ++i) { // using the fewest number of electrons
+      uint8_t result = SimulateElectron(nl_src, x, y, d);
+      pruned_netlist[result][nl_src] = pruned_netlist[nl_src][result] = 1;
+
+      // If the first electron did not hit a branch (TPIECE), it wouldn't have called the decide
+      // function, and therefore we don't need to send any more electrons from nl_src, because
+      // they will also never branch. This saves a ton of clock cycles (3000-4000 typically, but
+      // sometimes 13000+ clocks).
+      if (!decide(DECIDE_QUERY))
+        return;
+    }
+    decide(DECIDE_NEXT);
+  }
+}
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+// circuit/oracle2$ ./main > sorted_netlists_and_led_states.inc
+// (under another name, since engine.c may include the same table)
+#define sorted_netlists_and_led_states reference_netlists_and_led_states
+#include "../oracle2/sorted_netlists_and_led_states.inc"
+
+static uint8_t ConsultOracle(uint32_t nl)
+{
+  int16_t low = 0;
+  int16_t high = NELEMS(sorted_netlists_and_led_states) - 1;
+
+  while (low <= high) {
+    int16_t mid = (low + high) / 2;
+
+    uint32_t netlist_and_led_states = (uint32_t)pgm_read_dword(&sorted_netlists_and_led_states[mid]);
+    uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
+
+    if (netlist < nl) {
+      low = mid + 1;
+    } else if (netlist > nl) {
+      high = mid - 1;
+    } else {
+      // We found it, so extract the led state, and return it
+      uint8_t led_states = (uint8_t)((netlist_and_led_states & NETLIST_LED_STATES_MASK) >> 29);
+      return led_states;
+    }
+  }
+  // Not found, so default all LEDs to off
+  return 0;
+}
+
+
+// The evaluation half of BoardChanged, without the drawing and sound
+void Reference_Evaluate(const uint8_t b[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* result)
+{
+  memcpy(board, b, sizeof(board));
+
+  PruneBoard(PRUNEBOARD_FLAG_NORMAL);
+
+  memset(pruned_netlist, 0, sizeof(pruned_netlist));
+
+  // Find where all the pieces of interest are on 'pruned_board', and call SimulateElectrons
+  // from that x, y, and direction the electrons need to go into the adjacent piece
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = pruned_board[y][x];
+      switch (piece) {
+
+        // VCC
+      case P_VCC_T:
+        SimulateElectrons(NL_VV, x, y - 1, D_IN_B);
+        break;
+      case P_VCC_R:
+        SimulateElectrons(NL_VV, x + 1, y, D_IN_L);
+        break;
+      case P_VCC_B:
+        SimulateElectrons(NL_VV, x, y + 1, D_IN_T);
+        break;
+      case P_VCC_L:
+        SimulateElectrons(NL_VV, x - 1, y, D_IN_R);
+        break;
+
+        // RED LED
+      case P_RLED_AT_CL:
+        SimulateElectrons(NL_RA, x, y - 1, D_IN_B);
+        SimulateElectrons(NL_RC, x - 1, y, D_IN_R);
+        break;
+      case P_RLED_AR_CT:
+        SimulateElectrons(NL_RA, x + 1, y, D_IN_L);
+        SimulateElectrons(NL_RC, x, y - 1, D_IN_B);
+        break;
+      case P_RLED_AB_CR:
+        SimulateElectrons(NL_RA, x, y + 1, D_IN_T);
+        SimulateElectrons(NL_RC, x + 1, y, D_IN_L);
+        break;
+      case P_RLED_AL_CB:
+        SimulateElectrons(NL_RA, x - 1, y, D_IN_R);
+        SimulateElectrons(NL_RC, x, y + 1, D_IN_T);
+        break;
+
+        // YELLOW LED
+      case P_YLED_AT_CB:
+        SimulateElectrons(NL_YA, x, y - 1, D_IN_B);
+        SimulateElectrons(NL_YC, x, y + 1, D_IN_T);
+        break;
+      case P_YLED_AR_CL:
+        SimulateElectrons(NL_YA, x + 1, y, D_IN_L);
+        SimulateElectrons(NL_YC, x - 1, y, D_IN_R);
+        break;
+      case P_YLED_AB_CT:
+        SimulateElectrons(NL_YA, x, y + 1, D_IN_T);
+        SimulateElectrons(NL_YC, x, y - 1, D_IN_B);
+        break;
+      case P_YLED_AL_CR:
+        SimulateElectrons(NL_YA, x - 1, y, D_IN_R);
+        SimulateElectrons(NL_YC, x + 1, y, D_IN_L);
+        break;
+
+        // GREEN LED
+      case P_GLED_AT_CR:
+        SimulateElectrons(NL_GA, x, y - 1, D_IN_B);
+        SimulateElectrons(NL_GC, x + 1, y, D_IN_L);
+        break;
+      case P_GLED_AR_CB:
+        SimulateElectrons(NL_GA, x + 1, y, D_IN_L);
+        SimulateElectrons(NL_GC, x, y + 1, D_IN_T);
+        break;
+      case P_GLED_AB_CL:
+        SimulateElectrons(NL_GA, x, y + 1, D_IN_T);
+        SimulateElectrons(NL_GC, x - 1, y, D_IN_R);
+        break;
+      case P_GLED_AL_CT:
+        SimulateElectrons(NL_GA, x - 1, y, D_IN_R);
+        SimulateElectrons(NL_GC, x, y - 1, D_IN_B);
+        break;
+
+      }
+    }
+
+  // Pack the netlist into a single 27 bit number
+  const uint8_t packedNetlistY[] =
+    {
+     NL_GA,
+     NL_YC, NL_YC,
+     NL_YA, NL_YA, NL_YA,
+     NL_RC, NL_RC, NL_RC, NL_RC,
+     NL_RA, NL_RA, NL_RA, NL_RA, NL_RA,
+     NL_00, NL_00, NL_00, NL_00, NL_00, NL_00,
+     NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
+    };
+  const uint8_t packedNetlistX[] =
+    {
+     NL_GC,
+     NL_GC, NL_GA,
+     NL_GC, NL_GA, NL_YC,
+     NL_GC, NL_GA, NL_YC, NL_YA,
+     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC,
+     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA,
+     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
+    };
+
+  bool isShort = false;
+    // If we always check for a short, the 28th bit can always be 0, and then we only need to use 27 bits
+  if (pruned_netlist[NL_00][NL_VV])
+    isShort = true;
+
+  uint32_t packed_netlist = 0;
+  if (!isShort) {
+    uint32_t bitmask = 1;
+    for (uint8_t i = 0; i < 27; ++i) {
+      if (pruned_netlist[packedNetlistY[i]][packedNetlistX[i]])
+        packed_netlist |= bitmask;
+      bitmask <<= 1;
+    }
+  }
+
+  // Not part of BoardChanged: the same bits again, kept even when there is a short
+  connections = isShort ? NETLIST_SHORT : 0;
+  for (uint8_t i = 0; i < 27; ++i)
+    if (pruned_netlist[packedNetlistY[i]][packedNetlistX[i]])
+      connections |= (uint32_t)1 << i;
+
+  uint8_t ledStates = ConsultOracle(packed_netlist);
+
+  bool meetsRules = true;
+
+  // The rules can't be met if there is a short circuit
+  if (isShort)
+    meetsRules = false;
+  // The rules can't be met if there are invalid "loose ends"
+  else if (PruneBoard(PRUNEBOARD_FLAG_MEETS_RULES) == false)
+    meetsRules = false;
+
+  result->netlist = packed_netlist;
+  result->ledStates = ledStates;
+  result->isShort = isShort;
+  result->meetsRules = meetsRules;
+}
+
+uint32_t Reference_Connections(void)
+{
+  return connections;
+}
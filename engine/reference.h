@@ -0,0 +1,15 @@
+#pragma once
+
+/* The pre-engine evaluation code from circuit.c, kept as the
+   reference that the engine has to match bit for bit. */
+
+#include <stdint.h>
+
+#include "engine.h"
+
+// The same result Engine_Evaluate gives, the way BoardChanged used to compute it
+void Reference_Evaluate(const uint8_t board[BOARD_HEIGHT][BOARD_WIDTH], ENGINE_RESULT* result);
+
+// Every pair of NL_* nodes the last Reference_Evaluate on this thread found connected,
+// short or not, in the same layout as ENGINE.netlist (NETLIST_SHORT included)
+uint32_t Reference_Connections(void);
@@ -0,0 +1,530 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+#include "../engine/reference.h"
+
+/* Differential fuzzer for the engine. Every board goes through both
+   Engine_EvaluateBatch and Reference_Evaluate (the code from circuit.c
+   before the engine existed, see reference.c), and the packed netlist,
+   short flag, LED states, and meets-rules result are compared. When
+   there is a short circuit, the packed netlist is 0 on both sides, so
+   every connection each side found is compared as well (see
+   Reference_Connections). Any difference at all is a mismatch.
+
+   The boards come from four places, picked at random for each one:
+
+     - Random: every square gets a random piece (or a blank, with a
+       random density per board), along with random FLAG_* bits.
+     - Levels: a level from levelData with its hand placed on random
+       blank squares, and every *_U piece and rotating piece turned a
+       random way, which is what the game actually evaluates.
+     - Branchy: VCC, sometimes GND, and one to three LEDs, with runs of
+       T-pieces leading away from them, and every other square a
+       T-piece, bridge, or double corner. decide() only sends electrons
+       both ways out of the first two T-pieces they meet, and the same
+       way out of the rest, so these are the boards where the engine
+       has to follow the electrons instead of its groups.
+     - Mutations: a board that lit something up, or met the rules,
+       with a few squares changed, rotated, swapped, or blanked.
+
+   Each mismatch is shrunk to a small reproducer by blanking squares and dropping
+   FLAG_* bits for as long as it still differs the same way, and
+   printed as a board in the same format as levels.inc.
+
+   Example:
+     circuit/fuzz$ ./main                (10 million boards)
+     circuit/fuzz$ ./main -n 1000000000  (a billion boards)
+     circuit/fuzz$ ./main -t 4 -s 7      (on 4 threads, starting from seed 7)
+     circuit/fuzz$ ./main -m 1           (stop at the first mismatch)
+
+   To fuzz one of the other oracle layouts in engine.c:
+     circuit/fuzz$ make clean && make CPPFLAGS=-DORACLE_LAYOUT=1
+
+   (ORACLE_LAYOUT_ANALYTIC is expected to mismatch: it works out LED
+   states for netlists that aren't in the table, where the reference
+   leaves every LED off.) */
+
+#include "../data/levels.inc"
+
+// The level layout, as in circuit.c
+#define GOAL_WIDTH 4
+#define GOAL_HEIGHT 3
+#define HAND_WIDTH 5
+#define HAND_HEIGHT 2
+#define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
+#define LEVELS (sizeof(levelData) / LEVEL_SIZE)
+#define BOARD_OFFSET_IN_LEVEL 0
+#define GOAL_OFFSET_IN_LEVEL (BOARD_WIDTH * BOARD_HEIGHT)
+#define HAND_OFFSET_IN_LEVEL (GOAL_OFFSET_IN_LEVEL + (GOAL_WIDTH * GOAL_HEIGHT))
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define PIECES 48 // P_BLANK through P_BLOCKER, everything that can be on a board while it is evaluated
+#define MAX_THREADS 256
+#define DEFAULT_BOARDS 10000000
+#define DEFAULT_MAX_MISMATCHES 10
+#define BATCH 256   // boards per Engine_EvaluateBatch call
+#define CORPUS 1024 // interesting boards each worker keeps around to mutate
+
+#define SOURCE_RANDOM   0
+#define SOURCE_LEVEL    1
+#define SOURCE_MUTATION 2
+#define SOURCE_BRANCHY  3
+#define SOURCES 4
+
+typedef uint8_t BOARD[BOARD_HEIGHT][BOARD_WIDTH];
+
+struct MISMATCH;
+typedef struct MISMATCH MISMATCH;
+
+struct MISMATCH {
+  BOARD board;     // as it was found
+  BOARD minimized; // the smallest board that still mismatches
+  uint8_t source;  // SOURCE_*
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  uint64_t seed;
+  uint64_t boards;    // how many to evaluate
+  uint64_t evaluated;
+  uint64_t sources[SOURCES];
+  uint64_t shorts;
+  uint64_t lit;       // at least one LED on
+  uint64_t meetsRules;
+  uint64_t mismatches;
+  BOARD corpus[CORPUS];
+  uint32_t corpusCount;
+};
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+static uint64_t maxMismatches = DEFAULT_MAX_MISMATCHES;
+
+// The mismatches found so far by all of the workers, which stop once there are maxMismatches of them
+static MISMATCH* mismatches;
+static uint64_t mismatchCount;
+static pthread_mutex_t mismatchLock = PTHREAD_MUTEX_INITIALIZER;
+
+// xorshift64, which gets stuck at 0, so every worker starts from somewhere else
+static uint64_t Random(WORKER* w)
+{
+  w->seed ^= w->seed << 13;
+  w->seed ^= w->seed >> 7;
+  w->seed ^= w->seed << 17;
+  return w->seed;
+}
+
+static uint32_t RandomBelow(WORKER* w, uint32_t n)
+{
+  return (uint32_t)((Random(w) >> 32) * n >> 32);
+}
+
+// A random rotation of the same piece. Switches can be in any of their positions.
+static uint8_t RandomRotation(WORKER* w, uint8_t piece)
+{
+  switch (piece) {
+  case P_VCC_T ... P_GLED_AR_CB:
+    return (piece - 1) / 4 * 4 + 1 + RandomBelow(w, 4);
+  case P_VCC_U ... P_GLED_U:
+    return (piece - P_VCC_U) * 4 + 1 + RandomBelow(w, 4);
+  case P_STRAIGHT_LR:
+  case P_STRAIGHT_TB:
+  case P_STRAIGHT_U:
+    return P_STRAIGHT_LR + RandomBelow(w, 2);
+  case P_DBL_CORNER_TL_BR:
+  case P_DBL_CORNER_TR_BL:
+  case P_DBL_CORNER_U:
+    return P_DBL_CORNER_TL_BR + RandomBelow(w, 2);
+  case P_CORNER_BL ... P_CORNER_BR:
+  case P_CORNER_U:
+    return P_CORNER_BL + RandomBelow(w, 4);
+  case P_TPIECE_RBL ... P_TPIECE_TRB:
+  case P_TPIECE_U:
+    return P_TPIECE_RBL + RandomBelow(w, 4);
+  case P_BRIDGE1_TB_LR:
+  case P_BRIDGE2_TB_LR:
+  case P_BRIDGE_U:
+    return P_BRIDGE1_TB_LR + RandomBelow(w, 2);
+  default:
+    return piece;
+  }
+}
+
+static void RandomBoard(WORKER* w, BOARD board)
+{
+  uint32_t density = 1 + RandomBelow(w, 100);
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = (RandomBelow(w, 100) < density) ? RandomBelow(w, PIECES) : P_BLANK;
+      board[y][x] = piece | (Random(w) & FLAGS_MASK);
+    }
+}
+
+static void LevelBoard(WORKER* w, BOARD board)
+{
+  const uint8_t* level = &levelData[RandomBelow(w, LEVELS) * LEVEL_SIZE];
+  uint8_t blanks[CELLS];
+  uint8_t blankCount = 0;
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t piece = pgm_read_byte(&level[BOARD_OFFSET_IN_LEVEL + i]);
+    uint8_t flags = piece & FLAGS_MASK;
+    piece &= PIECE_MASK;
+    if (piece >= P_VCC_U || (flags & FLAG_ROTATE))
+      piece = RandomRotation(w, piece);
+    board[i / BOARD_WIDTH][i % BOARD_WIDTH] = piece | flags;
+    if (piece == P_BLANK)
+      blanks[blankCount++] = i;
+  }
+
+  // Place the hand, a random square at a time
+  for (uint8_t i = 0; i < HAND_WIDTH * HAND_HEIGHT && blankCount; ++i) {
+    uint8_t piece = pgm_read_byte(&level[HAND_OFFSET_IN_LEVEL + i]) & PIECE_MASK;
+    if (piece == P_BLANK)
+      continue;
+    uint8_t j = RandomBelow(w, blankCount);
+    uint8_t cell = blanks[j];
+    blanks[j] = blanks[--blankCount];
+    board[cell / BOARD_WIDTH][cell % BOARD_WIDTH] = RandomRotation(w, piece);
+  }
+}
+
+static void MutateBoard(WORKER* w, BOARD board)
+{
+  memcpy(board, w->corpus[RandomBelow(w, w->corpusCount)], sizeof(BOARD));
+  uint8_t* cells = &board[0][0];
+  uint8_t changes = 1 + RandomBelow(w, 3);
+  for (uint8_t i = 0; i < changes; ++i) {
+    uint8_t a = RandomBelow(w, CELLS);
+    uint8_t b = RandomBelow(w, CELLS);
+    switch (RandomBelow(w, 4)) {
+    case 0: // a different piece
+      cells[a] = RandomBelow(w, PIECES) | (cells[a] & FLAGS_MASK);
+      break;
+    case 1: // the same piece turned another way
+      cells[a] = RandomRotation(w, cells[a] & PIECE_MASK) | (cells[a] & FLAGS_MASK);
+      break;
+    case 2: { // two squares traded
+      uint8_t piece = cells[a];
+      cells[a] = cells[b];
+      cells[b] = piece;
+      break;
+    }
+    case 3: // a piece taken off
+      cells[a] = P_BLANK;
+      break;
+    }
+  }
+}
+
+// T-pieces, bridges, and double corners, the pieces that give decide()'s electrons the most ways to go
+static uint8_t BranchyPiece(WORKER* w)
+{
+  uint32_t roll = RandomBelow(w, 10);
+  if (roll < 8)
+    return P_TPIECE_RBL + RandomBelow(w, 4);
+  if (roll < 9)
+    return P_BRIDGE1_TB_LR + RandomBelow(w, 2);
+  return P_DBL_CORNER_TL_BR + RandomBelow(w, 2);
+}
+
+static void BranchyBoard(WORKER* w, BOARD board)
+{
+  // Indexed the same way as the P_VCC_* rotations: up, right, down, left
+  static const int8_t dx[4] = { 0, 1, 0, -1 };
+  static const int8_t dy[4] = { -1, 0, 1, 0 };
+  static const uint8_t leds[3] = { P_RLED_AB_CR, P_YLED_AL_CR, P_GLED_AB_CL };
+
+  memset(board, P_BLANK, sizeof(BOARD));
+  uint8_t parts[5];
+  uint8_t partCount = 0;
+  parts[partCount++] = P_VCC_T + RandomBelow(w, 4);
+  if (RandomBelow(w, 2))
+    parts[partCount++] = P_GND_LTR + RandomBelow(w, 4);
+  uint8_t ledCount = 1 + RandomBelow(w, 3);
+  uint8_t firstLed = RandomBelow(w, 3);
+  for (uint8_t i = 0; i < ledCount; ++i)
+    parts[partCount++] = leds[(firstLed + i) % 3] + RandomBelow(w, 4);
+
+  uint8_t cells[5];
+  for (uint8_t i = 0; i < partCount; ++i) {
+    do
+      cells[i] = RandomBelow(w, CELLS);
+    while (board[cells[i] / BOARD_WIDTH][cells[i] % BOARD_WIDTH] != P_BLANK);
+    board[cells[i] / BOARD_WIDTH][cells[i] % BOARD_WIDTH] = parts[i];
+  }
+
+  // A run leading away from each of them, out of VCC's only port, turning now and then
+  for (uint8_t i = 0; i < partCount; ++i) {
+    int8_t x = cells[i] % BOARD_WIDTH;
+    int8_t y = cells[i] / BOARD_WIDTH;
+    uint8_t direction = (parts[i] <= P_VCC_L) ? parts[i] - P_VCC_T : (uint8_t)RandomBelow(w, 4);
+    uint8_t steps = 2 + RandomBelow(w, 10);
+    for (uint8_t s = 0; s < steps; ++s) {
+      x += dx[direction];
+      y += dy[direction];
+      if (x < 0 || x >= BOARD_WIDTH || y < 0 || y >= BOARD_HEIGHT)
+        break;
+      if (board[y][x] == P_BLANK)
+        board[y][x] = RandomBelow(w, 4) ? P_TPIECE_RBL + RandomBelow(w, 4) : BranchyPiece(w);
+      if (!RandomBelow(w, 3))
+        direction = RandomBelow(w, 4);
+    }
+  }
+
+  // Every other square filled in, since a blank is a loose end that gets the pieces around it pruned
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y)
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+      if (board[y][x] == P_BLANK)
+        board[y][x] = BranchyPiece(w);
+}
+
+static bool ResultsMatch(const ENGINE_RESULT* a, const ENGINE_RESULT* b)
+{
+  return (a->netlist == b->netlist && a->ledStates == b->ledStates &&
+          a->isShort == b->isShort && a->meetsRules == b->meetsRules);
+}
+
+// Whether the engine and the reference agree on a board, going by every connection each side found as well as the results
+static bool Matches(ENGINE* engine, const BOARD board)
+{
+  ENGINE_RESULT expected;
+  ENGINE_RESULT actual;
+  Reference_Evaluate(board, &expected);
+  Engine_Evaluate(engine, board, &actual);
+  return ResultsMatch(&expected, &actual) && engine->netlist == Reference_Connections();
+}
+
+// Blanks squares and drops FLAG_* bits for as long as the board still mismatches, until nothing else can go
+static void Minimize(ENGINE* engine, BOARD board)
+{
+  uint8_t* cells = &board[0][0];
+  bool changed;
+  do {
+    changed = false;
+    for (uint8_t i = 0; i < CELLS; ++i) {
+      const uint8_t simpler[] = { P_BLANK, cells[i] & PIECE_MASK };
+      for (uint8_t s = 0; s < sizeof(simpler); ++s) {
+        if (cells[i] == simpler[s])
+          continue;
+        uint8_t piece = cells[i];
+        cells[i] = simpler[s];
+        if (!Matches(engine, board)) {
+          changed = true;
+          break;
+        }
+        cells[i] = piece;
+      }
+    }
+  } while (changed);
+}
+
+static void* Fuzz(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  ENGINE engine = { 0 };
+  static __thread BOARD boards[BATCH];
+  static __thread uint8_t sources[BATCH];
+  static __thread ENGINE_RESULT results[BATCH];
+
+  while (w->boards) {
+    uint32_t batch = (w->boards < BATCH) ? w->boards : BATCH;
+    for (uint32_t b = 0; b < batch; ++b) {
+      uint32_t roll = RandomBelow(w, 8);
+      sources[b] = (roll < 2) ? SOURCE_RANDOM : (roll < 4) ? SOURCE_BRANCHY :
+        (roll < 6 || !w->corpusCount) ? SOURCE_LEVEL : SOURCE_MUTATION;
+      if (sources[b] == SOURCE_RANDOM)
+        RandomBoard(w, boards[b]);
+      else if (sources[b] == SOURCE_LEVEL)
+        LevelBoard(w, boards[b]);
+      else if (sources[b] == SOURCE_BRANCHY)
+        BranchyBoard(w, boards[b]);
+      else
+        MutateBoard(w, boards[b]);
+    }
+    Engine_EvaluateBatch((const BOARD*)boards, results, batch);
+
+    for (uint32_t b = 0; b < batch; ++b) {
+      ENGINE_RESULT expected;
+      Reference_Evaluate((const uint8_t (*)[BOARD_WIDTH])boards[b], &expected);
+      w->sources[sources[b]]++;
+      w->shorts += expected.isShort;
+      w->lit += (expected.ledStates != 0);
+      w->meetsRules += expected.meetsRules;
+
+      if ((expected.ledStates || expected.meetsRules) && sources[b] != SOURCE_BRANCHY) {
+        // Keep it to mutate later, replacing an older one once the corpus is full (branchy boards
+        // light something up so often that they would crowd out the rest, and never meet the rules)
+        uint32_t slot = (w->corpusCount < CORPUS) ? w->corpusCount++ : RandomBelow(w, CORPUS);
+        memcpy(w->corpus[slot], boards[b], sizeof(BOARD));
+      }
+
+      // With a short, the packed netlist is 0 on both sides, so the connections behind it get compared too
+      if (ResultsMatch(&expected, &results[b]) && (!expected.isShort || Matches(&engine, boards[b])))
+        continue;
+      w->mismatches++;
+      pthread_mutex_lock(&mismatchLock);
+      bool keep = (mismatchCount < maxMismatches);
+      uint64_t slot = mismatchCount++;
+      pthread_mutex_unlock(&mismatchLock);
+      if (!keep)
+        break;
+      MISMATCH* m = &mismatches[slot];
+      memcpy(m->board, boards[b], sizeof(BOARD));
+      memcpy(m->minimized, boards[b], sizeof(BOARD));
+      m->source = sources[b];
+      Minimize(&engine, m->minimized);
+    }
+    w->evaluated += batch;
+    w->boards -= batch;
+
+    if (__atomic_load_n(&mismatchCount, __ATOMIC_RELAXED) >= maxMismatches)
+      break;
+  }
+  return NULL;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* pieceNames[] = {
+  "0",
+  "P_VCC_T", "P_VCC_R", "P_VCC_B", "P_VCC_L",
+  "P_GND_LTR", "P_GND_TRB", "P_GND_RBL", "P_GND_BLT",
+  "P_SW1_BL", "P_SW1_LT", "P_SW1_TR", "P_SW1_RB",
+  "P_RLED_AB_CR", "P_RLED_AL_CB", "P_RLED_AT_CL", "P_RLED_AR_CT",
+  "P_SW2_BT", "P_SW2_LR", "P_SW2_TB", "P_SW2_RL",
+  "P_YLED_AL_CR", "P_YLED_AT_CB", "P_YLED_AR_CL", "P_YLED_AB_CT",
+  "P_SW3_BR", "P_SW3_LB", "P_SW3_TL", "P_SW3_RT",
+  "P_GLED_AB_CL", "P_GLED_AL_CT", "P_GLED_AT_CR", "P_GLED_AR_CB",
+  "P_STRAIGHT_LR", "P_STRAIGHT_TB",
+  "P_DBL_CORNER_TL_BR", "P_DBL_CORNER_TR_BL",
+  "P_CORNER_BL", "P_CORNER_TL", "P_CORNER_TR", "P_CORNER_BR",
+  "P_TPIECE_RBL", "P_TPIECE_BLT", "P_TPIECE_LTR", "P_TPIECE_TRB",
+  "P_BRIDGE1_TB_LR", "P_BRIDGE2_TB_LR",
+  "P_BLOCKER",
+};
+
+static void PrintBoard(const BOARD board)
+{
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y) {
+    printf(" ");
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x) {
+      uint8_t piece = board[y][x];
+      printf(" %s", pieceNames[piece & PIECE_MASK]);
+      if (piece & FLAG_ROTATE)
+        printf("|FLAG_ROTATE");
+      if (piece & FLAG_LOCKED)
+        printf("|FLAG_LOCKED");
+      printf(",");
+    }
+    printf("\n");
+  }
+}
+
+static void PrintResult(const char* name, const ENGINE_RESULT* r)
+{
+  printf("  // %-9s netlist 0x%07x, leds %c%c%c, %s, %s\n", name, r->netlist,
+         (r->ledStates & R_BIT) ? 'R' : '-', (r->ledStates & Y_BIT) ? 'Y' : '-', (r->ledStates & G_BIT) ? 'G' : '-',
+         r->isShort ? "short" : "no short", r->meetsRules ? "meets the rules" : "doesn't meet the rules");
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t boards = DEFAULT_BOARDS;
+  uint64_t seed = 1;
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t"))
+      cpus = atol(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-n"))
+      boards = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-s"))
+      seed = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-m"))
+      maxMismatches = strtoull(argv[2], NULL, 0);
+    else
+      break;
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc > 1 || maxMismatches < 1) {
+    fprintf(stderr, "Usage: %s [-t threads] [-n boards] [-s seed] [-m max mismatches]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    workers[t].seed = (seed + t) * 0x9E3779B97F4A7C15ULL; // xorshift gets stuck at 0
+    workers[t].boards = boards / workerCount + (t < boards % workerCount);
+  }
+  mismatches = calloc(maxMismatches, sizeof(MISMATCH));
+  if (!mismatches) {
+    perror("calloc");
+    return EXIT_FAILURE;
+  }
+
+  double start = Now();
+  for (uint32_t t = 0; t < workerCount; ++t)
+    if (pthread_create(&workers[t].thread, NULL, Fuzz, &workers[t])) {
+      perror("pthread_create");
+      return EXIT_FAILURE;
+    }
+  for (uint32_t t = 0; t < workerCount; ++t)
+    pthread_join(workers[t].thread, NULL);
+  double elapsed = Now() - start;
+
+  const char* sourceNames[SOURCES] = { "random", "level", "mutation", "branchy" };
+  uint64_t shown = (mismatchCount < maxMismatches) ? mismatchCount : maxMismatches;
+  ENGINE engine = { 0 };
+  for (uint64_t i = 0; i < shown; ++i) {
+    const MISMATCH* m = &mismatches[i];
+    ENGINE_RESULT expected;
+    ENGINE_RESULT actual;
+    Reference_Evaluate(m->minimized, &expected);
+    Engine_Evaluate(&engine, m->minimized, &actual);
+    printf("  // MISMATCH %lu (from a %s board)\n", i + 1, sourceNames[m->source]);
+    PrintBoard(m->minimized);
+    PrintResult("reference", &expected);
+    PrintResult("engine", &actual);
+    printf("  // Found as\n");
+    PrintBoard(m->board);
+    printf("\n");
+  }
+
+  uint64_t evaluated = 0;
+  uint64_t sources[SOURCES] = { 0 };
+  uint64_t shorts = 0;
+  uint64_t lit = 0;
+  uint64_t meetsRules = 0;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    evaluated += workers[t].evaluated;
+    for (uint8_t s = 0; s < SOURCES; ++s)
+      sources[s] += workers[t].sources[s];
+    shorts += workers[t].shorts;
+    lit += workers[t].lit;
+    meetsRules += workers[t].meetsRules;
+  }
+  fprintf(stderr, "%lu boards on %u threads in %.2f s (%.0f boards/s)\n", evaluated, workerCount, elapsed,
+          evaluated / elapsed);
+  for (uint8_t s = 0; s < SOURCES; ++s)
+    fprintf(stderr, "  %-9s %12lu\n", sourceNames[s], sources[s]);
+  fprintf(stderr, "  %lu short circuits, %lu with an LED on, %lu meeting the rules\n", shorts, lit, meetsRules);
+  fprintf(stderr, "%lu mismatches\n", mismatchCount);
+
+  free(mismatches);
+  return mismatchCount ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1040 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+
+/* Makes new levels. Each candidate starts out as a finished circuit:
+   a random tree of connected squares, with extra connections here and
+   there for loops, and a random piece on each square that meets the
+   rules with the connections it has (at most one VCC, GND, switch,
+   and LED of each color, like any level, with the switch always in the
+   SW1 position). It has to meet the rules, light an LED without a
+   short, and if it has a switch, light something different in some
+   switch position. The LEDs it lights become the goal, and then each
+   of its pieces either goes into the hand, gets locked in place, or
+   gets locked in place but left free to rotate, and some of the empty
+   squares get a blocker.
+
+   The level is then searched the same way solver/ searches levelData
+   (same rules, same reductions, same forward checking), and kept when
+   it has exactly the number of solutions asked for (-u), counted up to
+   swapping identical pieces and rotations that conduct the same way,
+   which is what a player would see as a different solution. The
+   search stops as soon as it finds one too many, or runs out of its
+   node budget (-b), so most bad candidates cost very little. The nodes
+   it took to search the whole level are its score, puzzles that take
+   fewer than -e nodes are thrown out as too easy, and the rest are
+   printed from easiest to hardest as levelData rows, ready to paste
+   into data/levels.inc. Every CPU works on its own candidates.
+
+   Example:
+     circuit/generator$ ./main                 (10 puzzles with one solution)
+     circuit/generator$ ./main -n 100 -e 5000  (100 puzzles that take at least 5000 nodes)
+     circuit/generator$ ./main -u 2 -s 7       (puzzles with 2 solutions, starting from seed 7)
+     circuit/generator$ ./main -t 4 -p 12      (on 4 threads, with circuits of up to 12 pieces) */
+
+// The level layout, as in circuit.c
+#define GOAL_WIDTH 4
+#define GOAL_HEIGHT 3
+#define HAND_WIDTH 5
+#define HAND_HEIGHT 2
+#define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
+#define BOARD_OFFSET_IN_LEVEL 0
+#define GOAL_OFFSET_IN_LEVEL (BOARD_WIDTH * BOARD_HEIGHT)
+#define HAND_OFFSET_IN_LEVEL (GOAL_OFFSET_IN_LEVEL + (GOAL_WIDTH * GOAL_HEIGHT))
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define MAX_TOKENS (HAND_WIDTH * HAND_HEIGHT)
+#define MAX_THREADS 256
+#define DEFAULT_PUZZLES 10
+#define DEFAULT_BUDGET 2000000
+#define DEFAULT_MIN_PIECES 4
+#define DEFAULT_MAX_PIECES 10
+#define HAND_PERCENT 50    // of the pieces in the circuit
+#define ROTATE_PERCENT 20  // of the pieces in the circuit
+#define BLOCKER_PERCENT 8  // of the empty squares
+#define LOOP_PERCENT 20    // of the neighbors in the circuit that aren't connected yet
+
+#define CELL_FIXED  0 // locked in place
+#define CELL_ROTATE 1 // can be rotated in place
+#define CELL_OPEN   2 // blank, so a piece from the hand may go here
+
+#define NO_TOKEN 0xFF
+
+#define SEARCH_REDUCE    1 // skip placements that are equivalent to ones already tried
+#define SEARCH_PROPAGATE 2 // give up on partial boards the rest of the hand can't complete
+
+#define ROLE_VCC 8 // along with R_BIT, Y_BIT, and G_BIT for the LEDs
+
+// What happened to each candidate
+#define OUTCOME_UNBUILT   0 // no piece fit some square, or there was no VCC, GND, or LED
+#define OUTCOME_DARK      1 // didn't meet the rules, didn't light anything, or the switch didn't matter
+#define OUTCOME_SOLUTIONS 2 // had the wrong number of solutions
+#define OUTCOME_BUDGET    3 // took more than the node budget to search
+#define OUTCOME_EASY      4 // took fewer nodes than the minimum effort to search
+#define OUTCOME_DUPLICATE 5 // was already found
+#define OUTCOME_MISMATCH  6 // the search didn't find the circuit it was made from (should stay 0)
+#define OUTCOME_ILLEGAL   7 // had more than one VCC, GND, switch, or LED of a color (should stay 0)
+#define OUTCOME_ACCEPTED  8
+#define OUTCOMES 9
+
+// A level, decoded for the search
+struct LEVEL;
+typedef struct LEVEL LEVEL;
+
+struct LEVEL {
+  uint8_t flags;             // SEARCH_*
+  uint8_t board[CELLS];      // the pieces that start on the board, P_BLANK where the hand can go
+  uint8_t kind[CELLS];       // CELL_*
+  uint8_t rotations[CELLS][4]; // the rotations a CELL_ROTATE square can have
+  uint8_t rotationWeight[CELLS][4]; // how many rotations each one stands for
+  uint8_t count[CELLS];
+  uint8_t rotatePorts[CELLS]; // every side any of those rotations has a port on
+  uint8_t order[CELLS];      // the squares the search decides, in the order it decides them
+  uint8_t orderCount;
+  uint8_t openAfter[CELLS + 1]; // how many CELL_OPEN squares there are in order[i..]
+  uint8_t tokenRotations[MAX_TOKENS][4]; // the rotations of each piece in the hand
+  uint8_t tokenWeight[MAX_TOKENS][4];
+  uint8_t tokenCount[MAX_TOKENS];
+  uint8_t tokenPorts[MAX_TOKENS];
+  uint8_t tokenRoles[MAX_TOKENS]; // ROLE_VCC, or the color of an LED
+  uint8_t tokenSame[MAX_TOKENS]; // an identical piece earlier in the hand, which has to be placed first, or NO_TOKEN
+  uint8_t tokens;
+  uint32_t weight;           // how many boards each one the search finds stands for, on top of TASK.weight
+  bool hasSwitch;
+  uint8_t goalStates[3];     // for each switch position, or just [0] without a switch
+  uint8_t goalLeds;          // the LEDs that are lit in any of them
+};
+
+struct TASK;
+typedef struct TASK TASK;
+
+// A partly filled in board
+struct TASK {
+  uint8_t board[CELLS];
+  uint32_t decided; // bit i is set once board[i] can't change anymore
+  uint16_t used;    // bit i is set once tokens[i] has been placed
+  uint8_t depth;    // index into order[] of the next square to decide
+  uint32_t weight;  // how many boards this one stands for, from the rotations skipped so far
+};
+
+struct SPARE;
+typedef struct SPARE SPARE;
+
+struct SPARE {
+  uint8_t ports; // the sides any rotation of any piece left in the hand has a port on
+  uint8_t roles; // ROLE_* of the pieces left in the hand
+  uint8_t remaining; // how many pieces are left in the hand
+  bool blankAllowed; // there are more undecided blank squares than pieces left in the hand
+};
+
+struct SEARCH;
+typedef struct SEARCH SEARCH;
+
+// One candidate being searched, on one thread
+struct SEARCH {
+  const LEVEL* level;
+  ENGINE* engine;
+  uint64_t nodes;     // pieces (or blanks) tried on a square
+  uint64_t budget;
+  uint64_t solutions; // boards found, up to symmetry
+  uint64_t limit;     // stop once more solutions than this have been found
+  bool stopped;
+};
+
+struct PUZZLE;
+typedef struct PUZZLE PUZZLE;
+
+struct PUZZLE {
+  uint8_t data[LEVEL_SIZE];
+  uint64_t nodes;
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  uint64_t seed;
+  ENGINE engine;
+  uint64_t outcomes[OUTCOMES];
+};
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+
+static uint64_t target = 1;
+static uint64_t budget = DEFAULT_BUDGET;
+static uint64_t minNodes;
+static uint8_t minPieces = DEFAULT_MIN_PIECES;
+static uint8_t maxPieces = DEFAULT_MAX_PIECES;
+
+static pthread_mutex_t puzzleLock = PTHREAD_MUTEX_INITIALIZER;
+static PUZZLE* puzzles;
+static uint32_t puzzleCount;
+static uint32_t wanted = DEFAULT_PUZZLES;
+static bool done;
+
+static bool IsSwitch(uint8_t piece)
+{
+  return (piece >= P_SW1_BL && piece <= P_SW1_RB) || (piece >= P_SW2_BT && piece <= P_SW2_RL) || (piece >= P_SW3_BR && piece <= P_SW3_RT);
+}
+
+static bool IsGround(uint8_t piece)
+{
+  return piece >= P_GND_LTR && piece <= P_GND_BLT;
+}
+
+static uint8_t Role(uint8_t piece)
+{
+  if (piece >= P_VCC_T && piece <= P_VCC_L)
+    return ROLE_VCC;
+  if (piece >= P_RLED_AB_CR && piece <= P_RLED_AR_CT)
+    return R_BIT;
+  if (piece >= P_YLED_AL_CR && piece <= P_YLED_AB_CT)
+    return Y_BIT;
+  if (piece >= P_GLED_AB_CL && piece <= P_GLED_AR_CB)
+    return G_BIT;
+  return 0;
+}
+
+// The rotations a piece can be turned into, as a run of 'count' pieces starting at 'first'. The
+// *_U pieces stand for their whole group, and switches always use the SW1 position here.
+static uint8_t Rotations(uint8_t piece, uint8_t* first)
+{
+  switch (piece) {
+  case P_VCC_U:        piece = P_VCC_T; break;
+  case P_GND_U:        piece = P_GND_LTR; break;
+  case P_SW1_U:
+  case P_SW2_U:
+  case P_SW3_U:        piece = P_SW1_BL; break;
+  case P_RLED_U:       piece = P_RLED_AB_CR; break;
+  case P_YLED_U:       piece = P_YLED_AL_CR; break;
+  case P_GLED_U:       piece = P_GLED_AB_CL; break;
+  case P_STRAIGHT_U:   piece = P_STRAIGHT_LR; break;
+  case P_DBL_CORNER_U: piece = P_DBL_CORNER_TL_BR; break;
+  case P_CORNER_U:     piece = P_CORNER_BL; break;
+  case P_TPIECE_U:     piece = P_TPIECE_RBL; break;
+  case P_BRIDGE_U:     piece = P_BRIDGE1_TB_LR; break;
+  }
+  if (IsSwitch(piece))
+    piece = P_SW1_BL + ((piece - P_SW1_BL) & 3);
+
+  if (piece >= P_VCC_T && piece <= P_GLED_AR_CB) {
+    *first = ((piece - P_VCC_T) & ~3) + P_VCC_T;
+    return 4;
+  }
+  if (piece >= P_CORNER_BL && piece <= P_TPIECE_TRB) {
+    *first = ((piece - P_CORNER_BL) & ~3) + P_CORNER_BL;
+    return 4;
+  }
+  if (piece >= P_STRAIGHT_LR && piece <= P_BRIDGE2_TB_LR && piece != P_BLOCKER) {
+    *first = ((piece - P_STRAIGHT_LR) & ~1) + P_STRAIGHT_LR; // straights, double corners, and bridges come in pairs
+    return 2;
+  }
+  *first = piece;
+  return 1;
+}
+
+// Whether two rotations of the same piece make no difference to the game. A switch
+// has to match in all three positions, since the search only places it in SW1.
+static bool Equivalent(uint8_t a, uint8_t b)
+{
+  for (uint8_t p = 0; p < (IsSwitch(a) ? 3 : 1); ++p)
+    if (Engine_EquivalentPiece(a + p * (P_SW2_BT - P_SW1_BL)) != Engine_EquivalentPiece(b + p * (P_SW2_BT - P_SW1_BL)))
+      return false;
+  return true;
+}
+
+// The rotations of a piece the search tries, and how many rotations each one stands for
+static uint8_t Orientations(uint8_t piece, bool reduce, uint8_t rotations[4], uint8_t weights[4])
+{
+  uint8_t first;
+  uint8_t count = Rotations(piece, &first);
+  uint8_t n = 0;
+  for (uint8_t r = 0; r < count; ++r) {
+    uint8_t j = 0;
+    while (reduce && j < n && !Equivalent(rotations[j], first + r))
+      ++j;
+    if (reduce && j < n) {
+      weights[j]++;
+    } else {
+      rotations[n] = first + r;
+      weights[n++] = 1;
+    }
+  }
+  return n;
+}
+
+static bool DecodeLevel(const uint8_t* data, uint8_t flags, LEVEL* level)
+{
+  bool reduce = (flags & SEARCH_REDUCE);
+  memset(level, 0, sizeof(*level));
+  level->flags = flags;
+  level->weight = 1;
+
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t piece = data[BOARD_OFFSET_IN_LEVEL + i];
+    if (piece == P_BLANK) {
+      level->kind[i] = CELL_OPEN;
+    } else if (piece >= P_VCC_U) {
+      level->kind[i] = CELL_ROTATE;
+      level->count[i] = Orientations(piece, reduce, level->rotations[i], level->rotationWeight[i]);
+      piece = level->rotations[i][0];
+      for (uint8_t r = 0; r < level->count[i]; ++r)
+        level->rotatePorts[i] |= Engine_MeetsRulesPorts(level->rotations[i][r]);
+      if (level->count[i] == 1) {
+        level->kind[i] = CELL_FIXED;
+        level->weight *= level->rotationWeight[i][0];
+      }
+    } else {
+      level->kind[i] = CELL_FIXED;
+    }
+    level->board[i] = piece;
+    if (level->kind[i] != CELL_FIXED)
+      level->order[level->orderCount++] = i;
+  }
+  for (int8_t i = level->orderCount - 1; i >= 0; --i)
+    level->openAfter[i] = level->openAfter[i + 1] + (level->kind[level->order[i]] == CELL_OPEN);
+
+  for (uint8_t i = 0; i < HAND_WIDTH * HAND_HEIGHT; ++i) {
+    uint8_t piece = data[HAND_OFFSET_IN_LEVEL + i];
+    if (piece == P_BLANK)
+      continue;
+    uint8_t t = level->tokens++;
+    level->tokenCount[t] = Orientations(piece, reduce, level->tokenRotations[t], level->tokenWeight[t]);
+    for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+      level->tokenPorts[t] |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+    level->tokenRoles[t] = Role(level->tokenRotations[t][0]);
+
+    // Placing n identical pieces in a fixed order skips the other n! - 1 orders
+    uint8_t same = NO_TOKEN;
+    uint8_t identical = 1;
+    for (uint8_t u = 0; reduce && u < t; ++u)
+      if (level->tokenRotations[u][0] == level->tokenRotations[t][0]) {
+        same = u;
+        identical++;
+      }
+    level->tokenSame[t] = same;
+    level->weight *= identical;
+  }
+
+  // The same goal states GoalStatesForCurrentLevel in circuit.c comes up with
+  level->hasSwitch = (data[GOAL_OFFSET_IN_LEVEL] == P_GOAL_SW1);
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p)
+    for (uint8_t i = 0; i < 3; ++i)
+      switch (data[GOAL_OFFSET_IN_LEVEL + p * GOAL_WIDTH + (level->hasSwitch ? 1 : 0) + i]) {
+      case P_GOAL_RLED_ON:
+        level->goalStates[p] |= R_BIT;
+        break;
+      case P_GOAL_YLED_ON:
+        level->goalStates[p] |= Y_BIT;
+        break;
+      case P_GOAL_GLED_ON:
+        level->goalStates[p] |= G_BIT;
+        break;
+      }
+  level->goalLeds = level->goalStates[0] | level->goalStates[1] | level->goalStates[2];
+
+  return level->tokens <= level->openAfter[0];
+}
+
+// What the pieces left in the hand could still do, for the squares that haven't been decided yet
+static void Spare(const LEVEL* level, const TASK* task, SPARE* spare)
+{
+  uint8_t remaining = 0;
+  spare->ports = 0;
+  spare->roles = 0;
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t))) {
+      spare->ports |= level->tokenPorts[t];
+      spare->roles |= level->tokenRoles[t];
+      remaining++;
+    }
+  spare->remaining = remaining;
+  spare->blankAllowed = (remaining < level->openAfter[task->depth]);
+}
+
+// The square on the given side of square c, or false if that's off the board
+static bool Neighbor(uint8_t c, uint8_t side, uint8_t* n)
+{
+  uint8_t x = c % BOARD_WIDTH;
+  uint8_t y = c / BOARD_WIDTH;
+  switch (side) {
+  case D_OUT_T: *n = c - BOARD_WIDTH; return y > 0;
+  case D_OUT_R: *n = c + 1;           return x < BOARD_WIDTH - 1;
+  case D_OUT_B: *n = c + BOARD_WIDTH; return y < BOARD_HEIGHT - 1;
+  default:      *n = c - 1;           return x > 0;
+  }
+}
+
+static uint8_t Opposite(uint8_t side)
+{
+  return ((side << 2) | (side >> 2)) & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+}
+
+// The sides square c might end up with a port on. Without propagation, a square that hasn't been decided
+// yet is assumed to end up facing every way, otherwise it's whatever could still be put there.
+static uint8_t Ports(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (task->decided & (1UL << c))
+    return Engine_MeetsRulesPorts(task->board[c]);
+  if (!(level->flags & SEARCH_PROPAGATE))
+    return D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L;
+  return (level->kind[c] == CELL_ROTATE) ? level->rotatePorts[c] : spare->ports;
+}
+
+// The sides of square c that have a neighbor that might face back at it
+static uint8_t ValidSides(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (Ports(level, task, n, spare) & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// Whether the piece on square c can still meet the rules (see Engine_PieceMeetsRules)
+static bool Fits(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t piece = task->board[c];
+  if (!Engine_MeetsRulesPorts(piece))
+    return true;
+  return Engine_PieceMeetsRules(piece, ValidSides(level, task, c, spare));
+}
+
+// Deciding square c can only take possibilities away from it and its decided neighbors
+static bool Consistent(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (!Fits(level, task, c, spare))
+    return false;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && !Fits(level, task, n, spare))
+      return false;
+  }
+  return true;
+}
+
+// The sides of square c whose neighbor might face back at it, given what each square might face its neighbors with
+static uint8_t Facing(const uint8_t ports[CELLS], uint8_t c)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (ports[n] & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// The sides that the pieces that could still go on undecided square c, and meet the rules there, have ports on.
+// Returns false if there aren't any, and the square can't be left blank either.
+static bool Narrow(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare, uint8_t ports[CELLS])
+{
+  uint8_t valid = Facing(ports, c);
+  uint8_t narrowed = 0;
+  bool any = false;
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      if (Engine_PieceMeetsRules(level->rotations[c][r], valid)) {
+        narrowed |= Engine_MeetsRulesPorts(level->rotations[c][r]);
+        any = true;
+      }
+  } else {
+    any = spare->blankAllowed;
+    for (uint8_t t = 0; t < level->tokens; ++t)
+      if (!(task->used & (1U << t)))
+        for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+          if (Engine_PieceMeetsRules(level->tokenRotations[t][r], valid)) {
+            narrowed |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+            any = true;
+          }
+  }
+  ports[c] = narrowed;
+  return any;
+}
+
+// Every LED the goal wants lit has to be able to connect to a VCC. Squares are joined wherever they might
+// face each other, so this only gives up once no way of filling in the rest of the board could connect them.
+static bool CanLight(const LEVEL* level, const TASK* task, const SPARE* spare, const uint8_t ports[CELLS])
+{
+  if (!level->goalLeds)
+    return true;
+
+  uint8_t roles[CELLS];
+  uint8_t stack[CELLS];
+  uint8_t top = 0;
+  uint32_t reached = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (task->decided & (1UL << c))
+      roles[c] = Role(task->board[c]);
+    else
+      roles[c] = (level->kind[c] == CELL_ROTATE) ? Role(level->rotations[c][0]) : spare->roles;
+    if (roles[c] & ROLE_VCC) {
+      reached |= (1UL << c);
+      stack[top++] = c;
+    }
+  }
+
+  uint8_t lit = 0;
+  while (top) {
+    uint8_t c = stack[--top];
+    lit |= roles[c];
+    for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+      uint8_t n;
+      if ((ports[c] & side) && Neighbor(c, side, &n) && !(reached & (1UL << n)) && (ports[n] & Opposite(side))) {
+        reached |= (1UL << n);
+        stack[top++] = n;
+      }
+    }
+  }
+  return (lit & level->goalLeds) == level->goalLeds;
+}
+
+// Forward checking: narrows down what every undecided square could still face its neighbors with, until
+// nothing changes, then makes sure every decided square can still meet the rules, that there are enough
+// pieces left in the hand for the blank squares that have to be filled in, and that the goal can still be lit
+static bool Propagate(const LEVEL* level, const TASK* task, const SPARE* spare)
+{
+  uint8_t ports[CELLS];
+  for (uint8_t c = 0; c < CELLS; ++c)
+    ports[c] = Ports(level, task, c, spare);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint8_t c = 0; c < CELLS; ++c)
+      if (!(task->decided & (1UL << c))) {
+        uint8_t before = ports[c];
+        if (!Narrow(level, task, c, spare, ports))
+          return false;
+        changed |= (ports[c] != before);
+      }
+  }
+
+  uint8_t mustFill = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (!(task->decided & (1UL << c))) {
+      if (level->kind[c] != CELL_OPEN)
+        continue;
+      // Left blank, this square would take away a port one of its decided neighbors needs
+      for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+        uint8_t n;
+        if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && (ports[n] & Opposite(side)) &&
+            !Engine_PieceMeetsRules(task->board[n], Facing(ports, n) & ~Opposite(side))) {
+          mustFill++;
+          break;
+        }
+      }
+    } else if (ports[c] && !Engine_PieceMeetsRules(task->board[c], Facing(ports, c))) {
+      return false;
+    }
+  }
+  if (mustFill > spare->remaining)
+    return false;
+
+  return CanLight(level, task, spare, ports);
+}
+
+
+// The LED states a complete board lights up in each switch position (just [0] without a switch), the same way
+// BoardChanged works them out. Returns false if it doesn't meet the rules, or has a short in every position.
+static bool Light(ENGINE* engine, uint8_t board[CELLS], bool hasSwitch, uint8_t states[3])
+{
+  const uint8_t (*rows)[BOARD_WIDTH] = (const uint8_t (*)[BOARD_WIDTH])board;
+  if (!Engine_PruneBoard(engine, rows, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY))
+    return false;
+
+  int8_t sw = -1;
+  if (hasSwitch) {
+    for (uint8_t i = 0; i < CELLS && sw == -1; ++i)
+      if (IsSwitch(board[i]))
+        sw = i;
+    if (sw == -1)
+      return false;
+  }
+
+  uint8_t original = (sw == -1) ? 0 : board[sw];
+  bool anyWithoutShort = false;
+  for (uint8_t p = 0; p < (hasSwitch ? 3 : 1); ++p) {
+    if (sw != -1)
+      board[sw] = P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((original - P_SW1_BL) & 3);
+    Engine_PruneBoard(engine, rows, PRUNEBOARD_FLAG_NORMAL);
+    Engine_UpdateNetlist(engine);
+    anyWithoutShort |= !Engine_IsShort(engine);
+    states[p] = Engine_ConsultOracle(Engine_PackNetlist(engine));
+  }
+  if (sw != -1)
+    board[sw] = original;
+  return anyWithoutShort;
+}
+
+static void Evaluate(SEARCH* s, TASK* task)
+{
+  const LEVEL* level = s->level;
+  uint8_t states[3];
+  if (!Light(s->engine, task->board, level->hasSwitch, states))
+    return;
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p)
+    if (states[p] != level->goalStates[p])
+      return;
+  if (++s->solutions > s->limit)
+    s->stopped = true;
+}
+
+static void Search(SEARCH* s, TASK* task);
+
+static void Try(SEARCH* s, TASK* task, uint8_t c, uint8_t piece, uint16_t used, uint8_t weight)
+{
+  const LEVEL* level = s->level;
+  if (++s->nodes > s->budget)
+    s->stopped = true;
+
+  uint16_t previouslyUsed = task->used;
+  uint32_t previousWeight = task->weight;
+  task->board[c] = piece;
+  task->decided |= (1UL << c);
+  task->used = used;
+  task->depth++;
+  task->weight *= weight;
+
+  SPARE spare;
+  Spare(level, task, &spare);
+  if (Consistent(level, task, c, &spare) && (!(level->flags & SEARCH_PROPAGATE) || Propagate(level, task, &spare))) {
+    if (task->depth == level->orderCount)
+      Evaluate(s, task);
+    else
+      Search(s, task);
+  }
+
+  task->weight = previousWeight;
+  task->depth--;
+  task->used = previouslyUsed;
+  task->decided &= ~(1UL << c);
+  task->board[c] = P_BLANK;
+}
+
+static void Search(SEARCH* s, TASK* task)
+{
+  const LEVEL* level = s->level;
+  uint8_t c = level->order[task->depth];
+
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c] && !s->stopped; ++r)
+      Try(s, task, c, level->rotations[c][r], task->used, level->rotationWeight[c][r]);
+    return;
+  }
+
+  // Every piece in the hand has to end up on the board, so only leave this square blank if there is room for them after it
+  uint8_t remaining = level->tokens - __builtin_popcount(task->used);
+  if (remaining < level->openAfter[task->depth])
+    Try(s, task, c, P_BLANK, task->used, 1);
+  if (remaining == 0)
+    return;
+
+  for (uint8_t t = 0; t < level->tokens && !s->stopped; ++t)
+    if (!(task->used & (1U << t)) && (level->tokenSame[t] == NO_TOKEN || (task->used & (1U << level->tokenSame[t]))))
+      for (uint8_t r = 0; r < level->tokenCount[t] && !s->stopped; ++r)
+        Try(s, task, c, level->tokenRotations[t][r], task->used | (1U << t), level->tokenWeight[t][r]);
+}
+
+// Counts the solutions of a level, up to one more than 'limit', within the node budget
+static void CountSolutions(ENGINE* engine, const uint8_t data[LEVEL_SIZE], uint64_t limit, SEARCH* s)
+{
+  LEVEL level;
+  bool feasible = DecodeLevel(data, SEARCH_REDUCE | SEARCH_PROPAGATE, &level);
+
+  TASK root;
+  memcpy(root.board, level.board, CELLS);
+  root.decided = 0;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if (level.kind[i] == CELL_FIXED)
+      root.decided |= (1UL << i);
+  root.used = 0;
+  root.depth = 0;
+  root.weight = 1;
+
+  // A locked piece surrounded by other locked pieces never gets checked by the search
+  SPARE spare;
+  Spare(&level, &root, &spare);
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if ((root.decided & (1UL << i)) && !Fits(&level, &root, i, &spare))
+      feasible = false;
+  if (!Propagate(&level, &root, &spare))
+    feasible = false;
+
+  memset(s, 0, sizeof(*s));
+  s->level = &level;
+  s->engine = engine;
+  s->budget = budget;
+  s->limit = limit;
+  if (!feasible)
+    return;
+  if (level.orderCount == 0)
+    Evaluate(s, &root);
+  else
+    Search(s, &root);
+  s->level = NULL;
+}
+
+// xorshift64, which gets stuck at 0, so every worker starts from somewhere else
+static uint64_t Random(WORKER* w)
+{
+  w->seed ^= w->seed << 13;
+  w->seed ^= w->seed >> 7;
+  w->seed ^= w->seed << 17;
+  return w->seed;
+}
+
+static uint32_t RandomBelow(WORKER* w, uint32_t n)
+{
+  return (uint32_t)((Random(w) >> 32) * n >> 32);
+}
+
+// The piece that stands for every rotation of a piece in the level definitions
+static uint8_t Unknown(uint8_t piece)
+{
+  if (IsSwitch(piece))
+    return P_SW1_U;
+  switch (Role(piece)) {
+  case ROLE_VCC: return P_VCC_U;
+  case R_BIT:    return P_RLED_U;
+  case Y_BIT:    return P_YLED_U;
+  case G_BIT:    return P_GLED_U;
+  }
+  if (IsGround(piece))
+    return P_GND_U;
+  if (piece == P_STRAIGHT_LR || piece == P_STRAIGHT_TB)
+    return P_STRAIGHT_U;
+  if (piece == P_DBL_CORNER_TL_BR || piece == P_DBL_CORNER_TR_BL)
+    return P_DBL_CORNER_U;
+  if (piece >= P_CORNER_BL && piece <= P_CORNER_BR)
+    return P_CORNER_U;
+  if (piece >= P_TPIECE_RBL && piece <= P_TPIECE_TRB)
+    return P_TPIECE_U;
+  if (piece == P_BRIDGE1_TB_LR || piece == P_BRIDGE2_TB_LR)
+    return P_BRIDGE_U;
+  return piece;
+}
+
+// A random circuit that has a piece on each square that meets the rules with the connections that square has
+static bool BuildCircuit(WORKER* w, uint8_t board[CELLS])
+{
+  uint8_t sides[CELLS] = { 0 };
+  uint8_t cells[CELLS];
+  uint8_t count = 0;
+  uint32_t chosen = 0;
+
+  uint8_t size = minPieces + RandomBelow(w, maxPieces - minPieces + 1);
+  cells[count++] = RandomBelow(w, CELLS);
+  chosen |= (1UL << cells[0]);
+  for (uint16_t attempts = 0; count < size && attempts < 1000; ++attempts) {
+    uint8_t c = cells[RandomBelow(w, count)];
+    uint8_t side = 1 << RandomBelow(w, 4);
+    uint8_t n;
+    if (!Neighbor(c, side, &n) || (chosen & (1UL << n)))
+      continue;
+    chosen |= (1UL << n);
+    cells[count++] = n;
+    sides[c] |= side;
+    sides[n] |= Opposite(side);
+  }
+  for (uint8_t i = 0; i < count; ++i)
+    for (uint8_t side = D_OUT_R; side <= D_OUT_B; side <<= 1) {
+      uint8_t n;
+      if (Neighbor(cells[i], side, &n) && (chosen & (1UL << n)) && !(sides[cells[i]] & side) && RandomBelow(w, 100) < LOOP_PERCENT) {
+        sides[cells[i]] |= side;
+        sides[n] |= Opposite(side);
+      }
+    }
+
+  memset(board, P_BLANK, CELLS);
+  uint8_t roles = 0;
+  bool haveGround = false;
+  bool haveSwitch = false;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t c = cells[i];
+    uint8_t options[P_BLOCKER];
+    uint8_t n = 0;
+    for (uint8_t piece = P_VCC_T; piece < P_BLOCKER; ++piece) {
+      // BoardChanged in circuit.c only keeps track of one VCC, GND, switch, and LED of each color
+      if (IsSwitch(piece) && (haveSwitch || piece > P_SW1_RB))
+        continue;
+      if ((Role(piece) & roles) || (IsGround(piece) && haveGround))
+        continue;
+      if ((Engine_MeetsRulesPorts(piece) & sides[c]) == sides[c] && Engine_PieceMeetsRules(piece, sides[c]))
+        options[n++] = piece;
+    }
+    if (!n)
+      return false;
+    board[c] = options[RandomBelow(w, n)];
+    roles |= Role(board[c]);
+    haveGround |= IsGround(board[c]);
+    haveSwitch |= IsSwitch(board[c]);
+  }
+  return (roles & ROLE_VCC) && (roles & (R_BIT | Y_BIT | G_BIT)) && haveGround;
+}
+
+// Whether a level, on the board and in the hand, has no more than one VCC, GND, switch, and LED of each color
+static bool IsLegal(const uint8_t data[LEVEL_SIZE])
+{
+  uint8_t seen = 0;
+  for (uint8_t i = 0; i < LEVEL_SIZE; ++i) {
+    if (i >= GOAL_OFFSET_IN_LEVEL && i < HAND_OFFSET_IN_LEVEL)
+      continue; // the goal has its own pieces
+    uint8_t piece = Unknown(data[i]);
+    if (piece == P_SW2_U || piece == P_SW3_U)
+      piece = P_SW1_U;
+    if (piece < P_VCC_U || piece > P_GLED_U)
+      continue;
+    if (seen & (1 << (piece - P_VCC_U)))
+      return false;
+    seen |= (uint8_t)(1 << (piece - P_VCC_U));
+  }
+  return true;
+}
+
+// Turns a circuit into a level that it solves
+static bool MakeLevel(WORKER* w, const uint8_t board[CELLS], bool hasSwitch, const uint8_t states[3], uint8_t data[LEVEL_SIZE])
+{
+  memset(data, 0, LEVEL_SIZE);
+  uint8_t hand[MAX_TOKENS];
+  uint8_t handCount = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    uint8_t piece = board[c];
+    uint32_t r = RandomBelow(w, 100);
+    if (piece == P_BLANK)
+      data[BOARD_OFFSET_IN_LEVEL + c] = (r < BLOCKER_PERCENT) ? P_BLOCKER : P_BLANK;
+    else if (r < HAND_PERCENT && handCount < MAX_TOKENS)
+      hand[handCount++] = Unknown(piece);
+    else if (r < HAND_PERCENT + ROTATE_PERCENT)
+      data[BOARD_OFFSET_IN_LEVEL + c] = Unknown(piece);
+    else
+      data[BOARD_OFFSET_IN_LEVEL + c] = piece;
+  }
+  if (!handCount)
+    return false;
+
+  // The hand in piece order, like the hand-made levels mostly are
+  for (uint8_t i = 1; i < handCount; ++i)
+    for (uint8_t j = i; j > 0 && hand[j - 1] > hand[j]; --j) {
+      uint8_t piece = hand[j];
+      hand[j] = hand[j - 1];
+      hand[j - 1] = piece;
+    }
+  memcpy(&data[HAND_OFFSET_IN_LEVEL], hand, handCount);
+
+  // The same goal layout GoalStatesForCurrentLevel in circuit.c reads back
+  const uint8_t bits[3] = { R_BIT, Y_BIT, G_BIT };
+  if (hasSwitch) {
+    for (uint8_t p = 0; p < 3; ++p) {
+      data[GOAL_OFFSET_IN_LEVEL + p * GOAL_WIDTH] = P_GOAL_SW1 + p;
+      for (uint8_t i = 0; i < 3; ++i)
+        data[GOAL_OFFSET_IN_LEVEL + p * GOAL_WIDTH + 1 + i] = ((states[p] & bits[i]) ? P_GOAL_RLED_ON : P_GOAL_RLED_OFF) + i;
+    }
+  } else {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < 3; ++i)
+      if (states[0] & bits[i])
+        data[GOAL_OFFSET_IN_LEVEL + n++] = P_GOAL_RLED_ON + i;
+  }
+  return true;
+}
+
+static uint8_t Candidate(WORKER* w, PUZZLE* puzzle)
+{
+  uint8_t board[CELLS];
+  if (!BuildCircuit(w, board))
+    return OUTCOME_UNBUILT;
+
+  bool hasSwitch = false;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    hasSwitch |= IsSwitch(board[i]);
+  uint8_t states[3] = { 0 };
+  if (!Light(&w->engine, board, hasSwitch, states) || !(states[0] | states[1] | states[2]))
+    return OUTCOME_DARK;
+  if (hasSwitch && states[0] == states[1] && states[1] == states[2])
+    return OUTCOME_DARK;
+
+  if (!MakeLevel(w, board, hasSwitch, states, puzzle->data))
+    return OUTCOME_UNBUILT;
+  if (!IsLegal(puzzle->data))
+    return OUTCOME_ILLEGAL;
+
+  SEARCH s;
+  CountSolutions(&w->engine, puzzle->data, target, &s);
+  puzzle->nodes = s.nodes;
+  if (s.nodes > budget)
+    return OUTCOME_BUDGET;
+  if (!s.solutions)
+    return OUTCOME_MISMATCH;
+  if (s.solutions != target)
+    return OUTCOME_SOLUTIONS;
+  if (s.nodes < minNodes)
+    return OUTCOME_EASY;
+  return OUTCOME_ACCEPTED;
+}
+
+static void* Work(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  PUZZLE puzzle;
+  while (!__atomic_load_n(&done, __ATOMIC_RELAXED)) {
+    uint8_t outcome = Candidate(w, &puzzle);
+    if (outcome == OUTCOME_ACCEPTED) {
+      pthread_mutex_lock(&puzzleLock);
+      for (uint32_t i = 0; i < puzzleCount && outcome == OUTCOME_ACCEPTED; ++i)
+        if (!memcmp(puzzles[i].data, puzzle.data, LEVEL_SIZE))
+          outcome = OUTCOME_DUPLICATE;
+      if (outcome == OUTCOME_ACCEPTED && puzzleCount < wanted) {
+        puzzles[puzzleCount++] = puzzle;
+        fprintf(stderr, "Found %u of %u, %lu nodes\n", puzzleCount, wanted, puzzle.nodes);
+        if (puzzleCount == wanted)
+          __atomic_store_n(&done, true, __ATOMIC_RELAXED);
+      }
+      pthread_mutex_unlock(&puzzleLock);
+    }
+    w->outcomes[outcome]++;
+  }
+  return NULL;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* pieceNames[] = {
+  "0",
+  "P_VCC_T", "P_VCC_R", "P_VCC_B", "P_VCC_L",
+  "P_GND_LTR", "P_GND_TRB", "P_GND_RBL", "P_GND_BLT",
+  "P_SW1_BL", "P_SW1_LT", "P_SW1_TR", "P_SW1_RB",
+  "P_RLED_AB_CR", "P_RLED_AL_CB", "P_RLED_AT_CL", "P_RLED_AR_CT",
+  "P_SW2_BT", "P_SW2_LR", "P_SW2_TB", "P_SW2_RL",
+  "P_YLED_AL_CR", "P_YLED_AT_CB", "P_YLED_AR_CL", "P_YLED_AB_CT",
+  "P_SW3_BR", "P_SW3_LB", "P_SW3_TL", "P_SW3_RT",
+  "P_GLED_AB_CL", "P_GLED_AL_CT", "P_GLED_AT_CR", "P_GLED_AR_CB",
+  "P_STRAIGHT_LR", "P_STRAIGHT_TB",
+  "P_DBL_CORNER_TL_BR", "P_DBL_CORNER_TR_BL",
+  "P_CORNER_BL", "P_CORNER_TL", "P_CORNER_TR", "P_CORNER_BR",
+  "P_TPIECE_RBL", "P_TPIECE_BLT", "P_TPIECE_LTR", "P_TPIECE_TRB",
+  "P_BRIDGE1_TB_LR", "P_BRIDGE2_TB_LR",
+  "P_BLOCKER",
+  "P_VCC_U", "P_GND_U", "P_SW1_U", "P_RLED_U", "P_SW2_U", "P_YLED_U", "P_SW3_U", "P_GLED_U",
+  "P_STRAIGHT_U", "P_DBL_CORNER_U", "P_CORNER_U", "P_TPIECE_U", "P_BRIDGE_U",
+};
+
+static const char* goalNames[] = {
+  "0",
+  "P_GOAL_RLED_OFF", "P_GOAL_YLED_OFF", "P_GOAL_GLED_OFF",
+  "P_GOAL_RLED_ON", "P_GOAL_YLED_ON", "P_GOAL_GLED_ON",
+  "P_GOAL_SW1", "P_GOAL_SW2", "P_GOAL_SW3",
+};
+
+static void PrintRows(const uint8_t* data, uint8_t width, uint8_t height, const char* names[])
+{
+  for (uint8_t y = 0; y < height; ++y) {
+    printf(" ");
+    for (uint8_t x = 0; x < width; ++x)
+      printf(" %s,", names[data[y * width + x]]);
+    printf("\n");
+  }
+}
+
+static int CompareNodes(const void* a, const void* b)
+{
+  uint64_t x = ((const PUZZLE*)a)->nodes;
+  uint64_t y = ((const PUZZLE*)b)->nodes;
+  return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t seed = (uint64_t)time(NULL);
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t"))
+      cpus = atol(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-n"))
+      wanted = strtoul(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-u"))
+      target = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-b"))
+      budget = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-e"))
+      minNodes = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-p"))
+      maxPieces = atoi(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-s"))
+      seed = strtoull(argv[2], NULL, 0);
+    else
+      break;
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc > 1 || wanted < 1 || target < 1 || maxPieces < minPieces || maxPieces > CELLS) {
+    fprintf(stderr, "Usage: %s [-t threads] [-n puzzles] [-u solutions] [-b budget] [-e min nodes] [-p max pieces] [-s seed]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  puzzles = malloc(wanted * sizeof(PUZZLE));
+  if (!puzzles) {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
+  fprintf(stderr, "Seed %lu\n", seed);
+
+  double start = Now();
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    workers[t].seed = (seed + t + 1) * 0x9E3779B97F4A7C15ULL; // xorshift gets stuck at 0
+    if (pthread_create(&workers[t].thread, NULL, Work, &workers[t])) {
+      perror("pthread_create");
+      return EXIT_FAILURE;
+    }
+  }
+  for (uint32_t t = 0; t < workerCount; ++t)
+    pthread_join(workers[t].thread, NULL);
+  double elapsed = Now() - start;
+
+  // Easiest first, the way the levels go
+  qsort(puzzles, puzzleCount, sizeof(PUZZLE), CompareNodes);
+  for (uint32_t i = 0; i < puzzleCount; ++i) {
+    printf("  // GENERATED %02u (%lu nodes to search)\n", i + 1, puzzles[i].nodes);
+    printf("  // Puzzle\n");
+    PrintRows(&puzzles[i].data[BOARD_OFFSET_IN_LEVEL], BOARD_WIDTH, BOARD_HEIGHT, pieceNames);
+    printf("  // Goal\n");
+    PrintRows(&puzzles[i].data[GOAL_OFFSET_IN_LEVEL], GOAL_WIDTH, GOAL_HEIGHT, goalNames);
+    printf("  // Hand\n");
+    PrintRows(&puzzles[i].data[HAND_OFFSET_IN_LEVEL], HAND_WIDTH, HAND_HEIGHT, pieceNames);
+    printf("\n");
+  }
+
+  const char* outcomeNames[OUTCOMES] = { "unbuildable", "dark", "wrong number of solutions", "over budget",
+                                         "too easy", "duplicates", "mismatches", "illegal", "accepted" };
+  uint64_t outcomes[OUTCOMES] = { 0 };
+  uint64_t candidates = 0;
+  for (uint32_t t = 0; t < workerCount; ++t)
+    for (uint8_t o = 0; o < OUTCOMES; ++o) {
+      outcomes[o] += workers[t].outcomes[o];
+      candidates += workers[t].outcomes[o];
+    }
+  fprintf(stderr, "\n%lu candidates on %u threads in %.2f s:\n", candidates, workerCount, elapsed);
+  for (uint8_t o = 0; o < OUTCOMES; ++o)
+    fprintf(stderr, "  %lu %s\n", outcomes[o], outcomeNames[o]);
+  fprintf(stderr, "%.0f puzzles per hour\n", (elapsed > 0) ? puzzleCount * 3600 / elapsed : 0.0);
+
+  free(puzzles);
+  return (outcomes[OUTCOME_MISMATCH] || outcomes[OUTCOME_ILLEGAL]) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+
+/* Checks the rules in Engine_EvaluateLeds against the oracle table,
+   so either one can be shipped. Every one of the 2^27 packed
+   netlists is run through both Engine_ConsultOracle (the table) and
+   Engine_EvaluateLeds, split across one thread per CPU, and any
+   netlist in the table that the rules disagree with is printed.
+
+   Example:
+     circuit/ledcheck$ ./main */
+
+// (under another name, since engine.c may include the same table)
+#define sorted_netlists_and_led_states ledcheck_netlists_and_led_states
+#include "../oracle2/sorted_netlists_and_led_states.inc"
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+#define NETLIST_COUNT (NETLIST_NETLIST_MASK + 1UL)
+#define CHUNK_SIZE    (1UL << 16)
+#define MAX_THREADS   256
+#define MAX_REPORTED  16
+
+struct CHECK;
+typedef struct CHECK CHECK;
+
+struct CHECK {
+  uint32_t tableHits;    // netlists the table has an entry for
+  uint32_t disagree;     // ... and the rules come up with different LED states
+  uint32_t rulesOnly;    // netlists that only the rules light up
+  uint32_t ledCount[8];  // how many netlists the rules give each combination of R_BIT | Y_BIT | G_BIT
+};
+
+static uint32_t nextChunk = 0;
+static pthread_mutex_t reportLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void* CheckChunks(void* arg)
+{
+  CHECK* check = (CHECK*)arg;
+  for (;;) {
+    uint32_t first = __atomic_fetch_add(&nextChunk, CHUNK_SIZE, __ATOMIC_RELAXED);
+    if (first >= NETLIST_COUNT)
+      break;
+
+    for (uint32_t nl = first; nl < first + CHUNK_SIZE; ++nl) {
+      uint8_t table = Engine_ConsultOracle(nl);
+      uint8_t rules = Engine_EvaluateLeds(nl);
+      check->ledCount[rules]++;
+      if (table) {
+        check->tableHits++;
+        if (table != rules) {
+          pthread_mutex_lock(&reportLock);
+          if (check->disagree < MAX_REPORTED)
+            printf("0x%08x table %u rules %u\n", nl, table, rules);
+          pthread_mutex_unlock(&reportLock);
+          check->disagree++;
+        }
+      } else if (rules) {
+        check->rulesOnly++;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  (void)argc;
+  (void)argv;
+
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t threadCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+
+  pthread_t threads[MAX_THREADS];
+  CHECK checks[MAX_THREADS];
+  memset(checks, 0, sizeof(checks));
+  for (uint32_t t = 0; t < threadCount; ++t)
+    if (pthread_create(&threads[t], NULL, CheckChunks, &checks[t])) {
+      perror("pthread_create");
+      return EXIT_FAILURE;
+    }
+
+  CHECK total;
+  memset(&total, 0, sizeof(total));
+  for (uint32_t t = 0; t < threadCount; ++t) {
+    pthread_join(threads[t], NULL);
+    total.tableHits += checks[t].tableHits;
+    total.disagree += checks[t].disagree;
+    total.rulesOnly += checks[t].rulesOnly;
+    for (uint8_t i = 0; i < 8; ++i)
+      total.ledCount[i] += checks[t].ledCount[i];
+  }
+
+  // Every entry in the table has at least one LED on, so each of them should have been a hit
+  bool allEntriesHit = (total.tableHits == NELEMS(sorted_netlists_and_led_states));
+
+  printf("\nChecked %lu netlists using %u threads\n", NETLIST_COUNT, threadCount);
+  printf("Table entries: %zu Hits: %u Disagree: %u\n", NELEMS(sorted_netlists_and_led_states), total.tableHits, total.disagree);
+  printf("Netlists only the rules light up: %u\n", total.rulesOnly);
+  for (uint8_t i = 1; i < 8; ++i)
+    printf("  %c%c%c: %u\n", (i & R_BIT) ? 'R' : '-', (i & Y_BIT) ? 'Y' : '-', (i & G_BIT) ? 'G' : '-', total.ledCount[i]);
+  puts((allEntriesHit && !total.disagree) ? "\nThe rules agree with every entry in the table\n" : "\nFAILED\n");
+
+  return (allEntriesHit && !total.disagree) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+/*
+
+  bptree+debug.c
+
+  Adds a method to the B+ Tree implementation that writes the tree
+  to a DOT file, with one record per node holding its keys (in hex),
+  an edge to each child, and a dashed edge from each leaf to the next
+  one.
+
+  Copyright 2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#include <inttypes.h>
+
+#include "bptree+debug.h"
+
+static void PrintDotAux(bptree_t *self, void *node, unsigned int height, FILE *stream) {
+  if (!height) {
+    bptree_leaf_t *leaf = node;
+    fprintf(stream, "    \"%p\" [label=\"", node);
+    for (unsigned int i = 0; i < leaf->count; ++i)
+      fprintf(stream, "%s%08" PRIx32, i ? "|" : "", leaf->keys[i]);
+    fprintf(stream, "\"];\n");
+    if (leaf->next)
+      fprintf(stream, "    \"%p\" -> \"%p\" [style=dashed constraint=false];\n", node, (void *)leaf->next);
+    return;
+  }
+
+  bptree_inner_t *inner = node;
+  fprintf(stream, "    \"%p\" [label=\"", node);
+  for (unsigned int i = 0; i < inner->count; ++i)
+    fprintf(stream, "%s%08" PRIx32, i ? "|" : "", inner->keys[i]);
+  fprintf(stream, "\" style=filled fillcolor=lightgray];\n");
+  for (unsigned int i = 0; i <= inner->count; ++i) {
+    fprintf(stream, "    \"%p\" -> \"%p\";\n", node, inner->children[i]);
+    PrintDotAux(self, inner->children[i], height - 1, stream);
+  }
+}
+
+void bptree_print_dot(bptree_t *self, FILE *stream) {
+  fprintf(stream, "digraph bptree {\n    node [shape=record fontname=mono];\n");
+  if (self->root)
+    PrintDotAux(self, self->root, self->height, stream);
+  fprintf(stream, "}\n");
+}
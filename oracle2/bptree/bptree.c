@@ -0,0 +1,286 @@
+/*
+
+  bptree.c
+
+  Implements an ordered set of 32 bit values as a B+ Tree, for sets
+  that are too big for one node per key (see rbtree.h) to stay out of
+  the cache misses. Every node is BPTREE_NODE_BYTES long and aligned to
+  its size, so it covers whole cache lines, and the keys in each node
+  are searched with a fixed length loop that counts the keys below the
+  one being looked for, which the compiler turns into SIMD compares.
+
+  Values are ordered and compared on (value & mask), so bits outside
+  of the mask ride along, the same way netlist_node_compare ignores
+  the LED states of a netlist. The methods follow rbtree.h and
+  rbtree+setinsert.h: a value in the set is referred to by a pointer
+  to it inside its leaf, bptree_minimum and bptree_successor return
+  NULL at the end of the set, and bptree_setinsert silently discards
+  duplicates. Any insert may move values around, so it invalidates
+  every pointer into the set.
+
+  Copyright 2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bptree.h"
+
+_Static_assert(sizeof(bptree_leaf_t) == BPTREE_NODE_BYTES, "a leaf has to fill its node");
+_Static_assert(sizeof(bptree_inner_t) == BPTREE_NODE_BYTES, "an inner node has to fill its node");
+
+// How many of the first count keys are below k. The loop always runs
+// over the whole node, so it vectorizes without a scalar tail.
+static inline unsigned int RankLeaf(const bptree_leaf_t *leaf, uint32_t mask, uint32_t k) {
+  unsigned int rank = 0;
+  for (unsigned int i = 0; i < BPTREE_LEAF_KEYS; ++i)
+    rank += (i < leaf->count) & ((leaf->keys[i] & mask) < k);
+  return rank;
+}
+
+// Which child k belongs in, the number of separators at or below it
+static inline unsigned int RankInner(const bptree_inner_t *inner, uint32_t k) {
+  unsigned int rank = 0;
+  for (unsigned int i = 0; i < BPTREE_INNER_KEYS; ++i)
+    rank += (i < inner->count) & (inner->keys[i] <= k);
+  return rank;
+}
+
+static void *NewNode(bptree_t *self) {
+  void *node = aligned_alloc(BPTREE_NODE_BYTES, BPTREE_NODE_BYTES);
+  if (node) {
+    memset(node, 0, BPTREE_NODE_BYTES);
+    self->nodes++;
+  }
+  return node;
+}
+
+static void FreeNodes(void *node, unsigned int height) {
+  if (height) {
+    bptree_inner_t *inner = node;
+    for (unsigned int i = 0; i <= inner->count; ++i)
+      FreeNodes(inner->children[i], height - 1);
+  }
+  free(node);
+}
+
+static bptree_leaf_t *FindLeaf(bptree_t *self, uint32_t k) {
+  void *node = self->root;
+  for (unsigned int level = self->height; level; --level) {
+    bptree_inner_t *inner = node;
+    node = inner->children[RankInner(inner, k)];
+  }
+  return node;
+}
+
+void bptree_init(bptree_t *self, uint32_t mask) {
+  self->root = 0;
+  self->height = 0;
+  self->mask = mask;
+  self->count = 0;
+  self->nodes = 0;
+}
+
+void bptree_destroy(bptree_t *self) {
+  if (self->root)
+    FreeNodes(self->root, self->height);
+  memset(self, 0, sizeof(bptree_t));
+}
+
+uint32_t *bptree_search(bptree_t *self, uint32_t key) {
+  if (!self->root)
+    return 0;
+  uint32_t k = key & self->mask;
+  bptree_leaf_t *leaf = FindLeaf(self, k);
+  unsigned int i = RankLeaf(leaf, self->mask, k);
+  if (i < leaf->count && (leaf->keys[i] & self->mask) == k)
+    return &leaf->keys[i];
+  return 0;
+}
+
+// Returns 1 if the value was inserted, 0 if an equal one was already
+// there, or -1 if it ran out of memory (the set is left as it was)
+int bptree_setinsert(bptree_t *self, uint32_t value) {
+  uint32_t k = value & self->mask;
+  if (!self->root) {
+    bptree_leaf_t *leaf = NewNode(self);
+    if (!leaf)
+      return -1;
+    leaf->keys[0] = value;
+    leaf->count = 1;
+    self->root = leaf;
+    self->count = 1;
+    return 1;
+  }
+
+  bptree_inner_t *path[BPTREE_MAX_HEIGHT];
+  unsigned int slots[BPTREE_MAX_HEIGHT];
+  void *node = self->root;
+  for (unsigned int level = 0; level < self->height; ++level) {
+    bptree_inner_t *inner = node;
+    path[level] = inner;
+    slots[level] = RankInner(inner, k);
+    node = inner->children[slots[level]];
+  }
+
+  bptree_leaf_t *leaf = node;
+  unsigned int i = RankLeaf(leaf, self->mask, k);
+  if (i < leaf->count && (leaf->keys[i] & self->mask) == k)
+    return 0;
+
+  if (leaf->count < BPTREE_LEAF_KEYS) {
+    memmove(&leaf->keys[i + 1], &leaf->keys[i], (leaf->count - i) * sizeof(uint32_t));
+    leaf->keys[i] = value;
+    leaf->count++;
+    self->count++;
+    return 1;
+  }
+
+  // Every node that splits on the way up needs a new sibling, and the root needs a new parent
+  unsigned int splits = 1;
+  while (splits <= self->height && path[self->height - splits]->count == BPTREE_INNER_KEYS)
+    splits++;
+  if (splits > self->height && self->height + 1 >= BPTREE_MAX_HEIGHT)
+    return -1;
+  void *spare[BPTREE_MAX_HEIGHT + 1];
+  unsigned int needed = splits + (splits > self->height);
+  for (unsigned int n = 0; n < needed; ++n)
+    if (!(spare[n] = NewNode(self))) {
+      while (n--) {
+        free(spare[n]);
+        self->nodes--;
+      }
+      return -1;
+    }
+  unsigned int used = 0;
+
+  // Split the leaf in half, and put the value in whichever half it belongs in
+  bptree_leaf_t *right = spare[used++];
+  unsigned int half = BPTREE_LEAF_KEYS / 2;
+  right->count = BPTREE_LEAF_KEYS - half;
+  memcpy(right->keys, &leaf->keys[half], right->count * sizeof(uint32_t));
+  leaf->count = half;
+  right->next = leaf->next;
+  leaf->next = right;
+  bptree_leaf_t *target = (i <= half) ? leaf : right;
+  if (target == right)
+    i -= half;
+  memmove(&target->keys[i + 1], &target->keys[i], (target->count - i) * sizeof(uint32_t));
+  target->keys[i] = value;
+  target->count++;
+  self->count++;
+
+  uint32_t separator = right->keys[0] & self->mask;
+  void *child = right;
+  for (unsigned int level = self->height; level--;) {
+    bptree_inner_t *inner = path[level];
+    unsigned int slot = slots[level];
+    if (inner->count < BPTREE_INNER_KEYS) {
+      memmove(&inner->keys[slot + 1], &inner->keys[slot], (inner->count - slot) * sizeof(uint32_t));
+      memmove(&inner->children[slot + 2], &inner->children[slot + 1], (inner->count - slot) * sizeof(void *));
+      inner->keys[slot] = separator;
+      inner->children[slot + 1] = child;
+      inner->count++;
+      return 1;
+    }
+
+    // Lay out the full node plus the new separator, and move the upper half into a sibling
+    uint32_t keys[BPTREE_INNER_KEYS + 1];
+    void *children[BPTREE_INNER_KEYS + 2];
+    memcpy(keys, inner->keys, slot * sizeof(uint32_t));
+    keys[slot] = separator;
+    memcpy(&keys[slot + 1], &inner->keys[slot], (BPTREE_INNER_KEYS - slot) * sizeof(uint32_t));
+    memcpy(children, inner->children, (slot + 1) * sizeof(void *));
+    children[slot + 1] = child;
+    memcpy(&children[slot + 2], &inner->children[slot + 1], (BPTREE_INNER_KEYS - slot) * sizeof(void *));
+
+    bptree_inner_t *sibling = spare[used++];
+    unsigned int middle = (BPTREE_INNER_KEYS + 1) / 2;
+    inner->count = middle;
+    memcpy(inner->keys, keys, middle * sizeof(uint32_t));
+    memcpy(inner->children, children, (middle + 1) * sizeof(void *));
+    sibling->count = BPTREE_INNER_KEYS - middle;
+    memcpy(sibling->keys, &keys[middle + 1], sibling->count * sizeof(uint32_t));
+    memcpy(sibling->children, &children[middle + 1], (sibling->count + 1) * sizeof(void *));
+    separator = keys[middle];
+    child = sibling;
+  }
+
+  bptree_inner_t *root = spare[used++];
+  root->count = 1;
+  root->keys[0] = separator;
+  root->children[0] = self->root;
+  root->children[1] = child;
+  self->root = root;
+  self->height++;
+  return 1;
+}
+
+uint32_t *bptree_minimum(bptree_t *self) {
+  if (!self->root)
+    return 0;
+  void *node = self->root;
+  for (unsigned int level = self->height; level; --level)
+    node = ((bptree_inner_t *)node)->children[0];
+  return ((bptree_leaf_t *)node)->keys;
+}
+
+uint32_t *bptree_maximum(bptree_t *self) {
+  if (!self->root)
+    return 0;
+  void *node = self->root;
+  for (unsigned int level = self->height; level; --level) {
+    bptree_inner_t *inner = node;
+    node = inner->children[inner->count];
+  }
+  bptree_leaf_t *leaf = node;
+  return &leaf->keys[leaf->count - 1];
+}
+
+// Every leaf is aligned to its size, so the leaf a value is in comes from its address
+uint32_t *bptree_successor(bptree_t *self, uint32_t *x) {
+  (void)self;
+  bptree_leaf_t *leaf = (bptree_leaf_t *)((uintptr_t)x & ~(uintptr_t)(BPTREE_NODE_BYTES - 1));
+  if (x + 1 < &leaf->keys[leaf->count])
+    return x + 1;
+  leaf = leaf->next;
+  return leaf ? leaf->keys : 0;
+}
+
+void bptree_inorderwalk(bptree_t *self,
+                        void (*ApplyFunc)(uint32_t *, void *),
+                        void *context) {
+  if (!self->root)
+    return;
+  void *node = self->root;
+  for (unsigned int level = self->height; level; --level)
+    node = ((bptree_inner_t *)node)->children[0];
+  for (bptree_leaf_t *leaf = node; leaf; leaf = leaf->next)
+    for (unsigned int i = 0; i < leaf->count; ++i)
+      ApplyFunc(&leaf->keys[i], context);
+}
@@ -0,0 +1,94 @@
+/*
+
+  bptree.h
+
+  Implements an ordered set of 32 bit values as a B+ Tree, for sets
+  that are too big for one node per key (see rbtree.h) to stay out of
+  the cache misses. Every node is BPTREE_NODE_BYTES long and aligned to
+  its size, so it covers whole cache lines, and the keys in each node
+  are searched with a fixed length loop that counts the keys below the
+  one being looked for, which the compiler turns into SIMD compares.
+
+  Values are ordered and compared on (value & mask), so bits outside
+  of the mask ride along, the same way netlist_node_compare ignores
+  the LED states of a netlist. The methods follow rbtree.h and
+  rbtree+setinsert.h: a value in the set is referred to by a pointer
+  to it inside its leaf, bptree_minimum and bptree_successor return
+  NULL at the end of the set, and bptree_setinsert silently discards
+  duplicates. Any insert may move values around, so it invalidates
+  every pointer into the set.
+
+  Copyright 2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BPTREE_NODE_BYTES 256
+#define BPTREE_LEAF_KEYS ((BPTREE_NODE_BYTES - 16) / sizeof(uint32_t))
+#define BPTREE_INNER_KEYS ((BPTREE_NODE_BYTES - 16) / (sizeof(uint32_t) + sizeof(void *)))
+#define BPTREE_MAX_HEIGHT 16
+
+typedef struct _bptree_leaf_t bptree_leaf_t;
+struct _bptree_leaf_t {
+  uint32_t count;
+  uint32_t padding;
+  bptree_leaf_t *next;
+  uint32_t keys[BPTREE_LEAF_KEYS];
+} __attribute__ ((aligned(BPTREE_NODE_BYTES)));
+
+// A separator is the smallest masked key in the child to its right
+typedef struct _bptree_inner_t bptree_inner_t;
+struct _bptree_inner_t {
+  uint32_t count;
+  uint32_t keys[BPTREE_INNER_KEYS];
+  void *children[BPTREE_INNER_KEYS + 1];
+} __attribute__ ((aligned(BPTREE_NODE_BYTES)));
+
+typedef struct _bptree_t bptree_t;
+struct _bptree_t {
+  void *root;
+  unsigned int height;  // inner levels above the leaves
+  uint32_t mask;
+  size_t count;
+  size_t nodes;
+};
+
+void bptree_init(bptree_t *self, uint32_t mask);
+void bptree_destroy(bptree_t *self);
+uint32_t *bptree_search(bptree_t *self, uint32_t key);
+int bptree_setinsert(bptree_t *self, uint32_t value);
+uint32_t *bptree_minimum(bptree_t *self);
+uint32_t *bptree_maximum(bptree_t *self);
+uint32_t *bptree_successor(bptree_t *self, uint32_t *x);
+
+void bptree_inorderwalk(bptree_t *self,
+                        void (*ApplyFunc)(uint32_t *, void *),
+                        void *context);
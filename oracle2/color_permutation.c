@@ -0,0 +1,46 @@
+#include "color_permutation.h"
+#include "../engine/packed_netlist.h"
+
+// The anode of each color is its cathode minus 1
+static uint8_t ColorPermutation_Node(const uint8_t colors[3], uint8_t node)
+{
+  if (node < NL_RA)
+    return node; // VCC and GND don't have a color
+  return NL_RA + 2 * colors[(node - NL_RA) / 2] + (node - NL_RA) % 2;
+}
+
+void ColorPermutation_Init(COLOR_PERMUTATION* p, uint8_t red, uint8_t yellow, uint8_t green)
+{
+  p->colors[COLOR_RED] = red;
+  p->colors[COLOR_YELLOW] = yellow;
+  p->colors[COLOR_GREEN] = green;
+
+  // Where each bit of the word ends up
+  uint8_t target[32];
+  for (uint8_t i = 0; i < 32; ++i)
+    target[i] = i;
+  for (uint8_t a = 0; a < NL_COUNT; ++a)
+    for (uint8_t b = a + 1; b < NL_COUNT; ++b)
+      target[NETLIST_BIT_INDEX(a, b)] = NETLIST_BIT_INDEX(ColorPermutation_Node(p->colors, a), ColorPermutation_Node(p->colors, b));
+  for (uint8_t c = 0; c < 3; ++c)
+    target[29 + c] = 29 + p->colors[c]; // NETLIST_R_ON, NETLIST_Y_ON, NETLIST_G_ON
+
+  for (uint8_t k = 0; k < 4; ++k)
+    for (uint16_t v = 0; v < 256; ++v) {
+      uint32_t bits = 0;
+      for (uint8_t j = 0; j < 8; ++j)
+        if (v & (1 << j))
+          bits |= (uint32_t)1 << target[8 * k + j];
+      p->bytes[k][v] = bits;
+    }
+}
+
+void ColorPermutation_InitAll(COLOR_PERMUTATION p[COLOR_PERMUTATIONS])
+{
+  ColorPermutation_Init(&p[0], COLOR_RED, COLOR_YELLOW, COLOR_GREEN);
+  ColorPermutation_Init(&p[1], COLOR_YELLOW, COLOR_RED, COLOR_GREEN);
+  ColorPermutation_Init(&p[2], COLOR_GREEN, COLOR_YELLOW, COLOR_RED);
+  ColorPermutation_Init(&p[3], COLOR_RED, COLOR_GREEN, COLOR_YELLOW);
+  ColorPermutation_Init(&p[4], COLOR_GREEN, COLOR_RED, COLOR_YELLOW);
+  ColorPermutation_Init(&p[5], COLOR_YELLOW, COLOR_GREEN, COLOR_RED);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Renaming the LED colors turns one netlist into another one that
+   lights up the same way, just with the colors renamed. There are 6
+   ways to order red, yellow, and green, and each of them is a fixed
+   permutation of the 32 bits of a packed netlist and its LED states:
+   the pair bits follow their nodes (NL_RA..NL_GC), the LED state bits
+   follow their colors, and everything else stays put.
+
+   Each permutation is built once into one lookup table per byte of
+   the word, so permuting a word is 4 lookups ORed together, whether
+   it's one word at a time or a whole array of them. */
+
+#define COLOR_PERMUTATIONS 6
+#define COLOR_RED    0
+#define COLOR_YELLOW 1
+#define COLOR_GREEN  2
+
+struct COLOR_PERMUTATION;
+typedef struct COLOR_PERMUTATION COLOR_PERMUTATION;
+
+struct COLOR_PERMUTATION {
+  uint8_t colors[3];      // the color that red, yellow, and green each turn into
+  uint32_t bytes[4][256]; // the permuted bits for each value of each byte of the word
+};
+
+// Builds the tables for turning red, yellow, and green into the given colors
+void ColorPermutation_Init(COLOR_PERMUTATION* p, uint8_t red, uint8_t yellow, uint8_t green);
+
+// All 6 orderings of the colors, starting with the one that leaves them alone
+void ColorPermutation_InitAll(COLOR_PERMUTATION p[COLOR_PERMUTATIONS]);
+
+static inline uint32_t ColorPermutation_Apply(const COLOR_PERMUTATION* p, uint32_t netlist_and_led_states)
+{
+  return (p->bytes[0][netlist_and_led_states & 0xFF] |
+          p->bytes[1][(netlist_and_led_states >> 8) & 0xFF] |
+          p->bytes[2][(netlist_and_led_states >> 16) & 0xFF] |
+          p->bytes[3][netlist_and_led_states >> 24]);
+}
+
+// 'in' and 'out' may be the same array
+static inline void ColorPermutation_ApplyBatch(const COLOR_PERMUTATION* p, const uint32_t* in, uint32_t* out, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    out[i] = ColorPermutation_Apply(p, in[i]);
+}
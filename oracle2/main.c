@@ -3,8 +3,12 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
-#include "netlist_node.h"
+#include "netlist_set.h"
+#include "oracle_hash.h"
+#include "color_permutation.h"
+#include "oracle_index.h"
 
 /* This was cut and pasted from the switch statement in circuit.c, and
    then massaged to have the appropriate LED-on bits tacked on to each
@@ -125,467 +129,704 @@ uint32_t unsorted_netlists[] =
 
 #define NELEMS(x) (sizeof(x)/sizeof(x[0]))
 
-#define NL_VV 0
-#define NL_00 1
-#define NL_RA 2
-#define NL_RC 3
-#define NL_YA 4
-#define NL_YC 5
-#define NL_GA 6
-#define NL_GC 7
+void netlist_print_dot(FILE *stream, const rbtree_node_t *node) {
+  const char nodeNames[NL_COUNT] = { '+', '-', 'R', 'r', 'Y', 'y', 'G', 'g' };
+
+  uint32_t netlist_and_led_states = ((const netlist_node_t *)node)->n.netlist_and_led_states;
+  uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
+  uint32_t led_states = netlist_and_led_states & NETLIST_LED_STATES_MASK;
 
-#define SWAPCOLORS_FLAG_RED_YELLOW    1
-#define SWAPCOLORS_FLAG_RED_GREEN     2
-#define SWAPCOLORS_FLAG_YELLOW_GREEN  3
+  fprintf(stream,
+          "<"
+          "<table border=\"0\" cellborder=\"1\" cellspacing=\"0\">"
+          "<tr><td colspan=\"9\">0x%08x</td></tr>"
+          "<tr><td colspan=\"3\" bgcolor=\"%s\">%s</td><td colspan=\"3\" bgcolor=\"%s\">%s</td><td colspan=\"3\" bgcolor=\"%s\">%s</td></tr>"
+          "<tr><td></td><td>+</td><td>-</td><td>R</td><td>r</td><td>Y</td><td>y</td><td>G</td><td>g</td></tr>",
+          netlist,
+          (led_states & NETLIST_R_ON) ? "red" : "white",
+          (led_states & NETLIST_R_ON) ? "R" : "",
+          (led_states & NETLIST_Y_ON) ? "yellow" : "white",
+          (led_states & NETLIST_Y_ON) ? "Y" : "",
+          (led_states & NETLIST_G_ON) ? "green" : "white",
+          (led_states & NETLIST_G_ON) ? "G" : "");
+
+  // Each node is connected to itself along the diagonal
+  for (uint8_t y = 0; y < NL_COUNT; ++y) {
+    fprintf(stream, "<tr><td>%c</td>", nodeNames[y]);
+    for (uint8_t x = 0; x < NL_COUNT; ++x)
+      fprintf(stream, "<td>%s</td>", (x == y || NETLIST_CONNECTED(netlist, y, x)) ? "x" : "");
+    fprintf(stream, "</tr>");
+  }
+
+  fprintf(stream,
+          "</table>"
+          ">");
+}
 
-uint32_t SwapColors(uint32_t netlist_and_led_states, uint8_t flag)
+struct OUTPUT;
+typedef struct OUTPUT OUTPUT;
+
+// Each layout gets the unique netlists one at a time, in sorted order
+struct OUTPUT {
+  void (*begin)(OUTPUT* output);
+  void (*emit)(OUTPUT* output, uint32_t netlist);
+  void (*end)(OUTPUT* output);
+  bool collect; // keeps every netlist, for the layouts (and the DOT file) that need them all at once
+  uint32_t* netlists;
+  size_t count;
+  size_t capacity;
+  uint32_t* offsets;
+  size_t collectLimit; // stops collecting past this many netlists, 0 for no limit
+};
+
+void Output_Emit(OUTPUT* output, uint32_t netlist)
 {
-  // the diagonal needs to start cleared
-  uint8_t pruned_netlist[8][8] = {
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-  };
-
-  const uint8_t packedNetlistY[] =
-    {
-     NL_GA,
-     NL_YC, NL_YC,
-     NL_YA, NL_YA, NL_YA,
-     NL_RC, NL_RC, NL_RC, NL_RC,
-     NL_RA, NL_RA, NL_RA, NL_RA, NL_RA,
-     NL_00, NL_00, NL_00, NL_00, NL_00, NL_00,
-     NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
-  const uint8_t packedNetlistX[] =
-    {
-     NL_GC,
-     NL_GC, NL_GA,
-     NL_GC, NL_GA, NL_YC,
-     NL_GC, NL_GA, NL_YC, NL_YA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
+  if (output->collect && output->collectLimit && output->count == output->collectLimit) {
+    free(output->netlists);
+    output->netlists = 0;
+    output->collect = false;
+  }
+  if (output->collect) {
+    if (output->count == output->capacity) {
+      output->capacity = output->capacity ? 2 * output->capacity : 1024;
+      output->netlists = realloc(output->netlists, output->capacity * sizeof(uint32_t));
+      if (!output->netlists) {
+        perror("realloc");
+        exit(EXIT_FAILURE);
+      }
+    }
+    output->netlists[output->count] = netlist;
+  }
+  output->count++;
+  if (output->emit)
+    output->emit(output, netlist);
+}
 
-  uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
-  uint32_t led_states = netlist_and_led_states & NETLIST_LED_STATES_MASK;
+void SortedBegin(OUTPUT* output)
+{
+  (void)output;
+  puts("const uint32_t sorted_netlists_and_led_states[] PROGMEM =");
+  puts("{");
+}
+
+void SortedEmit(OUTPUT* output, uint32_t netlist)
+{
+  (void)output;
+  printf("  0x%08x,\n", netlist);
+}
 
-  // Turn the netlist back into the matrix version
-  uint32_t bitmask = 1;
-  for (uint8_t i = 0; i < 27; ++i) {
-    if (netlist & bitmask)
-      pruned_netlist[packedNetlistY[i]][packedNetlistX[i]] = pruned_netlist[packedNetlistX[i]][packedNetlistY[i]] = 1;
-    bitmask <<= 1;
+void SortedEnd(OUTPUT* output)
+{
+  (void)output;
+  puts("};");
+}
+
+// Just the words, in host byte order
+void BlobEmit(OUTPUT* output, uint32_t netlist)
+{
+  (void)output;
+  fwrite(&netlist, sizeof(netlist), 1, stdout);
+}
+
+void IndexBegin(OUTPUT* output)
+{
+  output->offsets = calloc(ORACLE_INDEX_BUCKETS + 1, sizeof(uint32_t));
+  if (!output->offsets) {
+    perror("calloc");
+    exit(EXIT_FAILURE);
   }
+}
 
-  // print the netlist
-  /* putchar('\n'); */
-  /* for (uint8_t y = 0; y < 8; ++y) { */
-  /*   for (uint8_t x = 0; x < 8; ++x) { */
-  /*     putchar(pruned_netlist[y][x] ? '1' : '0'); putchar(' '); */
-  /*   } */
-  /*   putchar('\n'); */
-  /* } */
+void IndexEmit(OUTPUT* output, uint32_t netlist)
+{
+  output->offsets[OracleIndex_Bucket(netlist, ORACLE_INDEX_BUCKET_BITS) + 1]++;
+  fwrite(&netlist, sizeof(netlist), 1, stdout);
+}
 
-  ////  printf("0x%08x -> ", netlist_and_led_states); // was previously printing just netlist
+// The bucket counts become where each bucket starts, see oracle_index.h
+void IndexEnd(OUTPUT* output)
+{
+  for (uint32_t b = 0; b < ORACLE_INDEX_BUCKETS; ++b)
+    output->offsets[b + 1] += output->offsets[b];
+  fwrite(output->offsets, sizeof(uint32_t), ORACLE_INDEX_BUCKETS + 1, stdout);
+  ORACLE_INDEX_TRAILER trailer = { ORACLE_INDEX_BUCKET_BITS, output->count, ORACLE_INDEX_VERSION, ORACLE_INDEX_MAGIC };
+  fwrite(&trailer, sizeof(trailer), 1, stdout);
+  free(output->offsets);
+}
 
-  // permute it
-  uint32_t new_led_states = 0;
+// Fills 'eytzinger' with an in-order walk of the implicit tree where the children of k are 2k+1 and 2k+2
+size_t Eytzinger(const uint32_t* sorted, uint32_t* eytzinger, size_t count, size_t i, size_t k)
+{
+  if (k < count) {
+    i = Eytzinger(sorted, eytzinger, count, i, 2 * k + 1);
+    eytzinger[k] = sorted[i++];
+    i = Eytzinger(sorted, eytzinger, count, i, 2 * k + 2);
+  }
+  return i;
+}
 
-  // ---------------------------------------- SWAPPING RED AND YELLOW
-  if (flag == SWAPCOLORS_FLAG_RED_YELLOW) {
+void PrintEytzinger(const uint32_t* netlists, size_t count)
+{
+  uint32_t *eytzinger = malloc(count * sizeof(uint32_t));
+  Eytzinger(netlists, eytzinger, count, 0, 0);
 
-    // swap the red anode and yellow anode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_RA][i];
-      pruned_netlist[NL_RA][i] = pruned_netlist[NL_YA][i];
-      pruned_netlist[NL_YA][i] = scratch;
-    }
-    // swap the red cathode and yellow cathode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_RC][i];
-      pruned_netlist[NL_RC][i] = pruned_netlist[NL_YC][i];
-      pruned_netlist[NL_YC][i] = scratch;
-    }
-    // swap the red anode and yellow anode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_RA];
-      pruned_netlist[i][NL_RA] = pruned_netlist[i][NL_YA];
-      pruned_netlist[i][NL_YA] = scratch;
-    }
-    // swap the red cathode and yellow cathode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_RC];
-      pruned_netlist[i][NL_RC] = pruned_netlist[i][NL_YC];
-      pruned_netlist[i][NL_YC] = scratch;
-    }
+  puts("const uint32_t eytzinger_netlists_and_led_states[] PROGMEM =");
+  puts("{");
+  for (size_t i = 0; i < count; ++i)
+    printf("  0x%08x,\n", eytzinger[i]);
+  puts("};");
 
-    // reflect the matrix across the diagonal
-    for (uint8_t y = 0; y < 8; ++y)
-      for (uint8_t x = 0; x < 8; ++x)
-        if (pruned_netlist[y][x] || pruned_netlist[x][y])
-          pruned_netlist[y][x] = pruned_netlist[x][y] = 1;
+  free(eytzinger);
+}
 
-    // swap LED on states
-    bool redOn = led_states & NETLIST_R_ON;
-    bool yellowOn = led_states & NETLIST_Y_ON;
-    bool greenOn = led_states & NETLIST_G_ON;
+// xorshift32, so the search for the hash multipliers (and the output) is the same every time
+static uint32_t Random(void)
+{
+  static uint32_t state = 2463534242;
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
 
-    new_led_states |= redOn ? NETLIST_Y_ON : 0;
-    new_led_states |= yellowOn ? NETLIST_R_ON : 0;
-    new_led_states |= greenOn ? NETLIST_G_ON : 0;
+// Tries to place every bucket, largest first, returns false if some bucket has no displacement that fits
+bool PlaceBuckets(const uint32_t* netlists, size_t count, uint32_t mul1, uint16_t mul2, uint8_t* displacements, uint32_t* slots)
+{
+  uint8_t *buckets = malloc(count);
+  uint16_t *members = malloc(count * sizeof(uint16_t));
+  bool *used = calloc(count, sizeof(bool));
+  uint16_t bucketSizes[ORACLE_HASH_BUCKETS] = { 0 };
+
+  for (size_t i = 0; i < count; ++i) {
+    buckets[i] = OracleHash_Bucket(OracleHash(netlists[i] & NETLIST_NETLIST_MASK, mul1));
+    bucketSizes[buckets[i]]++;
   }
-  // ---------------------------------------- SWAPPING RED AND GREEN
-  else if (flag == SWAPCOLORS_FLAG_RED_GREEN) {
-
-    // swap the red anode and green anode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_RA][i];
-      pruned_netlist[NL_RA][i] = pruned_netlist[NL_GA][i];
-      pruned_netlist[NL_GA][i] = scratch;
-    }
-    // swap the red cathode and green cathode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_RC][i];
-      pruned_netlist[NL_RC][i] = pruned_netlist[NL_GC][i];
-      pruned_netlist[NL_GC][i] = scratch;
+  memset(displacements, 0, ORACLE_HASH_BUCKETS);
+
+  bool placedAll = true;
+  for (size_t size = count; size > 0 && placedAll; --size)
+    for (uint16_t b = 0; b < ORACLE_HASH_BUCKETS && placedAll; ++b) {
+      if (bucketSizes[b] != size)
+        continue;
+
+      uint16_t memberCount = 0;
+      for (size_t i = 0; i < count; ++i)
+        if (buckets[i] == b)
+          members[memberCount++] = i;
+
+      bool placed = false;
+      for (uint16_t d = 0; d < 256 && !placed; ++d) {
+        placed = true;
+        for (uint16_t m = 0; m < memberCount && placed; ++m) {
+          uint16_t slot = OracleHash_Slot(OracleHash(netlists[members[m]] & NETLIST_NETLIST_MASK, mul1), d, mul2, count);
+          if (used[slot])
+            placed = false;
+          for (uint16_t n = 0; n < m && placed; ++n)
+            if (slot == OracleHash_Slot(OracleHash(netlists[members[n]] & NETLIST_NETLIST_MASK, mul1), d, mul2, count))
+              placed = false;
+        }
+        if (placed) {
+          displacements[b] = d;
+          for (uint16_t m = 0; m < memberCount; ++m) {
+            uint16_t slot = OracleHash_Slot(OracleHash(netlists[members[m]] & NETLIST_NETLIST_MASK, mul1), d, mul2, count);
+            used[slot] = true;
+            slots[slot] = netlists[members[m]];
+          }
+        }
+      }
+      placedAll = placed;
     }
-    // swap the red anode and green anode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_RA];
-      pruned_netlist[i][NL_RA] = pruned_netlist[i][NL_GA];
-      pruned_netlist[i][NL_GA] = scratch;
-    }
-    // swap the red cathode and green cathode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_RC];
-      pruned_netlist[i][NL_RC] = pruned_netlist[i][NL_GC];
-      pruned_netlist[i][NL_GC] = scratch;
+
+  free(used);
+  free(members);
+  free(buckets);
+  return placedAll;
+}
+
+void PrintHashed(const uint32_t* netlists, size_t count)
+{
+  uint8_t displacements[ORACLE_HASH_BUCKETS];
+  uint32_t *slots = malloc(count * sizeof(uint32_t));
+
+  uint32_t mul1;
+  uint16_t mul2;
+  int attempts = 0;
+  do {
+    mul1 = Random() | 1;
+    mul2 = (uint16_t)Random() | 1;
+    if (++attempts > 100000) {
+      fprintf(stderr, "Unable to find a perfect hash for %zu netlists\n", count);
+      exit(EXIT_FAILURE);
     }
+  } while (!PlaceBuckets(netlists, count, mul1, mul2, displacements, slots));
+
+  printf("#define ORACLE_HASH_MUL1 0x%08xUL\n", mul1);
+  printf("#define ORACLE_HASH_MUL2 0x%04x\n", mul2);
+  puts("");
+  puts("const uint8_t oracle_hash_displacements[ORACLE_HASH_BUCKETS] PROGMEM =");
+  puts("{");
+  for (size_t b = 0; b < ORACLE_HASH_BUCKETS; b += 8) {
+    printf(" ");
+    for (size_t i = b; i < b + 8; ++i)
+      printf(" 0x%02x,", displacements[i]);
+    puts("");
+  }
+  puts("};");
+  puts("");
+  puts("const uint32_t hashed_netlists_and_led_states[] PROGMEM =");
+  puts("{");
+  for (size_t i = 0; i < count; ++i)
+    printf("  0x%08x,\n", slots[i]);
+  puts("};");
 
-    // reflect the matrix across the diagonal
-    for (uint8_t y = 0; y < 8; ++y)
-      for (uint8_t x = 0; x < 8; ++x)
-        if (pruned_netlist[y][x] || pruned_netlist[x][y])
-          pruned_netlist[y][x] = pruned_netlist[x][y] = 1;
+  fprintf(stderr, "\nFound a perfect hash after %d attempts\n", attempts);
+  free(slots);
+}
 
-    // swap LED on states
-    bool redOn = led_states & NETLIST_R_ON;
-    bool yellowOn = led_states & NETLIST_Y_ON;
-    bool greenOn = led_states & NETLIST_G_ON;
+void EytzingerEnd(OUTPUT* output)
+{
+  PrintEytzinger(output->netlists, output->count);
+}
 
-    new_led_states |= redOn ? NETLIST_G_ON : 0;
-    new_led_states |= yellowOn ? NETLIST_Y_ON : 0;
-    new_led_states |= greenOn ? NETLIST_R_ON : 0;
+void HashedEnd(OUTPUT* output)
+{
+  // The AVR finds the slots with 16 bit math
+  if (output->count > UINT16_MAX) {
+    fprintf(stderr, "Too many netlists to hash: %zu\n", output->count);
+    exit(EXIT_FAILURE);
   }
-  // ---------------------------------------- SWAPPING YELLOW AND GREEN
-  else if (flag == SWAPCOLORS_FLAG_YELLOW_GREEN) {
-
-    // swap the yellow anode and green anode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_YA][i];
-      pruned_netlist[NL_YA][i] = pruned_netlist[NL_GA][i];
-      pruned_netlist[NL_GA][i] = scratch;
-    }
-    // swap the yellow cathode and green cathode rows
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[NL_YC][i];
-      pruned_netlist[NL_YC][i] = pruned_netlist[NL_GC][i];
-      pruned_netlist[NL_GC][i] = scratch;
-    }
-    // swap the yellow anode and green anode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_YA];
-      pruned_netlist[i][NL_YA] = pruned_netlist[i][NL_GA];
-      pruned_netlist[i][NL_GA] = scratch;
-    }
-    // swap the yellow cathode and green cathode cols
-    for (uint8_t i = 0; i < 8; ++i) {
-      uint8_t scratch = pruned_netlist[i][NL_YC];
-      pruned_netlist[i][NL_YC] = pruned_netlist[i][NL_GC];
-      pruned_netlist[i][NL_GC] = scratch;
-    }
+  PrintHashed(output->netlists, output->count);
+}
+
+struct FORMAT;
+typedef struct FORMAT FORMAT;
+
+struct FORMAT {
+  const char* name;
+  OUTPUT output;
+};
+
+const FORMAT formats[] = {
+  { "sorted",    { SortedBegin, SortedEmit, SortedEnd, false, 0, 0, 0, 0, 0 } },
+  { "eytzinger", { 0, 0, EytzingerEnd, true, 0, 0, 0, 0, 0 } },
+  { "hash",      { 0, 0, HashedEnd, true, 0, 0, 0, 0, 0 } },
+  { "blob",      { 0, BlobEmit, 0, false, 0, 0, 0, 0, 0 } },
+  { "index",     { IndexBegin, IndexEmit, IndexEnd, false, 0, 0, 0, 0, 0 } },
+};
 
-    // reflect the matrix across the diagonal
-    for (uint8_t y = 0; y < 8; ++y)
-      for (uint8_t x = 0; x < 8; ++x)
-        if (pruned_netlist[y][x] || pruned_netlist[x][y])
-          pruned_netlist[y][x] = pruned_netlist[x][y] = 1;
+// Only the netlist is sorted on, the LED states ride along in the top 3 bits
+#define NETLIST_KEY(nl) ((nl) & NETLIST_NETLIST_MASK)
+#define NETLIST_STATE(nl) ((nl) >> 29)
 
-    // swap LED on states
-    bool redOn = led_states & NETLIST_R_ON;
-    bool yellowOn = led_states & NETLIST_Y_ON;
-    bool greenOn = led_states & NETLIST_G_ON;
+#define DEFAULT_MEMORY 64 // megabytes of netlists sorted at once, the rest spills to temporary files
+#define RUN_BUFFER 4096
+#define MAX_REPORTED_CONFLICTS 20
+#define DOT_MAX_NETLISTS (1 << 16) // -d keeps every netlist in memory, and dot can't lay out more anyway
+
+// Sorts 9 bits at a time, so equal netlists stay in the order they came in, returns whichever buffer ends up sorted
+uint32_t* RadixSort(uint32_t* netlists, uint32_t* scratch, size_t count)
+{
+  for (uint8_t shift = 0; shift < 27; shift += 9) {
+    size_t starts[512] = { 0 };
+    for (size_t i = 0; i < count; ++i)
+      starts[(NETLIST_KEY(netlists[i]) >> shift) & 511]++;
+    size_t total = 0;
+    for (uint16_t d = 0; d < 512; ++d) {
+      size_t n = starts[d];
+      starts[d] = total;
+      total += n;
+    }
+    for (size_t i = 0; i < count; ++i)
+      scratch[starts[(NETLIST_KEY(netlists[i]) >> shift) & 511]++] = netlists[i];
 
-    new_led_states |= redOn ? NETLIST_R_ON : 0;
-    new_led_states |= yellowOn ? NETLIST_G_ON : 0;
-    new_led_states |= greenOn ? NETLIST_Y_ON : 0;
+    uint32_t* sorted = scratch;
+    scratch = netlists;
+    netlists = sorted;
   }
-  else {
-    abort(); // this should never happen
+  return netlists;
+}
+
+// Drops the repeats of each netlist, but keeps the first one with each
+// different set of LED states, so the conflicts can be reported once
+// all of the runs are merged
+size_t Unique(uint32_t* netlists, size_t count)
+{
+  size_t kept = 0;
+  uint8_t seen = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (!kept || NETLIST_KEY(netlists[i]) != NETLIST_KEY(netlists[kept - 1]))
+      seen = 0;
+    uint8_t state = 1 << NETLIST_STATE(netlists[i]);
+    if (!(seen & state)) {
+      seen |= state;
+      netlists[kept++] = netlists[i];
+    }
   }
+  return kept;
+}
+
+struct RUN;
+typedef struct RUN RUN;
 
-  /* printf("Turned into: \n"); */
-
-  // print the netlist
-  /* putchar('\n'); */
-  /* for (uint8_t y = 0; y < 8; ++y) { */
-  /*   for (uint8_t x = 0; x < 8; ++x) { */
-  /*     putchar(pruned_netlist[y][x] ? '1' : '0'); putchar(' '); */
-  /*   } */
-  /*   putchar('\n'); */
-  /* } */
-
-  // repack the netlist into a single uint32_t
-  uint32_t repacked_netlist = new_led_states; // was 0 before
-  {
-    uint32_t bitmask = 1;
-    for (uint8_t i = 0; i < 27; ++i) {
-      if (pruned_netlist[packedNetlistY[i]][packedNetlistX[i]])
-        repacked_netlist |= bitmask;
-      bitmask <<= 1;
+// A sorted run of netlists, either spilled to a file or still in memory
+struct RUN {
+  FILE* file;
+  uint32_t* words;
+  size_t at;
+  size_t count;
+};
+
+bool Run_Peek(RUN* run, uint32_t* netlist)
+{
+  if (run->at == run->count) {
+    if (!run->file)
+      return false;
+    run->at = 0;
+    run->count = fread(run->words, sizeof(uint32_t), RUN_BUFFER, run->file);
+    if (ferror(run->file)) {
+      perror("reading a sorted run");
+      exit(EXIT_FAILURE);
     }
-////    printf("0x%08x\n", repacked_netlist);
+    if (!run->count)
+      return false;
   }
+  *netlist = run->words[run->at];
+  return true;
+}
+
+struct DEDUP;
+typedef struct DEDUP DEDUP;
+
+struct DEDUP {
+  COLOR_PERMUTATION permutations[COLOR_PERMUTATIONS];
+  uint8_t permutationCount; // 1 when the input already has every ordering of the colors
+  uint32_t* chunk;
+  uint32_t* scratch;
+  size_t fill;
+  size_t capacity;
+  RUN* runs;
+  size_t runCount;
+  size_t inputCount;
+  size_t conflictCount;
+};
 
-  // scan the original list to see if we had that permutation
-  // UNCOMMENT FOR DEBUGGING
-  /* for (size_t i = 0; i < NELEMS(unsorted_netlists); ++i) { */
-  /*   uint32_t nl = unsorted_netlists[i]; */
-  /*   if (repacked_netlist == nl) */
-  /*     printf("FOUND PERMUTATION!\n"); */
-  /* } */
+void Dedup_Spill(DEDUP* dedup)
+{
+  uint32_t* sorted = RadixSort(dedup->chunk, dedup->scratch, dedup->fill);
+  size_t count = Unique(sorted, dedup->fill);
+  FILE* file = tmpfile();
+  if (!file || fwrite(sorted, sizeof(uint32_t), count, file) != count || fflush(file) || fseek(file, 0, SEEK_SET)) {
+    perror("spilling a sorted run");
+    exit(EXIT_FAILURE);
+  }
 
-  // Return the permuted netlist_and_led_states
-  return repacked_netlist;
+  RUN* runs = realloc(dedup->runs, (dedup->runCount + 1) * sizeof(RUN));
+  if (!runs) {
+    perror("realloc");
+    exit(EXIT_FAILURE);
+  }
+  dedup->runs = runs;
+  uint32_t* words = malloc(RUN_BUFFER * sizeof(uint32_t));
+  if (!words) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+  dedup->runs[dedup->runCount++] = (RUN){ file, words, 0, 0 };
+  dedup->fill = 0;
 }
 
-void netlist_print_dot(FILE *stream, const rbtree_node_t *node) {
-  uint8_t pruned_netlist[8][8] = {
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-    { 0, 0, 0, 0, 0, 0, 0, 0 },
-  };
-
-  const uint8_t packedNetlistY[] =
-    {
-     NL_GA,
-     NL_YC, NL_YC,
-     NL_YA, NL_YA, NL_YA,
-     NL_RC, NL_RC, NL_RC, NL_RC,
-     NL_RA, NL_RA, NL_RA, NL_RA, NL_RA,
-     NL_00, NL_00, NL_00, NL_00, NL_00, NL_00,
-     NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, NL_VV, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
-
-  const uint8_t packedNetlistX[] =
-    {
-     NL_GC,
-     NL_GC, NL_GA,
-     NL_GC, NL_GA, NL_YC,
-     NL_GC, NL_GA, NL_YC, NL_YA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA,
-     NL_GC, NL_GA, NL_YC, NL_YA, NL_RC, NL_RA, /*NL_VV,*/ // highest bit assumed to be 0, we don't store short circuits
-    };
+void Dedup_Add(DEDUP* dedup, uint32_t netlist)
+{
+  if (dedup->fill + dedup->permutationCount > dedup->capacity)
+    Dedup_Spill(dedup);
+  for (uint8_t p = 0; p < dedup->permutationCount; ++p)
+    dedup->chunk[dedup->fill++] = ColorPermutation_Apply(&dedup->permutations[p], netlist);
+  dedup->inputCount++;
+}
 
-  uint32_t netlist_and_led_states = ((const netlist_node_t *)node)->n.netlist_and_led_states;
-  uint32_t netlist = netlist_and_led_states & NETLIST_NETLIST_MASK;
-  uint32_t led_states = netlist_and_led_states & NETLIST_LED_STATES_MASK;
+void PrintLedStates(FILE* stream, uint8_t state)
+{
+  fprintf(stream, "%c%c%c",
+          (state & (NETLIST_R_ON >> 29)) ? 'R' : '-',
+          (state & (NETLIST_Y_ON >> 29)) ? 'Y' : '-',
+          (state & (NETLIST_G_ON >> 29)) ? 'G' : '-');
+}
 
-  // Turn the netlist back into the matrix version
-  uint32_t bitmask = 1;
-  for (uint8_t i = 0; i < 27; ++i) {
-    if (netlist & bitmask)
-      pruned_netlist[packedNetlistY[i]][packedNetlistX[i]] = pruned_netlist[packedNetlistX[i]][packedNetlistY[i]] = 1;
-    bitmask <<= 1;
+// The first netlist that came in wins, any other LED states it was seen with are a conflict
+void Dedup_Emit(DEDUP* dedup, OUTPUT* output, uint32_t kept, uint8_t states)
+{
+  uint8_t others = states & ~(1 << NETLIST_STATE(kept));
+  if (others && ++dedup->conflictCount <= MAX_REPORTED_CONFLICTS) {
+    fprintf(stderr, "Conflict: netlist 0x%08x keeps ", NETLIST_KEY(kept));
+    PrintLedStates(stderr, NETLIST_STATE(kept));
+    fprintf(stderr, " but was also seen with");
+    for (uint8_t state = 0; state < 8; ++state)
+      if (others & (1 << state)) {
+        fprintf(stderr, " ");
+        PrintLedStates(stderr, state);
+      }
+    fprintf(stderr, "\n");
   }
+  Output_Emit(output, kept);
+}
 
-  // Fill in the diagonals
-  for (uint8_t i = 0; i < 8; ++i)
-    pruned_netlist[i][i] = 1;
+// Merges the sorted runs, ties going to the earlier run so the first netlist in wins
+void Dedup_Finish(DEDUP* dedup, OUTPUT* output)
+{
+  RUN memory;
+  RUN* runs = &memory;
+  size_t runCount = 1;
+  if (!dedup->runCount) {
+    uint32_t* sorted = RadixSort(dedup->chunk, dedup->scratch, dedup->fill);
+    memory = (RUN){ 0, sorted, 0, Unique(sorted, dedup->fill) };
+  } else {
+    if (dedup->fill)
+      Dedup_Spill(dedup);
+    runs = dedup->runs;
+    runCount = dedup->runCount;
+  }
 
-  fprintf(stream,
-          "<"
-          "<table border=\"0\" cellborder=\"1\" cellspacing=\"0\">"
-          "<tr><td colspan=\"9\">0x%08x</td></tr>"
-          "<tr><td colspan=\"3\" bgcolor=\"%s\">%s</td><td colspan=\"3\" bgcolor=\"%s\">%s</td><td colspan=\"3\" bgcolor=\"%s\">%s</td></tr>"
-          "<tr><td></td><td>+</td><td>-</td><td>R</td><td>r</td><td>Y</td><td>y</td><td>G</td><td>g</td></tr>"
-          "<tr><td>+</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>-</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>R</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>r</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>Y</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>y</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>G</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "<tr><td>g</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td><td>%s</td></tr>"
-          "</table>"
-          ">",
-          netlist,
-          (led_states & NETLIST_R_ON) ? "red" : "white",
-          (led_states & NETLIST_R_ON) ? "R" : "",
-          (led_states & NETLIST_Y_ON) ? "yellow" : "white",
-          (led_states & NETLIST_Y_ON) ? "Y" : "",
-          (led_states & NETLIST_G_ON) ? "green" : "white",
-          (led_states & NETLIST_G_ON) ? "G" : "",
-          pruned_netlist[0][0] ? "x" : "",
-          pruned_netlist[0][1] ? "x" : "",
-          pruned_netlist[0][2] ? "x" : "",
-          pruned_netlist[0][3] ? "x" : "",
-          pruned_netlist[0][4] ? "x" : "",
-          pruned_netlist[0][5] ? "x" : "",
-          pruned_netlist[0][6] ? "x" : "",
-          pruned_netlist[0][7] ? "x" : "",
-          pruned_netlist[1][0] ? "x" : "",
-          pruned_netlist[1][1] ? "x" : "",
-          pruned_netlist[1][2] ? "x" : "",
-          pruned_netlist[1][3] ? "x" : "",
-          pruned_netlist[1][4] ? "x" : "",
-          pruned_netlist[1][5] ? "x" : "",
-          pruned_netlist[1][6] ? "x" : "",
-          pruned_netlist[1][7] ? "x" : "",
-          pruned_netlist[2][0] ? "x" : "",
-          pruned_netlist[2][1] ? "x" : "",
-          pruned_netlist[2][2] ? "x" : "",
-          pruned_netlist[2][3] ? "x" : "",
-          pruned_netlist[2][4] ? "x" : "",
-          pruned_netlist[2][5] ? "x" : "",
-          pruned_netlist[2][6] ? "x" : "",
-          pruned_netlist[2][7] ? "x" : "",
-          pruned_netlist[3][0] ? "x" : "",
-          pruned_netlist[3][1] ? "x" : "",
-          pruned_netlist[3][2] ? "x" : "",
-          pruned_netlist[3][3] ? "x" : "",
-          pruned_netlist[3][4] ? "x" : "",
-          pruned_netlist[3][5] ? "x" : "",
-          pruned_netlist[3][6] ? "x" : "",
-          pruned_netlist[3][7] ? "x" : "",
-          pruned_netlist[4][0] ? "x" : "",
-          pruned_netlist[4][1] ? "x" : "",
-          pruned_netlist[4][2] ? "x" : "",
-          pruned_netlist[4][3] ? "x" : "",
-          pruned_netlist[4][4] ? "x" : "",
-          pruned_netlist[4][5] ? "x" : "",
-          pruned_netlist[4][6] ? "x" : "",
-          pruned_netlist[4][7] ? "x" : "",
-          pruned_netlist[5][0] ? "x" : "",
-          pruned_netlist[5][1] ? "x" : "",
-          pruned_netlist[5][2] ? "x" : "",
-          pruned_netlist[5][3] ? "x" : "",
-          pruned_netlist[5][4] ? "x" : "",
-          pruned_netlist[5][5] ? "x" : "",
-          pruned_netlist[5][6] ? "x" : "",
-          pruned_netlist[5][7] ? "x" : "",
-          pruned_netlist[6][0] ? "x" : "",
-          pruned_netlist[6][1] ? "x" : "",
-          pruned_netlist[6][2] ? "x" : "",
-          pruned_netlist[6][3] ? "x" : "",
-          pruned_netlist[6][4] ? "x" : "",
-          pruned_netlist[6][5] ? "x" : "",
-          pruned_netlist[6][6] ? "x" : "",
-          pruned_netlist[6][7] ? "x" : "",
-          pruned_netlist[7][0] ? "x" : "",
-          pruned_netlist[7][1] ? "x" : "",
-          pruned_netlist[7][2] ? "x" : "",
-          pruned_netlist[7][3] ? "x" : "",
-          pruned_netlist[7][4] ? "x" : "",
-          pruned_netlist[7][5] ? "x" : "",
-          pruned_netlist[7][6] ? "x" : "",
-          pruned_netlist[7][7] ? "x" : "");
+  if (output->begin)
+    output->begin(output);
+  uint32_t kept = 0;
+  uint8_t states = 0;
+  for (;;) {
+    RUN* next = 0;
+    uint32_t netlist = 0;
+    for (size_t r = 0; r < runCount; ++r) {
+      uint32_t candidate;
+      if (Run_Peek(&runs[r], &candidate) && (!next || NETLIST_KEY(candidate) < NETLIST_KEY(netlist))) {
+        next = &runs[r];
+        netlist = candidate;
+      }
+    }
+    if (!next)
+      break;
+    next->at++;
+
+    if (states && NETLIST_KEY(netlist) == NETLIST_KEY(kept)) {
+      states |= 1 << NETLIST_STATE(netlist);
+      continue;
+    }
+    if (states)
+      Dedup_Emit(dedup, output, kept, states);
+    kept = netlist;
+    states = 1 << NETLIST_STATE(netlist);
+  }
+  if (states)
+    Dedup_Emit(dedup, output, kept, states);
+  if (output->end)
+    output->end(output);
+
+  for (size_t r = 0; r < dedup->runCount; ++r) {
+    fclose(dedup->runs[r].file);
+    free(dedup->runs[r].words);
+  }
+  free(dedup->runs);
+}
+
+// Numbers separated by whitespace or commas, '#' comments out the rest of the line
+bool ReadText(DEDUP* dedup, FILE* file, const char* name)
+{
+  char *line = 0;
+  size_t size = 0;
+  size_t lineNumber = 0;
+  bool ok = true;
+  while (ok && getline(&line, &size, file) >= 0) {
+    lineNumber++;
+    line[strcspn(line, "#")] = 0;
+    char *save;
+    for (char *token = strtok_r(line, " \t\r\n,", &save); token && ok; token = strtok_r(0, " \t\r\n,", &save)) {
+      char *end;
+      errno = 0;
+      unsigned long long netlist = strtoull(token, &end, 0);
+      if (*end || errno || netlist > UINT32_MAX) {
+        fprintf(stderr, "%s:%zu: '%s' isn't a 32 bit netlist\n", name, lineNumber, token);
+        ok = false;
+      } else {
+        Dedup_Add(dedup, (uint32_t)netlist);
+      }
+    }
+  }
+  if (ferror(file)) {
+    fprintf(stderr, "%s: %s\n", name, strerror(errno));
+    ok = false;
+  }
+  free(line);
+  return ok;
 }
 
-void Insert(rbtree_t* tree, uint32_t netlist)
+// 32 bit words in host byte order, like the blob output
+bool ReadBinary(DEDUP* dedup, FILE* file, const char* name)
 {
-  struct netlist nl = { netlist };
-  rbtree_node_t *n = netlist_node_new(&nl);
-  if (!rbtree_setinsert(tree, n))
-    free(n);
+  uint32_t words[RUN_BUFFER];
+  size_t bytes;
+  while ((bytes = fread(words, 1, sizeof(words), file)) > 0) {
+    if (bytes % sizeof(uint32_t)) {
+      fprintf(stderr, "%s: ends partway through a netlist\n", name);
+      return false;
+    }
+    for (size_t i = 0; i < bytes / sizeof(uint32_t); ++i)
+      Dedup_Add(dedup, words[i]);
+  }
+  if (ferror(file)) {
+    fprintf(stderr, "%s: %s\n", name, strerror(errno));
+    return false;
+  }
+  return true;
 }
 
 /* This will generate a sorted list of netlists, with the solution
    bits in the top 3 MSB, so the ConsultOracle2 function can find
-   things using binary search */
+   things using binary search. The same netlists can also be output
+   in the other layouts that Engine_ConsultOracle knows how to search:
+
+     circuit/oracle2$ ./main > sorted_netlists_and_led_states.inc
+     circuit/oracle2$ ./main eytzinger > eytzinger_netlists_and_led_states.inc
+     circuit/oracle2$ ./main hash > hashed_netlists_and_led_states.inc
+
+   Without any input files it uses the netlists from circuit.c above,
+   otherwise it streams them in from the files ('-' is stdin), as text
+   numbers or with -b as raw 32 bit words. Every ordering of the colors
+   is added unless -n says the input already has them. Anything that
+   doesn't fit in -m megabytes is sorted in runs that spill to
+   temporary files and get merged, so the input can be as big as the
+   disk. Netlists that show up with different LED states are reported
+   (-s makes that an error), and the first one in wins.
+
+   The blob layout is the sorted words as they are, and the index
+   layout adds a bucket index that host tools can mmap and search
+   (see oracle_index.h):
+
+     circuit/oracle2$ ./main -b -n blob corpus.bin > corpus.blob
+     circuit/oracle2$ ./main index corpus.txt > corpus.idx
+
+   -d writes the red-black tree of the netlists to a DOT file (or the
+   B+ tree, when built with CPPFLAGS=-DNETLIST_SET_BPTREE, see
+   netlist_set.h), which is the only thing that uses a tree, and turns
+   into a PNG with:
+
+     dot -Tpng rbtree.dot -o rbtree.png
+
+   Unlike the rest, -d keeps every unique netlist in memory, so it is
+   meant for the built-in netlists or a small corpus: it stops keeping
+   them past DOT_MAX_NETLISTS and fails once the output is written. */
 int main(int argc, char *argv[]) {
-  (void)argc;
-  (void)argv;
-
-  // Initialize the Red-Black Tree used for sorting the netlists (ignoring the solution bits)
-  netlist_node_t myNil;
-  rbtree_node_t *myNilRef = (rbtree_node_t *)&myNil;
-  rbtree_t tree;
-  rbtree_init(&tree, myNilRef, sizeof(netlist_node_t), netlist_node_compare);
-
-////  puts("\nUnsorted\n");
-
-  int inputCount = 0;
-  for (size_t i = 0; i < NELEMS(unsorted_netlists); ++i) {
-    //printf("0x%08x,\n", unsorted_netlists[i]);
-    /* struct netlist n = { unsorted_netlists[i] }; */
-    /* rbtree_setinsert(&tree, netlist_node_new(&n)); */
-
-    // ryg
-    Insert(&tree, unsorted_netlists[i]);
-    uint32_t yrg = SwapColors(unsorted_netlists[i], SWAPCOLORS_FLAG_RED_YELLOW);
-    Insert(&tree, yrg);
-    uint32_t gyr = SwapColors(unsorted_netlists[i], SWAPCOLORS_FLAG_RED_GREEN);
-    Insert(&tree, gyr);
-    uint32_t rgy = SwapColors(unsorted_netlists[i], SWAPCOLORS_FLAG_YELLOW_GREEN);
-    Insert(&tree, rgy);
-    uint32_t ygr = SwapColors(rgy, SWAPCOLORS_FLAG_RED_GREEN);
-    Insert(&tree, ygr);
-    uint32_t gry = SwapColors(yrg, SWAPCOLORS_FLAG_RED_GREEN);
-    Insert(&tree, gry);
-    inputCount++;
+  bool binary = false;
+  bool permute = true;
+  bool strict = false;
+  size_t memory = DEFAULT_MEMORY;
+  const char *dotPath = 0;
+  const char *program = argv[0]; // argv moves past the options
+  for (;;) {
+    int used = 1;
+    if (argc > 1 && !strcmp(argv[1], "-b")) {
+      binary = true;
+    } else if (argc > 1 && !strcmp(argv[1], "-n")) {
+      permute = false;
+    } else if (argc > 1 && !strcmp(argv[1], "-s")) {
+      strict = true;
+    } else if (argc > 2 && !strcmp(argv[1], "-m")) {
+      memory = strtoul(argv[2], 0, 0);
+      used = 2;
+    } else if (argc > 2 && !strcmp(argv[1], "-d")) {
+      dotPath = argv[2];
+      used = 2;
+    } else {
+      break;
+    }
+    argc -= used;
+    argv += used;
   }
 
-  // Loop over unsorted_netlists, swapping the colors around to ensure we have full coverage
-
-////  puts("\nUnique and Sorted\n");
+  OUTPUT output = formats[0].output;
+  for (size_t f = 0; argc > 1 && f < NELEMS(formats); ++f)
+    if (!strcmp(argv[1], formats[f].name)) {
+      output = formats[f].output;
+      argc--;
+      argv++;
+      break;
+    }
+  if (memory < 1 || (argc > 1 && argv[1][0] == '-' && argv[1][1])) {
+    fprintf(stderr, "Usage: %s [-b] [-n] [-s] [-m megabytes] [-d dotfile] [sorted|eytzinger|hash|blob|index] [files...]\n", program);
+    return EXIT_FAILURE;
+  }
+  if (dotPath && !output.collect) {
+    output.collect = true;
+    output.collectLimit = DOT_MAX_NETLISTS;
+  }
 
-  puts("const uint32_t sorted_netlists_and_led_states[] PROGMEM =");
-  puts("{");
+  DEDUP dedup = { .permutationCount = permute ? COLOR_PERMUTATIONS : 1 };
+  ColorPermutation_InitAll(dedup.permutations);
+  dedup.capacity = (memory << 20) / (2 * sizeof(uint32_t));
+  dedup.chunk = malloc(dedup.capacity * sizeof(uint32_t));
+  dedup.scratch = malloc(dedup.capacity * sizeof(uint32_t));
+  if (!dedup.chunk || !dedup.scratch) {
+    perror("malloc");
+    return EXIT_FAILURE;
+  }
 
-  int outputCount = 0;
-  // Iterate through the sorted netlists
-  for (rbtree_node_t *itr = rbtree_minimum(&tree);
-       itr != myNilRef;
-       itr = rbtree_successor(&tree, itr)) {
+  if (argc == 1) {
+    for (size_t i = 0; i < NELEMS(unsorted_netlists); ++i)
+      Dedup_Add(&dedup, unsorted_netlists[i]);
+  }
+  for (int i = 1; i < argc; ++i) {
+    bool useStdin = !strcmp(argv[i], "-");
+    FILE *file = useStdin ? stdin : fopen(argv[i], binary ? "rb" : "r");
+    if (!file) {
+      perror(argv[i]);
+      return EXIT_FAILURE;
+    }
+    bool ok = binary ? ReadBinary(&dedup, file, argv[i]) : ReadText(&dedup, file, argv[i]);
+    if (!useStdin)
+      fclose(file);
+    if (!ok)
+      return EXIT_FAILURE;
+  }
 
-    uint32_t netlist = ((netlist_node_t *)itr)->n.netlist_and_led_states;
-    printf("  0x%08x,\n", netlist);
-    outputCount++;
+  Dedup_Finish(&dedup, &output);
+  free(dedup.scratch);
+  free(dedup.chunk);
+  if (fflush(stdout)) {
+    perror("writing the output");
+    return EXIT_FAILURE;
   }
 
-  puts("};");
+  if (dotPath && output.count > DOT_MAX_NETLISTS) {
+    fprintf(stderr, "%s: %zu netlists are too many for -d, it takes at most %d\n", dotPath, output.count, DOT_MAX_NETLISTS);
+    return EXIT_FAILURE;
+  }
+  if (dotPath) {
+    // Initialize the set used for sorting the netlists (ignoring the solution bits). The netlists
+    // are already sorted and unique, so the Red-Black Tree is built in one pass without any rotations
+    netlist_set_t set;
+    if (!netlist_set_init(&set, output.count) || !netlist_set_build_sorted(&set, output.netlists, output.count)) {
+      perror("malloc");
+      return EXIT_FAILURE;
+    }
 
-  // Just for fun, dump the state of the red-black tree. To turn this
-  // into a PNG file, run the following command:
-  //
-  //   dot -Tpng rbtree.dot -o rbtree.png
-  //
-  FILE *dotfile = fopen("rbtree.dot", "w");
-  rbtree_print_dot(&tree, dotfile, netlist_print_dot, "shape=plain color=black fontcolor=black fontname=mono", "color=red");
-  fclose(dotfile);
-
-  // Cleanup the Red-Black Tree
-  for (rbtree_node_t *itr = rbtree_minimum(&tree); itr != myNilRef; itr = rbtree_minimum(&tree)) {
-    rbtree_delete(&tree, itr);
-    free(itr);
+    FILE *dotfile = fopen(dotPath, "w");
+    if (!dotfile) {
+      perror(dotPath);
+      return EXIT_FAILURE;
+    }
+#if defined(NETLIST_SET_BPTREE)
+    bptree_print_dot(&set.tree, dotfile);
+#else
+    rbtree_print_dot(&set.tree, dotfile, netlist_print_dot, "shape=plain color=black fontcolor=black fontname=mono", "color=red");
+#endif
+    fclose(dotfile);
+
+    netlist_set_destroy(&set);
   }
-  rbtree_destroy(&tree);
+  free(output.netlists);
 
   fprintf(stderr, "\nPermuting known netlists\n");
-  fprintf(stderr, "Input Count: %d Output Count: %d\n\n", inputCount, outputCount);
-  return 0;
+  fprintf(stderr, "Input Count: %zu Output Count: %zu\n", dedup.inputCount, output.count);
+  if (dedup.runCount)
+    fprintf(stderr, "Merged %zu sorted runs\n", dedup.runCount);
+  if (dedup.conflictCount)
+    fprintf(stderr, "Conflicts: %zu\n", dedup.conflictCount);
+  fprintf(stderr, "\n");
+  return (strict && dedup.conflictCount) ? EXIT_FAILURE : 0;
 }
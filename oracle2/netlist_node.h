@@ -5,6 +5,8 @@
 #include "rbtree/rbtree.h"
 #include "rbtree/rbtree+setinsert.h"
 #include "rbtree/rbtree+debug.h"
+#include "rbtree/rbtree+pool.h"
+#include "rbtree/rbtree+build.h"
 
 #include "netlist.h"
 
@@ -12,8 +14,11 @@ typedef struct _netlist_node_t { rbtree_node_t super;
   struct netlist n;
 } netlist_node_t;
 
-rbtree_node_t *netlist_node_new(struct netlist *n) {
-  netlist_node_t *self = malloc(sizeof(netlist_node_t));
+rbtree_node_t *netlist_node_new(rbtree_t *tree, struct netlist *n) {
+  void *node = rbtree_node_alloc(tree);
+  netlist_node_t *self = node;
+  if (!self)
+    return 0;
   memcpy(&self->n, n, sizeof(self->n));
   return (rbtree_node_t *)self;
 }
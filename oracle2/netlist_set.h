@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "netlist_node.h"
+#include "bptree/bptree.h"
+#include "bptree/bptree+debug.h"
+
+/* An ordered set of netlists (ignoring the LED states) with the
+   rbtree-style methods oracle2 needs, so the backend is picked at
+   build time: the Red-Black Tree in rbtree/ by default, or the B+
+   Tree in bptree/ with
+
+     circuit/oracle2$ make CPPFLAGS=-DNETLIST_SET_BPTREE
+
+   An iterator is a node of the Red-Black Tree, or a pointer into a
+   leaf of the B+ Tree, and netlist_set_end tells whether it went past
+   the last netlist. A set must not be copied once it has been
+   initialized, since the Red-Black Tree keeps its nil node inside.
+
+   The netlists are deduplicated by the radix sort in main.c, so the
+   only thing oracle2 builds a set for is the -d DOT file, which is
+   capped at DOT_MAX_NETLISTS. The pooled nodes, rbtree_build_sorted,
+   rbtree_union, the compact node layouts and the B+ Tree are measured
+   at corpus scale by treebench instead. */
+
+#if defined(NETLIST_SET_BPTREE)
+typedef uint32_t *netlist_set_iter_t;
+
+typedef struct _netlist_set_t {
+  bptree_t tree;
+} netlist_set_t;
+#else
+typedef rbtree_node_t *netlist_set_iter_t;
+
+typedef struct _netlist_set_t {
+  netlist_node_t nil;
+  rbtree_t tree;
+  rbtree_pool_t pool;
+} netlist_set_t;
+#endif
+
+// capacity is the most netlists the set will hold, which only matters to the RBTREE_COMPACT_INDEX layout,
+// returns false if it ran out of memory
+static inline bool netlist_set_init(netlist_set_t *self, size_t capacity) {
+#if defined(NETLIST_SET_BPTREE)
+  (void)capacity;
+  bptree_init(&self->tree, NETLIST_NETLIST_MASK);
+  return true;
+#else
+  rbtree_pool_init(&self->pool, sizeof(netlist_node_t), capacity + 1);
+  return rbtree_init_pool(&self->tree, (rbtree_node_t *)&self->nil, sizeof(netlist_node_t), netlist_node_compare, &self->pool);
+#endif
+}
+
+static inline void netlist_set_destroy(netlist_set_t *self) {
+#if defined(NETLIST_SET_BPTREE)
+  bptree_destroy(&self->tree);
+#else
+  rbtree_clear(&self->tree);
+  rbtree_destroy(&self->tree);
+  rbtree_pool_destroy(&self->pool);
+#endif
+}
+
+// Returns 1 if it was inserted, 0 if the netlist was already in the set, or -1 if it ran out of memory
+static inline int netlist_set_setinsert(netlist_set_t *self, uint32_t netlist_and_led_states) {
+#if defined(NETLIST_SET_BPTREE)
+  return bptree_setinsert(&self->tree, netlist_and_led_states);
+#else
+  struct netlist nl = { netlist_and_led_states };
+  rbtree_node_t *n = netlist_node_new(&self->tree, &nl);
+  if (!n)
+    return -1;
+  if (rbtree_setinsert(&self->tree, n))
+    return 1;
+  rbtree_node_free(&self->tree, n);
+  return 0;
+#endif
+}
+
+// Fills an empty set from netlists that are already sorted and unique, returns false if it ran out of memory
+static inline bool netlist_set_build_sorted(netlist_set_t *self, const uint32_t *netlists, size_t count) {
+#if defined(NETLIST_SET_BPTREE)
+  for (size_t i = 0; i < count; ++i)
+    if (bptree_setinsert(&self->tree, netlists[i]) < 0)
+      return false;
+  return true;
+#else
+  rbtree_node_t **nodes = malloc(count * sizeof(rbtree_node_t *));
+  if (!nodes)
+    return false;
+  for (size_t i = 0; i < count; ++i) {
+    struct netlist nl = { netlists[i] };
+    if (!(nodes[i] = netlist_node_new(&self->tree, &nl))) {
+      while (i--)
+        rbtree_node_free(&self->tree, nodes[i]);
+      free(nodes);
+      return false;
+    }
+  }
+  rbtree_build_sorted(&self->tree, nodes, count);
+  free(nodes);
+  return true;
+#endif
+}
+
+static inline netlist_set_iter_t netlist_set_search(netlist_set_t *self, uint32_t netlist) {
+#if defined(NETLIST_SET_BPTREE)
+  return bptree_search(&self->tree, netlist);
+#else
+  netlist_node_t k = { .n = { netlist } };
+  return rbtree_search(&self->tree, (rbtree_node_t *)&k);
+#endif
+}
+
+static inline netlist_set_iter_t netlist_set_minimum(netlist_set_t *self) {
+#if defined(NETLIST_SET_BPTREE)
+  return bptree_minimum(&self->tree);
+#else
+  return rbtree_minimum(&self->tree);
+#endif
+}
+
+static inline netlist_set_iter_t netlist_set_successor(netlist_set_t *self, netlist_set_iter_t x) {
+#if defined(NETLIST_SET_BPTREE)
+  return bptree_successor(&self->tree, x);
+#else
+  return rbtree_successor(&self->tree, x);
+#endif
+}
+
+static inline bool netlist_set_end(netlist_set_t *self, netlist_set_iter_t x) {
+#if defined(NETLIST_SET_BPTREE)
+  (void)self;
+  return !x;
+#else
+  return x == self->tree.nil;
+#endif
+}
+
+// The netlist with its LED states
+static inline uint32_t netlist_set_value(netlist_set_t *self, netlist_set_iter_t x) {
+  (void)self;
+#if defined(NETLIST_SET_BPTREE)
+  return *x;
+#else
+  void *node = x;
+  return ((netlist_node_t *)node)->n.netlist_and_led_states;
+#endif
+}
+
+static inline void netlist_set_inorderwalk(netlist_set_t *self,
+                                           void (*ApplyFunc)(uint32_t, void *),
+                                           void *context) {
+  for (netlist_set_iter_t x = netlist_set_minimum(self); !netlist_set_end(self, x); x = netlist_set_successor(self, x))
+    ApplyFunc(netlist_set_value(self, x), context);
+}
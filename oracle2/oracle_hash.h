@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+/* The minimal perfect hash used by the hashed oracle layout, shared
+   by the oracle2 generator and Engine_ConsultOracle. The netlist is
+   multiplied by ORACLE_HASH_MUL1, the top bits of that pick a bucket,
+   and the displacement byte stored for the bucket moves each of its
+   netlists into its own slot (hash and displace). Every slot holds
+   exactly one netlist, so a lookup is one compare. */
+
+#define ORACLE_HASH_BUCKET_BITS 7
+#define ORACLE_HASH_BUCKETS (1 << ORACLE_HASH_BUCKET_BITS)
+
+static inline uint32_t OracleHash(uint32_t nl, uint32_t mul1)
+{
+  return nl * mul1;
+}
+
+static inline uint8_t OracleHash_Bucket(uint32_t hash)
+{
+  return (uint8_t)(hash >> (32 - ORACLE_HASH_BUCKET_BITS));
+}
+
+// Maps onto [0, count) with a multiply instead of a divide
+static inline uint16_t OracleHash_Slot(uint32_t hash, uint8_t displacement, uint16_t mul2, uint16_t count)
+{
+  uint16_t h = (uint16_t)(((uint16_t)(hash >> 8) ^ displacement) * mul2);
+  return (uint16_t)(((uint32_t)h * count) >> 16);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../engine/packed_netlist.h"
+
+/* The indexed oracle layout that the oracle2 generator writes for
+   host tools (./main index). The file can be written in one pass
+   to a pipe, so everything it needs to be searched comes at the end:
+
+     uint32_t netlists[count];          sorted by netlist, LED states in the top 3 bits
+     uint32_t offsets[buckets + 1];     where each bucket starts in netlists[]
+     ORACLE_INDEX_TRAILER trailer;
+
+   The top ORACLE_INDEX_BUCKET_BITS bits of the 27 bit netlist pick the
+   bucket, so a lookup is a binary search over a handful of entries
+   straight out of the mapped file. All of the words are in host byte
+   order. */
+
+#define ORACLE_INDEX_MAGIC 0x4c43524f // "ORCL"
+#define ORACLE_INDEX_VERSION 1
+#define ORACLE_INDEX_BUCKET_BITS 16
+#define ORACLE_INDEX_BUCKETS (1 << ORACLE_INDEX_BUCKET_BITS)
+
+struct ORACLE_INDEX_TRAILER;
+typedef struct ORACLE_INDEX_TRAILER ORACLE_INDEX_TRAILER;
+
+struct ORACLE_INDEX_TRAILER {
+  uint32_t bucketBits;
+  uint32_t count;
+  uint32_t version;
+  uint32_t magic;
+};
+
+struct ORACLE_INDEX;
+typedef struct ORACLE_INDEX ORACLE_INDEX;
+
+struct ORACLE_INDEX {
+  const uint32_t* netlists;
+  const uint32_t* offsets;
+  uint32_t count;
+  uint32_t bucketBits;
+  void* map;
+  size_t length;
+};
+
+static inline uint32_t OracleIndex_Bucket(uint32_t netlist, uint32_t bucketBits)
+{
+  return (netlist & NETLIST_NETLIST_MASK) >> (27 - bucketBits);
+}
+
+// Maps the file at 'path', returns false if it can't be opened or isn't an index
+static inline bool OracleIndex_Open(ORACLE_INDEX* index, const char* path)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size < (off_t)sizeof(ORACLE_INDEX_TRAILER)) {
+    close(fd);
+    return false;
+  }
+  index->length = st.st_size;
+  index->map = mmap(0, index->length, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (index->map == MAP_FAILED)
+    return false;
+
+  const ORACLE_INDEX_TRAILER* trailer = (const ORACLE_INDEX_TRAILER*)((const uint8_t*)index->map + index->length - sizeof(ORACLE_INDEX_TRAILER));
+  size_t words = (index->length - sizeof(ORACLE_INDEX_TRAILER)) / sizeof(uint32_t);
+  if (trailer->magic != ORACLE_INDEX_MAGIC || trailer->version != ORACLE_INDEX_VERSION ||
+      trailer->bucketBits > 27 || words != (size_t)trailer->count + (1 << trailer->bucketBits) + 1) {
+    munmap(index->map, index->length);
+    return false;
+  }
+  index->count = trailer->count;
+  index->bucketBits = trailer->bucketBits;
+  index->netlists = (const uint32_t*)index->map;
+  index->offsets = index->netlists + index->count;
+  return true;
+}
+
+static inline void OracleIndex_Close(ORACLE_INDEX* index)
+{
+  munmap(index->map, index->length);
+}
+
+// Returns the netlist with its LED states, or NULL if it isn't in the oracle
+static inline const uint32_t* OracleIndex_Find(const ORACLE_INDEX* index, uint32_t netlist)
+{
+  netlist &= NETLIST_NETLIST_MASK;
+  uint32_t bucket = OracleIndex_Bucket(netlist, index->bucketBits);
+  uint32_t lo = index->offsets[bucket];
+  uint32_t hi = index->offsets[bucket + 1];
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint32_t candidate = index->netlists[mid] & NETLIST_NETLIST_MASK;
+    if (candidate == netlist)
+      return &index->netlists[mid];
+    else if (candidate < netlist)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return 0;
+}
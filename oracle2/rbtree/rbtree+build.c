@@ -0,0 +1,134 @@
+/*
+
+  rbtree+build.c
+
+  Adds methods to the Red-Black Tree implementation that build a tree
+  from nodes that are already in sorted order in O(n), instead of
+  inserting them one at a time in O(n lg n). The middle node of each
+  range becomes the root of its subtree, so every level is full except
+  the deepest one, and coloring the deepest level red and everything
+  above it black makes a valid Red-Black Tree without any rotations.
+
+  rbtree_build_sorted replaces the contents of the tree with the nodes
+  in the array, which must be in strictly increasing order according
+  to the tree's compare function. rbtree_union moves every node of
+  another tree into this one in O(n + m), merging the two in order and
+  rebuilding. When both trees hold an equal node, the one already in
+  this tree is kept, and the other is released with rbtree_node_free
+  on the other tree (see rbtree+pool.h). The other tree is left empty.
+
+  Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#include <stdlib.h>
+
+#include "rbtree+build.h"
+#include "rbtree+pool.h"
+#include "rbtree.r"
+
+static rbtree_node_t *BuildSorted(rbtree_t *self,
+                                  rbtree_node_t **nodes,
+                                  size_t n,
+                                  rbtree_node_t *parent,
+                                  unsigned int depth,
+                                  unsigned int red_depth) {
+  if (!n)
+    return self->nil;
+
+  size_t middle = n / 2;
+  rbtree_node_t *x = nodes[middle];
+  SetParent(self, x, parent);
+  SetLeft(self, x, BuildSorted(self, nodes, middle, x, depth + 1, red_depth));
+  SetRight(self, x, BuildSorted(self, nodes + middle + 1, n - middle - 1, x, depth + 1, red_depth));
+  rbtree_node_set_color(x, (depth == red_depth) ? RBTREE_NODE_COLOR_RED : RBTREE_NODE_COLOR_BLACK);
+  return x;
+}
+
+static size_t Count(rbtree_t *self) {
+  size_t n = 0;
+  if (self->root != self->nil)
+    for (rbtree_node_t *x = Minimum(self, self->root); x != self->nil; x = Successor(self, x))
+      n++;
+  return n;
+}
+
+void rbtree_build_sorted(rbtree_t *self, rbtree_node_t **nodes, size_t n) {
+  // Every node is at most floor(lg n) deep, and only that level can be partially filled
+  unsigned int red_depth = 0;
+  while ((size_t)2 << red_depth <= n)
+    red_depth++;
+
+  self->root = BuildSorted(self, nodes, n, self->nil, 0, red_depth);
+  SetBlack(self->root);
+}
+
+int rbtree_union(rbtree_t *self, rbtree_t *other) {
+  size_t capacity = Count(self) + Count(other);
+  if (!capacity)
+    return 1;
+
+  rbtree_node_t **nodes = malloc(capacity * sizeof(rbtree_node_t *));
+  if (!nodes)
+    return 0;
+
+  // Merges the two in order, the nodes from other that are already in
+  // self fill the array from the back, so both trees can still be
+  // walked until the merge is done
+  rbtree_node_t *x = (self->root != self->nil) ? Minimum(self, self->root) : self->nil;
+  rbtree_node_t *y = (other->root != other->nil) ? Minimum(other, other->root) : other->nil;
+  size_t n = 0;
+  size_t duplicates = capacity;
+  while (x != self->nil || y != other->nil) {
+    int order;
+    if (x == self->nil)
+      order = 1;
+    else if (y == other->nil)
+      order = -1;
+    else
+      order = self->Compare(x, y);
+
+    if (order <= 0) {
+      nodes[n++] = x;
+      x = Successor(self, x);
+      if (order == 0) {
+        nodes[--duplicates] = y;
+        y = Successor(other, y);
+      }
+    } else {
+      nodes[n++] = y;
+      y = Successor(other, y);
+    }
+  }
+
+  rbtree_build_sorted(self, nodes, n);
+  other->root = other->nil;
+  for (size_t i = duplicates; i < capacity; ++i)
+    rbtree_node_free(other, nodes[i]);
+  free(nodes);
+  return 1;
+}
@@ -0,0 +1,55 @@
+/*
+
+  rbtree+build.h
+
+  Adds methods to the Red-Black Tree implementation that build a tree
+  from nodes that are already in sorted order in O(n), instead of
+  inserting them one at a time in O(n lg n). The middle node of each
+  range becomes the root of its subtree, so every level is full except
+  the deepest one, and coloring the deepest level red and everything
+  above it black makes a valid Red-Black Tree without any rotations.
+
+  rbtree_build_sorted replaces the contents of the tree with the nodes
+  in the array, which must be in strictly increasing order according
+  to the tree's compare function. rbtree_union moves every node of
+  another tree into this one in O(n + m), merging the two in order and
+  rebuilding. When both trees hold an equal node, the one already in
+  this tree is kept, and the other is released with rbtree_node_free
+  on the other tree (see rbtree+pool.h). The other tree is left empty.
+
+  Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "rbtree.h"
+
+void rbtree_build_sorted(rbtree_t *self, rbtree_node_t **nodes, size_t n);
+int rbtree_union(rbtree_t *self, rbtree_t *other);
@@ -46,15 +46,15 @@ static void PrintDotNil(rbtree_node_t *node, int nilcount, FILE *stream) {
 static void PrintDotAux(rbtree_t *self, rbtree_node_t *node, FILE *stream) {
   static unsigned int nilcount = 0;
 
-  if (node->left != self->nil) {
-    fprintf(stream, "    \"%p\" -> \"%p\";\n", node, node->left);
-    PrintDotAux(self, node->left, stream);
+  if (rbtree_node_left(self, node) != self->nil) {
+    fprintf(stream, "    \"%p\" -> \"%p\";\n", node, rbtree_node_left(self, node));
+    PrintDotAux(self, rbtree_node_left(self, node), stream);
   } else
     PrintDotNil(node, nilcount++, stream);
 
-  if (node->right != self->nil) {
-    fprintf(stream, "    \"%p\" -> \"%p\";\n", node, node->right);
-    PrintDotAux(self, node->right, stream);
+  if (rbtree_node_right(self, node) != self->nil) {
+    fprintf(stream, "    \"%p\" -> \"%p\";\n", node, rbtree_node_right(self, node));
+    PrintDotAux(self, rbtree_node_right(self, node), stream);
   } else
     PrintDotNil(node, nilcount++, stream);
 }
@@ -71,7 +71,7 @@ void rbtree_print_dot(rbtree_t *self, FILE *stream, void (*PrintNodeFunc)(FILE *
 
   if (self->root == self->nil)
     fprintf(stream, "\n");
-  else if (self->root->right == self->nil && self->root->left == self->nil)
+  else if (rbtree_node_right(self, self->root) == self->nil && rbtree_node_left(self, self->root) == self->nil)
     fprintf(stream, "    \"%p\";\n", self->root);
   else
     PrintDotAux(self, self->root, stream);
@@ -87,7 +87,7 @@ void rbtree_print_dot(rbtree_t *self, FILE *stream, void (*PrintNodeFunc)(FILE *
   // Color red nodes
   rbtree_node_t *first_red_node = 0;
   for (rbtree_node_t *itr = rbtree_minimum(self); itr != self->nil; itr = rbtree_successor(self, itr))
-    if (itr->color == RBTREE_NODE_COLOR_RED) {
+    if (rbtree_node_color(itr) == RBTREE_NODE_COLOR_RED) {
       if (!first_red_node) {
         first_red_node = itr;
         fprintf(stream, "    ");
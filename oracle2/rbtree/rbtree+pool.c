@@ -0,0 +1,170 @@
+/*
+
+  rbtree+pool.c
+
+  Adds node allocation from a pool of contiguous slabs to the
+  Red-Black Tree implementation, along with a clear method that
+  releases every node in the tree in O(n) without rebalancing. A tree
+  initialized with rbtree_init_pool gets its nodes from the pool, and
+  a tree initialized with rbtree_init gets them from malloc, so code
+  that calls rbtree_node_alloc and rbtree_node_free works either way.
+
+  A pool hands out nodes of rbtree_node_t_size bytes from slabs of
+  nodes_per_slab nodes, and recycles freed nodes before carving new
+  ones out of a slab. Several trees with the same node size may share
+  one pool, and rbtree_pool_destroy frees every slab at once.
+
+  Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rbtree+pool.h"
+#include "rbtree.r"
+
+void rbtree_pool_init(rbtree_pool_t *pool,
+                      unsigned int rbtree_node_t_size,
+                      unsigned int nodes_per_slab) {
+  pool->slabs = 0;
+  pool->unused = pool->end = 0;
+  pool->free_list = 0;
+#if defined(RBTREE_COMPACT)
+  // The low bit of every link is the color
+  rbtree_node_t_size = (rbtree_node_t_size + 1) & ~1u;
+#endif
+  pool->rbtree_node_t_size = rbtree_node_t_size;
+  pool->nodes_per_slab = nodes_per_slab ? nodes_per_slab : 1;
+#if defined(RBTREE_COMPACT_INDEX)
+  // Every node has to be reachable by a 32 bit offset from the start of the arena
+  if (pool->nodes_per_slab > (UINT32_MAX - sizeof(rbtree_pool_slab_t)) / rbtree_node_t_size)
+    pool->nodes_per_slab = (UINT32_MAX - sizeof(rbtree_pool_slab_t)) / rbtree_node_t_size;
+#endif
+  pool->slab_count = 0;
+  pool->recycled_count = 0;
+}
+
+void rbtree_pool_destroy(rbtree_pool_t *pool) {
+  while (pool->slabs) {
+    rbtree_pool_slab_t *next = pool->slabs->next;
+    free(pool->slabs);
+    pool->slabs = next;
+  }
+  rbtree_pool_init(pool, pool->rbtree_node_t_size, pool->nodes_per_slab);
+}
+
+static int AddSlab(rbtree_pool_t *pool) {
+  rbtree_pool_slab_t *slab = malloc(sizeof(rbtree_pool_slab_t) +
+                                    (size_t)pool->nodes_per_slab * pool->rbtree_node_t_size);
+  if (!slab)
+    return 0;
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->slab_count++;
+  pool->unused = (unsigned char *)(slab + 1);
+  pool->end = pool->unused + (size_t)pool->nodes_per_slab * pool->rbtree_node_t_size;
+  return 1;
+}
+
+// Freed nodes are linked together through their first bytes, whatever the node layout is
+rbtree_node_t *rbtree_pool_alloc(rbtree_pool_t *pool) {
+  rbtree_node_t *z = pool->free_list;
+  if (z) {
+    memcpy(&pool->free_list, z, sizeof(pool->free_list));
+    pool->recycled_count++;
+    return z;
+  }
+  if (pool->unused == pool->end) {
+#if defined(RBTREE_COMPACT_INDEX)
+    // The arena is a single slab, so it never moves
+    if (pool->slabs)
+      return 0;
+#endif
+    if (!AddSlab(pool))
+      return 0;
+  }
+  z = (rbtree_node_t *)pool->unused;
+  pool->unused += pool->rbtree_node_t_size;
+  return z;
+}
+
+void rbtree_pool_free(rbtree_pool_t *pool, rbtree_node_t *z) {
+  memcpy(z, &pool->free_list, sizeof(pool->free_list));
+  pool->free_list = z;
+}
+
+int rbtree_init_pool(rbtree_t *self,
+                     rbtree_node_t *nil,
+                     unsigned int rbtree_node_t_size,
+                     int (*CompareFunc)(const rbtree_node_t *,
+                                        const rbtree_node_t *),
+                     rbtree_pool_t *pool) {
+  rbtree_init(self, nil, rbtree_node_t_size, CompareFunc);
+  self->pool = pool;
+#if defined(RBTREE_COMPACT_INDEX)
+  // Every link is an offset from the start of the arena, so it has to exist before the first node
+  if (!pool->slabs && !AddSlab(pool))
+    return 0;
+  self->arena = (unsigned char *)pool->slabs;
+#endif
+  return 1;
+}
+
+rbtree_node_t *rbtree_node_alloc(rbtree_t *self) {
+  if (self->pool)
+    return rbtree_pool_alloc(self->pool);
+  return malloc(self->rbtree_node_t_size);
+}
+
+void rbtree_node_free(rbtree_t *self, rbtree_node_t *z) {
+  if (self->pool)
+    rbtree_pool_free(self->pool, z);
+  else
+    free(z);
+}
+
+// Rotates each left child up until the top node has none, and then
+// frees it and moves on to its right child, so every node is visited
+// once without a stack or any rebalancing
+void rbtree_clear(rbtree_t *self) {
+  rbtree_node_t *x = self->root;
+  while (x != self->nil) {
+    rbtree_node_t *y = Left(self, x);
+    if (y != self->nil) {
+      SetLeft(self, x, Right(self, y));
+      SetRight(self, y, x);
+      x = y;
+    } else {
+      y = Right(self, x);
+      rbtree_node_free(self, x);
+      x = y;
+    }
+  }
+  self->root = self->nil;
+}
@@ -0,0 +1,89 @@
+/*
+
+  rbtree+pool.h
+
+  Adds node allocation from a pool of contiguous slabs to the
+  Red-Black Tree implementation, along with a clear method that
+  releases every node in the tree in O(n) without rebalancing. A tree
+  initialized with rbtree_init_pool gets its nodes from the pool, and
+  a tree initialized with rbtree_init gets them from malloc, so code
+  that calls rbtree_node_alloc and rbtree_node_free works either way.
+
+  A pool hands out nodes of rbtree_node_t_size bytes from slabs of
+  nodes_per_slab nodes, and recycles freed nodes before carving new
+  ones out of a slab. Several trees with the same node size may share
+  one pool, and rbtree_pool_destroy frees every slab at once.
+
+  With -DRBTREE_COMPACT_INDEX the links in the nodes are offsets from
+  the start of the pool, so the pool is a single arena of
+  nodes_per_slab nodes that never moves, and rbtree_pool_alloc returns
+  NULL once it is full. Size it for every node the trees will hold.
+  The arena is allocated by rbtree_init_pool, which returns 0 if that
+  fails (it always returns 1 in the other layouts).
+
+  Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#include "rbtree.h"
+
+typedef struct _rbtree_pool_slab_t rbtree_pool_slab_t;
+struct _rbtree_pool_slab_t {
+  rbtree_pool_slab_t *next;
+};
+
+struct _rbtree_pool_t {
+  rbtree_pool_slab_t *slabs;
+  unsigned char *unused;
+  unsigned char *end;
+  rbtree_node_t *free_list;
+  unsigned int rbtree_node_t_size;
+  unsigned int nodes_per_slab;
+  size_t slab_count;
+  size_t recycled_count;
+};
+
+void rbtree_pool_init(rbtree_pool_t *pool,
+                      unsigned int rbtree_node_t_size,
+                      unsigned int nodes_per_slab);
+void rbtree_pool_destroy(rbtree_pool_t *pool);
+rbtree_node_t *rbtree_pool_alloc(rbtree_pool_t *pool);
+void rbtree_pool_free(rbtree_pool_t *pool, rbtree_node_t *z);
+
+int rbtree_init_pool(rbtree_t *self,
+                     rbtree_node_t *nil,
+                     unsigned int rbtree_node_t_size,
+                     int (*CompareFunc)(const rbtree_node_t *,
+                                        const rbtree_node_t *),
+                     rbtree_pool_t *pool);
+rbtree_node_t *rbtree_node_alloc(rbtree_t *self);
+void rbtree_node_free(rbtree_t *self, rbtree_node_t *z);
+void rbtree_clear(rbtree_t *self);
@@ -43,9 +43,9 @@ rbtree_node_t *rbtree_search_using(rbtree_t *self,
   rbtree_node_t *x = self->root;
   while (x != self->nil && CompareFunc(k, x)) {
     if (CompareFunc(k, x) < 0)
-      x = x->left;
+      x = rbtree_node_left(self, x);
     else
-      x = x->right;
+      x = rbtree_node_right(self, x);
   }
   return x;
 }
@@ -43,25 +43,25 @@ int rbtree_setinsert(rbtree_t *self, rbtree_node_t *z) {
   while (x != self->nil && (unique = self->Compare(z, x))) {
     y = x;
     if (unique < 0)
-      x = x->left;
+      x = Left(self, x);
     else
-      x = x->right;
+      x = Right(self, x);
   }
   if (!unique)
     return 0;
 
-  z->parent = y;
+  SetParent(self, z, y);
   if (y == self->nil)
     self->root = z;
   else {
     if (self->Compare(z, y) < 0)
-      y->left = z;
+      SetLeft(self, y, z);
     else
-      y->right = z;
+      SetRight(self, y, z);
   }
-  z->left = self->nil;
-  z->right = self->nil;
-  z->color = RBTREE_NODE_COLOR_RED;
+  SetLeft(self, z, self->nil);
+  SetRight(self, z, self->nil);
+  SetRed(z);
   InsertFixup(self, z);
   return 1;
 }
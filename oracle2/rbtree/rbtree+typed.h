@@ -0,0 +1,423 @@
+/*
+
+  rbtree+typed.h
+
+  A typed Red-Black Tree, generated at compile time for one key type
+  and an inline compare, instead of going through a Compare function
+  pointer and packed nodes. Define the parameters and include this
+  file, once per tree type (it has no include guard on purpose):
+
+    #define RBTREE_TYPED_NAME netlist_rbtree
+    #define RBTREE_TYPED_KEY uint32_t
+    #define RBTREE_TYPED_COMPARE(x, y) (((x) > (y)) - ((x) < (y)))
+    #include "rbtree/rbtree+typed.h"
+
+  which defines netlist_rbtree_t and netlist_rbtree_node_t, and the
+  same methods as rbtree.h and rbtree+setinsert.h, with the name in
+  front instead of rbtree: _init, _destroy, _search, _insert,
+  _setinsert, _minimum, _maximum, _predecessor, _successor, _delete,
+  and the three walks. RBTREE_TYPED_COMPARE takes two keys and
+  returns less than, equal to, or greater than zero, and may look at
+  only part of the key (a struct key carries a payload that way).
+
+  The nodes are naturally aligned, with the key stored in the node, and
+  the nil sentinel lives inside the tree, so a tree must not be copied
+  once it has been initialized. _search takes a key, and returns the
+  nil sentinel when it is not found, like rbtree_search. _delete keeps
+  the same contract as rbtree_delete: it returns the node to be freed,
+  which may not be the one passed in, in which case the key of the
+  node it returns has been moved into the one passed in. The parameter
+  macros are undefined at the end of this file.
+
+  Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  1. Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  2. Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY MATTHEW T. PANDINA "AS IS" AND ANY
+  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHEW T. PANDINA OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF
+  USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+  OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+  SUCH DAMAGE.
+
+*/
+
+#include <string.h>
+
+#include "rbtree.h"
+
+#if !defined(RBTREE_TYPED_NAME) || !defined(RBTREE_TYPED_KEY) || !defined(RBTREE_TYPED_COMPARE)
+#error "Define RBTREE_TYPED_NAME, RBTREE_TYPED_KEY, and RBTREE_TYPED_COMPARE before including rbtree+typed.h"
+#endif
+
+#define RBTREE_TYPED_CAT_(name, suffix) name##_##suffix
+#define RBTREE_TYPED_CAT(name, suffix) RBTREE_TYPED_CAT_(name, suffix)
+#define RBTREE_TYPED_FN(suffix) RBTREE_TYPED_CAT(RBTREE_TYPED_NAME, suffix)
+#define RBTREE_TYPED_TREE RBTREE_TYPED_FN(t)
+#define RBTREE_TYPED_NODE RBTREE_TYPED_FN(node_t)
+
+typedef struct RBTREE_TYPED_FN(node_s) RBTREE_TYPED_NODE;
+struct RBTREE_TYPED_FN(node_s) {
+  RBTREE_TYPED_NODE *left;
+  RBTREE_TYPED_NODE *right;
+  RBTREE_TYPED_NODE *parent;
+  RBTREE_TYPED_KEY key;
+  unsigned char color;
+};
+
+typedef struct RBTREE_TYPED_FN(s) RBTREE_TYPED_TREE;
+struct RBTREE_TYPED_FN(s) {
+  RBTREE_TYPED_NODE *root;
+  RBTREE_TYPED_NODE nil;
+};
+
+static inline void RBTREE_TYPED_FN(init)(RBTREE_TYPED_TREE *self) {
+  self->nil.parent = self->nil.left = self->nil.right = &self->nil;
+  self->nil.color = RBTREE_NODE_COLOR_BLACK;
+  self->root = &self->nil;
+}
+
+static inline void RBTREE_TYPED_FN(destroy)(RBTREE_TYPED_TREE *self) {
+  memset(self, 0, sizeof(RBTREE_TYPED_TREE));
+}
+
+static inline void RBTREE_TYPED_FN(LeftRotate)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  RBTREE_TYPED_NODE *y = x->right;
+  x->right = y->left;
+  if (y->left != &self->nil)
+    y->left->parent = x;
+  y->parent = x->parent;
+  if (x->parent == &self->nil)
+    self->root = y;
+  else {
+    if (x == x->parent->left)
+      x->parent->left = y;
+    else
+      x->parent->right = y;
+  }
+  y->left = x;
+  x->parent = y;
+}
+
+static inline void RBTREE_TYPED_FN(RightRotate)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *y) {
+  RBTREE_TYPED_NODE *x = y->left;
+  y->left = x->right;
+  if (x->right != &self->nil)
+    x->right->parent = y;
+  x->parent = y->parent;
+  if (y->parent == &self->nil)
+    self->root = x;
+  else {
+    if (y == y->parent->right)
+      y->parent->right = x;
+    else
+      y->parent->left = x;
+  }
+  x->right = y;
+  y->parent = x;
+}
+
+static inline void RBTREE_TYPED_FN(InsertFixup)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *z) {
+  RBTREE_TYPED_NODE *y;
+  while (z->parent->color == RBTREE_NODE_COLOR_RED) {
+    if (z->parent == z->parent->parent->left) {
+      y = z->parent->parent->right;
+      if (y->color == RBTREE_NODE_COLOR_RED) {
+        z->parent->color = RBTREE_NODE_COLOR_BLACK;
+        y->color = RBTREE_NODE_COLOR_BLACK;
+        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
+        z = z->parent->parent;
+      } else {
+        if (z == z->parent->right) {
+          z = z->parent;
+          RBTREE_TYPED_FN(LeftRotate)(self, z);
+        }
+        z->parent->color = RBTREE_NODE_COLOR_BLACK;
+        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
+        RBTREE_TYPED_FN(RightRotate)(self, z->parent->parent);
+      }
+    } else {
+      y = z->parent->parent->left;
+      if (y->color == RBTREE_NODE_COLOR_RED) {
+        z->parent->color = RBTREE_NODE_COLOR_BLACK;
+        y->color = RBTREE_NODE_COLOR_BLACK;
+        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
+        z = z->parent->parent;
+      } else {
+        if (z == z->parent->left) {
+          z = z->parent;
+          RBTREE_TYPED_FN(RightRotate)(self, z);
+        }
+        z->parent->color = RBTREE_NODE_COLOR_BLACK;
+        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
+        RBTREE_TYPED_FN(LeftRotate)(self, z->parent->parent);
+      }
+    }
+  }
+  self->root->color = RBTREE_NODE_COLOR_BLACK;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(Minimum)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  while (x->left != &self->nil)
+    x = x->left;
+  return x;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(Maximum)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  while (x->right != &self->nil)
+    x = x->right;
+  return x;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(predecessor)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  if (x->left != &self->nil)
+    return RBTREE_TYPED_FN(Maximum)(self, x->left);
+  RBTREE_TYPED_NODE *y = x->parent;
+  while (y != &self->nil && x == y->left) {
+    x = y;
+    y = y->parent;
+  }
+  return y;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(successor)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  if (x->right != &self->nil)
+    return RBTREE_TYPED_FN(Minimum)(self, x->right);
+  RBTREE_TYPED_NODE *y = x->parent;
+  while (y != &self->nil && x == y->right) {
+    x = y;
+    y = y->parent;
+  }
+  return y;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(minimum)(RBTREE_TYPED_TREE *self) {
+  return RBTREE_TYPED_FN(Minimum)(self, self->root);
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(maximum)(RBTREE_TYPED_TREE *self) {
+  return RBTREE_TYPED_FN(Maximum)(self, self->root);
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(search)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_KEY k) {
+  RBTREE_TYPED_NODE *x = self->root;
+  int order;
+  while (x != &self->nil && (order = RBTREE_TYPED_COMPARE(k, x->key))) {
+    if (order < 0)
+      x = x->left;
+    else
+      x = x->right;
+  }
+  return x;
+}
+
+static inline void RBTREE_TYPED_FN(Link)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *z, RBTREE_TYPED_NODE *y, int order) {
+  z->parent = y;
+  if (y == &self->nil)
+    self->root = z;
+  else {
+    if (order < 0)
+      y->left = z;
+    else
+      y->right = z;
+  }
+  z->left = &self->nil;
+  z->right = &self->nil;
+  z->color = RBTREE_NODE_COLOR_RED;
+  RBTREE_TYPED_FN(InsertFixup)(self, z);
+}
+
+static inline void RBTREE_TYPED_FN(insert)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *z) {
+  RBTREE_TYPED_NODE *y = &self->nil;
+  RBTREE_TYPED_NODE *x = self->root;
+  int order = 0;
+  while (x != &self->nil) {
+    y = x;
+    order = RBTREE_TYPED_COMPARE(z->key, x->key);
+    if (order < 0)
+      x = x->left;
+    else
+      x = x->right;
+  }
+  RBTREE_TYPED_FN(Link)(self, z, y, order);
+}
+
+static inline int RBTREE_TYPED_FN(setinsert)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *z) {
+  RBTREE_TYPED_NODE *y = &self->nil;
+  RBTREE_TYPED_NODE *x = self->root;
+  int order = 0;
+  while (x != &self->nil) {
+    order = RBTREE_TYPED_COMPARE(z->key, x->key);
+    if (!order)
+      return 0;
+    y = x;
+    if (order < 0)
+      x = x->left;
+    else
+      x = x->right;
+  }
+  RBTREE_TYPED_FN(Link)(self, z, y, order);
+  return 1;
+}
+
+static inline void RBTREE_TYPED_FN(DeleteFixup)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *x) {
+  RBTREE_TYPED_NODE *w;
+  while (x != self->root && x->color == RBTREE_NODE_COLOR_BLACK) {
+    if (x == x->parent->left) {
+      w = x->parent->right;
+      if (w->color == RBTREE_NODE_COLOR_RED) {
+        w->color = RBTREE_NODE_COLOR_BLACK;
+        x->parent->color = RBTREE_NODE_COLOR_RED;
+        RBTREE_TYPED_FN(LeftRotate)(self, x->parent);
+        w = x->parent->right;
+      }
+      if (w->left->color == RBTREE_NODE_COLOR_BLACK &&
+          w->right->color == RBTREE_NODE_COLOR_BLACK) {
+        w->color = RBTREE_NODE_COLOR_RED;
+        x = x->parent;
+      } else {
+        if (w->right->color == RBTREE_NODE_COLOR_BLACK) {
+          w->left->color = RBTREE_NODE_COLOR_BLACK;
+          w->color = RBTREE_NODE_COLOR_RED;
+          RBTREE_TYPED_FN(RightRotate)(self, w);
+          w = x->parent->right;
+        }
+        w->color = x->parent->color;
+        x->parent->color = RBTREE_NODE_COLOR_BLACK;
+        w->right->color = RBTREE_NODE_COLOR_BLACK;
+        RBTREE_TYPED_FN(LeftRotate)(self, x->parent);
+        x = self->root;
+      }
+    } else {
+      w = x->parent->left;
+      if (w->color == RBTREE_NODE_COLOR_RED) {
+        w->color = RBTREE_NODE_COLOR_BLACK;
+        x->parent->color = RBTREE_NODE_COLOR_RED;
+        RBTREE_TYPED_FN(RightRotate)(self, x->parent);
+        w = x->parent->left;
+      }
+      if (w->right->color == RBTREE_NODE_COLOR_BLACK &&
+          w->left->color == RBTREE_NODE_COLOR_BLACK) {
+        w->color = RBTREE_NODE_COLOR_RED;
+        x = x->parent;
+      } else {
+        if (w->left->color == RBTREE_NODE_COLOR_BLACK) {
+          w->right->color = RBTREE_NODE_COLOR_BLACK;
+          w->color = RBTREE_NODE_COLOR_RED;
+          RBTREE_TYPED_FN(LeftRotate)(self, w);
+          w = x->parent->left;
+        }
+        w->color = x->parent->color;
+        x->parent->color = RBTREE_NODE_COLOR_BLACK;
+        w->left->color = RBTREE_NODE_COLOR_BLACK;
+        RBTREE_TYPED_FN(RightRotate)(self, x->parent);
+        x = self->root;
+      }
+    }
+  }
+  x->color = RBTREE_NODE_COLOR_BLACK;
+}
+
+static inline RBTREE_TYPED_NODE *RBTREE_TYPED_FN(delete)(RBTREE_TYPED_TREE *self, RBTREE_TYPED_NODE *z) {
+  RBTREE_TYPED_NODE *x, *y;
+  if (z->left == &self->nil || z->right == &self->nil)
+    y = z;
+  else
+    y = RBTREE_TYPED_FN(successor)(self, z);
+  if (y->left != &self->nil)
+    x = y->left;
+  else
+    x = y->right;
+  x->parent = y->parent;
+  if (y->parent == &self->nil)
+    self->root = x;
+  else {
+    if (y == y->parent->left)
+      y->parent->left = x;
+    else
+      y->parent->right = x;
+  }
+  if (y != z)
+    z->key = y->key;
+  if (y->color == RBTREE_NODE_COLOR_BLACK)
+    RBTREE_TYPED_FN(DeleteFixup)(self, x);
+  return y;
+}
+
+__attribute__((unused))
+static void RBTREE_TYPED_FN(InorderTreeWalk)(RBTREE_TYPED_TREE *self,
+                                             RBTREE_TYPED_NODE *x,
+                                             void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                             void *context) {
+  if (x != &self->nil) {
+    RBTREE_TYPED_FN(InorderTreeWalk)(self, x->left, ApplyFunc, context);
+    ApplyFunc(x, context);
+    RBTREE_TYPED_FN(InorderTreeWalk)(self, x->right, ApplyFunc, context);
+  }
+}
+
+static inline void RBTREE_TYPED_FN(inorderwalk)(RBTREE_TYPED_TREE *self,
+                                                void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                                void *context) {
+  RBTREE_TYPED_FN(InorderTreeWalk)(self, self->root, ApplyFunc, context);
+}
+
+__attribute__((unused))
+static void RBTREE_TYPED_FN(PreorderTreeWalk)(RBTREE_TYPED_TREE *self,
+                                              RBTREE_TYPED_NODE *x,
+                                              void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                              void *context) {
+  if (x != &self->nil) {
+    ApplyFunc(x, context);
+    RBTREE_TYPED_FN(PreorderTreeWalk)(self, x->left, ApplyFunc, context);
+    RBTREE_TYPED_FN(PreorderTreeWalk)(self, x->right, ApplyFunc, context);
+  }
+}
+
+static inline void RBTREE_TYPED_FN(preorderwalk)(RBTREE_TYPED_TREE *self,
+                                                 void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                                 void *context) {
+  RBTREE_TYPED_FN(PreorderTreeWalk)(self, self->root, ApplyFunc, context);
+}
+
+__attribute__((unused))
+static void RBTREE_TYPED_FN(PostorderTreeWalk)(RBTREE_TYPED_TREE *self,
+                                               RBTREE_TYPED_NODE *x,
+                                               void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                               void *context) {
+  if (x != &self->nil) {
+    RBTREE_TYPED_FN(PostorderTreeWalk)(self, x->left, ApplyFunc, context);
+    RBTREE_TYPED_FN(PostorderTreeWalk)(self, x->right, ApplyFunc, context);
+    ApplyFunc(x, context);
+  }
+}
+
+static inline void RBTREE_TYPED_FN(postorderwalk)(RBTREE_TYPED_TREE *self,
+                                                  void (*ApplyFunc)(RBTREE_TYPED_NODE *, void *),
+                                                  void *context) {
+  RBTREE_TYPED_FN(PostorderTreeWalk)(self, self->root, ApplyFunc, context);
+}
+
+#undef RBTREE_TYPED_NODE
+#undef RBTREE_TYPED_TREE
+#undef RBTREE_TYPED_FN
+#undef RBTREE_TYPED_CAT
+#undef RBTREE_TYPED_CAT_
+#undef RBTREE_TYPED_COMPARE
+#undef RBTREE_TYPED_KEY
+#undef RBTREE_TYPED_NAME
@@ -44,8 +44,14 @@ void rbtree_init(rbtree_t *self,
                  int (*CompareFunc)(const rbtree_node_t *,
                                     const rbtree_node_t *)) {
   self->nil = nil;
-  self->nil->parent = self->nil->left = self->nil->right = self->nil;
-  self->nil->color = RBTREE_NODE_COLOR_BLACK;
+  self->pool = 0;
+#if defined(RBTREE_COMPACT_INDEX)
+  self->arena = 0;
+#endif
+  SetParent(self, self->nil, self->nil);
+  SetLeft(self, self->nil, self->nil);
+  SetRight(self, self->nil, self->nil);
+  SetBlack(self->nil);
 
   self->root = self->nil;
   self->rbtree_node_t_size = rbtree_node_t_size;
@@ -60,9 +66,9 @@ rbtree_node_t *rbtree_search(rbtree_t *self, rbtree_node_t *k) {
   rbtree_node_t *x = self->root;
   while (x != self->nil && self->Compare(k, x)) {
     if (self->Compare(k, x) < 0)
-      x = x->left;
+      x = Left(self, x);
     else
-      x = x->right;
+      x = Right(self, x);
   }
   return x;
 }
@@ -73,22 +79,22 @@ void rbtree_insert(rbtree_t *self, rbtree_node_t *z) {
   while (x != self->nil) {
     y = x;
     if (self->Compare(z, x) < 0)
-      x = x->left;
+      x = Left(self, x);
     else
-      x = x->right;
+      x = Right(self, x);
   }
-  z->parent = y;
+  SetParent(self, z, y);
   if (y == self->nil)
     self->root = z;
   else {
     if (self->Compare(z, y) < 0)
-      y->left = z;
+      SetLeft(self, y, z);
     else
-      y->right = z;
+      SetRight(self, y, z);
   }
-  z->left = self->nil;
-  z->right = self->nil;
-  z->color = RBTREE_NODE_COLOR_RED;
+  SetLeft(self, z, self->nil);
+  SetRight(self, z, self->nil);
+  SetRed(z);
   InsertFixup(self, z);
 }
 
@@ -110,28 +116,28 @@ rbtree_node_t *rbtree_successor(rbtree_t *self, rbtree_node_t *x) {
 
 rbtree_node_t *rbtree_delete(rbtree_t *self, rbtree_node_t *z) {
   rbtree_node_t *x, *y;
-  if (z->left == self->nil || z->right == self->nil)
+  if (Left(self, z) == self->nil || Right(self, z) == self->nil)
     y = z;
   else
     y = Successor(self, z);
-  if (y->left != self->nil)
-    x = y->left;
+  if (Left(self, y) != self->nil)
+    x = Left(self, y);
   else
-    x = y->right;
-  x->parent = y->parent;
-  if (y->parent == self->nil)
+    x = Right(self, y);
+  SetParent(self, x, Parent(self, y));
+  if (Parent(self, y) == self->nil)
     self->root = x;
   else {
-    if (y == y->parent->left)
-      y->parent->left = x;
+    if (y == Left(self, Parent(self, y)))
+      SetLeft(self, Parent(self, y), x);
     else
-      y->parent->right = x;
+      SetRight(self, Parent(self, y), x);
   }
   if (y != z && self->rbtree_node_t_size > sizeof(rbtree_node_t))
     memcpy(((unsigned char *)z) + sizeof(rbtree_node_t),
            ((unsigned char *)y) + sizeof(rbtree_node_t),
            self->rbtree_node_t_size - sizeof(rbtree_node_t));
-  if (y->color == RBTREE_NODE_COLOR_BLACK)
+  if (IsBlack(y))
     DeleteFixup(self, x);
   return y;
 }
@@ -141,9 +147,9 @@ static void InorderTreeWalk(rbtree_t *self,
                             void (*ApplyFunc)(rbtree_node_t *, void *),
                             void *context) {
   if (x != self->nil) {
-    InorderTreeWalk(self, x->left, ApplyFunc, context);
+    InorderTreeWalk(self, Left(self, x), ApplyFunc, context);
     ApplyFunc(x, context);
-    InorderTreeWalk(self, x->right, ApplyFunc, context);
+    InorderTreeWalk(self, Right(self, x), ApplyFunc, context);
   }
 }
 
@@ -159,8 +165,8 @@ static void PreorderTreeWalk(rbtree_t *self,
                              void *context) {
   if (x != self->nil) {
     ApplyFunc(x, context);
-    PreorderTreeWalk(self, x->left, ApplyFunc, context);
-    PreorderTreeWalk(self, x->right, ApplyFunc, context);
+    PreorderTreeWalk(self, Left(self, x), ApplyFunc, context);
+    PreorderTreeWalk(self, Right(self, x), ApplyFunc, context);
   }
 }
 
@@ -175,8 +181,8 @@ static void PostorderTreeWalk(rbtree_t *self,
                               void (*ApplyFunc)(rbtree_node_t *, void *),
                               void *context) {
   if (x != self->nil) {
-    PostorderTreeWalk(self, x->left, ApplyFunc, context);
-    PostorderTreeWalk(self, x->right, ApplyFunc, context);
+    PostorderTreeWalk(self, Left(self, x), ApplyFunc, context);
+    PostorderTreeWalk(self, Right(self, x), ApplyFunc, context);
     ApplyFunc(x, context);
   }
 }
@@ -5,6 +5,20 @@
   Implements the Red-Black Tree algorithm as described in
   "Introduction to Algorithms"
 
+  The node layout can be made smaller at build time:
+
+    -DRBTREE_COMPACT stores the color in the low bit of the parent
+    pointer, so nodes must be at least 2 byte aligned.
+
+    -DRBTREE_COMPACT_INDEX (which implies RBTREE_COMPACT) stores
+    32 bit byte offsets into the arena of an rbtree_pool_t instead of
+    pointers, with 0 standing for nil. Every tree has to be set up with
+    rbtree_init_pool, and get all of its nodes from that pool (see
+    rbtree+pool.h).
+
+  Code outside of the implementation should use the rbtree_node_*
+  accessors below instead of the fields, so it works with any layout.
+
   Copyright 2009-2020 Matthew T. Pandina. All rights reserved.
 
   Redistribution and use in source and binary forms, with or without
@@ -35,6 +49,12 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#if defined(RBTREE_COMPACT_INDEX) && !defined(RBTREE_COMPACT)
+#define RBTREE_COMPACT
+#endif
+
 typedef enum _rbtree_node_color_t rbtree_node_color_t;
 enum _rbtree_node_color_t {
   RBTREE_NODE_COLOR_RED,
@@ -43,20 +63,148 @@ enum _rbtree_node_color_t {
 
 typedef struct _rbtree_node_t rbtree_node_t;
 struct _rbtree_node_t {
+#if defined(RBTREE_COMPACT_INDEX)
+  uint32_t left;
+  uint32_t right;
+  uint32_t parent_color;
+#elif defined(RBTREE_COMPACT)
+  rbtree_node_t *left;
+  rbtree_node_t *right;
+  uintptr_t parent_color;
+#else
   rbtree_node_color_t color;
   rbtree_node_t *left;
   rbtree_node_t *right;
   rbtree_node_t *parent;
+#endif
 } __attribute__ ((packed));
 
+typedef struct _rbtree_pool_t rbtree_pool_t;
+
 typedef struct _rbtree_t rbtree_t;
 struct _rbtree_t {
   rbtree_node_t *nil;
   rbtree_node_t *root;
   unsigned int rbtree_node_t_size;
   int (*Compare)(const rbtree_node_t *x, const rbtree_node_t *y);
+  rbtree_pool_t *pool;
+#if defined(RBTREE_COMPACT_INDEX)
+  unsigned char *arena;
+#endif
 } __attribute__ ((packed));
 
+#if defined(RBTREE_COMPACT_INDEX)
+static inline rbtree_node_t *rbtree_node_at(const rbtree_t *self, uint32_t offset) {
+  return offset ? (rbtree_node_t *)(self->arena + offset) : self->nil;
+}
+
+static inline uint32_t rbtree_node_offset(const rbtree_t *self, const rbtree_node_t *x) {
+  return (x == self->nil) ? 0 : (uint32_t)((const unsigned char *)x - self->arena);
+}
+
+static inline rbtree_node_t *rbtree_node_left(const rbtree_t *self, const rbtree_node_t *x) {
+  return rbtree_node_at(self, x->left);
+}
+
+static inline rbtree_node_t *rbtree_node_right(const rbtree_t *self, const rbtree_node_t *x) {
+  return rbtree_node_at(self, x->right);
+}
+
+static inline rbtree_node_t *rbtree_node_parent(const rbtree_t *self, const rbtree_node_t *x) {
+  return rbtree_node_at(self, x->parent_color & ~1u);
+}
+
+static inline void rbtree_node_set_left(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  x->left = rbtree_node_offset(self, y);
+}
+
+static inline void rbtree_node_set_right(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  x->right = rbtree_node_offset(self, y);
+}
+
+static inline void rbtree_node_set_parent(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  x->parent_color = rbtree_node_offset(self, y) | (x->parent_color & 1);
+}
+#elif defined(RBTREE_COMPACT)
+static inline rbtree_node_t *rbtree_node_left(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return x->left;
+}
+
+static inline rbtree_node_t *rbtree_node_right(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return x->right;
+}
+
+static inline rbtree_node_t *rbtree_node_parent(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return (rbtree_node_t *)(x->parent_color & ~(uintptr_t)1);
+}
+
+static inline void rbtree_node_set_left(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->left = y;
+}
+
+static inline void rbtree_node_set_right(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->right = y;
+}
+
+static inline void rbtree_node_set_parent(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->parent_color = (uintptr_t)y | (x->parent_color & 1);
+}
+#else
+static inline rbtree_node_t *rbtree_node_left(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return x->left;
+}
+
+static inline rbtree_node_t *rbtree_node_right(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return x->right;
+}
+
+static inline rbtree_node_t *rbtree_node_parent(const rbtree_t *self, const rbtree_node_t *x) {
+  (void)self;
+  return x->parent;
+}
+
+static inline void rbtree_node_set_left(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->left = y;
+}
+
+static inline void rbtree_node_set_right(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->right = y;
+}
+
+static inline void rbtree_node_set_parent(const rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  (void)self;
+  x->parent = y;
+}
+#endif
+
+#if defined(RBTREE_COMPACT)
+static inline rbtree_node_color_t rbtree_node_color(const rbtree_node_t *x) {
+  return (rbtree_node_color_t)(x->parent_color & 1);
+}
+
+static inline void rbtree_node_set_color(rbtree_node_t *x, rbtree_node_color_t color) {
+  x->parent_color = (x->parent_color & ~1) | color;
+}
+#else
+static inline rbtree_node_color_t rbtree_node_color(const rbtree_node_t *x) {
+  return x->color;
+}
+
+static inline void rbtree_node_set_color(rbtree_node_t *x, rbtree_node_color_t color) {
+  x->color = color;
+}
+#endif
+
 void rbtree_init(rbtree_t *self,
                  rbtree_node_t *nil,
                  unsigned int rbtree_node_t_size,
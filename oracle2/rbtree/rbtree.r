@@ -43,170 +43,211 @@
 
 #include "rbtree.h"
 
+// Short names for the accessors in rbtree.h, which work with every node layout
+static inline rbtree_node_t *Left(rbtree_t *self, rbtree_node_t *x) {
+  return rbtree_node_left(self, x);
+}
+
+static inline rbtree_node_t *Right(rbtree_t *self, rbtree_node_t *x) {
+  return rbtree_node_right(self, x);
+}
+
+static inline rbtree_node_t *Parent(rbtree_t *self, rbtree_node_t *x) {
+  return rbtree_node_parent(self, x);
+}
+
+static inline void SetLeft(rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  rbtree_node_set_left(self, x, y);
+}
+
+static inline void SetRight(rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  rbtree_node_set_right(self, x, y);
+}
+
+static inline void SetParent(rbtree_t *self, rbtree_node_t *x, rbtree_node_t *y) {
+  rbtree_node_set_parent(self, x, y);
+}
+
+static inline int IsRed(rbtree_node_t *x) {
+  return rbtree_node_color(x) == RBTREE_NODE_COLOR_RED;
+}
+
+static inline int IsBlack(rbtree_node_t *x) {
+  return rbtree_node_color(x) == RBTREE_NODE_COLOR_BLACK;
+}
+
+static inline void SetRed(rbtree_node_t *x) {
+  rbtree_node_set_color(x, RBTREE_NODE_COLOR_RED);
+}
+
+static inline void SetBlack(rbtree_node_t *x) {
+  rbtree_node_set_color(x, RBTREE_NODE_COLOR_BLACK);
+}
+
 static inline void LeftRotate(rbtree_t *self, rbtree_node_t *x) {
-  rbtree_node_t *y = x->right;
-  x->right = y->left;
-  if (y->left != self->nil)
-    y->left->parent = x;
-  y->parent = x->parent;
-  if (x->parent == self->nil)
+  rbtree_node_t *y = Right(self, x);
+  SetRight(self, x, Left(self, y));
+  if (Left(self, y) != self->nil)
+    SetParent(self, Left(self, y), x);
+  SetParent(self, y, Parent(self, x));
+  if (Parent(self, x) == self->nil)
     self->root = y;
   else {
-    if (x == x->parent->left)
-      x->parent->left = y;
+    if (x == Left(self, Parent(self, x)))
+      SetLeft(self, Parent(self, x), y);
     else
-      x->parent->right = y;
+      SetRight(self, Parent(self, x), y);
   }
-  y->left = x;
-  x->parent = y;
+  SetLeft(self, y, x);
+  SetParent(self, x, y);
 }
 
 static inline void RightRotate(rbtree_t *self, rbtree_node_t *y) {
-  rbtree_node_t *x = y->left;
-  y->left = x->right;
-  if (x->right != self->nil)
-    x->right->parent = y;
-  x->parent = y->parent;
-  if (y->parent == self->nil)
+  rbtree_node_t *x = Left(self, y);
+  SetLeft(self, y, Right(self, x));
+  if (Right(self, x) != self->nil)
+    SetParent(self, Right(self, x), y);
+  SetParent(self, x, Parent(self, y));
+  if (Parent(self, y) == self->nil)
     self->root = x;
   else {
-    if (y == y->parent->right)
-      y->parent->right = x;
+    if (y == Right(self, Parent(self, y)))
+      SetRight(self, Parent(self, y), x);
     else
-      y->parent->left = x;
+      SetLeft(self, Parent(self, y), x);
   }
-  x->right = y;
-  y->parent = x;
+  SetRight(self, x, y);
+  SetParent(self, y, x);
 }
 
 static inline void InsertFixup(rbtree_t *self, rbtree_node_t *z) {
   rbtree_node_t *y;
-  while (z->parent->color == RBTREE_NODE_COLOR_RED) {
-    if (z->parent == z->parent->parent->left) {
-      y = z->parent->parent->right;
-      if (y->color == RBTREE_NODE_COLOR_RED) {
-        z->parent->color = RBTREE_NODE_COLOR_BLACK;
-        y->color = RBTREE_NODE_COLOR_BLACK;
-        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
-        z = z->parent->parent;
+  while (IsRed(Parent(self, z))) {
+    if (Parent(self, z) == Left(self, Parent(self, Parent(self, z)))) {
+      y = Right(self, Parent(self, Parent(self, z)));
+      if (IsRed(y)) {
+        SetBlack(Parent(self, z));
+        SetBlack(y);
+        SetRed(Parent(self, Parent(self, z)));
+        z = Parent(self, Parent(self, z));
       } else {
-        if (z == z->parent->right) {
-          z = z->parent;
+        if (z == Right(self, Parent(self, z))) {
+          z = Parent(self, z);
           LeftRotate(self, z);
         }
-        z->parent->color = RBTREE_NODE_COLOR_BLACK;
-        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
-        RightRotate(self, z->parent->parent);
+        SetBlack(Parent(self, z));
+        SetRed(Parent(self, Parent(self, z)));
+        RightRotate(self, Parent(self, Parent(self, z)));
       }
     } else {
-      y = z->parent->parent->left;
-      if (y->color == RBTREE_NODE_COLOR_RED) {
-        z->parent->color = RBTREE_NODE_COLOR_BLACK;
-        y->color = RBTREE_NODE_COLOR_BLACK;
-        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
-        z = z->parent->parent;
+      y = Left(self, Parent(self, Parent(self, z)));
+      if (IsRed(y)) {
+        SetBlack(Parent(self, z));
+        SetBlack(y);
+        SetRed(Parent(self, Parent(self, z)));
+        z = Parent(self, Parent(self, z));
       } else {
-        if (z == z->parent->left) {
-          z = z->parent;
+        if (z == Left(self, Parent(self, z))) {
+          z = Parent(self, z);
           RightRotate(self, z);
         }
-        z->parent->color = RBTREE_NODE_COLOR_BLACK;
-        z->parent->parent->color = RBTREE_NODE_COLOR_RED;
-        LeftRotate(self, z->parent->parent);
+        SetBlack(Parent(self, z));
+        SetRed(Parent(self, Parent(self, z)));
+        LeftRotate(self, Parent(self, Parent(self, z)));
       }
     }
   }
-  self->root->color = RBTREE_NODE_COLOR_BLACK;
+  SetBlack(self->root);
 }
 
 static inline rbtree_node_t *Minimum(rbtree_t *self, rbtree_node_t *x) {
-  while (x->left != self->nil)
-    x = x->left;
+  while (Left(self, x) != self->nil)
+    x = Left(self, x);
   return x;
 }
 
 static inline rbtree_node_t *Maximum(rbtree_t *self, rbtree_node_t *x) {
-  while (x->right != self->nil)
-    x = x->right;
+  while (Right(self, x) != self->nil)
+    x = Right(self, x);
   return x;
 }
 
 static inline rbtree_node_t *Predecessor(rbtree_t *self, rbtree_node_t *x) {
-  if (x->left != self->nil)
-    return Maximum(self, x->left);
-  rbtree_node_t *y = x->parent;
-  while (y != self->nil && x == y->left) {
+  if (Left(self, x) != self->nil)
+    return Maximum(self, Left(self, x));
+  rbtree_node_t *y = Parent(self, x);
+  while (y != self->nil && x == Left(self, y)) {
     x = y;
-    y = y->parent;
+    y = Parent(self, y);
   }
   return y;
 }
 
 static inline rbtree_node_t *Successor(rbtree_t *self, rbtree_node_t *x) {
-  if (x->right != self->nil)
-    return Minimum(self, x->right);
-  rbtree_node_t *y = x->parent;
-  while (y != self->nil && x == y->right) {
+  if (Right(self, x) != self->nil)
+    return Minimum(self, Right(self, x));
+  rbtree_node_t *y = Parent(self, x);
+  while (y != self->nil && x == Right(self, y)) {
     x = y;
-    y = y->parent;
+    y = Parent(self, y);
   }
   return y;
 }
 
 static inline void DeleteFixup(rbtree_t *self, rbtree_node_t *x) {
   rbtree_node_t *w;
-  while (x != self->root && x->color == RBTREE_NODE_COLOR_BLACK) {
-    if (x == x->parent->left) {
-      w = x->parent->right;
-      if (w->color == RBTREE_NODE_COLOR_RED) {
-        w->color = RBTREE_NODE_COLOR_BLACK;
-        x->parent->color = RBTREE_NODE_COLOR_RED;
-        LeftRotate(self, x->parent);
-        w = x->parent->right;
+  while (x != self->root && IsBlack(x)) {
+    if (x == Left(self, Parent(self, x))) {
+      w = Right(self, Parent(self, x));
+      if (IsRed(w)) {
+        SetBlack(w);
+        SetRed(Parent(self, x));
+        LeftRotate(self, Parent(self, x));
+        w = Right(self, Parent(self, x));
       }
-      if (w->left->color == RBTREE_NODE_COLOR_BLACK &&
-	  w->right->color == RBTREE_NODE_COLOR_BLACK) {
-        w->color = RBTREE_NODE_COLOR_RED;
-        x = x->parent;
+      if (IsBlack(Left(self, w)) &&
+	  IsBlack(Right(self, w))) {
+        SetRed(w);
+        x = Parent(self, x);
       } else {
-        if (w->right->color == RBTREE_NODE_COLOR_BLACK) {
-          w->left->color = RBTREE_NODE_COLOR_BLACK;
-          w->color = RBTREE_NODE_COLOR_RED;
+        if (IsBlack(Right(self, w))) {
+          SetBlack(Left(self, w));
+          SetRed(w);
           RightRotate(self, w);
-          w = x->parent->right;
+          w = Right(self, Parent(self, x));
         }
-        w->color = x->parent->color;
-        x->parent->color = RBTREE_NODE_COLOR_BLACK;
-        w->right->color = RBTREE_NODE_COLOR_BLACK;
-        LeftRotate(self, x->parent);
+        rbtree_node_set_color(w, rbtree_node_color(Parent(self, x)));
+        SetBlack(Parent(self, x));
+        SetBlack(Right(self, w));
+        LeftRotate(self, Parent(self, x));
         x = self->root;
       }
     } else {
-      w = x->parent->left;
-      if (w->color == RBTREE_NODE_COLOR_RED) {
-        w->color = RBTREE_NODE_COLOR_BLACK;
-        x->parent->color = RBTREE_NODE_COLOR_RED;
-        RightRotate(self, x->parent);
-        w = x->parent->left;
+      w = Left(self, Parent(self, x));
+      if (IsRed(w)) {
+        SetBlack(w);
+        SetRed(Parent(self, x));
+        RightRotate(self, Parent(self, x));
+        w = Left(self, Parent(self, x));
       }
-      if (w->right->color == RBTREE_NODE_COLOR_BLACK &&
-	  w->left->color == RBTREE_NODE_COLOR_BLACK) {
-        w->color = RBTREE_NODE_COLOR_RED;
-        x = x->parent;
+      if (IsBlack(Right(self, w)) &&
+	  IsBlack(Left(self, w))) {
+        SetRed(w);
+        x = Parent(self, x);
       } else {
-        if (w->left->color == RBTREE_NODE_COLOR_BLACK) {
-          w->right->color = RBTREE_NODE_COLOR_BLACK;
-          w->color = RBTREE_NODE_COLOR_RED;
+        if (IsBlack(Left(self, w))) {
+          SetBlack(Right(self, w));
+          SetRed(w);
           LeftRotate(self, w);
-          w = x->parent->left;
+          w = Left(self, Parent(self, x));
         }
-        w->color = x->parent->color;
-        x->parent->color = RBTREE_NODE_COLOR_BLACK;
-        w->left->color = RBTREE_NODE_COLOR_BLACK;
-        RightRotate(self, x->parent);
+        rbtree_node_set_color(w, rbtree_node_color(Parent(self, x)));
+        SetBlack(Parent(self, x));
+        SetBlack(Left(self, w));
+        RightRotate(self, Parent(self, x));
         x = self->root;
       }
     }
   }
-  x->color = RBTREE_NODE_COLOR_BLACK;
+  SetBlack(x);
 }
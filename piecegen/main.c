@@ -0,0 +1,307 @@
+/*
+
+  piecegen/main.c
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../engine/engine.h"
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+/* Generates the PROGMEM tables that describe the pieces to the
+   engine, so the pruning rules and the netlist builder can't drift
+   apart from each other:
+
+     pruneInfo[piece]             the ports, and how the piece is pruned
+     degeneratePiece[ports]       what a piece with only these ports left becomes
+     pieceTransitions[piece][d]   what is on the other side of a port
+
+   Example:
+     circuit/piecegen$ ./main > piece_tables.inc */
+
+// Each side of a piece (in T, R, B, L order) is one of:
+#define __ 0                   // no port on this side
+#define W1 1                   // a wire, connected to the other W1 sides of the same piece
+#define W2 2                   // a second wire, separate from W1 (bridges and double corners)
+#define TERMINAL 0x10          // a terminal, connected to nothing else on the piece
+#define VV (TERMINAL | NL_VV)
+#define G0 (TERMINAL | NL_00)
+#define RA (TERMINAL | NL_RA)
+#define RC (TERMINAL | NL_RC)
+#define YA (TERMINAL | NL_YA)
+#define YC (TERMINAL | NL_YC)
+#define GA (TERMINAL | NL_GA)
+#define GC (TERMINAL | NL_GC)
+
+#define SWITCH 1 // the "meets rules" check treats this piece as having ports on all 4 sides
+
+struct PIECE_DEF;
+typedef struct PIECE_DEF PIECE_DEF;
+
+struct PIECE_DEF {
+  uint8_t piece;
+  const char* name;
+  uint8_t flags;
+  uint8_t sides[4];
+};
+
+#define PIECE(p, flags, t, r, b, l) { p, #p, flags, { t, r, b, l } }
+
+// The single definition of every piece. The pruning and netlist tables are both generated from this.
+const PIECE_DEF pieces[] = {
+  //                            T   R   B   L
+  PIECE(P_BLANK,            0,      __, __, __, __),
+
+  PIECE(P_VCC_T,            0,      VV, __, __, __),
+  PIECE(P_VCC_R,            0,      __, VV, __, __),
+  PIECE(P_VCC_B,            0,      __, __, VV, __),
+  PIECE(P_VCC_L,            0,      __, __, __, VV),
+
+  PIECE(P_GND_LTR,          0,      G0, G0, __, G0),
+  PIECE(P_GND_TRB,          0,      G0, G0, G0, __),
+  PIECE(P_GND_RBL,          0,      __, G0, G0, G0),
+  PIECE(P_GND_BLT,          0,      G0, __, G0, G0),
+
+  PIECE(P_SW1_BL,           SWITCH, __, __, W1, W1),
+  PIECE(P_SW1_LT,           SWITCH, W1, __, __, W1),
+  PIECE(P_SW1_TR,           SWITCH, W1, W1, __, __),
+  PIECE(P_SW1_RB,           SWITCH, __, W1, W1, __),
+
+  PIECE(P_RLED_AB_CR,       0,      __, RC, RA, __),
+  PIECE(P_RLED_AL_CB,       0,      __, __, RC, RA),
+  PIECE(P_RLED_AT_CL,       0,      RA, __, __, RC),
+  PIECE(P_RLED_AR_CT,       0,      RC, RA, __, __),
+
+  PIECE(P_SW2_BT,           SWITCH, W1, __, W1, __),
+  PIECE(P_SW2_LR,           SWITCH, __, W1, __, W1),
+  PIECE(P_SW2_TB,           SWITCH, W1, __, W1, __),
+  PIECE(P_SW2_RL,           SWITCH, __, W1, __, W1),
+
+  PIECE(P_YLED_AL_CR,       0,      __, YC, __, YA),
+  PIECE(P_YLED_AT_CB,       0,      YA, __, YC, __),
+  PIECE(P_YLED_AR_CL,       0,      __, YA, __, YC),
+  PIECE(P_YLED_AB_CT,       0,      YC, __, YA, __),
+
+  PIECE(P_SW3_BR,           SWITCH, __, W1, W1, __),
+  PIECE(P_SW3_LB,           SWITCH, __, __, W1, W1),
+  PIECE(P_SW3_TL,           SWITCH, W1, __, __, W1),
+  PIECE(P_SW3_RT,           SWITCH, W1, W1, __, __),
+
+  PIECE(P_GLED_AB_CL,       0,      __, __, GA, GC),
+  PIECE(P_GLED_AL_CT,       0,      GC, __, __, GA),
+  PIECE(P_GLED_AT_CR,       0,      GA, GC, __, __),
+  PIECE(P_GLED_AR_CB,       0,      __, GA, GC, __),
+
+  PIECE(P_STRAIGHT_LR,      0,      __, W1, __, W1),
+  PIECE(P_STRAIGHT_TB,      0,      W1, __, W1, __),
+
+  PIECE(P_DBL_CORNER_TL_BR, 0,      W1, W2, W2, W1),
+  PIECE(P_DBL_CORNER_TR_BL, 0,      W1, W1, W2, W2),
+
+  PIECE(P_CORNER_BL,        0,      __, __, W1, W1),
+  PIECE(P_CORNER_TL,        0,      W1, __, __, W1),
+  PIECE(P_CORNER_TR,        0,      W1, W1, __, __),
+  PIECE(P_CORNER_BR,        0,      __, W1, W1, __),
+
+  PIECE(P_TPIECE_RBL,       0,      __, W1, W1, W1),
+  PIECE(P_TPIECE_BLT,       0,      W1, __, W1, W1),
+  PIECE(P_TPIECE_LTR,       0,      W1, W1, __, W1),
+  PIECE(P_TPIECE_TRB,       0,      W1, W1, W1, __),
+
+  PIECE(P_BRIDGE1_TB_LR,    0,      W1, W2, W1, W2),
+  PIECE(P_BRIDGE2_TB_LR,    0,      W1, W2, W1, W2),
+
+  PIECE(P_BLOCKER,          0,      __, __, __, __),
+};
+
+static const char* sideNames[4] = { "T", "R", "B", "L" };
+static const char* doutNames[4] = { "D_OUT_T", "D_OUT_R", "D_OUT_B", "D_OUT_L" };
+static const char* nlNames[8] = { "NL_VV", "NL_00", "NL_RA", "NL_RC", "NL_YA", "NL_YC", "NL_GA", "NL_GC" };
+
+static uint8_t Ports(const PIECE_DEF* def, uint8_t mask)
+{
+  uint8_t ports = 0;
+  for (uint8_t d = 0; d < 4; ++d)
+    if (def->sides[d] & mask)
+      ports |= (uint8_t)(1 << d);
+  return ports;
+}
+
+static uint8_t WirePorts(const PIECE_DEF* def, uint8_t wire)
+{
+  uint8_t ports = 0;
+  for (uint8_t d = 0; d < 4; ++d)
+    if (def->sides[d] == wire)
+      ports |= (uint8_t)(1 << d);
+  return ports;
+}
+
+static bool IsTerminalPiece(const PIECE_DEF* def)
+{
+  return Ports(def, TERMINAL) != 0;
+}
+
+static void PrintPorts(uint8_t ports)
+{
+  if (!ports) {
+    printf("0");
+    return;
+  }
+  bool first = true;
+  for (uint8_t d = 0; d < 4; ++d)
+    if (ports & (1 << d)) {
+      printf("%s%s", first ? "" : " | ", doutNames[d]);
+      first = false;
+    }
+}
+
+static const char* PruneKind(const PIECE_DEF* def)
+{
+  for (uint8_t d = 0; d < 4; ++d)
+    if (def->sides[d] == VV || def->sides[d] == G0)
+      return "PRUNE_ANY_PORT";
+  if (def->flags & SWITCH)
+    return "PRUNE_SWITCH";
+  if (WirePorts(def, W2)) {
+    switch (WirePorts(def, W1)) {
+    case D_OUT_T | D_OUT_L:
+      return "PRUNE_PAIR_TL_BR";
+    case D_OUT_T | D_OUT_R:
+      return "PRUNE_PAIR_TR_BL";
+    case D_OUT_T | D_OUT_B:
+      return "PRUNE_PAIR_TB_LR";
+    default:
+      fprintf(stderr, "%s: W1 must include the T side\n", def->name);
+      exit(EXIT_FAILURE);
+    }
+  }
+  return "PRUNE_VALID_PORTS";
+}
+
+// Blank lines between the families of pieces, like P_VCC_* and P_GND_*
+static void PrintFamilySeparator(size_t i)
+{
+  if (i == 0)
+    return;
+  const char* a = pieces[i - 1].name + 2;
+  const char* b = pieces[i].name + 2;
+  size_t la = strcspn(a, "_");
+  size_t lb = strcspn(b, "_");
+  if (la != lb || strncmp(a, b, la))
+    puts("");
+}
+
+int main(int argc, char *argv[]) {
+  (void)argc;
+  (void)argv;
+
+  // Sanity check the definitions
+  for (size_t i = 0; i < NELEMS(pieces); ++i) {
+    const PIECE_DEF* def = &pieces[i];
+    if (def->piece != i) {
+      fprintf(stderr, "%s is defined out of order\n", def->name);
+      return EXIT_FAILURE;
+    }
+    if (IsTerminalPiece(def) && (WirePorts(def, W1) || WirePorts(def, W2))) {
+      fprintf(stderr, "%s mixes terminals and wires\n", def->name);
+      return EXIT_FAILURE;
+    }
+  }
+
+  puts("// This data is generated by running the piecegen/main program from the");
+  puts("// piece definitions in piecegen/main.c, so don't edit it by hand");
+  puts("// circuit/piecegen$ ./main > piece_tables.inc");
+  puts("");
+
+  printf("const uint8_t pruneInfo[%zu] PROGMEM =\n", NELEMS(pieces));
+  puts("  {");
+  for (size_t i = 0; i < NELEMS(pieces); ++i) {
+    const PIECE_DEF* def = &pieces[i];
+    PrintFamilySeparator(i);
+    printf("// %s %d\n", def->name, def->piece);
+    printf("   %s | ", PruneKind(def));
+    PrintPorts(Ports(def, 0xFF));
+    puts(",");
+  }
+  puts("};");
+  puts("");
+
+  // Pieces only ever degenerate into a plain corner or straight
+  puts("// What a piece degenerates into when only these D_OUT_* ports are left");
+  puts("const uint8_t degeneratePiece[16] PROGMEM =");
+  puts("  {");
+  for (uint8_t ports = 0; ports < 16; ++ports) {
+    const char* name = "P_BLANK";
+    for (size_t i = 0; i < NELEMS(pieces); ++i) {
+      const PIECE_DEF* def = &pieces[i];
+      if (ports && !IsTerminalPiece(def) && !(def->flags & SWITCH) && !WirePorts(def, W2) && WirePorts(def, W1) == ports && __builtin_popcount(ports) == 2) {
+        name = def->name;
+        break;
+      }
+    }
+    char comment[16] = "none";
+    if (ports) {
+      comment[0] = '\0';
+      for (uint8_t d = 0; d < 4; ++d)
+        if (ports & (1 << d)) {
+          if (comment[0])
+            strcat(comment, " ");
+          strcat(comment, sideNames[d]);
+        }
+    }
+    printf("   %s,%*s// %s\n", name, (int)(14 - strlen(name)), "", comment);
+  }
+  puts("};");
+  puts("");
+
+  puts("// [piece][D_T, D_R, D_B, D_L] -> the terminal on that port, or the other ports a wire leads to");
+  printf("const uint8_t pieceTransitions[%zu][4] PROGMEM =\n", NELEMS(pieces));
+  puts("  {");
+  for (size_t i = 0; i < NELEMS(pieces); ++i) {
+    const PIECE_DEF* def = &pieces[i];
+    PrintFamilySeparator(i);
+    printf("// %s %d\n", def->name, def->piece);
+    printf("   {");
+    for (uint8_t d = 0; d < 4; ++d) {
+      uint8_t side = def->sides[d];
+      if (d)
+        printf(", ");
+      if (side == __) {
+        printf("TRANSITION_HALT");
+      } else if (side & TERMINAL) {
+        printf("TRANSITION_NODE | %s", nlNames[side & ~TERMINAL]);
+      } else {
+        printf("TRANSITION_EXIT | ");
+        PrintPorts(WirePorts(def, side) & ~(1 << d));
+      }
+    }
+    puts("},");
+  }
+  puts("};");
+
+  fprintf(stderr, "\nGenerated tables for %zu pieces\n", NELEMS(pieces));
+  fprintf(stderr, "pruneInfo: %zu bytes, degeneratePiece: 16 bytes, pieceTransitions: %zu bytes of PROGMEM\n\n", NELEMS(pieces), NELEMS(pieces) * 4);
+  return 0;
+}
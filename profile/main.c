@@ -0,0 +1,129 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "profile.h"
+
+/* Summarizes the records that an OPTION_PROFILE build of circuit.c
+   writes through the emulator's debug ports. Pipe the emulator's
+   output in, and anything that isn't a record is skipped.
+
+   Example:
+     circuit/default$ uzem circuit.hex | ../profile/main */
+
+#define NELEMS(x) (sizeof(x)/sizeof(x[0]))
+
+#define FRAME_BUCKETS 4 // 1, 2, 3, 4+ vsyncs per pass
+
+static const char* phaseNames[PROFILE_PHASE_COUNT] = {
+  [PROFILE_PRUNEBOARD]    = "PruneBoard",
+  [PROFILE_UPDATENETLIST] = "UpdateNetlist",
+  [PROFILE_PACKNETLIST]   = "PackNetlist",
+  [PROFILE_CONSULTORACLE] = "ConsultOracle",
+  [PROFILE_REDRAWLEDS]    = "RedrawLeds",
+  [PROFILE_MEETSRULES]    = "MeetsRules",
+  [PROFILE_BOARDCHANGED]  = "BoardChanged",
+  [PROFILE_LOADLEVEL]     = "LoadLevel",
+  [PROFILE_RAMFONT_LOAD]  = "RamFont_Load",
+  [PROFILE_FRAME]         = "Frame",
+};
+
+struct PHASE_STATS;
+typedef struct PHASE_STATS PHASE_STATS;
+struct PHASE_STATS {
+  uint64_t count;
+  uint64_t interrupted;
+  uint64_t total;
+  uint32_t min;
+  uint32_t max;
+};
+
+static PHASE_STATS stats[PROFILE_PHASE_COUNT];
+static uint64_t frames[FRAME_BUCKETS];
+
+// Finds the first record in line, returns false if there isn't one
+static bool ParseRecord(const char* line, uint8_t* phase, uint32_t* value)
+{
+  for (const char* p = strchr(line, PROFILE_RECORD_START); p; p = strchr(p + 1, PROFILE_RECORD_START)) {
+    uint32_t record = 0;
+    int i;
+    for (i = 1; i <= 8 && isxdigit((unsigned char)p[i]); ++i)
+      record = (record << 4) | (isdigit((unsigned char)p[i]) ? p[i] - '0' : (tolower((unsigned char)p[i]) - 'a' + 10));
+    if (i == 9) {
+      *phase = record >> 24;
+      *value = record & 0x00FFFFFF;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void Record(uint8_t phase, uint32_t value)
+{
+  uint8_t id = phase & PROFILE_PHASE_MASK;
+  if (id >= PROFILE_PHASE_COUNT)
+    return;
+
+  if (id == PROFILE_FRAME) {
+    if (value == 0) // the first pass after Profile_Init
+      return;
+    ++frames[(value > FRAME_BUCKETS ? FRAME_BUCKETS : value) - 1];
+    return;
+  }
+
+  PHASE_STATS* s = &stats[id];
+  if (phase & PROFILE_FLAG_INTERRUPTED) { // the ticks can't be trusted
+    ++s->interrupted;
+    return;
+  }
+  uint32_t cycles = value * PROFILE_CYCLES_PER_TICK;
+  if (s->count == 0 || cycles < s->min)
+    s->min = cycles;
+  if (cycles > s->max)
+    s->max = cycles;
+  s->total += cycles;
+  ++s->count;
+}
+
+int main()
+{
+  char line[1024];
+  uint64_t records = 0;
+
+  while (fgets(line, sizeof(line), stdin)) {
+    uint8_t phase;
+    uint32_t value;
+    if (ParseRecord(line, &phase, &value)) {
+      Record(phase, value);
+      ++records;
+    }
+  }
+
+  printf("%lu records, cycles (excluding interrupted samples), vsync budget is %lu cycles\n\n", records, PROFILE_CYCLES_PER_VSYNC);
+  printf("%-14s %10s %10s %10s %10s %10s %8s\n", "phase", "count", "min", "mean", "max", "interrupt", "%vsync");
+  for (uint8_t i = 0; i < NELEMS(stats); ++i) {
+    if (i == PROFILE_FRAME)
+      continue;
+    PHASE_STATS* s = &stats[i];
+    if (s->count == 0 && s->interrupted == 0)
+      continue;
+    uint64_t mean = s->count ? s->total / s->count : 0;
+    printf("%-14s %10lu %10u %10lu %10u %10lu %7.1f%%\n", phaseNames[i], s->count, s->min, mean, s->max, s->interrupted,
+           100.0 * s->max / PROFILE_CYCLES_PER_VSYNC);
+  }
+
+  uint64_t passes = 0;
+  for (uint8_t i = 0; i < FRAME_BUCKETS; ++i)
+    passes += frames[i];
+  if (passes) {
+    printf("\nmain loop passes by vsyncs taken (more than 1 overran the frame)\n");
+    for (uint8_t i = 0; i < FRAME_BUCKETS; ++i)
+      printf("  %u%s %10lu\n", i + 1, (i == FRAME_BUCKETS - 1) ? "+" : " ", frames[i]);
+    printf("  overruns %lu of %lu (%.2f%%)\n", passes - frames[0], passes, 100.0 * (passes - frames[0]) / passes);
+  }
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+/*
+
+  profile/profile.h
+
+  Copyright 2017-2020 Matthew T. Pandina. All rights reserved.
+
+  This file is part of Circuit Puzzle.
+
+  Circuit Puzzle is free software: you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation, either version 3 of the
+  License, or (at your option) any later version.
+
+  Circuit Puzzle is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Circuit Puzzle.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+#pragma once
+
+/* The records that an OPTION_PROFILE build of circuit.c streams out
+   through the emulator's debug ports, shared with the collector in
+   profile/main.c. Each record is one line of emulator output:
+
+     UZEMC '@'
+     UZEMH phase (PROFILE_PHASE_MASK), maybe with PROFILE_FLAG_INTERRUPTED
+     UZEMH ticks 23..16
+     UZEMH ticks 15..8
+     UZEMH ticks 7..0
+     UZEMC '\n'
+
+   UZEMH prints each byte as 2 hex digits, so a record looks like
+   "@03000a1c". Ticks are Timer0 counts at F_CPU/8. PROFILE_FRAME
+   records have the number of vsyncs since the last one instead. */
+
+#define PROFILE_RECORD_START    '@'
+#define PROFILE_CYCLES_PER_TICK 8
+#define PROFILE_CYCLES_PER_VSYNC (1820UL * 262) // NTSC: 1820 cycles per line, 262 lines per field
+
+#define PROFILE_PHASE_MASK 0x7F
+#define PROFILE_FLAG_INTERRUPTED 0x80 // a vsync or the render loop got in the way, so the ticks may be short
+
+#define PROFILE_PRUNEBOARD      0 // Engine_PruneBoard(PRUNEBOARD_FLAG_NORMAL)
+#define PROFILE_UPDATENETLIST   1 // Engine_UpdateNetlistStep (what used to be the SimulateElectrons calls)
+#define PROFILE_PACKNETLIST     2 // Engine_PackNetlist
+#define PROFILE_CONSULTORACLE   3 // Engine_ConsultOracle
+#define PROFILE_REDRAWLEDS      4 // drawing the LEDs that changed
+#define PROFILE_MEETSRULES      5 // Engine_PruneBoard(PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY)
+#define PROFILE_BOARDCHANGED    6 // BoardChanged_Commit, drawing a finished evaluation
+#define PROFILE_LOADLEVEL       7 // LoadLevel
+#define PROFILE_RAMFONT_LOAD    8 // RamFont_Load
+#define PROFILE_FRAME           9 // one pass through the main loop, in vsyncs
+#define PROFILE_PHASE_COUNT    10
@@ -0,0 +1,950 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/pgmspace.h"
+#include "../engine/engine.h"
+#include "../engine/reference.h"
+
+/* Proves that the levels in levelData can be solved, and counts their
+   solutions. Every way of placing the hand into the blank squares is
+   tried, along with every rotation of the placed pieces and of the
+   pieces the level lets you rotate in place, and a board is a solution
+   when it would complete the level in the game: the LEDs match the
+   goal (for each switch position, if there is a switch), there is no
+   short circuit, and there are no loose ends. Identical pieces in the
+   hand are treated as different pieces, so swapping two of them counts
+   as another solution.
+
+   Most of those boards are the same board over and over, so the search
+   places each group of identical pieces in the hand only once (the
+   second one can only go down after the first one has), and only tries
+   one of the rotations that conduct the same way (Engine_EquivalentPiece,
+   which is how the two bridges are told apart). Each board it finds
+   stands for as many boards as it skipped, and the counts are given the
+   way the naive search would have counted them. Unless -r is given, the
+   naive search is run as well, to check that it finds the same number
+   of solutions and the same witness, and to show how many nodes the
+   reductions saved. Swapping LED colors is no help here, since the red,
+   yellow, and green LEDs are not the same shape.
+
+   Squares are filled in row-major order, and a branch is abandoned as
+   soon as a square can no longer meet the rules (see
+   Engine_PieceMeetsRules). After every placement, the sides each
+   undecided square could still have a port on are narrowed down to
+   what the pieces that fit there have, which can show that a decided
+   square will be left with a loose end, that some square has nothing
+   left that fits, that there aren't enough pieces left for the squares
+   that can't stay blank, or that an LED the goal needs lit can no
+   longer be connected to a VCC. Each level is also searched without
+   that propagation, to compare the number of nodes. The search runs on
+   one thread per CPU, which split off subtrees for each other whenever
+   one of them runs out of work.
+
+   With -c, every complete board is also run through the evaluation
+   from before the engine (decide() and its electrons, see
+   engine/reference.c) in each switch position, to count the boards the
+   two light up differently, and the ones they would disagree about
+   completing the level on (both should stay 0, like the fuzzer's
+   mismatches, but this covers every board the levels can end on).
+
+   Example:
+     circuit/solver$ ./main           (all levels)
+     circuit/solver$ ./main 12 33     (just levels 12 and 33)
+     circuit/solver$ ./main -t 4 12   (on 4 threads, instead of one per CPU)
+     circuit/solver$ ./main -r        (without checking against the naive search)
+     circuit/solver$ ./main -r -c     (comparing the engine with the old evaluation) */
+
+#include "../data/levels.inc"
+
+// The level layout, as in circuit.c
+#define GOAL_WIDTH 4
+#define GOAL_HEIGHT 3
+#define HAND_WIDTH 5
+#define HAND_HEIGHT 2
+#define LEVEL_SIZE (BOARD_WIDTH * BOARD_HEIGHT + GOAL_WIDTH * GOAL_HEIGHT + HAND_WIDTH * HAND_HEIGHT)
+#define LEVELS (sizeof(levelData) / LEVEL_SIZE)
+#define BOARD_OFFSET_IN_LEVEL 0
+#define GOAL_OFFSET_IN_LEVEL (BOARD_WIDTH * BOARD_HEIGHT)
+#define HAND_OFFSET_IN_LEVEL (GOAL_OFFSET_IN_LEVEL + (GOAL_WIDTH * GOAL_HEIGHT))
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define MAX_TOKENS (HAND_WIDTH * HAND_HEIGHT)
+#define MAX_THREADS 256
+#define SPLIT_MIN_DEPTH 4 // don't hand out subtrees with fewer squares left to decide than this
+
+#define CELL_FIXED  0 // locked in place
+#define CELL_ROTATE 1 // can be rotated in place
+#define CELL_OPEN   2 // blank, so a piece from the hand may go here
+
+#define NO_TOKEN 0xFF
+
+#define SEARCH_REDUCE    1 // skip placements that are equivalent to ones already tried
+#define SEARCH_PROPAGATE 2 // give up on partial boards the rest of the hand can't complete
+
+#define ROLE_VCC 8 // along with R_BIT, Y_BIT, and G_BIT for the LEDs
+
+struct LEVEL;
+typedef struct LEVEL LEVEL;
+
+struct LEVEL {
+  uint8_t number;
+  uint8_t flags;             // SEARCH_*
+  uint8_t board[CELLS];      // the pieces that start on the board, P_BLANK where the hand can go
+  uint8_t kind[CELLS];       // CELL_*
+  uint8_t rotations[CELLS][4]; // the rotations a CELL_ROTATE square can have
+  uint8_t rotationWeight[CELLS][4]; // how many rotations each one stands for
+  uint8_t count[CELLS];
+  uint8_t rotatePorts[CELLS]; // every side any of those rotations has a port on
+  uint8_t order[CELLS];      // the squares the search decides, in the order it decides them
+  uint8_t orderCount;
+  uint8_t openAfter[CELLS + 1]; // how many CELL_OPEN squares there are in order[i..]
+  uint8_t tokenRotations[MAX_TOKENS][4]; // the rotations of each piece in the hand
+  uint8_t tokenWeight[MAX_TOKENS][4];
+  uint8_t tokenCount[MAX_TOKENS];
+  uint8_t tokenPorts[MAX_TOKENS];
+  uint8_t tokenRoles[MAX_TOKENS]; // ROLE_VCC, or the color of an LED
+  uint8_t tokenSame[MAX_TOKENS]; // an identical piece earlier in the hand, which has to be placed first, or NO_TOKEN
+  uint8_t tokens;
+  uint32_t weight;           // how many boards each one the search finds stands for, on top of TASK.weight
+  bool hasSwitch;
+  uint8_t goalStates[3];     // for each switch position, or just [0] without a switch
+  uint8_t goalLeds;          // the LEDs that are lit in any of them
+};
+
+struct TASK;
+typedef struct TASK TASK;
+
+// A partly filled in board, everything that is needed to pick the search back up from there
+struct TASK {
+  uint8_t board[CELLS];
+  uint32_t decided; // bit i is set once board[i] can't change anymore
+  uint16_t used;    // bit i is set once tokens[i] has been placed
+  uint8_t depth;    // index into order[] of the next square to decide
+  uint32_t weight;  // how many boards this one stands for, from the rotations skipped so far
+};
+
+struct SPARE;
+typedef struct SPARE SPARE;
+
+struct SPARE {
+  uint8_t ports; // the sides any rotation of any piece left in the hand has a port on
+  uint8_t roles; // ROLE_* of the pieces left in the hand
+  uint8_t remaining; // how many pieces are left in the hand
+  bool blankAllowed; // there are more undecided blank squares than pieces left in the hand
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  const LEVEL* level;
+  ENGINE engine;
+  uint32_t seed;
+  uint64_t nodes;     // pieces (or blanks) tried on a square
+  uint64_t leaves;    // complete boards that got evaluated
+  uint64_t solutions;
+  uint64_t weighted;  // the solutions, counting the boards each one stands for
+  uint64_t mismatches; // leaves Engine_PruneBoard disagreed with the per-square checks on (should stay 0)
+  uint64_t referenceLit;      // with -c, leaves the reference gave other LED states or a different short flag
+  uint64_t referenceVerdicts; // with -c, leaves the reference would or wouldn't complete the level on when the engine doesn't
+
+  // Tasks that other workers can steal. The owner pushes and pops at the tail, thieves take from the head.
+  pthread_mutex_t lock;
+  TASK* tasks;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t capacity;
+};
+
+struct RESULT;
+typedef struct RESULT RESULT;
+
+struct RESULT {
+  uint64_t nodes;
+  uint64_t leaves;
+  uint64_t solutions; // boards the search found
+  uint64_t weighted;  // boards the naive search would have found
+  uint64_t mismatches;
+  uint64_t referenceLit;
+  uint64_t referenceVerdicts;
+  double elapsed;
+  bool haveWitness;
+  uint8_t witness[CELLS];
+};
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+static uint32_t pendingTasks; // pushed, but not finished yet
+static uint32_t idleWorkers;  // looking for something to steal
+static bool compareReference; // -c
+
+static pthread_mutex_t witnessLock = PTHREAD_MUTEX_INITIALIZER;
+static bool haveWitness;
+static uint8_t witness[CELLS];
+
+static bool IsSwitch(uint8_t piece)
+{
+  return (piece >= P_SW1_BL && piece <= P_SW1_RB) || (piece >= P_SW2_BT && piece <= P_SW2_RL) || (piece >= P_SW3_BR && piece <= P_SW3_RT);
+}
+
+static uint8_t Role(uint8_t piece)
+{
+  if (piece >= P_VCC_T && piece <= P_VCC_L)
+    return ROLE_VCC;
+  if (piece >= P_RLED_AB_CR && piece <= P_RLED_AR_CT)
+    return R_BIT;
+  if (piece >= P_YLED_AL_CR && piece <= P_YLED_AB_CT)
+    return Y_BIT;
+  if (piece >= P_GLED_AB_CL && piece <= P_GLED_AR_CB)
+    return G_BIT;
+  return 0;
+}
+
+// The rotations a piece can be turned into, as a run of 'count' pieces starting at 'first'. The
+// *_U pieces stand for their whole group, and switches always use the SW1 position here.
+static uint8_t Rotations(uint8_t piece, uint8_t* first)
+{
+  switch (piece) {
+  case P_VCC_U:        piece = P_VCC_T; break;
+  case P_GND_U:        piece = P_GND_LTR; break;
+  case P_SW1_U:
+  case P_SW2_U:
+  case P_SW3_U:        piece = P_SW1_BL; break;
+  case P_RLED_U:       piece = P_RLED_AB_CR; break;
+  case P_YLED_U:       piece = P_YLED_AL_CR; break;
+  case P_GLED_U:       piece = P_GLED_AB_CL; break;
+  case P_STRAIGHT_U:   piece = P_STRAIGHT_LR; break;
+  case P_DBL_CORNER_U: piece = P_DBL_CORNER_TL_BR; break;
+  case P_CORNER_U:     piece = P_CORNER_BL; break;
+  case P_TPIECE_U:     piece = P_TPIECE_RBL; break;
+  case P_BRIDGE_U:     piece = P_BRIDGE1_TB_LR; break;
+  }
+  if (IsSwitch(piece))
+    piece = P_SW1_BL + ((piece - P_SW1_BL) & 3);
+
+  if (piece >= P_VCC_T && piece <= P_GLED_AR_CB) {
+    *first = ((piece - P_VCC_T) & ~3) + P_VCC_T;
+    return 4;
+  }
+  if (piece >= P_CORNER_BL && piece <= P_TPIECE_TRB) {
+    *first = ((piece - P_CORNER_BL) & ~3) + P_CORNER_BL;
+    return 4;
+  }
+  if (piece >= P_STRAIGHT_LR && piece <= P_BRIDGE2_TB_LR && piece != P_BLOCKER) {
+    *first = ((piece - P_STRAIGHT_LR) & ~1) + P_STRAIGHT_LR; // straights, double corners, and bridges come in pairs
+    return 2;
+  }
+  *first = piece;
+  return 1;
+}
+
+// Whether two rotations of the same piece make no difference to the game. A switch
+// has to match in all three positions, since the search only places it in SW1.
+static bool Equivalent(uint8_t a, uint8_t b)
+{
+  for (uint8_t p = 0; p < (IsSwitch(a) ? 3 : 1); ++p)
+    if (Engine_EquivalentPiece(a + p * (P_SW2_BT - P_SW1_BL)) != Engine_EquivalentPiece(b + p * (P_SW2_BT - P_SW1_BL)))
+      return false;
+  return true;
+}
+
+// The rotations of a piece the search tries, and how many rotations each one stands for
+static uint8_t Orientations(uint8_t piece, bool reduce, uint8_t rotations[4], uint8_t weights[4])
+{
+  uint8_t first;
+  uint8_t count = Rotations(piece, &first);
+  uint8_t n = 0;
+  for (uint8_t r = 0; r < count; ++r) {
+    uint8_t j = 0;
+    while (reduce && j < n && !Equivalent(rotations[j], first + r))
+      ++j;
+    if (reduce && j < n) {
+      weights[j]++;
+    } else {
+      rotations[n] = first + r;
+      weights[n++] = 1;
+    }
+  }
+  return n;
+}
+
+static bool DecodeLevel(uint8_t number, uint8_t flags, LEVEL* level)
+{
+  const uint8_t* data = &levelData[(number - 1) * LEVEL_SIZE];
+  bool reduce = (flags & SEARCH_REDUCE);
+  memset(level, 0, sizeof(*level));
+  level->number = number;
+  level->flags = flags;
+  level->weight = 1;
+
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t piece = pgm_read_byte(&data[BOARD_OFFSET_IN_LEVEL + i]);
+    if (piece == P_BLANK) {
+      level->kind[i] = CELL_OPEN;
+    } else if (piece >= P_VCC_U) {
+      level->kind[i] = CELL_ROTATE;
+      level->count[i] = Orientations(piece, reduce, level->rotations[i], level->rotationWeight[i]);
+      piece = level->rotations[i][0];
+      for (uint8_t r = 0; r < level->count[i]; ++r)
+        level->rotatePorts[i] |= Engine_MeetsRulesPorts(level->rotations[i][r]);
+      if (level->count[i] == 1) {
+        level->kind[i] = CELL_FIXED;
+        level->weight *= level->rotationWeight[i][0];
+      }
+    } else {
+      level->kind[i] = CELL_FIXED;
+    }
+    level->board[i] = piece;
+    if (level->kind[i] != CELL_FIXED)
+      level->order[level->orderCount++] = i;
+  }
+  for (int8_t i = level->orderCount - 1; i >= 0; --i)
+    level->openAfter[i] = level->openAfter[i + 1] + (level->kind[level->order[i]] == CELL_OPEN);
+
+  for (uint8_t i = 0; i < HAND_WIDTH * HAND_HEIGHT; ++i) {
+    uint8_t piece = pgm_read_byte(&data[HAND_OFFSET_IN_LEVEL + i]);
+    if (piece == P_BLANK)
+      continue;
+    uint8_t t = level->tokens++;
+    level->tokenCount[t] = Orientations(piece, reduce, level->tokenRotations[t], level->tokenWeight[t]);
+    for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+      level->tokenPorts[t] |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+    level->tokenRoles[t] = Role(level->tokenRotations[t][0]);
+
+    // Placing n identical pieces in a fixed order skips the other n! - 1 orders
+    uint8_t same = NO_TOKEN;
+    uint8_t identical = 1;
+    for (uint8_t u = 0; reduce && u < t; ++u)
+      if (level->tokenRotations[u][0] == level->tokenRotations[t][0]) {
+        same = u;
+        identical++;
+      }
+    level->tokenSame[t] = same;
+    level->weight *= identical;
+  }
+
+  // The same goal states GoalStatesForCurrentLevel in circuit.c comes up with
+  level->hasSwitch = (pgm_read_byte(&data[GOAL_OFFSET_IN_LEVEL]) == P_GOAL_SW1);
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p)
+    for (uint8_t i = 0; i < 3; ++i)
+      switch (pgm_read_byte(&data[GOAL_OFFSET_IN_LEVEL + p * GOAL_WIDTH + (level->hasSwitch ? 1 : 0) + i])) {
+      case P_GOAL_RLED_ON:
+        level->goalStates[p] |= R_BIT;
+        break;
+      case P_GOAL_YLED_ON:
+        level->goalStates[p] |= Y_BIT;
+        break;
+      case P_GOAL_GLED_ON:
+        level->goalStates[p] |= G_BIT;
+        break;
+      }
+  level->goalLeds = level->goalStates[0] | level->goalStates[1] | level->goalStates[2];
+
+  return level->tokens <= level->openAfter[0];
+}
+
+// What the pieces left in the hand could still do, for the squares that haven't been decided yet
+static void Spare(const LEVEL* level, const TASK* task, SPARE* spare)
+{
+  uint8_t remaining = 0;
+  spare->ports = 0;
+  spare->roles = 0;
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t))) {
+      spare->ports |= level->tokenPorts[t];
+      spare->roles |= level->tokenRoles[t];
+      remaining++;
+    }
+  spare->remaining = remaining;
+  spare->blankAllowed = (remaining < level->openAfter[task->depth]);
+}
+
+// The square on the given side of square c, or false if that's off the board
+static bool Neighbor(uint8_t c, uint8_t side, uint8_t* n)
+{
+  uint8_t x = c % BOARD_WIDTH;
+  uint8_t y = c / BOARD_WIDTH;
+  switch (side) {
+  case D_OUT_T: *n = c - BOARD_WIDTH; return y > 0;
+  case D_OUT_R: *n = c + 1;           return x < BOARD_WIDTH - 1;
+  case D_OUT_B: *n = c + BOARD_WIDTH; return y < BOARD_HEIGHT - 1;
+  default:      *n = c - 1;           return x > 0;
+  }
+}
+
+static uint8_t Opposite(uint8_t side)
+{
+  return ((side << 2) | (side >> 2)) & (D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L);
+}
+
+// The sides square c might end up with a port on. Without propagation, a square that hasn't been decided
+// yet is assumed to end up facing every way, otherwise it's whatever could still be put there.
+static uint8_t Ports(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (task->decided & (1UL << c))
+    return Engine_MeetsRulesPorts(task->board[c]);
+  if (!(level->flags & SEARCH_PROPAGATE))
+    return D_OUT_T | D_OUT_R | D_OUT_B | D_OUT_L;
+  return (level->kind[c] == CELL_ROTATE) ? level->rotatePorts[c] : spare->ports;
+}
+
+// The sides of square c that have a neighbor that might face back at it
+static uint8_t ValidSides(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (Ports(level, task, n, spare) & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// Whether the piece on square c can still meet the rules (see Engine_PieceMeetsRules)
+static bool Fits(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  uint8_t piece = task->board[c];
+  if (!Engine_MeetsRulesPorts(piece))
+    return true;
+  return Engine_PieceMeetsRules(piece, ValidSides(level, task, c, spare));
+}
+
+// Deciding square c can only take possibilities away from it and its decided neighbors
+static bool Consistent(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare)
+{
+  if (!Fits(level, task, c, spare))
+    return false;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && !Fits(level, task, n, spare))
+      return false;
+  }
+  return true;
+}
+
+// The sides of square c whose neighbor might face back at it, given what each square might face its neighbors with
+static uint8_t Facing(const uint8_t ports[CELLS], uint8_t c)
+{
+  uint8_t valid = 0;
+  for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+    uint8_t n;
+    if (Neighbor(c, side, &n) && (ports[n] & Opposite(side)))
+      valid |= side;
+  }
+  return valid;
+}
+
+// The sides that the pieces that could still go on undecided square c, and meet the rules there, have ports on.
+// Returns false if there aren't any, and the square can't be left blank either.
+static bool Narrow(const LEVEL* level, const TASK* task, uint8_t c, const SPARE* spare, uint8_t ports[CELLS])
+{
+  uint8_t valid = Facing(ports, c);
+  uint8_t narrowed = 0;
+  bool any = false;
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      if (Engine_PieceMeetsRules(level->rotations[c][r], valid)) {
+        narrowed |= Engine_MeetsRulesPorts(level->rotations[c][r]);
+        any = true;
+      }
+  } else {
+    any = spare->blankAllowed;
+    for (uint8_t t = 0; t < level->tokens; ++t)
+      if (!(task->used & (1U << t)))
+        for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+          if (Engine_PieceMeetsRules(level->tokenRotations[t][r], valid)) {
+            narrowed |= Engine_MeetsRulesPorts(level->tokenRotations[t][r]);
+            any = true;
+          }
+  }
+  ports[c] = narrowed;
+  return any;
+}
+
+// Every LED the goal wants lit has to be able to connect to a VCC. Squares are joined wherever they might
+// face each other, so this only gives up once no way of filling in the rest of the board could connect them.
+static bool CanLight(const LEVEL* level, const TASK* task, const SPARE* spare, const uint8_t ports[CELLS])
+{
+  if (!level->goalLeds)
+    return true;
+
+  uint8_t roles[CELLS];
+  uint8_t stack[CELLS];
+  uint8_t top = 0;
+  uint32_t reached = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (task->decided & (1UL << c))
+      roles[c] = Role(task->board[c]);
+    else
+      roles[c] = (level->kind[c] == CELL_ROTATE) ? Role(level->rotations[c][0]) : spare->roles;
+    if (roles[c] & ROLE_VCC) {
+      reached |= (1UL << c);
+      stack[top++] = c;
+    }
+  }
+
+  uint8_t lit = 0;
+  while (top) {
+    uint8_t c = stack[--top];
+    lit |= roles[c];
+    for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+      uint8_t n;
+      if ((ports[c] & side) && Neighbor(c, side, &n) && !(reached & (1UL << n)) && (ports[n] & Opposite(side))) {
+        reached |= (1UL << n);
+        stack[top++] = n;
+      }
+    }
+  }
+  return (lit & level->goalLeds) == level->goalLeds;
+}
+
+// Forward checking: narrows down what every undecided square could still face its neighbors with, until
+// nothing changes, then makes sure every decided square can still meet the rules, that there are enough
+// pieces left in the hand for the blank squares that have to be filled in, and that the goal can still be lit
+static bool Propagate(const LEVEL* level, const TASK* task, const SPARE* spare)
+{
+  uint8_t ports[CELLS];
+  for (uint8_t c = 0; c < CELLS; ++c)
+    ports[c] = Ports(level, task, c, spare);
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (uint8_t c = 0; c < CELLS; ++c)
+      if (!(task->decided & (1UL << c))) {
+        uint8_t before = ports[c];
+        if (!Narrow(level, task, c, spare, ports))
+          return false;
+        changed |= (ports[c] != before);
+      }
+  }
+
+  uint8_t mustFill = 0;
+  for (uint8_t c = 0; c < CELLS; ++c) {
+    if (!(task->decided & (1UL << c))) {
+      if (level->kind[c] != CELL_OPEN)
+        continue;
+      // Left blank, this square would take away a port one of its decided neighbors needs
+      for (uint8_t side = D_OUT_T; side <= D_OUT_L; side <<= 1) {
+        uint8_t n;
+        if (Neighbor(c, side, &n) && (task->decided & (1UL << n)) && (ports[n] & Opposite(side)) &&
+            !Engine_PieceMeetsRules(task->board[n], Facing(ports, n) & ~Opposite(side))) {
+          mustFill++;
+          break;
+        }
+      }
+    } else if (ports[c] && !Engine_PieceMeetsRules(task->board[c], Facing(ports, c))) {
+      return false;
+    }
+  }
+  if (mustFill > spare->remaining)
+    return false;
+
+  return CanLight(level, task, spare, ports);
+}
+
+// Runs a complete board through both the engine and the reference, for every switch position
+static void CompareReference(WORKER* w, TASK* task, int8_t sw)
+{
+  const LEVEL* level = w->level;
+  const uint8_t (*board)[BOARD_WIDTH] = (const uint8_t (*)[BOARD_WIDTH])task->board;
+  uint8_t original = (sw == -1) ? 0 : task->board[sw];
+  bool lit = false;
+  bool complete[2] = { true, true }; // the engine, then the reference
+  bool anyWithoutShort[2] = { false, false };
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1); ++p) {
+    if (sw != -1)
+      task->board[sw] = P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((original - P_SW1_BL) & 3);
+    ENGINE_RESULT results[2];
+    Engine_Evaluate(&w->engine, board, &results[0]);
+    Reference_Evaluate(board, &results[1]);
+    lit |= (results[0].ledStates != results[1].ledStates || results[0].isShort != results[1].isShort);
+    for (uint8_t i = 0; i < 2; ++i) {
+      complete[i] &= (results[i].ledStates == level->goalStates[p]);
+      anyWithoutShort[i] |= !results[i].isShort;
+    }
+  }
+  if (sw != -1)
+    task->board[sw] = original;
+  w->referenceLit += lit;
+  w->referenceVerdicts += ((complete[0] && anyWithoutShort[0]) != (complete[1] && anyWithoutShort[1]));
+}
+
+// Runs a complete board through the engine the same way BoardChanged does, for every switch position
+static void Evaluate(WORKER* w, TASK* task)
+{
+  const LEVEL* level = w->level;
+  const uint8_t (*board)[BOARD_WIDTH] = (const uint8_t (*)[BOARD_WIDTH])task->board;
+  w->leaves++;
+
+  // The "meets rules" pruning treats a switch the same in every position
+  bool meetsRules = Engine_PruneBoard(&w->engine, board, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY);
+  if (!meetsRules) {
+    w->mismatches++;
+    return;
+  }
+
+  int8_t sw = -1;
+  if (level->hasSwitch) {
+    for (uint8_t i = 0; i < CELLS && sw == -1; ++i)
+      if (IsSwitch(task->board[i]))
+        sw = i;
+    if (sw == -1)
+      return;
+  }
+  if (compareReference)
+    CompareReference(w, task, sw);
+
+  // In the game, each goal gets checked off as the switch is moved into its position, and the level is complete
+  // once all of them have been checked off and the rules are met, which happens in any position without a short
+  uint8_t original = (sw == -1) ? 0 : task->board[sw];
+  bool complete = true;
+  bool anyWithoutShort = false;
+  for (uint8_t p = 0; p < (level->hasSwitch ? 3 : 1) && complete; ++p) {
+    if (sw != -1)
+      task->board[sw] = P_SW1_BL + p * (P_SW2_BT - P_SW1_BL) + ((original - P_SW1_BL) & 3);
+    Engine_PruneBoard(&w->engine, board, PRUNEBOARD_FLAG_NORMAL);
+    Engine_UpdateNetlist(&w->engine);
+    anyWithoutShort |= !Engine_IsShort(&w->engine);
+    complete = (Engine_ConsultOracle(Engine_PackNetlist(&w->engine)) == level->goalStates[p]);
+  }
+  if (sw != -1)
+    task->board[sw] = original;
+  if (!complete || !anyWithoutShort)
+    return;
+
+  w->solutions++;
+  w->weighted += task->weight;
+  pthread_mutex_lock(&witnessLock);
+  if (!haveWitness || memcmp(task->board, witness, CELLS) < 0) { // keep the same one no matter which thread finds it first
+    memcpy(witness, task->board, CELLS);
+    haveWitness = true;
+  }
+  pthread_mutex_unlock(&witnessLock);
+}
+
+static void Push(WORKER* w, const TASK* task)
+{
+  pthread_mutex_lock(&w->lock);
+  if (w->head == w->tail)
+    w->head = w->tail = 0;
+  if (w->tail == w->capacity) {
+    w->capacity = w->capacity ? w->capacity * 2 : 64;
+    w->tasks = realloc(w->tasks, w->capacity * sizeof(TASK));
+    if (!w->tasks) {
+      perror("realloc");
+      exit(EXIT_FAILURE);
+    }
+  }
+  w->tasks[w->tail++] = *task;
+  __atomic_add_fetch(&pendingTasks, 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&w->lock);
+}
+
+static bool Pop(WORKER* w, TASK* task)
+{
+  bool found = false;
+  pthread_mutex_lock(&w->lock);
+  if (w->tail > w->head) {
+    *task = w->tasks[--w->tail];
+    found = true;
+  }
+  pthread_mutex_unlock(&w->lock);
+  return found;
+}
+
+// Thieves take the oldest task, which is the one closest to the root, so it's likely to have the most work in it
+static bool Steal(WORKER* victim, TASK* task)
+{
+  bool found = false;
+  pthread_mutex_lock(&victim->lock);
+  if (victim->tail > victim->head) {
+    *task = victim->tasks[victim->head++];
+    found = true;
+  }
+  pthread_mutex_unlock(&victim->lock);
+  return found;
+}
+
+static void Search(WORKER* w, TASK* task);
+
+static void Try(WORKER* w, TASK* task, uint8_t c, uint8_t piece, uint16_t used, uint8_t weight)
+{
+  const LEVEL* level = w->level;
+  w->nodes++;
+
+  uint16_t previouslyUsed = task->used;
+  uint32_t previousWeight = task->weight;
+  task->board[c] = piece;
+  task->decided |= (1UL << c);
+  task->used = used;
+  task->depth++;
+  task->weight *= weight;
+
+  SPARE spare;
+  Spare(level, task, &spare);
+  if (Consistent(level, task, c, &spare) && (!(level->flags & SEARCH_PROPAGATE) || Propagate(level, task, &spare))) {
+    if (task->depth == level->orderCount)
+      Evaluate(w, task);
+    else if (__atomic_load_n(&idleWorkers, __ATOMIC_RELAXED) && level->orderCount - task->depth >= SPLIT_MIN_DEPTH)
+      Push(w, task); // someone is out of work, so let them have this subtree
+    else
+      Search(w, task);
+  }
+
+  task->weight = previousWeight;
+  task->depth--;
+  task->used = previouslyUsed;
+  task->decided &= ~(1UL << c);
+  task->board[c] = P_BLANK;
+}
+
+static void Search(WORKER* w, TASK* task)
+{
+  const LEVEL* level = w->level;
+  uint8_t c = level->order[task->depth];
+
+  if (level->kind[c] == CELL_ROTATE) {
+    for (uint8_t r = 0; r < level->count[c]; ++r)
+      Try(w, task, c, level->rotations[c][r], task->used, level->rotationWeight[c][r]);
+    return;
+  }
+
+  // Every piece in the hand has to end up on the board, so only leave this square blank if there is room for them after it
+  uint8_t remaining = level->tokens - __builtin_popcount(task->used);
+  if (remaining < level->openAfter[task->depth])
+    Try(w, task, c, P_BLANK, task->used, 1);
+  if (remaining == 0)
+    return;
+
+  for (uint8_t t = 0; t < level->tokens; ++t)
+    if (!(task->used & (1U << t)) && (level->tokenSame[t] == NO_TOKEN || (task->used & (1U << level->tokenSame[t]))))
+      for (uint8_t r = 0; r < level->tokenCount[t]; ++r)
+        Try(w, task, c, level->tokenRotations[t][r], task->used | (1U << t), level->tokenWeight[t][r]);
+}
+
+static void* Work(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  TASK task;
+
+  for (;;) {
+    bool found = Pop(w, &task);
+    if (!found) {
+      __atomic_add_fetch(&idleWorkers, 1, __ATOMIC_RELAXED);
+      while (!found && __atomic_load_n(&pendingTasks, __ATOMIC_RELAXED)) {
+        w->seed = w->seed * 1103515245 + 12345;
+        found = Steal(&workers[(w->seed >> 16) % workerCount], &task);
+        if (!found)
+          sched_yield();
+      }
+      __atomic_sub_fetch(&idleWorkers, 1, __ATOMIC_RELAXED);
+      if (!found)
+        break;
+    }
+
+    if (task.depth == w->level->orderCount)
+      Evaluate(w, &task);
+    else
+      Search(w, &task);
+    __atomic_sub_fetch(&pendingTasks, 1, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void RunSearch(uint8_t number, uint8_t flags, RESULT* result)
+{
+  LEVEL level;
+  bool feasible = DecodeLevel(number, flags, &level);
+
+  TASK root;
+  memcpy(root.board, level.board, CELLS);
+  root.decided = 0;
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if (level.kind[i] == CELL_FIXED)
+      root.decided |= (1UL << i);
+  root.used = 0;
+  root.depth = 0;
+  root.weight = 1;
+
+  // A locked piece surrounded by other locked pieces never gets checked by the search
+  SPARE spare;
+  Spare(&level, &root, &spare);
+  for (uint8_t i = 0; i < CELLS; ++i)
+    if ((root.decided & (1UL << i)) && !Fits(&level, &root, i, &spare))
+      feasible = false;
+  if ((flags & SEARCH_PROPAGATE) && !Propagate(&level, &root, &spare))
+    feasible = false;
+
+  haveWitness = false;
+  pendingTasks = 0;
+  idleWorkers = 0;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    WORKER* w = &workers[t];
+    w->level = &level;
+    memset(&w->engine, 0, sizeof(w->engine));
+    w->nodes = w->leaves = w->solutions = w->weighted = w->mismatches = 0;
+    w->referenceLit = w->referenceVerdicts = 0;
+    w->head = w->tail = 0;
+    w->seed = t + 1;
+  }
+
+  double start = Now();
+  if (feasible) {
+    Push(&workers[0], &root);
+    for (uint32_t t = 0; t < workerCount; ++t)
+      if (pthread_create(&workers[t].thread, NULL, Work, &workers[t])) {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+      }
+    for (uint32_t t = 0; t < workerCount; ++t)
+      pthread_join(workers[t].thread, NULL);
+  }
+
+  memset(result, 0, sizeof(*result));
+  result->elapsed = Now() - start;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    result->nodes += workers[t].nodes;
+    result->leaves += workers[t].leaves;
+    result->solutions += workers[t].solutions;
+    result->weighted += workers[t].weighted;
+    result->mismatches += workers[t].mismatches;
+    result->referenceLit += workers[t].referenceLit;
+    result->referenceVerdicts += workers[t].referenceVerdicts;
+  }
+  result->weighted *= level.weight;
+  result->haveWitness = haveWitness;
+  memcpy(result->witness, witness, CELLS);
+}
+
+static bool Agrees(const RESULT* a, const RESULT* b)
+{
+  return (a->weighted == b->weighted && a->haveWitness == b->haveWitness && !memcmp(a->witness, b->witness, CELLS) &&
+          !a->mismatches && !b->mismatches);
+}
+
+// Returns the number of solutions, or 0 if the searches don't agree
+static uint64_t SolveLevel(uint8_t number, bool verify, uint64_t totalNodes[3], uint64_t totalReference[2])
+{
+  RESULT full;
+  RunSearch(number, SEARCH_REDUCE | SEARCH_PROPAGATE, &full);
+  totalNodes[0] += full.nodes;
+
+  printf("Level %02u: %lu solutions (%lu up to symmetry), %lu nodes, %lu leaves, %.3f s, %.2f M nodes/s%s\n", number,
+         full.weighted, full.solutions, full.nodes, full.leaves, full.elapsed,
+         (full.elapsed > 0) ? full.nodes / full.elapsed / 1e6 : 0.0, full.solutions ? "" : "  UNSOLVABLE");
+  if (full.mismatches)
+    printf("  %lu leaves passed the per-square checks, but not Engine_PruneBoard\n", full.mismatches);
+  if (compareReference) {
+    printf("  reference: %lu leaves lit differently, %lu where it would disagree about completing the level\n",
+           full.referenceLit, full.referenceVerdicts);
+    totalReference[0] += full.referenceLit;
+    totalReference[1] += full.referenceVerdicts;
+  }
+
+  RESULT unpropagated;
+  RunSearch(number, SEARCH_REDUCE, &unpropagated);
+  totalNodes[1] += unpropagated.nodes;
+  bool agrees = Agrees(&full, &unpropagated);
+  printf("  without propagation: %lu nodes, %.3f s, %.2fx the nodes%s\n", unpropagated.nodes, unpropagated.elapsed,
+         full.nodes ? (double)unpropagated.nodes / full.nodes : 0.0, agrees ? "" : "  MISMATCH");
+
+  if (verify) {
+    RESULT naive;
+    RunSearch(number, 0, &naive);
+    totalNodes[2] += naive.nodes;
+    bool same = Agrees(&full, &naive);
+    printf("  naive: %lu solutions, %lu nodes, %.3f s, %.2fx the nodes%s\n", naive.weighted, naive.nodes, naive.elapsed,
+           full.nodes ? (double)naive.nodes / full.nodes : 0.0, same ? "" : "  MISMATCH");
+    agrees &= same;
+  }
+
+  if (full.haveWitness)
+    for (uint8_t y = 0; y < BOARD_HEIGHT; ++y) {
+      printf(" ");
+      for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+        printf(" %2u", full.witness[y * BOARD_WIDTH + x]);
+      printf("\n");
+    }
+
+  return (full.mismatches || !agrees) ? 0 : full.weighted;
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  bool verify = true;
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t")) {
+      cpus = atol(argv[2]);
+      argc -= 2;
+      argv += 2;
+    } else if (argc > 1 && !strcmp(argv[1], "-r")) {
+      verify = false;
+      argc--;
+      argv++;
+    } else if (argc > 1 && !strcmp(argv[1], "-c")) {
+      compareReference = true;
+      argc--;
+      argv++;
+    } else {
+      break;
+    }
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    pthread_mutex_init(&workers[t].lock, NULL);
+  }
+
+  uint8_t levels[LEVELS];
+  uint8_t levelCount = 0;
+  for (int i = 1; i < argc; ++i) {
+    int number = atoi(argv[i]);
+    if (number < 1 || number > (int)LEVELS) {
+      fprintf(stderr, "Levels go from 1 to %zu\n", LEVELS);
+      return EXIT_FAILURE;
+    }
+    levels[levelCount++] = number;
+  }
+  if (levelCount == 0)
+    for (uint8_t i = 1; i <= LEVELS; ++i)
+      levels[levelCount++] = i;
+
+  uint64_t totalNodes[3] = { 0 }; // with everything, without propagation, and naive
+  uint64_t totalReference[2] = { 0 }; // leaves lit differently, and leaves with a different verdict
+  uint8_t unsolvable = 0;
+  double start = Now();
+  for (uint8_t i = 0; i < levelCount; ++i)
+    if (!SolveLevel(levels[i], verify, totalNodes, totalReference))
+      unsolvable++;
+  double elapsed = Now() - start;
+
+  uint64_t nodes = totalNodes[0] + totalNodes[1] + totalNodes[2];
+  printf("\nSolved %u of %u levels using %u threads, %lu nodes in %.2f s (%.2f M nodes/s)\n", levelCount - unsolvable, levelCount,
+         workerCount, nodes, elapsed, (elapsed > 0) ? nodes / elapsed / 1e6 : 0.0);
+  printf("The search took %lu nodes, %lu (%.2fx) without propagation", totalNodes[0], totalNodes[1],
+         totalNodes[0] ? (double)totalNodes[1] / totalNodes[0] : 0.0);
+  if (verify)
+    printf(", and %lu (%.2fx) naively", totalNodes[2], totalNodes[0] ? (double)totalNodes[2] / totalNodes[0] : 0.0);
+  printf("\n");
+  if (compareReference)
+    printf("Compared with the reference, %lu leaves were lit differently, and %lu would complete the level differently\n",
+           totalReference[0], totalReference[1]);
+
+  return unsolvable ? EXIT_FAILURE : EXIT_SUCCESS;
+}
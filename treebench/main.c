@@ -0,0 +1,645 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "../oracle2/netlist_node.h"
+
+static inline int NetlistCompare(uint32_t x, uint32_t y)
+{
+  x &= NETLIST_NETLIST_MASK;
+  y &= NETLIST_NETLIST_MASK;
+  return (x > y) - (x < y);
+}
+
+// The same tree as netlist_node_t, with the compare inlined and aligned nodes
+#define RBTREE_TYPED_NAME netlist_rbtree
+#define RBTREE_TYPED_KEY uint32_t
+#define RBTREE_TYPED_COMPARE(x, y) NetlistCompare((x), (y))
+#include "../oracle2/rbtree/rbtree+typed.h"
+#include "../oracle2/bptree/bptree.h"
+
+/* Benchmarks the Red-Black Tree in oracle2/rbtree the way oracle2
+   uses it: a stream of netlists, many of them duplicates, goes
+   through rbtree_setinsert, and then the whole tree is thrown away.
+   Each strategy runs on the same keys:
+
+     - malloc, delete: every node comes from malloc, and the tree is
+       torn down the way oracle2 used to do it, rbtree_minimum and
+       rbtree_delete (which rebalances) and then free, until it is
+       empty.
+     - malloc, clear: the same nodes, torn down with rbtree_clear,
+       which visits each node once in O(n) without rebalancing.
+     - pool, clear: the nodes come from an rbtree_pool_t, so a
+       duplicate is recycled instead of going back to malloc, and
+       rbtree_clear hands everything back to the pool before
+       rbtree_pool_destroy frees the slabs.
+     - pool, destroy: rbtree_pool_destroy on its own, since nothing
+       needs the nodes once the tree is gone.
+
+   For each one it shows the calls to malloc and free the tree made,
+   and the time it took to insert the keys and to tear it down.
+
+   Then it loads the distinct keys, in sorted order, into a tree with
+   rbtree_setinsert and with rbtree_build_sorted, and merges two trees
+   (the even and the odd keys, and half the keys again so some are in
+   both) by inserting one into the other and with rbtree_union. Each
+   of those trees is checked to be a valid Red-Black Tree.
+
+   Then it runs the same operations on the function pointer tree
+   (netlist_node_t and netlist_node_compare) and on the typed tree
+   from rbtree+typed.h (uint32_t keys, the same masked compare
+   inlined): setinsert every key, search for as many netlists again
+   (about half of them in the tree), walk the tree with successor, and
+   delete the minimum until it is empty.
+
+   Last, it compares the Red-Black Tree (from a pool) with the B+ Tree
+   in oracle2/bptree, at 1000 keys and every power of 10 up to -m keys
+   (a million by default, which can go as high as the memory allows):
+   setinsert the keys, search for as many netlists again, and walk the
+   set with minimum and successor. The smaller sizes are run over and
+   over, so each one does at least a million keys in total. Both sets
+   have to come out the same.
+
+   Build it with make CPPFLAGS=-DRBTREE_COMPACT or with
+   make CPPFLAGS=-DRBTREE_COMPACT_INDEX to run all of it on the smaller
+   node layouts (see oracle2/rbtree/rbtree.h). The offset layout skips
+   the malloc strategies, since every node has to be in the pool.
+
+   Example:
+     circuit/treebench$ ./main                  (1 million keys, 500000 possible netlists)
+     circuit/treebench$ ./main -n 10000000      (10 million keys)
+     circuit/treebench$ ./main -k 1000 -s 7     (only 1000 possible netlists, from seed 7)
+     circuit/treebench$ ./main -m 100000000     (B+ Tree comparison up to 10^8 keys) */
+
+#define SLAB_NODES 4096
+
+#if defined(RBTREE_COMPACT_INDEX)
+// The pool is a single arena that never grows, so it has to hold every node at once
+#define POOL_NODES(count) (2 * (count) + 1)
+#define LAYOUT "32 bit offset"
+#elif defined(RBTREE_COMPACT)
+#define POOL_NODES(count) SLAB_NODES
+#define LAYOUT "compact pointer"
+#else
+#define POOL_NODES(count) SLAB_NODES
+#define LAYOUT "pointer"
+#endif
+
+static uint64_t seed = 1;
+
+// xorshift64, which gets stuck at 0
+static uint64_t Random(void)
+{
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Only fails with RBTREE_COMPACT_INDEX, where it allocates the whole arena up front
+static void InitPool(rbtree_t *tree, rbtree_node_t *nil, rbtree_pool_t *pool)
+{
+  if (!rbtree_init_pool(tree, nil, sizeof(netlist_node_t), netlist_node_compare, pool)) {
+    fprintf(stderr, "Out of memory\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Spreads the key numbers over the netlist bits, so neighboring keys aren't neighbors in the tree
+static uint32_t *MakeKeys(size_t count, uint32_t keyspace)
+{
+  uint32_t *keys = malloc(count * sizeof(uint32_t));
+  if (!keys)
+    return 0;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t k = (uint32_t)((Random() >> 32) * keyspace >> 32);
+    keys[i] = (k * 0x9E3779B1u) & NETLIST_NETLIST_MASK;
+  }
+  return keys;
+}
+
+enum STRATEGY { MALLOC_DELETE, MALLOC_CLEAR, POOL_CLEAR, POOL_DESTROY, STRATEGIES };
+
+static const char* strategyNames[STRATEGIES] = {
+  "malloc, delete",
+  "malloc, clear",
+  "pool, clear",
+  "pool, destroy",
+};
+
+struct RUN;
+typedef struct RUN RUN;
+
+struct RUN {
+  size_t nodes;     // distinct keys left in the tree
+  size_t mallocs;
+  size_t frees;
+  double insertSeconds;
+  double teardownSeconds;
+};
+
+static void Run(enum STRATEGY strategy, const uint32_t *keys, size_t count, RUN *run)
+{
+  netlist_node_t myNil;
+  rbtree_node_t *myNilRef = (rbtree_node_t *)&myNil;
+  rbtree_t tree;
+  rbtree_pool_t pool;
+  bool pooled = (strategy == POOL_CLEAR || strategy == POOL_DESTROY);
+
+  memset(run, 0, sizeof(*run));
+  if (pooled) {
+    rbtree_pool_init(&pool, sizeof(netlist_node_t), POOL_NODES(count));
+    InitPool(&tree, myNilRef, &pool);
+  } else {
+    rbtree_init(&tree, myNilRef, sizeof(netlist_node_t), netlist_node_compare);
+  }
+
+  double start = Now();
+  for (size_t i = 0; i < count; ++i) {
+    struct netlist nl = { keys[i] };
+    rbtree_node_t *n = netlist_node_new(&tree, &nl);
+    if (rbtree_setinsert(&tree, n))
+      run->nodes++;
+    else
+      rbtree_node_free(&tree, n);
+  }
+  double inserted = Now();
+
+  switch (strategy) {
+  case MALLOC_DELETE:
+    for (rbtree_node_t *itr = rbtree_minimum(&tree); itr != myNilRef; itr = rbtree_minimum(&tree)) {
+      rbtree_delete(&tree, itr);
+      free(itr);
+    }
+    break;
+  case MALLOC_CLEAR:
+  case POOL_CLEAR:
+    rbtree_clear(&tree);
+    break;
+  default:
+    break;
+  }
+  rbtree_destroy(&tree);
+  if (pooled) {
+    run->mallocs = run->frees = pool.slab_count;
+    rbtree_pool_destroy(&pool);
+  } else {
+    // One malloc per key, and a free for every duplicate, and then every node in the tree
+    run->mallocs = run->frees = count;
+  }
+  double tornDown = Now();
+
+  run->insertSeconds = inserted - start;
+  run->teardownSeconds = tornDown - inserted;
+}
+
+static int CompareKeys(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+// Returns the black height of the subtree, or -1 if it breaks any of the Red-Black Tree rules
+static int Check(rbtree_t *tree, rbtree_node_t *x, const rbtree_node_t *low, const rbtree_node_t *high)
+{
+  if (x == tree->nil)
+    return 1;
+  if ((low && tree->Compare(low, x) >= 0) || (high && tree->Compare(x, high) >= 0))
+    return -1;
+  rbtree_node_t *l = rbtree_node_left(tree, x);
+  rbtree_node_t *r = rbtree_node_right(tree, x);
+  if ((l != tree->nil && rbtree_node_parent(tree, l) != x) || (r != tree->nil && rbtree_node_parent(tree, r) != x))
+    return -1;
+  if (rbtree_node_color(x) == RBTREE_NODE_COLOR_RED &&
+      (rbtree_node_color(l) == RBTREE_NODE_COLOR_RED || rbtree_node_color(r) == RBTREE_NODE_COLOR_RED))
+    return -1;
+  int left = Check(tree, l, low, x);
+  int right = Check(tree, r, x, high);
+  if (left < 0 || left != right)
+    return -1;
+  return left + (rbtree_node_color(x) == RBTREE_NODE_COLOR_BLACK);
+}
+
+static bool Valid(rbtree_t *tree)
+{
+  return rbtree_node_color(tree->root) == RBTREE_NODE_COLOR_BLACK && Check(tree, tree->root, 0, 0) > 0;
+}
+
+static size_t Size(rbtree_t *tree)
+{
+  size_t n = 0;
+  for (rbtree_node_t *x = rbtree_minimum(tree); x != tree->nil; x = rbtree_successor(tree, x))
+    n++;
+  return n;
+}
+
+static void PrintLoad(const char *name, rbtree_t *tree, double seconds, size_t count)
+{
+  printf("%-22s %10zu %10.3f %10.1f %10s\n", name, Size(tree), seconds,
+         count ? seconds * 1e9 / count : 0.0, Valid(tree) ? "yes" : "NO");
+}
+
+// Fills the tree from sorted keys with setinsert, or in one pass with build_sorted
+static double Load(rbtree_t *tree, const uint32_t *sorted, size_t count, size_t step, bool build)
+{
+  rbtree_node_t **nodes = malloc((count / step + 1) * sizeof(rbtree_node_t *));
+  size_t n = 0;
+  for (size_t i = 0; i < count; i += step) {
+    struct netlist nl = { sorted[i] };
+    nodes[n++] = netlist_node_new(tree, &nl);
+  }
+
+  double start = Now();
+  if (build)
+    rbtree_build_sorted(tree, nodes, n);
+  else
+    for (size_t i = 0; i < n; ++i)
+      rbtree_setinsert(tree, nodes[i]);
+  double seconds = Now() - start;
+  free(nodes);
+  return seconds;
+}
+
+static void Sorted(const uint32_t *keys, size_t count)
+{
+  uint32_t *sorted = malloc(count * sizeof(uint32_t));
+  if (!sorted) {
+    fprintf(stderr, "Out of memory\n");
+    return;
+  }
+  memcpy(sorted, keys, count * sizeof(uint32_t));
+  qsort(sorted, count, sizeof(uint32_t), CompareKeys);
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i)
+    if (!n || sorted[i] != sorted[n - 1])
+      sorted[n++] = sorted[i];
+
+  netlist_node_t myNil;
+  rbtree_node_t *myNilRef = (rbtree_node_t *)&myNil;
+  rbtree_pool_t pool;
+  rbtree_t a, b;
+  rbtree_pool_init(&pool, sizeof(netlist_node_t), POOL_NODES(n));
+
+  printf("\n%-22s %10s %10s %10s %10s\n", "sorted keys", "nodes", "seconds", "ns/node", "valid");
+  for (int build = 0; build < 2; ++build) {
+    InitPool(&a, myNilRef, &pool);
+    double seconds = Load(&a, sorted, n, 1, build);
+    PrintLoad(build ? "build_sorted" : "setinsert", &a, seconds, n);
+    rbtree_clear(&a);
+  }
+
+  for (int merge = 0; merge < 2; ++merge) {
+    InitPool(&a, myNilRef, &pool);
+    InitPool(&b, myNilRef, &pool);
+    Load(&a, sorted, n, 2, true);
+    Load(&b, sorted + 1, n - 1, 2, true);
+    size_t total = Size(&a) + Size(&b);
+
+    double start = Now();
+    if (merge) {
+      rbtree_union(&a, &b);
+    } else {
+      for (rbtree_node_t *x = rbtree_minimum(&b); x != myNilRef; x = rbtree_minimum(&b)) {
+        rbtree_delete(&b, x);
+        if (!rbtree_setinsert(&a, x))
+          rbtree_node_free(&b, x);
+      }
+    }
+    PrintLoad(merge ? "union" : "delete, setinsert", &a, Now() - start, total);
+
+    // Half of the keys again, which are all duplicates now
+    InitPool(&b, myNilRef, &pool);
+    Load(&b, sorted, n, 2, true);
+    total = Size(&a) + Size(&b);
+    start = Now();
+    if (merge) {
+      rbtree_union(&a, &b);
+    } else {
+      for (rbtree_node_t *x = rbtree_minimum(&b); x != myNilRef; x = rbtree_minimum(&b)) {
+        rbtree_delete(&b, x);
+        if (!rbtree_setinsert(&a, x))
+          rbtree_node_free(&b, x);
+      }
+    }
+    PrintLoad(merge ? "union, duplicates" : "setinsert, duplicates", &a, Now() - start, total);
+    rbtree_clear(&a);
+  }
+
+  rbtree_pool_destroy(&pool);
+  free(sorted);
+}
+
+// The netlists to search for, every other one is from the keys, the rest are random
+static uint32_t *MakeProbes(const uint32_t *keys, size_t count)
+{
+  uint32_t *probes = malloc(count * sizeof(uint32_t));
+  if (!probes)
+    return 0;
+  for (size_t i = 0; i < count; ++i)
+    probes[i] = (i & 1) ? keys[(Random() >> 32) * count >> 32] : (uint32_t)Random() & NETLIST_NETLIST_MASK;
+  return probes;
+}
+
+static void PrintCompare(const char *name, double fnptr, double typed, size_t count)
+{
+  printf("%-22s %10.1f %10.1f %9.2fx\n", name, fnptr * 1e9 / count, typed * 1e9 / count, fnptr / typed);
+}
+
+static void Typed(const uint32_t *keys, size_t count)
+{
+  uint32_t *probes = MakeProbes(keys, count);
+  if (!probes) {
+    fprintf(stderr, "Out of memory\n");
+    return;
+  }
+
+  netlist_node_t myNil;
+  rbtree_node_t *myNilRef = (rbtree_node_t *)&myNil;
+  rbtree_pool_t pool, typedPool;
+  rbtree_t tree;
+  netlist_rbtree_t typed;
+  rbtree_pool_init(&pool, sizeof(netlist_node_t), POOL_NODES(count));
+  rbtree_pool_init(&typedPool, sizeof(netlist_rbtree_node_t), POOL_NODES(count));
+  InitPool(&tree, myNilRef, &pool);
+  netlist_rbtree_init(&typed);
+  double fnptr[4], typedSeconds[4];
+  size_t nodes = 0, found = 0, typedFound = 0, walked = 0, typedWalked = 0;
+  bool same = true;
+
+  double start = Now();
+  for (size_t i = 0; i < count; ++i) {
+    struct netlist nl = { keys[i] };
+    rbtree_node_t *n = netlist_node_new(&tree, &nl);
+    if (rbtree_setinsert(&tree, n))
+      nodes++;
+    else
+      rbtree_node_free(&tree, n);
+  }
+  fnptr[0] = Now() - start;
+
+  start = Now();
+  for (size_t i = 0; i < count; ++i) {
+    void *node = rbtree_pool_alloc(&typedPool);
+    netlist_rbtree_node_t *n = node;
+    n->key = keys[i];
+    if (!netlist_rbtree_setinsert(&typed, n))
+      rbtree_pool_free(&typedPool, node);
+  }
+  typedSeconds[0] = Now() - start;
+
+  start = Now();
+  for (size_t i = 0; i < count; ++i) {
+    netlist_node_t k = { .n = { probes[i] } };
+    found += rbtree_search(&tree, (rbtree_node_t *)&k) != myNilRef;
+  }
+  fnptr[1] = Now() - start;
+
+  start = Now();
+  for (size_t i = 0; i < count; ++i)
+    typedFound += netlist_rbtree_search(&typed, probes[i]) != &typed.nil;
+  typedSeconds[1] = Now() - start;
+
+  start = Now();
+  for (rbtree_node_t *x = rbtree_minimum(&tree); x != myNilRef; x = rbtree_successor(&tree, x))
+    walked += ((netlist_node_t *)(void *)x)->n.netlist_and_led_states & 1;
+  fnptr[2] = Now() - start;
+
+  start = Now();
+  for (netlist_rbtree_node_t *x = netlist_rbtree_minimum(&typed); x != &typed.nil; x = netlist_rbtree_successor(&typed, x))
+    typedWalked += x->key & 1;
+  typedSeconds[2] = Now() - start;
+
+  // Both trees hold the same keys in the same order
+  rbtree_node_t *x = rbtree_minimum(&tree);
+  netlist_rbtree_node_t *y = netlist_rbtree_minimum(&typed);
+  for (; x != myNilRef && y != &typed.nil; x = rbtree_successor(&tree, x), y = netlist_rbtree_successor(&typed, y))
+    same = same && ((netlist_node_t *)(void *)x)->n.netlist_and_led_states == y->key;
+  same = same && x == myNilRef && y == &typed.nil && found == typedFound && walked == typedWalked;
+
+  start = Now();
+  for (rbtree_node_t *x = rbtree_minimum(&tree); x != myNilRef; x = rbtree_minimum(&tree))
+    rbtree_node_free(&tree, rbtree_delete(&tree, x));
+  fnptr[3] = Now() - start;
+
+  start = Now();
+  for (netlist_rbtree_node_t *x = netlist_rbtree_minimum(&typed); x != &typed.nil; x = netlist_rbtree_minimum(&typed))
+    rbtree_pool_free(&typedPool, (void *)netlist_rbtree_delete(&typed, x));
+  typedSeconds[3] = Now() - start;
+
+  printf("\n%zu byte function pointer nodes, %zu byte typed nodes, same results: %s\n",
+         sizeof(netlist_node_t), sizeof(netlist_rbtree_node_t), same ? "yes" : "NO");
+  printf("%-22s %10s %10s %10s\n", "ns/operation", "fn pointer", "typed", "speedup");
+  PrintCompare("setinsert", fnptr[0], typedSeconds[0], count);
+  PrintCompare("search", fnptr[1], typedSeconds[1], count);
+  PrintCompare("successor", fnptr[2], typedSeconds[2], nodes);
+  PrintCompare("minimum, delete", fnptr[3], typedSeconds[3], nodes);
+
+  rbtree_destroy(&tree);
+  netlist_rbtree_destroy(&typed);
+  rbtree_pool_destroy(&pool);
+  rbtree_pool_destroy(&typedPool);
+  free(probes);
+}
+
+struct SCALE;
+typedef struct SCALE SCALE;
+
+struct SCALE {
+  size_t values;
+  size_t found;
+  uint64_t checksum;  // of the walk, in order
+  double bytes;       // per value
+  double insertSeconds;
+  double searchSeconds;
+  double walkSeconds;
+};
+
+static void ScaleRbtree(const uint32_t *keys, const uint32_t *probes, size_t count, SCALE *scale)
+{
+  netlist_node_t myNil;
+  rbtree_node_t *myNilRef = (rbtree_node_t *)&myNil;
+  rbtree_t tree;
+  rbtree_pool_t pool;
+  rbtree_pool_init(&pool, sizeof(netlist_node_t), POOL_NODES(count));
+  InitPool(&tree, myNilRef, &pool);
+
+  double start = Now();
+  for (size_t i = 0; i < count; ++i) {
+    struct netlist nl = { keys[i] };
+    rbtree_node_t *n = netlist_node_new(&tree, &nl);
+    if (!rbtree_setinsert(&tree, n))
+      rbtree_node_free(&tree, n);
+  }
+  double inserted = Now();
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i) {
+    netlist_node_t k = { .n = { probes[i] } };
+    found += rbtree_search(&tree, (rbtree_node_t *)&k) != myNilRef;
+  }
+  double searched = Now();
+  size_t values = 0;
+  uint64_t checksum = 0;
+  for (rbtree_node_t *x = rbtree_minimum(&tree); x != myNilRef; x = rbtree_successor(&tree, x)) {
+    checksum = checksum * 31 + ((netlist_node_t *)(void *)x)->n.netlist_and_led_states;
+    values++;
+  }
+  double walked = Now();
+
+  scale->values = values;
+  scale->found = found;
+  scale->checksum = checksum;
+  scale->bytes = (double)pool.slab_count * pool.nodes_per_slab * pool.rbtree_node_t_size / (values ? values : 1);
+  scale->insertSeconds += inserted - start;
+  scale->searchSeconds += searched - inserted;
+  scale->walkSeconds += walked - searched;
+  rbtree_clear(&tree);
+  rbtree_destroy(&tree);
+  rbtree_pool_destroy(&pool);
+}
+
+static void ScaleBptree(const uint32_t *keys, const uint32_t *probes, size_t count, SCALE *scale)
+{
+  bptree_t tree;
+  bptree_init(&tree, NETLIST_NETLIST_MASK);
+
+  double start = Now();
+  for (size_t i = 0; i < count; ++i)
+    bptree_setinsert(&tree, keys[i]);
+  double inserted = Now();
+  size_t found = 0;
+  for (size_t i = 0; i < count; ++i)
+    found += bptree_search(&tree, probes[i]) != 0;
+  double searched = Now();
+  size_t values = 0;
+  uint64_t checksum = 0;
+  for (uint32_t *x = bptree_minimum(&tree); x; x = bptree_successor(&tree, x)) {
+    checksum = checksum * 31 + *x;
+    values++;
+  }
+  double walked = Now();
+
+  scale->values = values;
+  scale->found = found;
+  scale->checksum = checksum;
+  scale->bytes = (double)tree.nodes * BPTREE_NODE_BYTES / (values ? values : 1);
+  scale->insertSeconds += inserted - start;
+  scale->searchSeconds += searched - inserted;
+  scale->walkSeconds += walked - searched;
+  bptree_destroy(&tree);
+}
+
+static void PrintScale(size_t count, const char *name, const SCALE *scale, size_t repeats, bool same)
+{
+  printf("%10zu %-8s %10zu %10.1f %10.1f %10.1f %10.1f %6s\n",
+         count, name, scale->values,
+         scale->insertSeconds * 1e9 / repeats / count,
+         scale->searchSeconds * 1e9 / repeats / count,
+         scale->walkSeconds * 1e9 / repeats / (scale->values ? scale->values : 1),
+         scale->bytes, same ? "yes" : "NO");
+}
+
+static void Scale(size_t maxCount)
+{
+  printf("\n%10s %-8s %10s %10s %10s %10s %10s %6s\n",
+         "keys", "set", "values", "insert ns", "search ns", "walk ns", "bytes/val", "same");
+  for (size_t count = 1000; count <= maxCount; count *= 10) {
+    // The netlists are drawn from about as many as there are keys, so some of them repeat
+    uint32_t keyspace = (count > NETLIST_NETLIST_MASK) ? NETLIST_NETLIST_MASK + 1 : count;
+    uint32_t *keys = MakeKeys(count, keyspace);
+    uint32_t *probes = keys ? MakeProbes(keys, count) : 0;
+    if (!probes) {
+      fprintf(stderr, "Out of memory at %zu keys\n", count);
+      free(keys);
+      return;
+    }
+
+    size_t repeats = (count < 1000000) ? 1000000 / count : 1;
+    SCALE rb = { 0 }, bp = { 0 };
+    for (size_t r = 0; r < repeats; ++r) {
+      ScaleRbtree(keys, probes, count, &rb);
+      ScaleBptree(keys, probes, count, &bp);
+    }
+    bool same = rb.values == bp.values && rb.found == bp.found && rb.checksum == bp.checksum;
+    PrintScale(count, "rbtree", &rb, repeats, same);
+    PrintScale(count, "bptree", &bp, repeats, same);
+    fflush(stdout);
+
+    free(probes);
+    free(keys);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  size_t count = 1000000;
+  size_t maxCount = 1000000;
+  uint32_t keyspace = 0;
+
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+      count = strtoull(argv[2], 0, 10);
+    } else if (argc > 2 && !strcmp(argv[1], "-k")) {
+      keyspace = strtoul(argv[2], 0, 10);
+    } else if (argc > 2 && !strcmp(argv[1], "-m")) {
+      maxCount = strtoull(argv[2], 0, 10);
+    } else if (argc > 2 && !strcmp(argv[1], "-s")) {
+      seed = strtoull(argv[2], 0, 10);
+    } else {
+      break;
+    }
+    argc -= 2;
+    argv += 2;
+  }
+  if (!count) {
+    fprintf(stderr, "-n needs at least 1 key\n");
+    return EXIT_FAILURE;
+  }
+  if (!keyspace)
+    keyspace = count / 2 ? count / 2 : 1;
+  if (keyspace > NETLIST_NETLIST_MASK + 1)
+    keyspace = NETLIST_NETLIST_MASK + 1;
+  seed = (seed + 1) * 0x9E3779B97F4A7C15ULL;
+
+  uint32_t *keys = MakeKeys(count, keyspace);
+  if (!keys) {
+    fprintf(stderr, "Out of memory\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%zu keys, %u possible netlists, %s links, %zu byte nodes (%.1f million per GB), %zu nodes per slab\n\n",
+         count, keyspace, LAYOUT, sizeof(netlist_node_t), 1024.0 * 1024 * 1024 / sizeof(netlist_node_t) / 1e6,
+         (size_t)POOL_NODES(count));
+  printf("%-16s %10s %10s %10s %10s %10s %10s %10s\n",
+         "strategy", "nodes", "mallocs", "frees", "insert s", "ns/key", "teardown s", "ns/node");
+  for (int s = 0; s < STRATEGIES; ++s) {
+#if defined(RBTREE_COMPACT_INDEX)
+    // Nodes from malloc can't be reached by an offset into the pool
+    if (s == MALLOC_DELETE || s == MALLOC_CLEAR)
+      continue;
+#endif
+    RUN run;
+    Run(s, keys, count, &run);
+    printf("%-16s %10zu %10zu %10zu %10.3f %10.1f %10.3f %10.1f\n",
+           strategyNames[s], run.nodes, run.mallocs, run.frees,
+           run.insertSeconds, run.insertSeconds * 1e9 / count,
+           run.teardownSeconds, run.nodes ? run.teardownSeconds * 1e9 / run.nodes : 0.0);
+  }
+
+  Sorted(keys, count);
+  Typed(keys, count);
+  Scale(maxCount);
+
+  free(keys);
+  return EXIT_SUCCESS;
+}
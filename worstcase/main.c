@@ -0,0 +1,564 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "../engine/engine.h"
+#include "../profile/profile.h"
+
+/* Searches for the boards that make BoardChanged slowest. The engine
+   is built with ENGINE_COUNTERS, so every evaluation counts the
+   squares, PruneBoard iterations, union-find steps, electrons,
+   oracle probes, and flash table reads it took, and a rough AVR
+   cycle model turns those into cycles for each step of the
+   evaluation that BoardChanged spreads across frames:
+
+     prune    Engine_PruneBoard(PRUNEBOARD_FLAG_NORMAL)
+     netlist  the slowest Engine_UpdateNetlistStep, repairing the
+              netlist from an empty board a square of sources at a time
+     lookup   Engine_PackNetlist and Engine_ConsultOracle
+     rules    Engine_PruneBoard(PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY),
+              when there isn't a short circuit
+
+   Each thread runs simulated annealing over legal boards (no more than
+   one VCC, GND, switch, and LED of each color, like any level can
+   have), restarting from a random board every so often, and the
+   slowest boards any of them find are printed in the same format as
+   levels.inc, for a regression benchmark.
+
+   The report ends with an upper bound on each step that holds for
+   every legal board, from the most each counter can structurally
+   reach, so the frame budget can be checked without trusting the
+   search to have found the true worst case. The cycle costs are
+   estimates for avr-gcc -Os code, and can be calibrated against what
+   an OPTION_PROFILE build measures (see profile/).
+
+   Example:
+     circuit/worstcase$ ./main                  (20 million steps, total cycles)
+     circuit/worstcase$ ./main -o prune         (the slowest single PruneBoard)
+     circuit/worstcase$ ./main -n 100000000 -k 20
+     circuit/worstcase$ ./main -t 4 -s 7        (on 4 threads, starting from seed 7) */
+
+#define CELLS (BOARD_WIDTH * BOARD_HEIGHT)
+#define PIECES 48 // P_BLANK through P_BLOCKER
+#define MAX_THREADS 256
+#define MAX_WORST 100
+#define DEFAULT_STEPS 20000000
+#define DEFAULT_WORST 10
+#define RESTART_STEPS 200000 // annealing steps before starting over from a random board
+#define START_TEMPERATURE 2000.0 // in cycles
+#define END_TEMPERATURE 5.0
+
+#define PHASE_PRUNE   0
+#define PHASE_NETLIST 1
+#define PHASE_LOOKUP  2
+#define PHASE_RULES   3
+#define PHASES 4
+#define OBJECTIVE_TOTAL PHASES
+
+// The pieces a legal board has at most one of, by group
+#define GROUP_NONE   0
+#define GROUP_VCC    1
+#define GROUP_GND    2
+#define GROUP_SWITCH 3
+#define GROUP_RLED   4
+#define GROUP_YLED   5
+#define GROUP_GLED   6
+#define GROUPS 7
+
+// Estimated AVR cycles for each thing the engine counts. The fixed costs cover each call's setup, and
+// for finding the wires, clearing the union-find.
+#define CYCLES_PRUNE_CALL        80
+#define CYCLES_PRUNE_SQUARE      75  // 9 bitboards shifted in, 32 bits at a time
+#define CYCLES_PRUNE_ITERATION   380 // about 90 32 bit ANDs, ORs, and shifts
+#define CYCLES_PRUNE_COPY        55
+#define CYCLES_PRUNE_DEGENERATED 30
+#define CYCLES_NETLIST_BUILD     900
+#define CYCLES_NETLIST_WIRES     1000 // about 300 bytes of NODES
+#define CYCLES_NETLIST_PIECE     110
+#define CYCLES_NETLIST_JOIN      40
+#define CYCLES_NETLIST_END       35  // a bounds check, a transition, and storing the end
+#define CYCLES_NETLIST_FIND_STEP 16
+#define CYCLES_NETLIST_SOURCE    60
+#define CYCLES_NETLIST_REPAIR    150
+#define CYCLES_NETLIST_TRACED    90  // both squares on either side of a node
+#define CYCLES_NETLIST_ELECTRON  40
+#define CYCLES_NETLIST_STEP      60  // finding the square an end faces, its transition, and the way out
+#define CYCLES_ORACLE_LOOKUP     150 // enough for the hash multiplies, if ORACLE_LAYOUT picks the hash
+#define CYCLES_ORACLE_PROBE      30
+#define CYCLES_TABLE_READ        3   // LPM, on top of the rest
+
+// The most each counter can reach for one call on a legal board
+#define BOUND_PRUNE_ITERATIONS (4 * CELLS + 1) // every pass but the last removes at least one of the 4 ports of a square
+#define BOUND_JOINS (3 * CELLS)                // a T-piece joins 3 pairs of its ports, nothing joins more
+#define BOUND_ENDS (2 * NODE_COUNT)            // both sides of every node
+#define BOUND_SOURCES (1 + 3 * 2)              // VCC, and both ends of the 3 LEDs
+#define BOUND_STEP_SOURCES 2                   // a step only traces the sources on one square, both ends of an LED
+#define BOUND_ELECTRONS (BOUND_STEP_SOURCES * 4 * 2) // 4 generations of 2 electrons from each source
+#define BOUND_STEPS (BOUND_ELECTRONS * 4 + 2 * BOUND_ENDS) // 2 turns of its own, and each end followed twice at most
+#define BOUND_FINDS (2 * BOUND_JOINS + BOUND_ENDS + BOUND_STEPS)
+#define BOUND_FIND_STEPS (BOUND_FINDS * 5)     // the union-find joins by rank, so no path is longer than 5
+#define BOUND_TRACED (BOUND_STEP_SOURCES * NODE_COUNT) // each source traced through every node
+#define NODE_COUNT ((BOARD_WIDTH + 1) * BOARD_HEIGHT + (BOARD_HEIGHT + 1) * BOARD_WIDTH) // as in engine.c
+#define BOUND_ORACLE_PROBES 16                 // a hash is 1, a binary search or Eytzinger layout under 16
+
+typedef uint8_t BOARD[BOARD_HEIGHT][BOARD_WIDTH];
+
+struct COST;
+typedef struct COST COST;
+
+struct COST {
+  ENGINE_COUNTS counts[PHASES];
+  uint32_t cycles[PHASES + 1]; // and the total
+};
+
+struct WORST;
+typedef struct WORST WORST;
+
+struct WORST {
+  BOARD board;
+  COST cost;
+};
+
+struct WORKER;
+typedef struct WORKER WORKER;
+
+struct WORKER {
+  pthread_t thread;
+  uint64_t seed;
+  uint64_t steps;     // how many to take
+  uint64_t evaluated;
+  uint64_t accepted;
+  uint32_t restarts;
+  uint32_t threshold; // the cycles a board needs to get into the worst list
+};
+
+static WORKER workers[MAX_THREADS];
+static uint32_t workerCount;
+static uint8_t objective = OBJECTIVE_TOTAL;
+
+// The slowest boards found by any worker, slowest first
+static WORST worst[MAX_WORST];
+static uint32_t worstCount;
+static uint32_t worstLimit = DEFAULT_WORST;
+static pthread_mutex_t worstLock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint8_t Group(uint8_t piece)
+{
+  switch (piece) {
+  case P_VCC_T ... P_VCC_L:
+    return GROUP_VCC;
+  case P_GND_LTR ... P_GND_BLT:
+    return GROUP_GND;
+  case P_SW1_BL ... P_SW1_RB:
+  case P_SW2_BT ... P_SW2_RL:
+  case P_SW3_BR ... P_SW3_RT:
+    return GROUP_SWITCH;
+  case P_RLED_AB_CR ... P_RLED_AR_CT:
+    return GROUP_RLED;
+  case P_YLED_AL_CR ... P_YLED_AB_CT:
+    return GROUP_YLED;
+  case P_GLED_AB_CL ... P_GLED_AR_CB:
+    return GROUP_GLED;
+  default:
+    return GROUP_NONE;
+  }
+}
+
+static bool IsLegal(const BOARD board)
+{
+  uint8_t seen = 0;
+  for (uint8_t i = 0; i < CELLS; ++i) {
+    uint8_t group = Group(board[i / BOARD_WIDTH][i % BOARD_WIDTH]);
+    if (group == GROUP_NONE)
+      continue;
+    if (seen & (1 << group))
+      return false;
+    seen |= (uint8_t)(1 << group);
+  }
+  return true;
+}
+
+static uint32_t Cycles(const ENGINE_COUNTS* c)
+{
+  return (c->pruneCalls * CYCLES_PRUNE_CALL +
+          c->pruneSquares * CYCLES_PRUNE_SQUARE +
+          c->pruneIterations * CYCLES_PRUNE_ITERATION +
+          c->pruneCopies * CYCLES_PRUNE_COPY +
+          c->pruneDegenerated * CYCLES_PRUNE_DEGENERATED +
+          c->netlistBuilds * CYCLES_NETLIST_BUILD +
+          c->netlistWires * CYCLES_NETLIST_WIRES +
+          c->netlistPieces * CYCLES_NETLIST_PIECE +
+          c->netlistJoins * CYCLES_NETLIST_JOIN +
+          c->netlistEnds * CYCLES_NETLIST_END +
+          c->netlistFindSteps * CYCLES_NETLIST_FIND_STEP +
+          c->netlistSources * CYCLES_NETLIST_SOURCE +
+          c->netlistRepairs * CYCLES_NETLIST_REPAIR +
+          c->netlistTraced * CYCLES_NETLIST_TRACED +
+          c->netlistElectrons * CYCLES_NETLIST_ELECTRON +
+          c->netlistSteps * CYCLES_NETLIST_STEP +
+          c->oracleLookups * CYCLES_ORACLE_LOOKUP +
+          c->oracleProbes * CYCLES_ORACLE_PROBE +
+          c->tableReads * CYCLES_TABLE_READ);
+}
+
+// Runs the steps BoardChanged does, counting each one separately
+static void Evaluate(ENGINE* engine, const BOARD board, COST* cost)
+{
+  memset(cost, 0, sizeof(COST));
+
+  // Starting from an empty board traces every source again
+  memset(engine, 0, sizeof(ENGINE));
+  memset(&engineCounts, 0, sizeof(engineCounts));
+  Engine_PruneBoard(engine, board, PRUNEBOARD_FLAG_NORMAL);
+  cost->counts[PHASE_PRUNE] = engineCounts;
+
+  // BoardChanged checks for the vsync between the steps of the repair, so the slowest one is what counts
+  bool done;
+  do {
+    memset(&engineCounts, 0, sizeof(engineCounts));
+    done = Engine_UpdateNetlistStep(engine);
+    if (Cycles(&engineCounts) >= Cycles(&cost->counts[PHASE_NETLIST]))
+      cost->counts[PHASE_NETLIST] = engineCounts;
+  } while (!done);
+
+  memset(&engineCounts, 0, sizeof(engineCounts));
+  Engine_ConsultOracle(Engine_PackNetlist(engine));
+  cost->counts[PHASE_LOOKUP] = engineCounts;
+
+  memset(&engineCounts, 0, sizeof(engineCounts));
+  if (!Engine_IsShort(engine))
+    Engine_PruneBoard(engine, board, PRUNEBOARD_FLAG_MEETS_RULES | PRUNEBOARD_FLAG_CHECK_ONLY);
+  cost->counts[PHASE_RULES] = engineCounts;
+
+  for (uint8_t p = 0; p < PHASES; ++p) {
+    cost->cycles[p] = Cycles(&cost->counts[p]);
+    cost->cycles[PHASES] += cost->cycles[p];
+  }
+}
+
+// xorshift64, which gets stuck at 0, so every worker starts from somewhere else
+static uint64_t Random(WORKER* w)
+{
+  w->seed ^= w->seed << 13;
+  w->seed ^= w->seed >> 7;
+  w->seed ^= w->seed << 17;
+  return w->seed;
+}
+
+static uint32_t RandomBelow(WORKER* w, uint32_t n)
+{
+  return (uint32_t)((Random(w) >> 32) * n >> 32);
+}
+
+static double RandomUnit(WORKER* w)
+{
+  return (Random(w) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// A random rotation of the same piece, or another position of a switch
+static uint8_t RandomRotation(WORKER* w, uint8_t piece)
+{
+  switch (piece) {
+  case P_VCC_T ... P_GLED_AR_CB:
+    return (piece - 1) / 4 * 4 + 1 + RandomBelow(w, 4);
+  case P_STRAIGHT_LR:
+  case P_STRAIGHT_TB:
+    return P_STRAIGHT_LR + RandomBelow(w, 2);
+  case P_DBL_CORNER_TL_BR:
+  case P_DBL_CORNER_TR_BL:
+    return P_DBL_CORNER_TL_BR + RandomBelow(w, 2);
+  case P_CORNER_BL ... P_CORNER_BR:
+    return P_CORNER_BL + RandomBelow(w, 4);
+  case P_TPIECE_RBL ... P_TPIECE_TRB:
+    return P_TPIECE_RBL + RandomBelow(w, 4);
+  case P_BRIDGE1_TB_LR:
+  case P_BRIDGE2_TB_LR:
+    return P_BRIDGE1_TB_LR + RandomBelow(w, 2);
+  default:
+    return piece;
+  }
+}
+
+static void RandomBoard(WORKER* w, BOARD board)
+{
+  do {
+    for (uint8_t i = 0; i < CELLS; ++i)
+      board[i / BOARD_WIDTH][i % BOARD_WIDTH] = RandomBelow(w, PIECES);
+  } while (!IsLegal(board));
+}
+
+// Changes, turns, or trades a square or two, and keeps trying until the board is still legal
+static void Neighbor(WORKER* w, const BOARD from, BOARD to)
+{
+  do {
+    memcpy(to, from, sizeof(BOARD));
+    uint8_t* cells = &to[0][0];
+    uint8_t a = RandomBelow(w, CELLS);
+    uint8_t b = RandomBelow(w, CELLS);
+    switch (RandomBelow(w, 3)) {
+    case 0:
+      cells[a] = RandomBelow(w, PIECES);
+      break;
+    case 1:
+      cells[a] = RandomRotation(w, cells[a]);
+      break;
+    case 2: {
+      uint8_t piece = cells[a];
+      cells[a] = cells[b];
+      cells[b] = piece;
+      break;
+    }
+    }
+  } while (!memcmp(to, from, sizeof(BOARD)) || !IsLegal(to));
+}
+
+// Adds the board to the worst list if it's slow enough and not already on it, returns the new threshold
+static uint32_t Submit(const BOARD board, const COST* cost)
+{
+  pthread_mutex_lock(&worstLock);
+  uint32_t score = cost->cycles[objective];
+  // Boards that cost exactly the same in every step are almost always the same board with some square that doesn't
+  // matter changed, so only the first of them is kept
+  bool known = false;
+  for (uint32_t i = 0; i < worstCount && !known; ++i)
+    known = !memcmp(worst[i].cost.cycles, cost->cycles, sizeof(cost->cycles));
+  if (!known && (worstCount < worstLimit || score > worst[worstCount - 1].cost.cycles[objective])) {
+    uint32_t i = (worstCount < worstLimit) ? worstCount++ : worstCount - 1;
+    while (i > 0 && worst[i - 1].cost.cycles[objective] < score) {
+      worst[i] = worst[i - 1];
+      --i;
+    }
+    memcpy(worst[i].board, board, sizeof(BOARD));
+    worst[i].cost = *cost;
+  }
+  uint32_t threshold = (worstCount < worstLimit) ? 0 : worst[worstCount - 1].cost.cycles[objective];
+  pthread_mutex_unlock(&worstLock);
+  return threshold;
+}
+
+static void* Anneal(void* arg)
+{
+  WORKER* w = (WORKER*)arg;
+  ENGINE engine = { 0 };
+  BOARD current;
+  BOARD candidate;
+  COST currentCost;
+  COST candidateCost;
+  double cooling = pow(END_TEMPERATURE / START_TEMPERATURE, 1.0 / RESTART_STEPS);
+  double temperature = 0;
+  uint32_t step = RESTART_STEPS;
+
+  while (w->steps) {
+    if (step == RESTART_STEPS) {
+      RandomBoard(w, current);
+      Evaluate(&engine, current, &currentCost);
+      temperature = START_TEMPERATURE;
+      step = 0;
+      w->restarts++;
+    }
+
+    Neighbor(w, current, candidate);
+    Evaluate(&engine, candidate, &candidateCost);
+    w->evaluated++;
+    double delta = (double)candidateCost.cycles[objective] - currentCost.cycles[objective];
+    if (delta >= 0 || RandomUnit(w) < exp(delta / temperature)) {
+      memcpy(current, candidate, sizeof(BOARD));
+      currentCost = candidateCost;
+      w->accepted++;
+      if (currentCost.cycles[objective] > w->threshold)
+        w->threshold = Submit(current, &currentCost);
+    }
+
+    temperature *= cooling;
+    ++step;
+    --w->steps;
+  }
+  return NULL;
+}
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const char* pieceNames[] = {
+  "0",
+  "P_VCC_T", "P_VCC_R", "P_VCC_B", "P_VCC_L",
+  "P_GND_LTR", "P_GND_TRB", "P_GND_RBL", "P_GND_BLT",
+  "P_SW1_BL", "P_SW1_LT", "P_SW1_TR", "P_SW1_RB",
+  "P_RLED_AB_CR", "P_RLED_AL_CB", "P_RLED_AT_CL", "P_RLED_AR_CT",
+  "P_SW2_BT", "P_SW2_LR", "P_SW2_TB", "P_SW2_RL",
+  "P_YLED_AL_CR", "P_YLED_AT_CB", "P_YLED_AR_CL", "P_YLED_AB_CT",
+  "P_SW3_BR", "P_SW3_LB", "P_SW3_TL", "P_SW3_RT",
+  "P_GLED_AB_CL", "P_GLED_AL_CT", "P_GLED_AT_CR", "P_GLED_AR_CB",
+  "P_STRAIGHT_LR", "P_STRAIGHT_TB",
+  "P_DBL_CORNER_TL_BR", "P_DBL_CORNER_TR_BL",
+  "P_CORNER_BL", "P_CORNER_TL", "P_CORNER_TR", "P_CORNER_BR",
+  "P_TPIECE_RBL", "P_TPIECE_BLT", "P_TPIECE_LTR", "P_TPIECE_TRB",
+  "P_BRIDGE1_TB_LR", "P_BRIDGE2_TB_LR",
+  "P_BLOCKER",
+};
+
+static const char* phaseNames[PHASES + 1] = { "prune", "netlist", "lookup", "rules", "total" };
+
+static void PrintCounts(uint8_t phase, const ENGINE_COUNTS* c, uint32_t cycles)
+{
+  printf("  // %-7s %6u cycles:", phaseNames[phase], cycles);
+  switch (phase) {
+  case PHASE_PRUNE:
+  case PHASE_RULES:
+    if (c->pruneCalls)
+      printf(" %u iterations, %u degenerated", c->pruneIterations, c->pruneDegenerated);
+    break;
+  case PHASE_NETLIST:
+    printf(" %u traced, %u pieces, %u joins, %u ends, %u find steps, %u sources, %u electrons, %u steps",
+           c->netlistTraced, c->netlistPieces, c->netlistJoins, c->netlistEnds, c->netlistFindSteps, c->netlistSources,
+           c->netlistElectrons, c->netlistSteps);
+    break;
+  case PHASE_LOOKUP:
+    printf(" %u probes", c->oracleProbes);
+    break;
+  }
+  printf(", %u table reads\n", c->tableReads);
+}
+
+static void PrintBoard(const BOARD board)
+{
+  for (uint8_t y = 0; y < BOARD_HEIGHT; ++y) {
+    printf(" ");
+    for (uint8_t x = 0; x < BOARD_WIDTH; ++x)
+      printf(" %s,", pieceNames[board[y][x]]);
+    printf("\n");
+  }
+}
+
+// What each step costs with every counter at the most it can be for a legal board
+static void Bound(COST* cost)
+{
+  memset(cost, 0, sizeof(COST));
+  ENGINE_COUNTS* c = &cost->counts[PHASE_PRUNE];
+  c->pruneCalls = 1;
+  c->pruneSquares = CELLS;
+  c->pruneIterations = BOUND_PRUNE_ITERATIONS;
+  c->pruneCopies = CELLS;
+  c->pruneDegenerated = CELLS;
+  c->tableReads = 2 * CELLS;
+
+  c = &cost->counts[PHASE_NETLIST];
+  // One square of sources, which finds the wires for their electrons, and then puts every source together
+  c->netlistWires = 1;
+  c->netlistRepairs = 1;
+  c->netlistTraced = BOUND_TRACED;
+  c->netlistPieces = CELLS;
+  c->netlistJoins = BOUND_JOINS;
+  c->netlistEnds = BOUND_ENDS;
+  c->netlistFindSteps = BOUND_FIND_STEPS;
+  c->netlistSources = BOUND_SOURCES;
+  c->netlistElectrons = BOUND_ELECTRONS;
+  c->netlistSteps = BOUND_STEPS;
+  c->tableReads = 2 * 4 * CELLS + BOUND_ENDS + BOUND_STEPS + 2 * BOUND_TRACED + BOUND_SOURCES * (NL_COUNT - 1) * 2;
+
+  c = &cost->counts[PHASE_LOOKUP];
+  c->oracleLookups = 1;
+  c->oracleProbes = BOUND_ORACLE_PROBES;
+  c->tableReads = BOUND_ORACLE_PROBES + 1;
+
+  // With PRUNEBOARD_FLAG_CHECK_ONLY it stops at the first pass that changes anything
+  c = &cost->counts[PHASE_RULES];
+  c->pruneCalls = 1;
+  c->pruneSquares = CELLS;
+  c->pruneIterations = 1;
+  c->tableReads = CELLS;
+
+  for (uint8_t p = 0; p < PHASES; ++p) {
+    cost->cycles[p] = Cycles(&cost->counts[p]);
+    cost->cycles[PHASES] += cost->cycles[p];
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t steps = DEFAULT_STEPS;
+  uint64_t seed = 1;
+  for (;;) {
+    if (argc > 2 && !strcmp(argv[1], "-t"))
+      cpus = atol(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-n"))
+      steps = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-s"))
+      seed = strtoull(argv[2], NULL, 0);
+    else if (argc > 2 && !strcmp(argv[1], "-k"))
+      worstLimit = atoi(argv[2]);
+    else if (argc > 2 && !strcmp(argv[1], "-o")) {
+      for (objective = 0; objective <= PHASES && strcmp(argv[2], phaseNames[objective]); ++objective)
+        ;
+    } else
+      break;
+    argc -= 2;
+    argv += 2;
+  }
+  if (argc > 1 || objective > PHASES || worstLimit < 1 || worstLimit > MAX_WORST) {
+    fprintf(stderr, "Usage: %s [-t threads] [-n steps] [-s seed] [-k boards, up to %u] "
+            "[-o prune|netlist|lookup|rules|total]\n", argv[0], MAX_WORST);
+    return EXIT_FAILURE;
+  }
+  workerCount = (cpus < 1) ? 1 : (cpus > MAX_THREADS) ? MAX_THREADS : (uint32_t)cpus;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    workers[t].seed = (seed + t) * 0x9E3779B97F4A7C15ULL; // xorshift gets stuck at 0
+    workers[t].steps = steps / workerCount + (t < steps % workerCount);
+  }
+
+  double start = Now();
+  for (uint32_t t = 0; t < workerCount; ++t)
+    if (pthread_create(&workers[t].thread, NULL, Anneal, &workers[t])) {
+      perror("pthread_create");
+      return EXIT_FAILURE;
+    }
+  for (uint32_t t = 0; t < workerCount; ++t)
+    pthread_join(workers[t].thread, NULL);
+  double elapsed = Now() - start;
+
+  for (uint32_t i = 0; i < worstCount; ++i) {
+    const WORST* b = &worst[i];
+    printf("  // WORST %02u (%u %s cycles)\n", i + 1, b->cost.cycles[objective], phaseNames[objective]);
+    PrintBoard(b->board);
+    for (uint8_t p = 0; p < PHASES; ++p)
+      PrintCounts(p, &b->cost.counts[p], b->cost.cycles[p]);
+    printf("  // total   %6u cycles\n\n", b->cost.cycles[PHASES]);
+  }
+
+  // The most any board found took for each step, which may be a different board for each
+  uint32_t found[PHASES + 1] = { 0 };
+  for (uint32_t i = 0; i < worstCount; ++i)
+    for (uint8_t p = 0; p <= PHASES; ++p)
+      if (worst[i].cost.cycles[p] > found[p])
+        found[p] = worst[i].cost.cycles[p];
+  COST bound;
+  Bound(&bound);
+  printf("  // Step     Found    Bound  Bound/vsync\n");
+  for (uint8_t p = 0; p <= PHASES; ++p)
+    printf("  // %-7s %6u %8u  %10.3f\n", phaseNames[p], found[p], bound.cycles[p],
+           (double)bound.cycles[p] / PROFILE_CYCLES_PER_VSYNC);
+
+  uint64_t evaluated = 0;
+  uint64_t accepted = 0;
+  uint32_t restarts = 0;
+  for (uint32_t t = 0; t < workerCount; ++t) {
+    evaluated += workers[t].evaluated;
+    accepted += workers[t].accepted;
+    restarts += workers[t].restarts;
+  }
+  fprintf(stderr, "%lu boards on %u threads in %.2f s (%.0f boards/s), %lu moves accepted, %u restarts\n",
+          evaluated, workerCount, elapsed, evaluated / elapsed, accepted, restarts);
+
+  return EXIT_SUCCESS;
+}